@@ -0,0 +1,381 @@
+# Copyright 2025 Daniel Bershatsky
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Asyncio bindings to MLSpace Gateway API.
+
+HTTP/1.1 client is implemented on top of asyncio streams so that no third
+party dependencies are required. Semantics of retries and rate limiting are the
+same as in synchronous :class:`mlspace.api.GatewayV2`.
+"""
+
+import asyncio
+import json
+import logging
+import ssl
+import sys
+from contextlib import asynccontextmanager
+from typing import Any, AsyncIterator, Iterable, Mapping
+from urllib.parse import ParseResult, quote, urlencode, urlparse
+
+if sys.version_info >= (3, 11):
+    from typing import Self
+else:
+    from typing_extensions import Self
+
+from mlspace import config
+from mlspace.api import (IDEMPOTENT_METHODS, Gateway, GatewayError, GatewayV2,
+                         HealthParams, Job, JobStatus, PriorityClass,
+                         RequestNotSent, RetryPolicy, TokenBucket,
+                         decode_content, filter_params, parse_retry_after)
+
+__all__ = ('AsyncConnection', 'AsyncConnectionPool', 'AsyncGateway',
+           'AsyncGatewayV2')
+
+MAX_LINE_LENGTH = 65536
+
+logger = logging.getLogger(__name__)
+
+
+class AsyncConnection:
+    """Single HTTP/1.1 connection which supports keep-alive."""
+
+    def __init__(self, host: str, reader: asyncio.StreamReader,
+                 writer: asyncio.StreamWriter):
+        self.host = host
+        self.reader = reader
+        self.writer = writer
+        self.will_close = False
+
+    @classmethod
+    async def open(cls, url: ParseResult,
+                   timeout: float | None = None) -> Self:
+        if url.hostname is None:
+            raise ValueError(f'Endpoint does not have hostname: {url}.')
+        match url.scheme:
+            case 'http':
+                ctx, port = None, url.port or 80
+            case 'https':
+                ctx, port = ssl.create_default_context(), url.port or 443
+            case _:
+                raise ValueError(f'Unknown endpoint scheme: {url.geturl()}.')
+        reader, writer = await asyncio.wait_for(
+            asyncio.open_connection(url.hostname, port, ssl=ctx,
+                                    limit=MAX_LINE_LENGTH), timeout)
+        return cls(url.netloc, reader, writer)
+
+    def close(self):
+        self.will_close = True
+        self.writer.close()
+
+    async def request(self, method: str, path: str, headers: dict[str, str],
+                      body: bytes | None = None,
+                      ) -> tuple[int, str, dict[str, str], bytes]:
+        lines = [f'{method} {path} HTTP/1.1', f'host: {self.host}']
+        lines.extend(f'{k}: {v}' for k, v in headers.items())
+        lines.append(f'content-length: {len(body or b"")}')
+        head = ('\r\n'.join(lines) + '\r\n\r\n').encode('latin-1')
+        try:
+            self.writer.write(head + (body or b''))
+            await self.writer.drain()
+        except OSError as e:
+            raise RequestNotSent(e) from e
+
+        status_line = await self.reader.readline()
+        if not status_line:
+            raise ConnectionResetError('Connection is closed by server.')
+        try:
+            _, status, reason = status_line.decode('latin-1').split(' ', 2)
+            code = int(status)
+        except ValueError as e:
+            raise ConnectionError(f'Malformed status line: {status_line!r}.') \
+                from e
+
+        res_headers: dict[str, str] = {}
+        while (line := await self.reader.readline()) not in (b'\r\n', b'\n'):
+            if not line:
+                raise ConnectionResetError('Connection is closed by server.')
+            key, _, value = line.decode('latin-1').partition(':')
+            res_headers[key.strip().lower()] = value.strip()
+
+        if res_headers.get('connection', '').lower() == 'close':
+            self.will_close = True
+        if method == 'HEAD' or code in (204, 304) or 100 <= code < 200:
+            content = b''
+        elif res_headers.get('transfer-encoding', '').lower() == 'chunked':
+            content = await self.read_chunked()
+        elif (length := res_headers.get('content-length')) is not None:
+            content = await self.reader.readexactly(int(length))
+        else:
+            content = await self.reader.read()
+            self.will_close = True
+        return code, reason.strip(), res_headers, content
+
+    async def read_chunked(self) -> bytes:
+        chunks = []
+        while True:
+            line = await self.reader.readline()
+            size = int(line.split(b';', 1)[0], 16)
+            if size == 0:
+                # Skip trailers.
+                while (await self.reader.readline()) not in (b'\r\n', b''):
+                    pass
+                return b''.join(chunks)
+            chunks.append(await self.reader.readexactly(size))
+            await self.reader.readexactly(2)  # CRLF
+
+
+class AsyncConnectionPool:
+    """Pool of keep-alive connections which also bounds number of concurrent
+    requests by `size`.
+    """
+
+    def __init__(self, url: ParseResult, size: int = 16,
+                 timeout: float | None = 30.0):
+        self.url = url
+        self.size = size
+        self.timeout = timeout
+        self.semaphore = asyncio.Semaphore(size)
+        self.idle: list[AsyncConnection] = []
+
+    @asynccontextmanager
+    async def connection(self) -> AsyncIterator[tuple[AsyncConnection, bool]]:
+        async with self.semaphore:
+            conn = self.idle.pop() if self.idle else None
+            reused = conn is not None
+            if conn is None:
+                try:
+                    conn = await AsyncConnection.open(self.url, self.timeout)
+                except (OSError, asyncio.TimeoutError) as e:
+                    raise RequestNotSent(e) from e
+            try:
+                yield conn, reused
+            except BaseException:
+                conn.close()
+                raise
+            if conn.will_close:
+                conn.close()
+            else:
+                self.idle.append(conn)
+
+    async def close(self):
+        idle, self.idle = self.idle, []
+        for conn in idle:
+            conn.close()
+        for conn in idle:
+            try:
+                await conn.writer.wait_closed()
+            except OSError:
+                pass
+
+
+class AsyncGatewayV2:
+    """Asynchronous counterpart of :class:`mlspace.api.GatewayV2`.
+
+    Number of concurrent requests is bounded by `pool_size` so that
+    thousands of jobs can be submitted with :meth:`job_run_many` or with
+    plain :func:`asyncio.gather` at once.
+    """
+
+    ENDPOINT = GatewayV2.ENDPOINT
+
+    JOB_RUN_PATH = '/public/v2/jobs'
+
+    JOBS_PATH = GatewayV2.JOBS_PATH
+
+    def __init__(self, api_key: str | None = None,
+                 access_token: str | None = None,
+                 workspace_id: str | None = None,
+                 endpoint: str | None = None,
+                 pool_size: int = 16,
+                 retry: RetryPolicy | None = None,
+                 rate_limit: float | None = None,
+                 timeout: float | None = 30.0):
+        self.access_token = access_token or config.access_token
+        self.api_key = api_key or config.api_key
+        self.workspace_id = workspace_id or config.workspace_id
+        self.endpoint: str = endpoint or self.ENDPOINT
+
+        self.url = urlparse(self.endpoint)
+        if self.url.hostname is None:
+            raise ValueError(
+                f'Endpoint does not have hostname: {self.endpoint}.')
+
+        self.timeout = timeout
+        self.pool = AsyncConnectionPool(self.url, pool_size, timeout)
+        self.retry = retry or RetryPolicy()
+        self.bucket = TokenBucket(rate_limit)
+
+        self.headers = {
+            'authorization': f'Bearer {self.access_token}',
+            'accept': 'application/json',
+            'content-type': 'application/json',
+            'x-api-key': self.api_key,
+            'x-workspace-id': self.workspace_id,
+        }
+
+    async def __aenter__(self):
+        return self
+
+    async def __aexit__(self, *args):
+        await self.close()
+
+    async def close(self):
+        await self.pool.close()
+
+    async def request(self, method: str, path: str, body: Any = None,
+                      idempotent: bool | None = None) -> Any:
+        """See :meth:`mlspace.api.GatewayV2.request`."""
+        if idempotent is None:
+            idempotent = method in IDEMPOTENT_METHODS
+        data = None
+        if body is not None:
+            data = json.dumps(body, ensure_ascii=False).encode('utf-8')
+
+        attempt = 0
+        while True:
+            attempt += 1
+            while (delay := self.bucket.try_acquire()) > 0:
+                await asyncio.sleep(delay)
+            try:
+                status, reason, headers, content = await self._send(
+                    method, path, data)
+            except (OSError, asyncio.IncompleteReadError,
+                    asyncio.TimeoutError) as e:
+                retryable = idempotent or isinstance(e, RequestNotSent)
+                if not retryable or attempt >= self.retry.max_attempts:
+                    raise
+                delay = self.retry.backoff(attempt)
+                logger.warning('request %s %s failed (attempt %d): %r; retry '
+                               'in %.2fs', method, path, attempt, e, delay)
+                await asyncio.sleep(delay)
+                continue
+
+            if 200 <= status < 300:
+                return decode_content(headers.get('content-type'), content)
+
+            if (attempt < self.retry.max_attempts and
+                    self.retry.should_retry(status, idempotent)):
+                delay = self.retry.backoff(attempt)
+                retry_after = parse_retry_after(headers.get('retry-after'))
+                if retry_after is not None:
+                    delay = min(retry_after, self.retry.backoff_max)
+                if status == 429:
+                    self.bucket.pause(delay)
+                logger.warning('request %s %s failed with status %d (attempt '
+                               '%d); retry in %.2fs', method, path, status,
+                               attempt, delay)
+                if status != 429:
+                    await asyncio.sleep(delay)  # Otherwise, bucket waits.
+                continue
+
+            raise self._error(status, reason, content)
+
+    async def _send(self, method: str, path: str, data: bytes | None,
+                    ) -> tuple[int, str, dict[str, str], bytes]:
+        async with self.pool.connection() as (conn, reused):
+            try:
+                return await asyncio.wait_for(
+                    conn.request(method, path, self.headers, data),
+                    self.timeout)
+            except ConnectionResetError as e:
+                # Server closes idle keep-alive connections at any moment.
+                if reused:
+                    raise RequestNotSent(e) from e
+                raise
+
+    _error = GatewayV2._error
+
+    async def ping(self) -> bool:
+        try:
+            await self.request('GET', '/ping')
+        except GatewayError:
+            return False
+        return True
+
+    async def job_kill(self, job_name: str):
+        await self.request('DELETE', f'{self.JOBS_PATH}/{quote(job_name)}')
+
+    async def job_list(self, region: str | None = None,
+                       status: JobStatus | None = None) -> list[Job]:
+        """See :meth:`mlspace.api.GatewayV2.job_list`."""
+        path = self.JOBS_PATH
+        params = filter_params({'region': region, 'status': status})
+        if query := urlencode(params):
+            path = f'{path}?{query}'
+        payload = await self.request('GET', path)
+        if isinstance(payload, dict):
+            payload = payload.get('jobs', [])
+        return [Job.from_dict(obj) for obj in payload or []]
+
+    async def job_run(
+        self,
+        script: str,
+        base_image: str,
+        instance_type: str,
+        region: str | None = None,
+        type_: str = 'binary',
+        n_workers: int = 1,
+        process_per_worker: int | None = None,
+        job_desc: str | None = None,
+        internet: bool | None = None,
+        max_retry: int | None = None,
+        priority_class: PriorityClass | None = None,
+        health_params: HealthParams | None = None,
+        flags: dict[str, str] = {},
+        env_variables: dict[str, str] = {},
+        **kwargs,
+    ) -> str:
+        """See :meth:`mlspace.api.GatewayV2.job_run`."""
+        params = {**locals()}
+        params.pop('self')
+        params.pop('kwargs')
+        params['type'] = params.pop('type_')
+        params.update(kwargs)
+        payload = await self.request('POST', self.JOB_RUN_PATH,
+                                     filter_params(params))
+        return payload['job_name']
+
+    async def job_run_many(self, jobs: Iterable[Mapping[str, Any]],
+                           return_exceptions: bool = False,
+                           ) -> list[str | BaseException]:
+        """Submit jobs concurrently (see
+        :meth:`mlspace.api.GatewayV2.job_run_many`).
+        """
+        coros = [self.job_run(**job) for job in jobs]
+        return await asyncio.gather(*coros,
+                                    return_exceptions=return_exceptions)
+
+    async def job_status(self, job_name: str) -> Job:
+        path = f'{self.JOBS_PATH}/{quote(job_name)}'
+        return Job.from_dict(await self.request('GET', path))
+
+
+class AsyncGateway(AsyncGatewayV2):
+    """Asynchronous counterpart of :class:`mlspace.api.Gateway`."""
+
+    ENDPOINT = Gateway.ENDPOINT
+
+    JOB_RUN_PATH = '/run_job'
+
+    JOBS_PATH = Gateway.JOBS_PATH
+
+    def __init__(self, api_key: str | None = None,
+                 access_token: str | None = None,
+                 workspace_id: str | None = None,
+                 endpoint: str | None = None, **kwargs):
+        endpoint = endpoint or config.gateway_v1_endpoint or Gateway.ENDPOINT
+        super().__init__(api_key, access_token, workspace_id, endpoint,
+                         **kwargs)
+
+    _error = Gateway._error
@@ -0,0 +1,90 @@
+# Copyright 2025 Daniel Bershatsky
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import asyncio
+from typing import Iterator
+
+import pytest
+
+from mlspace.aio import AsyncGatewayV2
+from mlspace.api import GatewayError, RetryPolicy
+from mlspace.testing import MockServer, spawn_mock_server
+
+
+@pytest.fixture(scope='module')
+def gwapi() -> Iterator[MockServer]:
+    server, thread = spawn_mock_server()
+    try:
+        yield server
+    finally:
+        server.stop()
+        thread.join()
+
+
+class TestAsyncGatewayV2:
+
+    KWARGS = {
+        'api_key': 'API_KEY',
+        'access_token': 'JWT',
+        'workspace_id': '00000000-0000-0000-0000-000000000000',
+    }
+
+    RETRY = RetryPolicy(backoff_base=0.01, backoff_max=0.05)
+
+    JOB = {
+        'script': '/home/user/.cache/mlspace/launch',
+        'base_image': 'cr.ai.cloud.ru/8ff21ec0-666d-4950/job-example',
+        'instance_type': 'v100.1gpu',
+    }
+
+    def test_ping(self, gwapi: MockServer):
+        async def run():
+            async with AsyncGatewayV2(**self.KWARGS,
+                                      endpoint=gwapi.endpoint) as cli:
+                assert await cli.ping()
+                assert await cli.ping()
+                assert len(cli.pool.idle) == 1  # Connection is kept alive.
+        asyncio.run(run())
+
+    def test_job_run_retry(self, gwapi: MockServer):
+        async def run():
+            async with AsyncGatewayV2(**self.KWARGS, endpoint=gwapi.endpoint,
+                                      retry=self.RETRY) as cli:
+                num_requests = gwapi.num_requests
+                gwapi.inject(429, retry_after=0)
+                gwapi.inject(503)
+                assert await cli.job_run(**self.JOB)
+                assert gwapi.num_requests - num_requests == 3
+        asyncio.run(run())
+
+    def test_job_run_no_retry(self, gwapi: MockServer):
+        async def run():
+            async with AsyncGatewayV2(**self.KWARGS, endpoint=gwapi.endpoint,
+                                      retry=self.RETRY) as cli:
+                gwapi.inject(500)
+                with pytest.raises(GatewayError) as e:
+                    await cli.job_run(**self.JOB)
+                assert e.value.status == 500
+        asyncio.run(run())
+
+    def test_job_run_many(self, gwapi: MockServer):
+        async def run():
+            async with AsyncGatewayV2(**self.KWARGS, endpoint=gwapi.endpoint,
+                                      retry=self.RETRY, pool_size=4) as cli:
+                gwapi.inject(429, count=3, retry_after=0)
+                job_names = await cli.job_run_many([self.JOB] * 64)
+                assert len(job_names) == 64
+                assert len(set(job_names)) == 64
+                assert 1 <= len(cli.pool.idle) <= 4
+        asyncio.run(run())
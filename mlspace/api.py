@@ -14,15 +14,23 @@
 
 import json
 import logging
+import random
+import time
+from concurrent.futures import ThreadPoolExecutor
+from contextlib import contextmanager
 from dataclasses import dataclass, field
-from datetime import datetime
-from http.client import HTTPConnection, HTTPSConnection
-from typing import Literal
-from urllib.parse import urlparse
+from datetime import datetime, timezone
+from email.utils import parsedate_to_datetime
+from http.client import (HTTPConnection, HTTPException, HTTPSConnection,
+                         RemoteDisconnected)
+from threading import Lock
+from typing import Any, Iterable, Iterator, Literal, Mapping
+from urllib.parse import ParseResult, quote, urlencode, urlparse
 
 from mlspace import config
 
-__all__ = ('HealthParams', 'GatewayV2', 'PriorityClass')
+__all__ = ('ConnectionPool', 'GatewayError', 'HealthParams', 'GatewayV2',
+           'Job', 'JobStatus', 'PriorityClass', 'RetryPolicy', 'TokenBucket')
 
 API_SPEC_URL = 'https://api.ai.cloud.ru/public/v2/redoc'
 
@@ -31,6 +39,11 @@ PriorityClass = Literal['low', 'medium', 'high']
 JobType = Literal['binary', 'horovod', 'pytorch', 'pytorch2',
                   'pytorch_elastic', 'spark', 'nogpu', 'binary_exp']
 
+JobStatus = Literal['Completed', 'Failed', 'Pending', 'Running', 'Stopped']
+
+# Job never leaves these states.
+TERMINAL_STATUSES = frozenset({'Completed', 'Failed', 'Stopped'})
+
 logger = logging.getLogger(__name__)
 
 
@@ -41,9 +54,224 @@ class Job:
 
     name: str
 
-    status: Literal['Completed', 'Failed', 'Pending', 'Running']
+    status: JobStatus
+
+    created_at: datetime | None = None
 
-    created_at: datetime
+    @property
+    def done(self) -> bool:
+        return self.status in TERMINAL_STATUSES
+
+    @classmethod
+    def from_dict(cls, obj: Mapping[str, Any]) -> 'Job':
+        name = obj.get('job_name') or obj['name']
+        created_at = None
+        match obj.get('created_at'):
+            case int() | float() as ts:
+                created_at = datetime.fromtimestamp(ts, timezone.utc)
+            case str() as ts:
+                created_at = datetime.fromisoformat(ts)
+        return cls(name, obj['status'], created_at)
+
+
+@dataclass
+class LogChunk:
+    """Piece of job log which starts at byte `offset`."""
+
+    data: bytes
+
+    offset: int
+
+    next_offset: int
+
+    complete: bool = False  # There is no more output.
+
+
+class GatewayError(RuntimeError):
+    """Gateway responded with non-successful status."""
+
+    def __init__(self, message: str, status: int | None = None,
+                 code: str | None = None):
+        super().__init__(message)
+        self.status = status
+        self.code = code
+
+
+@dataclass
+class RetryPolicy:
+    """Retry policy with exponential backoff and full jitter.
+
+    Idempotent requests are retried on connection failures and on all
+    `retry_statuses`. Non-idempotent requests (e.g. job submission) are retried
+    only if a server has certainly not processed them: on connection failure
+    before a request is sent, on stale keep-alive connection, and on 429 or
+    503 responses.
+    """
+
+    max_attempts: int = 5
+
+    backoff_base: float = 0.5
+
+    backoff_max: float = 30.0
+
+    retry_statuses: frozenset[int] = frozenset({429, 500, 502, 503, 504})
+
+    unprocessed_statuses: frozenset[int] = frozenset({429, 503})
+
+    def backoff(self, attempt: int) -> float:
+        """Delay before attempt `attempt + 1` (attempts start from 1)."""
+        upper = min(self.backoff_max, self.backoff_base * 2 ** (attempt - 1))
+        return random.uniform(0, upper)
+
+    def should_retry(self, status: int, idempotent: bool) -> bool:
+        if idempotent:
+            return status in self.retry_statuses
+        return status in self.unprocessed_statuses
+
+
+class TokenBucket:
+    """Thread-safe token bucket shared by all requests of a client.
+
+    Besides steady `rate` (requests per second) with `burst`, a bucket can be
+    paused by a server with 429 and `Retry-After` header. Then all requests
+    wait until the pause ends. If `rate` is `None` then only pauses apply.
+    """
+
+    def __init__(self, rate: float | None, burst: int | None = None,
+                 clock=time.monotonic, sleep=time.sleep):
+        if rate is not None and rate <= 0:
+            raise ValueError(f'Rate must be positive: {rate}.')
+        self.rate = rate
+        self.burst = burst or max(1, int(rate or 1))
+        self.clock = clock
+        self.sleep = sleep
+        self.lock = Lock()
+        self.tokens = float(self.burst)
+        self.updated_at = clock()
+        self.paused_until = 0.0
+
+    def acquire(self):
+        while (delay := self.try_acquire()) > 0:
+            self.sleep(delay)
+
+    def try_acquire(self) -> float:
+        """Take a token if available. Otherwise, return time to wait."""
+        with self.lock:
+            now = self.clock()
+            if now < self.paused_until:
+                return self.paused_until - now
+            if self.rate is None:
+                return 0.0
+            elapsed = now - self.updated_at
+            self.tokens = min(self.burst, self.tokens + elapsed * self.rate)
+            self.updated_at = now
+            if self.tokens >= 1:
+                self.tokens -= 1
+                return 0.0
+            return (1 - self.tokens) / self.rate
+
+    def pause(self, delay: float):
+        with self.lock:
+            self.paused_until = max(self.paused_until, self.clock() + delay)
+            self.tokens = 0
+
+
+def parse_retry_after(value: str | None) -> float | None:
+    """Parse `Retry-After` header which is either seconds or HTTP date."""
+    if value is None:
+        return None
+    try:
+        return max(0.0, float(value))
+    except ValueError:
+        pass
+    try:
+        date = parsedate_to_datetime(value)
+    except (TypeError, ValueError):
+        return None
+    return max(0.0, (date - datetime.now(timezone.utc)).total_seconds())
+
+
+class ConnectionPool:
+    """Thread-safe pool of keep-alive connections to a single host.
+
+    Connections are created on demand and returned to the pool once a response
+    is completely read. There is no limit on number of connections in use but
+    at most `size` idle connections are kept.
+    """
+
+    def __init__(self, url: ParseResult, size: int = 8,
+                 timeout: float | None = 30.0):
+        match url.scheme:
+            case 'http':
+                self.factory: type[HTTPConnection] = HTTPConnection
+            case 'https':
+                self.factory = HTTPSConnection
+            case _:
+                raise ValueError(f'Unknown endpoint scheme: {url.geturl()}.')
+        if url.hostname is None:
+            raise ValueError(f'Endpoint does not have hostname: {url}.')
+        self.host: str = url.hostname
+        self.port = url.port
+        self.size = size
+        self.timeout = timeout
+        self.lock = Lock()
+        self.idle: list[HTTPConnection] = []
+
+    @contextmanager
+    def connection(self) -> Iterator[tuple[HTTPConnection, bool]]:
+        """Acquire a connection and a flag whether it has been used before.
+        Connection is dropped if exception is raised.
+        """
+        with self.lock:
+            conn = self.idle.pop() if self.idle else None
+        reused = conn is not None
+        if conn is None:
+            conn = self.factory(self.host, self.port, timeout=self.timeout)
+        try:
+            yield conn, reused
+        except BaseException:
+            conn.close()
+            raise
+        with self.lock:
+            if len(self.idle) < self.size:
+                self.idle.append(conn)
+                return
+        conn.close()
+
+    def close(self):
+        with self.lock:
+            idle, self.idle = self.idle, []
+        for conn in idle:
+            conn.close()
+
+
+class RequestNotSent(ConnectionError):
+    """Request has certainly not reached a server so it is safe to retry."""
+
+
+IDEMPOTENT_METHODS = frozenset({'GET', 'HEAD', 'OPTIONS', 'PUT', 'DELETE'})
+
+
+def decode_content(content_type: str | None, content: bytes) -> Any:
+    """Decode JSON response or return text for other media types (e.g. logs).
+    """
+    if not content:
+        return None
+    if content_type and not content_type.startswith('application/json'):
+        return content.decode('utf-8', errors='replace')
+    return json.loads(content)
+
+
+def filter_params(params: dict[str, Any]) -> dict[str, Any]:
+    """Drop unspecified (`None`) and empty parameters."""
+    filtered_params = {}
+    for k, v in params.items():
+        if v is None:
+            continue
+        if isinstance(v, dict | list | tuple) and len(v) == 0:
+            continue
+        filtered_params[k] = v
+    return filtered_params
 
 
 @dataclass
@@ -68,15 +296,26 @@ class HealthParams:
 class GatewayV2:
     f"""Partially bound MLSpace Public API v2.
 
+    Client is thread-safe: requests are sent over a pool of keep-alive
+    connections, transient failures are retried according to `retry` policy,
+    and request rate is limited by `rate_limit` (requests per second) and by
+    server with 429 and `Retry-After`.
+
     [1]: {API_SPEC_URL}
     """
 
     ENDPOINT = 'https://api.ai.cloud.ru'
 
+    JOBS_PATH = '/public/v2/jobs'
+
     def __init__(self, api_key: str | None = None,
                  access_token: str | None = None,
                  workspace_id: str | None = None,
-                 endpoint: str | None = None):
+                 endpoint: str | None = None,
+                 pool_size: int = 8,
+                 retry: RetryPolicy | None = None,
+                 rate_limit: float | None = None,
+                 timeout: float | None = 30.0):
         # TODO(@daskol): Populate from module-level configuration object.
         self.access_token = access_token or config.access_token
         self.api_key = api_key or config.api_key
@@ -88,14 +327,9 @@ class GatewayV2:
             raise ValueError(
                 f'Endpoint does not have hostname: {self.endpoint}.')
 
-        # TODO(@daskol): No retries out of the box.
-        match self.url.scheme:
-            case 'http':
-                self.conn = HTTPConnection(self.url.hostname, self.url.port)
-            case 'https':
-                self.conn = HTTPSConnection(self.url.hostname, self.url.port)
-            case _:
-                raise ValueError(f'Unknown endpoint scheme: {self.endpoint}.')
+        self.pool = ConnectionPool(self.url, pool_size, timeout)
+        self.retry = retry or RetryPolicy()
+        self.bucket = TokenBucket(rate_limit)
 
         self.headers = {
             'authorization': f'Bearer {self.access_token}',
@@ -105,19 +339,167 @@ class GatewayV2:
             'x-workspace-id': self.workspace_id,
         }
 
-    def ping(self) -> bool:
-        """Test availablility of a remote or local mock server."""
-        self.conn.request('GET', '/ping', None, self.headers)
-        return self.conn.getresponse().status == 200
+    def __enter__(self):
+        return self
 
-    def job_kill(self):
-        pass
+    def __exit__(self, *args):
+        self.close()
 
-    def job_list(self):
-        pass
+    def close(self):
+        self.pool.close()
 
-    def job_logs(self):
-        pass
+    def request(self, method: str, path: str, body: Any = None,
+                idempotent: bool | None = None) -> Any:
+        """Send request with retries and return decoded JSON response (or
+        `None` if response is empty).
+
+        Args:
+          idempotent: Whether request can be safely repeated. By default, it is
+          determined by HTTP method.
+        """
+        headers, content = self.request_raw(method, path, body, idempotent)
+        return decode_content(headers.get('content-type'), content)
+
+    def request_raw(self, method: str, path: str, body: Any = None,
+                    idempotent: bool | None = None) -> tuple[Any, bytes]:
+        """Send request with retries and return headers and raw content of
+        successful response (see :meth:`request`).
+        """
+        if idempotent is None:
+            idempotent = method in IDEMPOTENT_METHODS
+        data = None
+        if body is not None:
+            data = json.dumps(body, ensure_ascii=False).encode('utf-8')
+
+        attempt = 0
+        while True:
+            attempt += 1
+            self.bucket.acquire()
+            try:
+                status, reason, headers, content = self._send(
+                    method, path, data)
+            except (OSError, HTTPException) as e:
+                retryable = idempotent or isinstance(e, RequestNotSent)
+                if not retryable or attempt >= self.retry.max_attempts:
+                    raise
+                delay = self.retry.backoff(attempt)
+                logger.warning('request %s %s failed (attempt %d): %s; retry '
+                               'in %.2fs', method, path, attempt, e, delay)
+                time.sleep(delay)
+                continue
+
+            if 200 <= status < 300:
+                return headers, content
+
+            if (attempt < self.retry.max_attempts and
+                    self.retry.should_retry(status, idempotent)):
+                delay = self.retry.backoff(attempt)
+                retry_after = parse_retry_after(headers.get('retry-after'))
+                if retry_after is not None:
+                    delay = min(retry_after, self.retry.backoff_max)
+                if status == 429:
+                    self.bucket.pause(delay)
+                logger.warning('request %s %s failed with status %d (attempt '
+                               '%d); retry in %.2fs', method, path, status,
+                               attempt, delay)
+                if status != 429:
+                    time.sleep(delay)  # Otherwise, bucket waits.
+                continue
+
+            raise self._error(status, reason, content)
+
+    def _send(self, method: str, path: str,
+              data: bytes | None) -> tuple[int, str, Any, bytes]:
+        with self.pool.connection() as (conn, reused):
+            # Request can not be processed by server if it is not sent
+            # completely.
+            try:
+                conn.request(method, path, data, self.headers)
+            except OSError as e:
+                raise RequestNotSent(e) from e
+            # Server closes idle keep-alive connections at any moment so that
+            # stale connection is detected on reading response.
+            try:
+                res = conn.getresponse()
+            except RemoteDisconnected as e:
+                if reused:
+                    raise RequestNotSent(e) from e
+                raise
+            content = res.read()
+            return res.status, res.reason, res.headers, content
+
+    def _error(self, status: int, reason: str, content: bytes) -> GatewayError:
+        try:
+            payload = json.loads(content)
+        except json.JSONDecodeError:
+            logger.error('failed to decode JSON response: %s', content)
+            return GatewayError(
+                f'Request failed with status {status} ({reason}).', status)
+        code = payload.get('error_code', 'no code')
+        desc = payload.get('error_message', 'no description')
+        return GatewayError(
+            f'Request failed with status {status} ({reason}): '
+            f'[{code}] {desc}.', status, code)
+
+    def ping(self) -> bool:
+        """Test availablility of a remote or local mock server."""
+        try:
+            self.request('GET', '/ping')
+        except GatewayError:
+            return False
+        return True
+
+    def job_kill(self, job_name: str):
+        """Stop a job. Killing of already finished job is not an error."""
+        self.request('DELETE', f'{self.JOBS_PATH}/{quote(job_name)}')
+
+    def job_list(self, region: str | None = None,
+                 status: JobStatus | None = None) -> list[Job]:
+        """List jobs of a workspace. It is the only way to query status of
+        many jobs with a single request (see :class:`mlspace.poller.Poller`).
+        """
+        path = self.JOBS_PATH
+        params = filter_params({'region': region, 'status': status})
+        if query := urlencode(params):
+            path = f'{path}?{query}'
+        payload = self.request('GET', path)
+        if isinstance(payload, dict):
+            payload = payload.get('jobs', [])
+        return [Job.from_dict(obj) for obj in payload or []]
+
+    def job_logs(self, job_name: str, tail: int | None = None) -> str:
+        """Fetch logs of a job or only `tail` last lines."""
+        path = f'{self.JOBS_PATH}/{quote(job_name)}/logs'
+        if tail is not None:
+            path = f'{path}?{urlencode({"tail": tail})}'
+        payload = self.request('GET', path)
+        if isinstance(payload, dict):
+            payload = payload.get('logs', '')
+        if isinstance(payload, list):
+            payload = '\n'.join(payload)
+        return payload or ''
+
+    def job_logs_chunk(self, job_name: str, offset: int = 0,
+                       wait: float | None = None) -> LogChunk:
+        """Fetch logs starting from byte `offset`.
+
+        Server returns bytes from `offset` and the next offset in
+        `x-log-offset` header; `x-log-complete` is set once a job is finished
+        and its log is read completely. With `wait` server may hold a request
+        up to `wait` seconds until new output appears (long polling). If a
+        server ignores offset (i.e. there is no `x-log-offset` header) then
+        whole log is returned and it is sliced here.
+        """
+        path = f'{self.JOBS_PATH}/{quote(job_name)}/logs'
+        params = filter_params({'offset': offset or None, 'wait': wait})
+        if query := urlencode(params):
+            path = f'{path}?{query}'
+        headers, content = self.request_raw('GET', path)
+        complete = headers.get('x-log-complete') in ('1', 'true')
+        if (value := headers.get('x-log-offset')) is None:
+            return LogChunk(content[offset:], offset,
+                            max(offset, len(content)), complete)
+        return LogChunk(content, offset, int(value), complete)
 
     def job_run(
         self,
@@ -148,30 +530,37 @@ class GatewayV2:
         params.pop('kwargs')
         params['type'] = params.pop('type_')
         params.update(kwargs)
-        filtered_params = {}
-        for k, v in params.items():
-            if v is None:
-                continue
-            if isinstance(v, dict | list | tuple) and len(v) == 0:
-                continue
-            filtered_params[k] = v
-        body = json.dumps(filtered_params, ensure_ascii=False)
-
-        self.conn.request('POST', '/public/v2/jobs', body, self.headers)
-        res = self.conn.getresponse()
-        if res.status != 200:
-            payload = json.load(res)
-            code = payload.get('error_code', 'no code')
-            desc = payload.get('error_message', 'no description')
-            raise RuntimeError(
-                f'Request failed with status {res.status} ({res.reason}): '
-                f'[{code}] {desc}.')
-
-        payload = json.load(res)
+        payload = self.request('POST', self.JOBS_PATH,
+                               filter_params(params))
         return payload['job_name']
 
-    def job_status(self):
-        pass
+    def job_run_many(self, jobs: Iterable[Mapping[str, Any]],
+                     max_workers: int | None = None,
+                     return_exceptions: bool = False,
+                     ) -> list[str | BaseException]:
+        """Submit jobs concurrently. Every item of `jobs` is keyword arguments
+        of :meth:`job_run`. Job names are returned in the same order.
+
+        If `return_exceptions` is false then the first failure is raised once
+        all submissions complete. Otherwise, exceptions are returned in place
+        of job names.
+        """
+        max_workers = max_workers or self.pool.size
+        with ThreadPoolExecutor(max_workers, 'gwapi') as executor:
+            futures = [executor.submit(self.job_run, **job) for job in jobs]
+        results: list[str | BaseException] = []
+        for future in futures:
+            if (exc := future.exception()) is None:
+                results.append(future.result())
+            elif return_exceptions:
+                results.append(exc)
+            else:
+                raise exc
+        return results
+
+    def job_status(self, job_name: str) -> Job:
+        payload = self.request('GET', f'{self.JOBS_PATH}/{quote(job_name)}')
+        return Job.from_dict(payload)
 
 
 class Gateway(GatewayV2):
@@ -179,12 +568,15 @@ class Gateway(GatewayV2):
 
     ENDPOINT = 'https://api.ai.cloud.ru/public/v1/'
 
+    JOBS_PATH = '/jobs'
+
     def __init__(self, api_key: str | None = None,
                  access_token: str | None = None,
                  workspace_id: str | None = None,
-                 endpoint: str | None = None):
+                 endpoint: str | None = None, **kwargs):
         endpoint = endpoint or config.gateway_v1_endpoint or Gateway.ENDPOINT
-        super().__init__(api_key, access_token, workspace_id, endpoint)
+        super().__init__(api_key, access_token, workspace_id, endpoint,
+                         **kwargs)
 
     def job_run(
         self,
@@ -209,30 +601,18 @@ class Gateway(GatewayV2):
         params.pop('kwargs')
         params['type'] = params.pop('type_')
         params.update(kwargs)
-        filtered_params = {}
-        for k, v in params.items():
-            if v is None:
-                continue
-            if isinstance(v, dict | list | tuple) and len(v) == 0:
-                continue
-            filtered_params[k] = v
-        body = json.dumps(filtered_params, ensure_ascii=False)
-
-        self.conn.request('POST', '/run_job', body, self.headers)
-        res = self.conn.getresponse()
-        if res.status != 200:
-            content = res.read()
-            try:
-                payload = json.loads(content)
-            except json.JSONDecodeError:
-                logger.error('failed to decode JSON response: %s', content)
-                raise RuntimeError(
-                    f'Request failed with status {res.status} ({res.reason}).')
-            reason = payload.get('reason', 'no reason')
-            status = payload.get('status', 'no status')
-            raise RuntimeError(
-                f'Request failed with status {res.status} ({res.reason}): '
-                f'[{status}] {reason}.')
-
-        payload = json.loads(payload)
+        payload = self.request('POST', '/run_job', filter_params(params))
         return payload['job_name']
+
+    def _error(self, status: int, reason: str, content: bytes) -> GatewayError:
+        try:
+            payload = json.loads(content)
+        except json.JSONDecodeError:
+            logger.error('failed to decode JSON response: %s', content)
+            return GatewayError(
+                f'Request failed with status {status} ({reason}).', status)
+        desc = payload.get('reason', 'no reason')
+        code = payload.get('status', 'no status')
+        return GatewayError(
+            f'Request failed with status {status} ({reason}): '
+            f'[{code}] {desc}.', status, code)
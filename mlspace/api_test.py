@@ -16,7 +16,8 @@ from typing import Iterator
 
 import pytest
 
-from mlspace.api import GatewayV2, HealthParams
+from mlspace.api import (GatewayError, GatewayV2, HealthParams, RetryPolicy,
+                         TokenBucket, parse_retry_after)
 from mlspace.testing import MockServer, spawn_mock_server
 
 
@@ -49,6 +50,60 @@ class TestHealthParams:
             _ = HealthParams(20)
 
 
+class FakeClock:
+
+    def __init__(self):
+        self.now = 0.0
+
+    def __call__(self) -> float:
+        return self.now
+
+    def sleep(self, delay: float):
+        self.now += delay
+
+
+class TestTokenBucket:
+
+    def test_rate(self):
+        clock = FakeClock()
+        bucket = TokenBucket(2.0, burst=2, clock=clock, sleep=clock.sleep)
+        for _ in range(6):
+            bucket.acquire()
+        # Two tokens are available at once and then two tokens per second.
+        assert clock.now == pytest.approx(2.0)
+
+    def test_pause(self):
+        clock = FakeClock()
+        bucket = TokenBucket(None, clock=clock, sleep=clock.sleep)
+        bucket.acquire()
+        assert clock.now == 0
+        bucket.pause(1.5)
+        bucket.acquire()
+        assert clock.now == pytest.approx(1.5)
+
+
+class TestRetryPolicy:
+
+    def test_backoff(self):
+        policy = RetryPolicy(backoff_base=1.0, backoff_max=5.0)
+        for attempt in range(1, 10):
+            delay = policy.backoff(attempt)
+            assert 0 <= delay <= min(5.0, 2 ** (attempt - 1))
+
+    def test_should_retry(self):
+        policy = RetryPolicy()
+        assert policy.should_retry(500, idempotent=True)
+        assert not policy.should_retry(500, idempotent=False)
+        assert policy.should_retry(429, idempotent=False)
+        assert not policy.should_retry(400, idempotent=True)
+
+    def test_parse_retry_after(self):
+        assert parse_retry_after(None) is None
+        assert parse_retry_after('2') == 2.0
+        assert parse_retry_after('Wed, 21 Oct 2015 07:28:00 GMT') == 0.0
+        assert parse_retry_after('soon') is None
+
+
 class TestGatewayV2:
 
     KWARGS = {
@@ -57,10 +112,82 @@ class TestGatewayV2:
         'workspace_id': '00000000-0000-0000-0000-000000000000',
     }
 
+    RETRY = RetryPolicy(backoff_base=0.01, backoff_max=0.05)
+
+    JOB = {
+        'script': '/home/user/.cache/mlspace/launch',
+        'base_image': 'cr.ai.cloud.ru/8ff21ec0-666d-4950/job-example',
+        'instance_type': 'v100.1gpu',
+    }
+
     def test_ping(self, gwapi: MockServer):
         cli = GatewayV2(**self.KWARGS, endpoint=gwapi.endpoint)
         assert cli.ping()
         assert cli.ping()
+        assert len(cli.pool.idle) == 1  # Connection is kept alive.
+
+    def test_job_run_retry(self, gwapi: MockServer):
+        cli = GatewayV2(**self.KWARGS, endpoint=gwapi.endpoint,
+                        retry=self.RETRY)
+        num_requests = gwapi.num_requests
+        gwapi.inject(429, retry_after=0)
+        gwapi.inject(503)
+        assert cli.job_run(**self.JOB)
+        assert gwapi.num_requests - num_requests == 3
+
+    def test_job_run_no_retry(self, gwapi: MockServer):
+        cli = GatewayV2(**self.KWARGS, endpoint=gwapi.endpoint,
+                        retry=self.RETRY)
+        gwapi.inject(500)
+        with pytest.raises(GatewayError) as e:
+            cli.job_run(**self.JOB)
+        assert e.value.status == 500
+
+    def test_job_run_many(self, gwapi: MockServer):
+        cli = GatewayV2(**self.KWARGS, endpoint=gwapi.endpoint,
+                        retry=self.RETRY, pool_size=4)
+        gwapi.inject(429, count=3, retry_after=0)
+        job_names = cli.job_run_many([self.JOB] * 32)
+        assert len(job_names) == 32
+        assert len(set(job_names)) == 32
+        assert 1 <= len(cli.pool.idle) <= 4
+
+    def test_job_status(self, gwapi: MockServer):
+        cli = GatewayV2(**self.KWARGS, endpoint=gwapi.endpoint)
+        job_name = cli.job_run(**self.JOB, region='SR006')
+        job = cli.job_status(job_name)
+        assert job.name == job_name
+        assert job.status == 'Completed'
+        assert job.done
+        assert job.created_at is not None
+
+        with pytest.raises(GatewayError) as e:
+            cli.job_status('no-such-job')
+        assert e.value.status == 404
+
+    def test_job_list(self, gwapi: MockServer):
+        cli = GatewayV2(**self.KWARGS, endpoint=gwapi.endpoint)
+        job_names = {cli.job_run(**self.JOB, region='SR008')
+                     for _ in range(3)}
+        jobs = cli.job_list(region='SR008')
+        assert {job.name for job in jobs} == job_names
+        assert cli.job_list(region='SR008', status='Running') == []
+
+    def test_job_logs(self, gwapi: MockServer):
+        cli = GatewayV2(**self.KWARGS, endpoint=gwapi.endpoint)
+        job_name = cli.job_run(**self.JOB)
+        assert job_name in cli.job_logs(job_name)
+
+    def test_job_kill(self, gwapi: MockServer):
+        cli = GatewayV2(**self.KWARGS, endpoint=gwapi.endpoint)
+        gwapi.set_durations(run=60)
+        try:
+            job_name = cli.job_run(**self.JOB)
+        finally:
+            gwapi.set_durations()
+        assert cli.job_status(job_name).status == 'Running'
+        cli.job_kill(job_name)
+        assert cli.job_status(job_name).status == 'Stopped'
 
     def test_job_run(self, gwapi: MockServer):
         cli = GatewayV2(**self.KWARGS, endpoint=gwapi.endpoint)
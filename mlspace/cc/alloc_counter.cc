@@ -0,0 +1,149 @@
+// Copyright 2025 Daniel Bershatsky
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "alloc_counter.h"
+
+#include <cstdlib>
+#include <new>
+
+namespace mlspace {
+
+namespace {
+
+// Counters are plain thread-local integers: they are constant-initialized
+// and need neither allocation nor synchronization.
+thread_local AllocStats stats;
+
+void *Allocate(size_t size) {
+    ++stats.num_allocs;
+    stats.num_bytes += size;
+    return std::malloc(size ? size : 1);
+}
+
+void *AllocateAligned(size_t size, std::align_val_t align) {
+    ++stats.num_allocs;
+    stats.num_bytes += size;
+    auto alignment = static_cast<size_t>(align);
+    size = (size + alignment - 1) / alignment * alignment;
+    return std::aligned_alloc(alignment, size ? size : alignment);
+}
+
+void Deallocate(void *ptr) {
+    if (ptr != nullptr) {
+        ++stats.num_frees;
+        std::free(ptr);
+    }
+}
+
+} // namespace
+
+AllocStats GetAllocStats(void) {
+    return stats;
+}
+
+} // namespace mlspace
+
+using mlspace::Allocate;
+using mlspace::AllocateAligned;
+using mlspace::Deallocate;
+
+void *operator new(size_t size) {
+    if (auto ptr = Allocate(size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new[](size_t size) {
+    return operator new(size);
+}
+
+void *operator new(size_t size, std::nothrow_t const &) noexcept {
+    return Allocate(size);
+}
+
+void *operator new[](size_t size, std::nothrow_t const &) noexcept {
+    return Allocate(size);
+}
+
+void *operator new(size_t size, std::align_val_t align) {
+    if (auto ptr = AllocateAligned(size, align)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new[](size_t size, std::align_val_t align) {
+    return operator new(size, align);
+}
+
+void *operator new(size_t size, std::align_val_t align,
+                   std::nothrow_t const &) noexcept {
+    return AllocateAligned(size, align);
+}
+
+void *operator new[](size_t size, std::align_val_t align,
+                     std::nothrow_t const &) noexcept {
+    return AllocateAligned(size, align);
+}
+
+void operator delete(void *ptr) noexcept {
+    Deallocate(ptr);
+}
+
+void operator delete[](void *ptr) noexcept {
+    Deallocate(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept {
+    Deallocate(ptr);
+}
+
+void operator delete[](void *ptr, size_t) noexcept {
+    Deallocate(ptr);
+}
+
+void operator delete(void *ptr, std::align_val_t) noexcept {
+    Deallocate(ptr);
+}
+
+void operator delete[](void *ptr, std::align_val_t) noexcept {
+    Deallocate(ptr);
+}
+
+void operator delete(void *ptr, size_t, std::align_val_t) noexcept {
+    Deallocate(ptr);
+}
+
+void operator delete[](void *ptr, size_t, std::align_val_t) noexcept {
+    Deallocate(ptr);
+}
+
+void operator delete(void *ptr, std::nothrow_t const &) noexcept {
+    Deallocate(ptr);
+}
+
+void operator delete[](void *ptr, std::nothrow_t const &) noexcept {
+    Deallocate(ptr);
+}
+
+void operator delete(void *ptr, std::align_val_t,
+                     std::nothrow_t const &) noexcept {
+    Deallocate(ptr);
+}
+
+void operator delete[](void *ptr, std::align_val_t,
+                       std::nothrow_t const &) noexcept {
+    Deallocate(ptr);
+}
@@ -0,0 +1,94 @@
+// Copyright 2025 Daniel Bershatsky
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace mlspace {
+
+// AllocStats are counters of heap allocations made by the current thread.
+//
+// Counting is enabled by linking `alloc_counter.cc` which replaces global
+// `operator new` and `operator delete`. It is linked to tests only, so that
+// the launcher itself is not affected.
+struct AllocStats {
+    size_t num_allocs = 0;
+    size_t num_frees = 0;
+    size_t num_bytes = 0;
+
+    AllocStats operator-(AllocStats const &that) const {
+        return {num_allocs - that.num_allocs, num_frees - that.num_frees,
+                num_bytes - that.num_bytes};
+    }
+};
+
+// GetAllocStats returns counters of the current thread since its start.
+AllocStats GetAllocStats(void);
+
+// AllocScope counts allocations since its construction.
+class AllocScope {
+public:
+    AllocScope(void) : begin_{GetAllocStats()} {
+    }
+
+    AllocStats Stats(void) const {
+        return GetAllocStats() - begin_;
+    }
+
+private:
+    AllocStats begin_;
+};
+
+// AllocPhases records allocations of consecutive phases of a pipeline, e.g.
+// parsing of command line, decoding, and parsing of a job. Each call of
+// `Mark` closes the current phase and starts a new one.
+class AllocPhases {
+public:
+    AllocPhases(void) {
+        phases_.reserve(8);
+        last_ = GetAllocStats();
+    }
+
+    void Mark(std::string_view name) {
+        auto now = GetAllocStats();
+        phases_.emplace_back(name, now - last_);
+        // Exclude the allocation of a phase name from the next phase.
+        last_ = GetAllocStats();
+    }
+
+    AllocStats operator[](std::string_view name) const {
+        for (auto const &[key, stats] : phases_) {
+            if (key == name) {
+                return stats;
+            }
+        }
+        return {};
+    }
+
+    std::vector<std::pair<std::string, AllocStats>> const &
+    phases(void) const {
+        return phases_;
+    }
+
+private:
+    AllocStats last_;
+    std::vector<std::pair<std::string, AllocStats>> phases_;
+};
+
+} // namespace mlspace
@@ -0,0 +1,155 @@
+// Copyright 2025 Daniel Bershatsky
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <mlspace/cc/alloc_counter.h>
+#include <mlspace/cc/base64.h>
+#include <mlspace/cc/cli.h>
+#include <mlspace/cc/job.h>
+#include <mlspace/cc/template.h>
+
+// Allocation budgets of launch pipeline. Budgets are proportional to number
+// of fields (args, env entries, chunks) and must not depend on size of
+// payload, so each test compares a small input with a large one.
+
+using mlspace::AllocPhases;
+using mlspace::AllocScope;
+using mlspace::AllocStats;
+using mlspace::Base64;
+using mlspace::ExecBuffer;
+using mlspace::Job;
+using mlspace::Spec;
+using mlspace::TemplateVars;
+
+namespace {
+
+// MakeJob makes JSON of a job with `num_fields` args and env entries of
+// `value_size` bytes each.
+std::string MakeJob(size_t num_fields, size_t value_size) {
+    std::string value(value_size, 'x');
+    std::string args, env;
+    for (size_t ix = 0; ix != num_fields; ++ix) {
+        auto sep = ix ? "," : "";
+        args += sep + ('"' + value + "-${RANK}\"");
+        env += sep + ("\"VAR_" + std::to_string(ix) + "\":\"" + value + '"');
+    }
+    return R"({"executable":"python","args":[)" + args + R"(],"env":{)" +
+           env + R"(},"work_dir":null})";
+}
+
+// MakeArgs makes command line of `launch` with `num_chunks` chunks of
+// `chunk_size` bytes each.
+std::vector<std::string> MakeArgs(size_t num_chunks, size_t chunk_size) {
+    std::vector<std::string> args = {"launch", "--spec-version", "1",
+                                     "--spec-num-chunks",
+                                     std::to_string(num_chunks)};
+    for (size_t ix = 0; ix != num_chunks; ++ix) {
+        args.push_back(std::string{Spec::opt_chunk_} + std::to_string(ix));
+        args.push_back(std::string(chunk_size, 'A'));
+    }
+    return args;
+}
+
+AllocStats ParseArgs(std::vector<std::string> const &args) {
+    std::vector<std::string_view> views(args.begin(), args.end());
+    AllocScope scope;
+    auto spec = Spec::FromArgs(views);
+    EXPECT_TRUE(spec);
+    EXPECT_EQ(spec->chunks.size(), (args.size() - 5) / 2);
+    return scope.Stats();
+}
+
+AllocStats ParseJob(std::string const &json) {
+    AllocScope scope;
+    auto job = Job::FromJSON(json);
+    EXPECT_TRUE(job);
+    return scope.Stats();
+}
+
+} // namespace
+
+TEST(AllocCounter, Counts) {
+    AllocScope scope;
+    auto ptr = std::make_unique<int[]>(16);
+    auto aligned = std::make_unique<std::max_align_t>();
+    EXPECT_EQ(scope.Stats().num_allocs, 2);
+    EXPECT_GE(scope.Stats().num_bytes, 16 * sizeof(int));
+    ptr.reset();
+    EXPECT_EQ(scope.Stats().num_frees, 1);
+
+    AllocPhases phases;
+    std::string str(64, 'x');
+    phases.Mark("string");
+    phases.Mark("nothing");
+    EXPECT_EQ(phases["string"].num_allocs, 1);
+    EXPECT_EQ(phases["nothing"].num_allocs, 0);
+}
+
+TEST(AllocBudget, Base64Decode) {
+    Base64 base64;
+    for (size_t size : {4, 4096, 1 << 20}) {
+        auto encoded = base64.Encode(std::string(size, '\x5a'));
+        AllocScope scope;
+        auto decoded = base64.Decode(encoded);
+        ASSERT_TRUE(decoded);
+        EXPECT_LE(scope.Stats().num_allocs, 1) << "size=" << size;
+    }
+}
+
+TEST(AllocBudget, SpecFromArgs) {
+    for (size_t num_chunks : {1, 4, 16}) {
+        auto small = ParseArgs(MakeArgs(num_chunks, 16));
+        auto large = ParseArgs(MakeArgs(num_chunks, 1 << 20));
+        EXPECT_LE(small.num_allocs, 4 + 2 * num_chunks) << num_chunks;
+        EXPECT_EQ(large.num_allocs, small.num_allocs) << num_chunks;
+    }
+}
+
+TEST(AllocBudget, JobFromJSON) {
+    for (size_t num_fields : {1, 8, 64}) {
+        auto small = ParseJob(MakeJob(num_fields, 16));
+        auto large = ParseJob(MakeJob(num_fields, 64 << 10));
+        // Each field is an arg and an env entry, both of which are parsed to
+        // JSON, copied to job, and parsed to templates.
+        EXPECT_LE(small.num_allocs, 64 + 16 * num_fields) << num_fields;
+        // Lexer buffer of JSON parser grows geometrically up to the longest
+        // value, so payload adds a logarithmic number of allocations.
+        EXPECT_LE(large.num_allocs, small.num_allocs + 2 * 16) << num_fields;
+    }
+}
+
+TEST(AllocBudget, Spawn) {
+    for (size_t num_fields : {1, 8, 64}) {
+        auto job = Job::FromJSON(MakeJob(num_fields, 4096));
+        ASSERT_TRUE(job);
+        char const *env[] = {"RANK=3", "PATH=/bin", nullptr};
+        AllocPhases phases;
+        auto vars = TemplateVars::FromEnv(env);
+        phases.Mark("vars");
+        ExecBuffer exec;
+        exec.Build(*job, vars, const_cast<char *const *>(env));
+        phases.Mark("build");
+        exec.Build(*job, vars, const_cast<char *const *>(env));
+        phases.Mark("rebuild");
+        EXPECT_LE(phases["vars"].num_allocs, 1);
+        EXPECT_LE(phases["build"].num_allocs, 3) << num_fields;
+        EXPECT_EQ(phases["rebuild"].num_allocs, 0) << num_fields;
+    }
+}
@@ -34,7 +34,8 @@ inline bool DecodeQuad(std::array<uint8_t, 256> const &map, Inp begin, Inp end,
     int32_t len = 0;
     uint32_t buf = 0;
     for (auto it = begin; it != end; ++it) {
-        if (auto bits = map[*it]; bits == Base64::unknown_mask) {
+        auto bits = map[static_cast<uint8_t>(*it)];
+        if (bits == Base64::unknown_mask) {
             return false;
         } else if (bits == Base64::padding_mask) {
             break;
@@ -51,7 +52,7 @@ inline bool DecodeQuad(std::array<uint8_t, 256> const &map, Inp begin, Inp end,
     return static_cast<bool>(len & 0b11000);
 }
 
-std::optional<std::string> Base64::Decode(std::string const &s) {
+std::optional<std::string> Base64::Decode(std::string_view s) {
     // Single character can not encode a byte.
     if (s.size() % 4 == 1) {
         return std::nullopt;
@@ -39,7 +39,7 @@ public:
 public:
     Base64(void);
 
-    std::optional<std::string> Decode(std::string const &str);
+    std::optional<std::string> Decode(std::string_view str);
 
     std::string Encode(std::string const &str);
 };
@@ -0,0 +1,393 @@
+// Copyright 2025 Daniel Bershatsky
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "codec.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <queue>
+#include <vector>
+
+namespace mlspace {
+
+namespace {
+
+constexpr size_t min_match = 4;
+constexpr size_t last_literals = 5; // Sequence ends with literals.
+constexpr size_t match_margin = 12; // Last match starts before that.
+constexpr size_t max_offset = 65535;
+constexpr int hash_bits = 14;
+constexpr int max_code_len = 11;
+
+uint32_t Load32(char const *ptr) {
+    uint32_t value;
+    std::memcpy(&value, ptr, sizeof(value));
+    return value;
+}
+
+uint32_t Hash(uint32_t value) {
+    return (value * 2654435761u) >> (32 - hash_bits);
+}
+
+// PutLength writes remainder of length which does not fit to token.
+char *PutLength(char *out, size_t len) {
+    for (; len >= 255; len -= 255) {
+        *out++ = static_cast<char>(255);
+    }
+    *out++ = static_cast<char>(len);
+    return out;
+}
+
+char *PutSequence(char *out, char const *literals, size_t num_literals,
+                  size_t offset, size_t match_len) {
+    auto *token = reinterpret_cast<uint8_t *>(out++);
+    *token = (num_literals < 15 ? num_literals : 15) << 4;
+    if (num_literals >= 15) {
+        out = PutLength(out, num_literals - 15);
+    }
+    std::memcpy(out, literals, num_literals);
+    out += num_literals;
+    if (match_len == 0) {
+        return out; // The last sequence has no match.
+    }
+    *out++ = static_cast<char>(offset & 0xff);
+    *out++ = static_cast<char>(offset >> 8);
+    match_len -= min_match;
+    *token |= match_len < 15 ? match_len : 15;
+    if (match_len >= 15) {
+        out = PutLength(out, match_len - 15);
+    }
+    return out;
+}
+
+// GetLength reads remainder of length and returns false on overrun.
+bool GetLength(uint8_t const *&in, uint8_t const *end, size_t &len) {
+    uint8_t byte;
+    do {
+        if (in == end) {
+            return false;
+        }
+        byte = *in++;
+        len += byte;
+    } while (byte == 255);
+    return true;
+}
+
+// CodeLengths builds Huffman tree of byte frequencies and returns code
+// lengths. Frequencies are halved until no code is longer than the limit.
+std::array<uint8_t, 256> CodeLengths(std::array<uint32_t, 256> freqs) {
+    std::array<uint8_t, 256> lens{};
+    std::vector<int> parent(512);
+    while (true) {
+        using Node = std::pair<uint32_t, int>; // Weight and index.
+        std::priority_queue<Node, std::vector<Node>, std::greater<Node>> queue;
+        for (int sym = 0; sym != 256; ++sym) {
+            if (freqs[sym] > 0) {
+                queue.emplace(freqs[sym], sym);
+            }
+        }
+        if (queue.size() == 1) {
+            lens[queue.top().second] = 1;
+            return lens;
+        }
+        int next = 256;
+        while (queue.size() > 1) {
+            auto [lhs_weight, lhs] = queue.top();
+            queue.pop();
+            auto [rhs_weight, rhs] = queue.top();
+            queue.pop();
+            parent[lhs] = parent[rhs] = next;
+            queue.emplace(lhs_weight + rhs_weight, next++);
+        }
+        int root = next - 1;
+        int max_len = 0;
+        for (int sym = 0; sym != 256; ++sym) {
+            if (freqs[sym] == 0) {
+                continue;
+            }
+            int len = 0;
+            for (int node = sym; node != root; node = parent[node]) {
+                ++len;
+            }
+            lens[sym] = len;
+            max_len = std::max(max_len, len);
+        }
+        if (max_len <= max_code_len) {
+            return lens;
+        }
+        for (auto &freq : freqs) {
+            freq = freq > 0 ? (freq + 1) / 2 : 0;
+        }
+    }
+}
+
+// CanonicalCodes assigns codes in order of length and byte value and
+// reverses their bits since codes are read from the least significant bit.
+// It returns false if lengths are not a prefix code.
+bool CanonicalCodes(std::array<uint8_t, 256> const &lens,
+                    std::array<uint16_t, 256> &codes) {
+    std::array<int, max_code_len + 1> counts{};
+    for (auto len : lens) {
+        counts[len] += 1;
+    }
+    counts[0] = 0;
+    std::array<uint32_t, max_code_len + 2> next{};
+    uint32_t code = 0;
+    for (int len = 1; len <= max_code_len; ++len) {
+        code = (code + counts[len - 1]) << 1;
+        next[len] = code;
+        if (code + counts[len] > (1u << len)) {
+            return false;
+        }
+    }
+    for (int sym = 0; sym != 256; ++sym) {
+        if (auto len = lens[sym]; len > 0) {
+            uint32_t value = next[len]++;
+            uint16_t reversed = 0;
+            for (int bit = 0; bit != len; ++bit) {
+                reversed |= ((value >> bit) & 1) << (len - 1 - bit);
+            }
+            codes[sym] = reversed;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+size_t LzCompress(std::string_view src, char *dst) {
+    std::array<uint32_t, 1 << hash_bits> table{};
+    auto const *base = src.data();
+    auto size = src.size();
+    char *out = dst;
+    size_t anchor = 0;
+    if (size > match_margin) {
+        auto limit = size - match_margin;
+        auto match_limit = size - last_literals;
+        size_t pos = 1;
+        table[Hash(Load32(base))] = 0;
+        while (pos < limit) {
+            auto &slot = table[Hash(Load32(base + pos))];
+            size_t cand = slot;
+            slot = pos;
+            if (pos - cand > max_offset ||
+                Load32(base + cand) != Load32(base + pos)) {
+                // Step grows with length of literal run.
+                pos += 1 + ((pos - anchor) >> 6);
+                continue;
+            }
+            while (pos > anchor && cand > 0 &&
+                   base[pos - 1] == base[cand - 1]) {
+                --pos;
+                --cand;
+            }
+            auto len = min_match;
+            while (pos + len < match_limit &&
+                   base[pos + len] == base[cand + len]) {
+                ++len;
+            }
+            out = PutSequence(out, base + anchor, pos - anchor, pos - cand,
+                              len);
+            pos += len;
+            anchor = pos;
+            if (pos < limit) {
+                table[Hash(Load32(base + pos - 2))] = pos - 2;
+            }
+        }
+    }
+    out = PutSequence(out, base + anchor, size - anchor, 0, 0);
+    return out - dst;
+}
+
+std::optional<size_t> LzDecompress(std::string_view src, char *dst,
+                                   size_t capacity) {
+    auto const *in = reinterpret_cast<uint8_t const *>(src.data());
+    auto const *end = in + src.size();
+    size_t pos = 0;
+    while (in != end) {
+        auto token = *in++;
+        size_t num_literals = token >> 4;
+        if (num_literals == 15 && !GetLength(in, end, num_literals)) {
+            return std::nullopt;
+        }
+        if (num_literals > static_cast<size_t>(end - in) ||
+            num_literals > capacity - pos) {
+            return std::nullopt;
+        }
+        std::memcpy(dst + pos, in, num_literals);
+        in += num_literals;
+        pos += num_literals;
+        if (in == end) {
+            break; // The last sequence has no match.
+        }
+        if (end - in < 2) {
+            return std::nullopt;
+        }
+        size_t offset = in[0] | in[1] << 8;
+        in += 2;
+        size_t len = token & 15;
+        if (len == 15 && !GetLength(in, end, len)) {
+            return std::nullopt;
+        }
+        len += min_match;
+        if (offset == 0 || offset > pos || len > capacity - pos) {
+            return std::nullopt;
+        }
+        auto *from = dst + pos - offset;
+        if (offset >= len) {
+            std::memcpy(dst + pos, from, len);
+        } else {
+            for (size_t ix = 0; ix != len; ++ix) {
+                dst[pos + ix] = from[ix]; // Overlapping copy repeats pattern.
+            }
+        }
+        pos += len;
+    }
+    return pos;
+}
+
+size_t HuffmanEncode(std::string_view src, char *dst) {
+    // Repeated bytes do not stall on the same counter with interleaved
+    // histograms.
+    std::array<std::array<uint32_t, 256>, 4> hists{};
+    auto const *ptr = reinterpret_cast<uint8_t const *>(src.data());
+    size_t pos = 0;
+    for (; pos + 4 <= src.size(); pos += 4) {
+        hists[0][ptr[pos]] += 1;
+        hists[1][ptr[pos + 1]] += 1;
+        hists[2][ptr[pos + 2]] += 1;
+        hists[3][ptr[pos + 3]] += 1;
+    }
+    for (; pos != src.size(); ++pos) {
+        hists[0][ptr[pos]] += 1;
+    }
+    std::array<uint32_t, 256> freqs;
+    for (int sym = 0; sym != 256; ++sym) {
+        freqs[sym] = hists[0][sym] + hists[1][sym] + hists[2][sym] +
+                     hists[3][sym];
+    }
+    std::array<uint8_t, 256> lens{};
+    std::array<uint16_t, 256> codes{};
+    if (!src.empty()) {
+        lens = CodeLengths(freqs);
+        CanonicalCodes(lens, codes);
+    }
+
+    uint32_t size = src.size();
+    std::memcpy(dst, &size, sizeof(size));
+    auto *out = reinterpret_cast<uint8_t *>(dst + 4);
+    for (int sym = 0; sym != 256; sym += 2) {
+        *out++ = lens[sym] | lens[sym + 1] << 4;
+    }
+    // Complete bytes are written with a single store and the rest is kept.
+    // Bound reserves room for the store past the end.
+    uint64_t bits = 0;
+    int num_bits = 0;
+    for (auto ch : src) {
+        auto sym = static_cast<uint8_t>(ch);
+        bits |= static_cast<uint64_t>(codes[sym]) << num_bits;
+        num_bits += lens[sym];
+        std::memcpy(out, &bits, sizeof(bits));
+        out += num_bits >> 3;
+        bits >>= num_bits & ~7;
+        num_bits &= 7;
+    }
+    if (num_bits > 0) {
+        *out++ = static_cast<uint8_t>(bits);
+    }
+    return reinterpret_cast<char *>(out) - dst;
+}
+
+std::optional<size_t> HuffmanDecode(std::string_view src, char *dst,
+                                    size_t capacity) {
+    if (src.size() < 132) {
+        return std::nullopt;
+    }
+    uint32_t size;
+    std::memcpy(&size, src.data(), sizeof(size));
+    if (size > capacity) {
+        return std::nullopt;
+    }
+    std::array<uint8_t, 256> lens;
+    for (int ix = 0; ix != 128; ++ix) {
+        auto byte = static_cast<uint8_t>(src[4 + ix]);
+        lens[2 * ix] = byte & 15;
+        lens[2 * ix + 1] = byte >> 4;
+        if (lens[2 * ix] > max_code_len || lens[2 * ix + 1] > max_code_len) {
+            return std::nullopt;
+        }
+    }
+    std::array<uint16_t, 256> codes;
+    if (!CanonicalCodes(lens, codes)) {
+        return std::nullopt;
+    }
+
+    // Table maps the next bits to byte and its code length (zero is for
+    // bits which are not a code).
+    constexpr uint32_t mask = (1u << max_code_len) - 1;
+    std::array<uint16_t, 1 << max_code_len> table{};
+    for (int sym = 0; sym != 256; ++sym) {
+        if (auto len = lens[sym]; len > 0) {
+            for (uint32_t ix = codes[sym]; ix <= mask; ix += 1u << len) {
+                table[ix] = sym << 4 | len;
+            }
+        }
+    }
+
+    auto const *in = reinterpret_cast<uint8_t const *>(src.data()) + 132;
+    auto const *end = reinterpret_cast<uint8_t const *>(src.data()) +
+                      src.size();
+    uint64_t bits = 0;
+    int num_bits = 0;
+    uint32_t pos = 0;
+
+    // Refill at least 56 bits at once and decode 4 codes of at most 11 bits
+    // while there are 8 bytes of input.
+    while (size - pos >= 4 && end - in >= 8) {
+        uint64_t next;
+        std::memcpy(&next, in, sizeof(next));
+        bits |= next << num_bits;
+        in += (63 - num_bits) >> 3;
+        num_bits |= 56;
+        for (int ix = 0; ix != 4; ++ix) {
+            auto entry = table[bits & mask];
+            int len = entry & 15;
+            if (len == 0) {
+                return std::nullopt;
+            }
+            dst[pos++] = static_cast<char>(entry >> 4);
+            bits >>= len;
+            num_bits -= len;
+        }
+    }
+    for (; pos != size; ++pos) {
+        while (num_bits <= 56 && in != end) {
+            bits |= static_cast<uint64_t>(*in++) << num_bits;
+            num_bits += 8;
+        }
+        auto entry = table[bits & mask];
+        int len = entry & 15;
+        if (len == 0 || len > num_bits) {
+            return std::nullopt;
+        }
+        dst[pos] = static_cast<char>(entry >> 4);
+        bits >>= len;
+        num_bits -= len;
+    }
+    return size;
+}
+
+} // namespace mlspace
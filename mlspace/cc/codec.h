@@ -0,0 +1,70 @@
+// Copyright 2025 Daniel Bershatsky
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string_view>
+
+namespace mlspace {
+
+// Codec is a pair of fast byte-oriented compressors for job output which
+// are used one after another.
+//
+// Lz is a LZ77 compressor. Compressed data is in LZ4 block format, so that
+// it is decoded by any LZ4 implementation (e.g. `lz4.block` in Python) and by
+// the pure-Python decoder in `mlspace/journal.py`. Compressor is greedy with
+// a single hash table of 4-byte sequences and it skips ahead faster in
+// incompressible data.
+//
+// Huffman is an order-0 entropy coder with canonical codes of at most 11
+// bits. It squeezes numbers and short literals which LZ77 does not. Encoded
+// data is a header of decoded size and code lengths of all bytes, and a
+// stream of codes which are packed from the least significant bit.
+//
+//     u32:size u8[128]:lengths bits[]
+//
+// Decoders check all bounds and fail on malformed input rather than reading
+// or writing out of buffers.
+
+// LzBound returns capacity of output buffer which is enough to compress
+// `size` bytes.
+constexpr size_t LzBound(size_t size) {
+    return size + size / 255 + 16;
+}
+
+// LzCompress compresses `src` to `dst` of at least `LzBound(src.size())`
+// bytes and returns compressed size.
+size_t LzCompress(std::string_view src, char *dst);
+
+// LzDecompress decompresses `src` to `dst` of `capacity` bytes and returns
+// decompressed size or `std::nullopt` if `src` is malformed or does not fit.
+std::optional<size_t> LzDecompress(std::string_view src, char *dst,
+                                   size_t capacity);
+
+constexpr size_t HuffmanBound(size_t size) {
+    return 4 + 128 + size * 11 / 8 + 8;
+}
+
+// HuffmanEncode encodes `src` to `dst` of at least `HuffmanBound(src.size())`
+// bytes and returns encoded size.
+size_t HuffmanEncode(std::string_view src, char *dst);
+
+// HuffmanDecode decodes `src` to `dst` of `capacity` bytes and returns
+// decoded size or `std::nullopt` if `src` is malformed or does not fit.
+std::optional<size_t> HuffmanDecode(std::string_view src, char *dst,
+                                    size_t capacity);
+
+} // namespace mlspace
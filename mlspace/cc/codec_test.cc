@@ -0,0 +1,165 @@
+// Copyright 2025 Daniel Bershatsky
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdio>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <mlspace/cc/codec.h>
+
+using mlspace::HuffmanBound;
+using mlspace::HuffmanDecode;
+using mlspace::HuffmanEncode;
+using mlspace::LzBound;
+using mlspace::LzCompress;
+using mlspace::LzDecompress;
+
+namespace {
+
+std::string Compress(std::string_view src) {
+    std::string dst(LzBound(src.size()), '\0');
+    dst.resize(LzCompress(src, dst.data()));
+    return dst;
+}
+
+std::optional<std::string> Decompress(std::string_view src, size_t size) {
+    std::string dst(size, '\0');
+    auto res = LzDecompress(src, dst.data(), dst.size());
+    if (!res) {
+        return std::nullopt;
+    }
+    dst.resize(*res);
+    return dst;
+}
+
+std::string Encode(std::string_view src) {
+    std::string dst(HuffmanBound(src.size()), '\0');
+    dst.resize(HuffmanEncode(src, dst.data()));
+    return dst;
+}
+
+std::optional<std::string> Decode(std::string_view src, size_t size) {
+    std::string dst(size, '\0');
+    auto res = HuffmanDecode(src, dst.data(), dst.size());
+    if (!res) {
+        return std::nullopt;
+    }
+    dst.resize(*res);
+    return dst;
+}
+
+std::string Random(size_t size, uint32_t range) {
+    std::mt19937 rng(0);
+    std::string str(size, '\0');
+    for (auto &ch : str) {
+        ch = static_cast<char>(rng() % range);
+    }
+    return str;
+}
+
+// TrainingLog imitates output of a training loop: repeated lines with
+// changing numbers.
+std::string TrainingLog(size_t num_lines) {
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> loss(0.5, 3.0);
+    std::string log;
+    char line[256];
+    for (size_t ix = 0; ix != num_lines; ++ix) {
+        snprintf(line, sizeof(line),
+                 "2025-01-01 12:%02zu:%02zu INFO trainer: step=%zu "
+                 "loss=%.4f lr=%.2e grad_norm=%.3f tokens/s=%zu\n",
+                 ix / 60 % 60, ix % 60, ix, loss(rng), 3e-4, loss(rng),
+                 100'000 + rng() % 1000);
+        log += line;
+    }
+    return log;
+}
+
+} // namespace
+
+TEST(Lz, RoundTrip) {
+    auto random = Random(100'000, 256);
+    std::vector<std::string> inputs = {
+        "",
+        "a",
+        "hello, world",
+        std::string(13, 'x'),
+        std::string(100'000, 'x'),
+        random,
+        TrainingLog(2'000),
+        random.substr(0, 1000) + random.substr(0, 1000) + "tail",
+    };
+    for (auto const &input : inputs) {
+        auto compressed = Compress(input);
+        EXPECT_LE(compressed.size(), LzBound(input.size()));
+        EXPECT_EQ(Decompress(compressed, input.size()), input);
+    }
+}
+
+TEST(Lz, Decompress) {
+    // Literal `a` and match of 5 bytes at offset 1, then 5 literals.
+    std::string_view block{"\x11" "a" "\x01\x00" "\x50" "bbbbb", 10};
+    EXPECT_EQ(Decompress(block, 64), "aaaaaabbbbb");
+    EXPECT_EQ(Decompress(block, 10), std::nullopt); // Does not fit.
+    EXPECT_EQ(Decompress(block.substr(0, 3), 64), std::nullopt);
+    EXPECT_EQ(Decompress({"\x11" "a" "\x02\x00", 4}, 64), std::nullopt);
+    EXPECT_EQ(Decompress({"\x11" "a" "\x00\x00", 4}, 64), std::nullopt);
+    EXPECT_EQ(Decompress({"\xf0\xff", 2}, 1'000), std::nullopt);
+}
+
+TEST(Huffman, RoundTrip) {
+    // Skewed distribution needs codes longer than the limit.
+    std::string skewed;
+    for (int ix = 0; ix != 20; ++ix) {
+        skewed.append(1 << ix, static_cast<char>('a' + ix));
+    }
+    std::vector<std::string> inputs = {
+        "", "a", std::string(1000, 'x'), Random(100'000, 256),
+        Random(100'000, 10), skewed, TrainingLog(2'000),
+    };
+    for (auto const &input : inputs) {
+        auto encoded = Encode(input);
+        EXPECT_LE(encoded.size(), HuffmanBound(input.size()));
+        EXPECT_EQ(Decode(encoded, input.size()), input);
+    }
+    EXPECT_LT(Encode(Random(100'000, 10)).size(), 45'000);
+}
+
+TEST(Huffman, Decode) {
+    auto encoded = Encode("abracadabra");
+    EXPECT_EQ(Decode(encoded, 11), "abracadabra");
+    EXPECT_EQ(Decode(encoded, 10), std::nullopt); // Does not fit.
+    EXPECT_EQ(Decode(encoded.substr(0, 100), 64), std::nullopt);
+    EXPECT_EQ(Decode(encoded.substr(0, 133), 64), std::nullopt);
+
+    // All bytes have codes of one bit.
+    std::string invalid(132, '\x11');
+    invalid.replace(0, 4, std::string_view{"\x01\0\0\0", 4});
+    EXPECT_EQ(Decode(invalid, 64), std::nullopt);
+}
+
+TEST(Codec, Ratio) {
+    auto log = TrainingLog(10'000);
+    auto encoded = Encode(Compress(log));
+    EXPECT_GT(log.size(), 4 * encoded.size())
+        << log.size() << " -> " << encoded.size();
+    auto compressed = Decode(encoded, LzBound(log.size()));
+    ASSERT_TRUE(compressed);
+    EXPECT_EQ(Decompress(*compressed, log.size()), log);
+}
@@ -0,0 +1,282 @@
+// Copyright 2025 Daniel Bershatsky
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "control.h"
+
+#include <array>
+#include <cerrno>
+#include <charconv>
+#include <csignal>
+#include <cstring>
+#include <utility>
+
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <mlspace/cc/log.h>
+
+namespace mlspace {
+
+namespace {
+
+constexpr std::array<std::pair<std::string_view, ControlVerb>, 8> verbs = {{
+    {"status", ControlVerb::Status},
+    {"rusage", ControlVerb::Rusage},
+    {"log-level", ControlVerb::LogLevel},
+    {"route", ControlVerb::Route},
+    {"signal", ControlVerb::Signal},
+    {"dump", ControlVerb::Dump},
+    {"stop", ControlVerb::Stop},
+    {"metrics", ControlVerb::Metrics},
+}};
+
+constexpr std::array<std::pair<std::string_view, int>, 16> signals = {{
+    {"HUP", SIGHUP},
+    {"INT", SIGINT},
+    {"QUIT", SIGQUIT},
+    {"ABRT", SIGABRT},
+    {"KILL", SIGKILL},
+    {"USR1", SIGUSR1},
+    {"SEGV", SIGSEGV},
+    {"USR2", SIGUSR2},
+    {"PIPE", SIGPIPE},
+    {"ALRM", SIGALRM},
+    {"TERM", SIGTERM},
+    {"CONT", SIGCONT},
+    {"STOP", SIGSTOP},
+    {"TSTP", SIGTSTP},
+    {"XCPU", SIGXCPU},
+    {"WINCH", SIGWINCH},
+}};
+
+} // namespace
+
+std::string ControlResponse::ToString(void) const {
+    std::string str = ok ? "ok" : "err";
+    if (!payload.empty()) {
+        str += ' ';
+        // Payload must not break framing.
+        for (char ch : payload) {
+            str += ch == '\n' ? ' ' : ch;
+        }
+    }
+    str += '\n';
+    return str;
+}
+
+std::optional<ControlRequest> ParseControlRequest(std::string_view line) {
+    std::vector<std::string_view> words;
+    while (!line.empty()) {
+        auto begin = line.find_first_not_of(" \t\r");
+        if (begin == line.npos) {
+            break;
+        }
+        auto end = line.find_first_of(" \t\r", begin);
+        if (end == line.npos) {
+            end = line.size();
+        }
+        words.push_back(line.substr(begin, end - begin));
+        line.remove_prefix(end);
+    }
+    if (words.empty()) {
+        return std::nullopt;
+    }
+
+    for (auto const &[name, verb] : verbs) {
+        if (words[0] == name) {
+            return ControlRequest{verb, {words.begin() + 1, words.end()}};
+        }
+    }
+    return std::nullopt;
+}
+
+std::optional<int> ParseSignal(std::string_view str) {
+    int signo;
+    auto [ptr, ec] = std::from_chars(str.begin(), str.end(), signo);
+    if (ec == std::errc() && ptr == str.end()) {
+        if (signo <= 0 || signo >= NSIG) {
+            return std::nullopt;
+        }
+        return signo;
+    }
+
+    if (str.starts_with("SIG")) {
+        str.remove_prefix(3);
+    }
+    for (auto const &[name, signo] : signals) {
+        if (str == name) {
+            return signo;
+        }
+    }
+    return std::nullopt;
+}
+
+ControlServer::ControlServer(EventLoop &loop, Handler handler)
+    : loop_{loop}, handler_{std::move(handler)} {
+}
+
+ControlServer::~ControlServer(void) {
+    while (!conns_.empty()) {
+        Close(conns_.begin()->first);
+    }
+    if (listen_fd_ != -1) {
+        loop_.Remove(listen_fd_);
+        close(listen_fd_);
+        std::error_code ec;
+        std::filesystem::remove(path_, ec);
+    }
+}
+
+bool ControlServer::Listen(std::filesystem::path const &path) {
+    sockaddr_un addr = {.sun_family = AF_UNIX};
+    if (path.native().size() >= sizeof(addr.sun_path)) {
+        LOG_ERROR("control socket path is too long: %s", path.c_str());
+        return false;
+    }
+    std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd == -1) {
+        LOG_ERROR("failed to create control socket: %s", strerror(errno));
+        return false;
+    }
+
+    // Nobody listens on a socket left after crash so that we remove it.
+    unlink(path.c_str());
+    if (bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == -1 ||
+        listen(fd, 16) == -1) {
+        LOG_ERROR("failed to listen control socket %s: %s", path.c_str(),
+                  strerror(errno));
+        close(fd);
+        return false;
+    }
+
+    if (!loop_.Add(fd, EPOLLIN, [this](auto) { Accept(); })) {
+        close(fd);
+        unlink(path.c_str());
+        return false;
+    }
+
+    listen_fd_ = fd;
+    path_ = path;
+    LOG_INFO("control socket is listening at %s", path.c_str());
+    return true;
+}
+
+bool ControlServer::Serve(int fd) {
+    auto ok = loop_.Add(fd, EPOLLIN | EPOLLRDHUP,
+                        [this, fd](uint32_t events) { OnEvent(fd, events); });
+    if (!ok) {
+        close(fd);
+        return false;
+    }
+    conns_.emplace(fd, Connection{});
+    return true;
+}
+
+void ControlServer::Accept(void) {
+    while (true) {
+        int fd = accept4(listen_fd_, nullptr, nullptr,
+                         SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd == -1) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                LOG_WARN("failed to accept control connection: %s",
+                         strerror(errno));
+            }
+            return;
+        }
+        Serve(fd);
+    }
+}
+
+void ControlServer::OnEvent(int fd, uint32_t events) {
+    auto it = conns_.find(fd);
+    if (it == conns_.end()) {
+        return;
+    }
+    auto &conn = it->second;
+
+    if (events & EPOLLOUT) {
+        if (!Flush(fd, conn)) {
+            return;
+        }
+    }
+
+    if (!(events & (EPOLLIN | EPOLLHUP | EPOLLRDHUP | EPOLLERR))) {
+        return;
+    }
+
+    char buf[1024];
+    ssize_t len;
+    while ((len = read(fd, buf, sizeof(buf))) > 0) {
+        conn.input.append(buf, len);
+    }
+    bool eof = len == 0 || (errno != EAGAIN && errno != EWOULDBLOCK);
+
+    // Handle all complete requests.
+    size_t offset = 0, pos;
+    while ((pos = conn.input.find('\n', offset)) != conn.input.npos) {
+        auto line = std::string_view{conn.input}.substr(offset, pos - offset);
+        offset = pos + 1;
+        if (auto req = ParseControlRequest(line)) {
+            conn.output += handler_(*req).ToString();
+        } else {
+            conn.output += ControlResponse::Err("unknown request").ToString();
+        }
+    }
+    conn.input.erase(0, offset);
+    if (conn.input.size() > max_line_length) {
+        LOG_WARN("control request is too long: %zu bytes", conn.input.size());
+        Close(fd);
+        return;
+    }
+
+    if (!Flush(fd, conn)) {
+        return;
+    }
+    if (eof && conn.output.empty()) {
+        Close(fd);
+    }
+}
+
+bool ControlServer::Flush(int fd, Connection &conn) {
+    while (!conn.output.empty()) {
+        auto len = send(fd, conn.output.data(), conn.output.size(),
+                        MSG_NOSIGNAL);
+        if (len == -1) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            Close(fd);
+            return false;
+        }
+        conn.output.erase(0, len);
+    }
+    uint32_t events = EPOLLIN | EPOLLRDHUP;
+    if (!conn.output.empty()) {
+        events |= EPOLLOUT;
+    }
+    loop_.Modify(fd, events);
+    return true;
+}
+
+void ControlServer::Close(int fd) {
+    loop_.Remove(fd);
+    conns_.erase(fd);
+    close(fd);
+}
+
+} // namespace mlspace
@@ -0,0 +1,131 @@
+// Copyright 2025 Daniel Bershatsky
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <mlspace/cc/event_loop.h>
+
+namespace mlspace {
+
+// Control protocol is line-oriented. Every request is a single line of
+// space-separated words `<verb> [<arg> ...]\n` and every response is a single
+// line as well: either `ok [<json>]\n` or `err <message>\n`. Requests are
+// served in order they are received over one connection.
+//
+//     status                   Supervisor and child state as JSON.
+//     rusage                   Resource usage of supervisor and child.
+//     log-level <level>        Set verbosity: debug, info, warn, or error.
+//     route <target> [<path>]  Route child output: console, null, file, or
+//                              journal.
+//     signal <signal>          Send signal (e.g. `TERM`, `SIGUSR1`, `10`).
+//     dump [<bytes>]           Dump tail of child output to the log.
+//     stop [<timeout-ms>]      Terminate child gracefully; kill on timeout.
+//     metrics                  Histogram of thread states of process tree.
+enum class ControlVerb {
+    Status,
+    Rusage,
+    LogLevel,
+    Route,
+    Signal,
+    Dump,
+    Stop,
+    Metrics,
+};
+
+struct ControlRequest {
+    ControlVerb verb;
+    std::vector<std::string> args;
+};
+
+struct ControlResponse {
+    bool ok = true;
+    std::string payload;
+
+    static ControlResponse Ok(std::string payload = {}) {
+        return {true, std::move(payload)};
+    }
+
+    static ControlResponse Err(std::string message) {
+        return {false, std::move(message)};
+    }
+
+    // Serialize response to a wire format (with trailing new line).
+    std::string ToString(void) const;
+};
+
+std::optional<ControlRequest> ParseControlRequest(std::string_view line);
+
+// ParseSignal accepts signal names with or without `SIG` prefix as well as
+// signal numbers.
+std::optional<int> ParseSignal(std::string_view str);
+
+// ControlServer accepts connections on Unix domain socket and serves requests
+// from event loop. Sockets are non-blocking and closed on exec so that served
+// job is not affected at all.
+class ControlServer {
+public:
+    using Handler = std::function<ControlResponse(ControlRequest const &)>;
+
+    static constexpr size_t max_line_length = 4096;
+
+    ControlServer(EventLoop &loop, Handler handler);
+
+    ~ControlServer(void);
+
+    ControlServer(ControlServer const &) = delete;
+
+    ControlServer &operator=(ControlServer const &) = delete;
+
+    // Listen binds socket to `path` and starts accepting connections. Stale
+    // socket file left by a dead supervisor is replaced.
+    bool Listen(std::filesystem::path const &path);
+
+    // Serve starts serving an already connected socket (e.g. one end of
+    // `socketpair`). Server takes ownership of the descriptor.
+    bool Serve(int fd);
+
+    size_t NumConnections(void) const {
+        return conns_.size();
+    }
+
+private:
+    struct Connection {
+        std::string input;
+        std::string output;
+    };
+
+    void Accept(void);
+
+    void OnEvent(int fd, uint32_t events);
+
+    bool Flush(int fd, Connection &conn);
+
+    void Close(int fd);
+
+    EventLoop &loop_;
+    Handler handler_;
+    int listen_fd_ = -1;
+    std::filesystem::path path_;
+    std::unordered_map<int, Connection> conns_;
+};
+
+} // namespace mlspace
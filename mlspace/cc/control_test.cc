@@ -0,0 +1,108 @@
+// Copyright 2025 Daniel Bershatsky
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <csignal>
+#include <string>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <mlspace/cc/control.h>
+#include <mlspace/cc/event_loop.h>
+
+using mlspace::ControlRequest;
+using mlspace::ControlResponse;
+using mlspace::ControlServer;
+using mlspace::ControlVerb;
+using mlspace::EventLoop;
+using mlspace::ParseControlRequest;
+using mlspace::ParseSignal;
+
+TEST(ControlRequest, Parse) {
+    auto req = ParseControlRequest("  route file  /tmp/job.log\r");
+    ASSERT_TRUE(req);
+    EXPECT_EQ(req->verb, ControlVerb::Route);
+    ASSERT_EQ(req->args.size(), 2);
+    EXPECT_EQ(req->args[0], "file");
+    EXPECT_EQ(req->args[1], "/tmp/job.log");
+
+    req = ParseControlRequest("status");
+    ASSERT_TRUE(req);
+    EXPECT_EQ(req->verb, ControlVerb::Status);
+    EXPECT_TRUE(req->args.empty());
+
+    req = ParseControlRequest("metrics");
+    ASSERT_TRUE(req);
+    EXPECT_EQ(req->verb, ControlVerb::Metrics);
+}
+
+TEST(ControlRequest, ParseUnknown) {
+    EXPECT_FALSE(ParseControlRequest(""));
+    EXPECT_FALSE(ParseControlRequest("   "));
+    EXPECT_FALSE(ParseControlRequest("reboot now"));
+}
+
+TEST(ControlResponse, ToString) {
+    EXPECT_EQ(ControlResponse::Ok().ToString(), "ok\n");
+    EXPECT_EQ(ControlResponse::Ok("{}").ToString(), "ok {}\n");
+    EXPECT_EQ(ControlResponse::Err("bad\nrequest").ToString(),
+              "err bad request\n");
+}
+
+TEST(ControlSignal, Parse) {
+    EXPECT_EQ(ParseSignal("TERM"), SIGTERM);
+    EXPECT_EQ(ParseSignal("SIGUSR1"), SIGUSR1);
+    EXPECT_EQ(ParseSignal("9"), SIGKILL);
+    EXPECT_FALSE(ParseSignal("0"));
+    EXPECT_FALSE(ParseSignal("SIGFOO"));
+    EXPECT_FALSE(ParseSignal("9x"));
+}
+
+TEST(ControlServer, Serve) {
+    int fds[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds), 0);
+
+    EventLoop loop;
+    std::vector<ControlVerb> verbs;
+    ControlServer server(loop, [&](ControlRequest const &req) {
+        verbs.push_back(req.verb);
+        if (req.verb == ControlVerb::Stop) {
+            loop.Stop();
+        }
+        return ControlResponse::Ok(std::to_string(req.args.size()));
+    });
+    ASSERT_TRUE(server.Serve(fds[0]));
+
+    // Requests are pipelined and the last one is split.
+    std::string_view reqs = "status\nsignal USR1\nfoo\nst";
+    ASSERT_EQ(write(fds[1], reqs.data(), reqs.size()), reqs.size());
+    loop.AddTimer(std::chrono::milliseconds{1}, {},
+                  [&]() { write(fds[1], "op 1 2\n", 7); });
+    ASSERT_TRUE(loop.Run());
+
+    ASSERT_EQ(verbs.size(), 3);
+    EXPECT_EQ(verbs[0], ControlVerb::Status);
+    EXPECT_EQ(verbs[1], ControlVerb::Signal);
+    EXPECT_EQ(verbs[2], ControlVerb::Stop);
+
+    char buf[256];
+    auto len = read(fds[1], buf, sizeof(buf));
+    ASSERT_GT(len, 0);
+    EXPECT_EQ(std::string_view(buf, len),
+              "ok 0\nok 1\nerr unknown request\nok 2\n");
+
+    close(fds[1]);
+}
@@ -0,0 +1,140 @@
+// Copyright 2025 Daniel Bershatsky
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "event_loop.h"
+
+#include <algorithm>
+#include <cerrno>
+
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+namespace mlspace {
+
+namespace {
+
+timespec ToTimespec(std::chrono::milliseconds ms) {
+    return {
+        .tv_sec = static_cast<time_t>(ms.count() / 1000),
+        .tv_nsec = static_cast<long>(ms.count() % 1000) * 1'000'000,
+    };
+}
+
+} // namespace
+
+EventLoop::EventLoop(void) : epfd_{epoll_create1(EPOLL_CLOEXEC)} {
+}
+
+EventLoop::~EventLoop(void) {
+    if (epfd_ != -1) {
+        close(epfd_);
+    }
+}
+
+bool EventLoop::Add(int fd, uint32_t events, Callback cb) {
+    epoll_event ev = {.events = events, .data = {.fd = fd}};
+    if (epoll_ctl(epfd_, EPOLL_CTL_ADD, fd, &ev) == -1) {
+        return false;
+    }
+    callbacks_[fd] = std::make_shared<Callback>(std::move(cb));
+    return true;
+}
+
+bool EventLoop::Modify(int fd, uint32_t events) {
+    epoll_event ev = {.events = events, .data = {.fd = fd}};
+    return epoll_ctl(epfd_, EPOLL_CTL_MOD, fd, &ev) == 0;
+}
+
+void EventLoop::Remove(int fd) {
+    if (callbacks_.erase(fd) > 0) {
+        epoll_ctl(epfd_, EPOLL_CTL_DEL, fd, nullptr);
+    }
+}
+
+int EventLoop::AddTimer(std::chrono::milliseconds delay,
+                        std::chrono::milliseconds interval, TimerCallback cb) {
+    int fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (fd == -1) {
+        return -1;
+    }
+
+    // Zero `it_value` disarms timer so that we round up zero delay.
+    itimerspec spec = {
+        .it_interval = ToTimespec(interval),
+        .it_value = ToTimespec(std::max(delay, std::chrono::milliseconds{1})),
+    };
+    if (timerfd_settime(fd, 0, &spec, nullptr) == -1) {
+        close(fd);
+        return -1;
+    }
+
+    auto ok = Add(fd, EPOLLIN, [this, fd, interval, cb = std::move(cb)](auto) {
+        uint64_t expirations;
+        if (read(fd, &expirations, sizeof(expirations)) == -1) {
+            return;
+        }
+        // Callback can remove timer and destroy closure so that we should
+        // keep a copy of everything we need.
+        auto repeat = interval.count() > 0;
+        auto fn = cb;
+        if (!repeat) {
+            RemoveTimer(fd);
+        }
+        fn();
+    });
+    if (!ok) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+void EventLoop::RemoveTimer(int fd) {
+    if (callbacks_.contains(fd)) {
+        Remove(fd);
+        close(fd);
+    }
+}
+
+bool EventLoop::Run(void) {
+    constexpr int max_events = 64;
+    epoll_event events[max_events];
+    running_ = true;
+    while (running_) {
+        int num_events = epoll_wait(epfd_, events, max_events, -1);
+        if (num_events == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        for (int ix = 0; ix != num_events && running_; ++ix) {
+            // Descriptor could be removed by one of previous callbacks.
+            auto it = callbacks_.find(events[ix].data.fd);
+            if (it == callbacks_.end()) {
+                continue;
+            }
+            auto cb = it->second; // Keep callback alive during call.
+            (*cb)(events[ix].events);
+        }
+    }
+    return true;
+}
+
+void EventLoop::Stop(void) {
+    running_ = false;
+}
+
+} // namespace mlspace
@@ -0,0 +1,76 @@
+// Copyright 2025 Daniel Bershatsky
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+
+namespace mlspace {
+
+// EventLoop is a minimal single-threaded reactor on top of epoll(7). Every
+// activity of `launch` supervisor (child output, signals, control requests,
+// timers) is dispatched from it.
+class EventLoop {
+public:
+    using Callback = std::function<void(uint32_t events)>;
+
+    using TimerCallback = std::function<void(void)>;
+
+    EventLoop(void);
+
+    ~EventLoop(void);
+
+    EventLoop(EventLoop const &) = delete;
+
+    EventLoop &operator=(EventLoop const &) = delete;
+
+    bool Add(int fd, uint32_t events, Callback cb);
+
+    bool Modify(int fd, uint32_t events);
+
+    // Remove unregisters file descriptor. It is safe to call it from any
+    // callback including the callback of the descriptor being removed. The
+    // descriptor itself is not closed.
+    void Remove(int fd);
+
+    // AddTimer arms a timer which fires once in `delay` and then every
+    // `interval` if it is non-zero. It returns timer descriptor which is used
+    // as a timer identifier or -1 on failure.
+    int AddTimer(std::chrono::milliseconds delay,
+                 std::chrono::milliseconds interval, TimerCallback cb);
+
+    // RemoveTimer disarms and closes timer.
+    void RemoveTimer(int fd);
+
+    // Run dispatches events until `Stop` is called. It returns false if
+    // polling fails.
+    bool Run(void);
+
+    void Stop(void);
+
+    bool IsValid(void) const {
+        return epfd_ != -1;
+    }
+
+private:
+    int epfd_ = -1;
+    bool running_ = false;
+    std::unordered_map<int, std::shared_ptr<Callback>> callbacks_;
+};
+
+} // namespace mlspace
@@ -0,0 +1,859 @@
+// Copyright 2025 Daniel Bershatsky
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "io_engine.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <mlspace/cc/log.h>
+
+namespace mlspace {
+
+namespace {
+
+// CopyState tracks a copy which is split into chunks of buffer size.
+struct CopyState {
+    int in_fd;
+    int out_fd;
+    int64_t in_offset;  // Offset of the next chunk.
+    int64_t out_offset; // Offset of the next chunk.
+    size_t remaining;   // Bytes not scheduled yet.
+    size_t copied = 0;
+    size_t num_chunks = 0; // Chunks in flight.
+    int error = 0;
+    bool eof = false;
+    IoEngine::Callback cb;
+
+    bool IsScheduled(void) const {
+        return remaining == 0 || error != 0 || eof;
+    }
+};
+
+void SignalEvent(int fd) {
+    uint64_t one = 1;
+    while (write(fd, &one, sizeof(one)) == -1 && errno == EINTR) {
+    }
+}
+
+void ClearEvent(int fd) {
+    uint64_t value;
+    while (read(fd, &value, sizeof(value)) == -1 && errno == EINTR) {
+    }
+}
+
+// UringEngine submits requests to io_uring(7) with raw syscalls. Copies are
+// split into chunks which are read into registered buffers and written by
+// linked requests, so that a chunk is a single round trip to kernel.
+class UringEngine : public IoEngine {
+public:
+    static std::unique_ptr<UringEngine> Create(Options const &opts);
+
+    ~UringEngine(void) override;
+
+    IoEngineKind kind(void) const override {
+        return IoEngineKind::Uring;
+    }
+
+    int fd(void) const override {
+        return event_fd_;
+    }
+
+    void Read(int fd, char *buf, size_t size, int64_t offset,
+              Callback cb) override;
+
+    void Write(int fd, char const *buf, size_t size, int64_t offset,
+               Callback cb) override;
+
+    void Copy(int in_fd, int64_t in_offset, int out_fd, int64_t out_offset,
+              size_t size, Callback cb) override;
+
+    size_t Submit(void) override;
+
+    size_t Reap(bool wait) override;
+
+    size_t NumPending(void) const override {
+        return backlog_.size() + num_inflight_ + copies_.size();
+    }
+
+private:
+    enum class Op : uint8_t {
+        Transfer,  // Read or write with a callback.
+        CopyRead,  // Read of a chunk (linked to write).
+        CopyWrite, // Write of a chunk.
+    };
+
+    struct Chunk;
+
+    // Request is referenced by `user_data` of submission.
+    struct Request {
+        Op op;
+        Callback cb;
+        Chunk *chunk = nullptr;
+    };
+
+    struct Chunk {
+        CopyState *copy;
+        unsigned buf;
+        int64_t in_offset;
+        int64_t out_offset;
+        size_t size;
+        size_t written = 0;
+        std::optional<ssize_t> read_res;
+        std::optional<ssize_t> write_res;
+        Request read{Op::CopyRead};
+        Request write{Op::CopyWrite};
+    };
+
+    // Submission is one or two linked entries which are submitted at once.
+    struct Submission {
+        io_uring_sqe sqes[2];
+        unsigned num_sqes;
+    };
+
+    UringEngine(void) = default;
+
+    void Queue(int op, int fd, void const *addr, size_t size, int64_t offset,
+               Request *req, int buf = -1);
+
+    void QueueChunk(Chunk *chunk);
+
+    void QueueChunkWrite(Chunk *chunk);
+
+    // Schedule splits pending copies into chunks while there are free
+    // buffers.
+    void Schedule(void);
+
+    void OnChunk(Chunk *chunk);
+
+    // Enter submits entries of submission queue and waits for `min_complete`
+    // completions.
+    int Enter(unsigned min_complete);
+
+    int ring_fd_ = -1;
+    int event_fd_ = -1;
+    unsigned num_entries_ = 0;
+
+    void *sq_ring_ = MAP_FAILED;
+    size_t sq_ring_size_ = 0;
+    void *cq_ring_ = MAP_FAILED;
+    size_t cq_ring_size_ = 0;
+    io_uring_sqe *sqes_ = static_cast<io_uring_sqe *>(MAP_FAILED);
+    size_t sqes_size_ = 0;
+
+    unsigned *sq_head_;
+    unsigned *sq_tail_;
+    unsigned sq_mask_;
+    unsigned *sq_array_;
+    unsigned *cq_head_;
+    unsigned *cq_tail_;
+    unsigned cq_mask_;
+    unsigned cq_entries_;
+    io_uring_cqe *cqes_;
+
+    char *buffers_ = static_cast<char *>(MAP_FAILED);
+    size_t buffer_size_ = 0;
+    size_t buffers_size_ = 0;
+    std::vector<unsigned> free_buffers_;
+
+    std::deque<Submission> backlog_;
+    std::deque<CopyState *> copies_; // Copies which wait for buffers.
+    size_t num_inflight_ = 0;
+};
+
+std::unique_ptr<UringEngine> UringEngine::Create(Options const &opts) {
+    std::unique_ptr<UringEngine> engine{new UringEngine};
+    io_uring_params params = {};
+    params.flags = IORING_SETUP_CLAMP;
+    engine->ring_fd_ = syscall(SYS_io_uring_setup, opts.depth, &params);
+    if (engine->ring_fd_ == -1) {
+        return nullptr;
+    }
+    engine->num_entries_ = params.sq_entries;
+
+    // Rings share a mapping on modern kernels but they are mapped separately
+    // for simplicity.
+    auto map = [fd = engine->ring_fd_](size_t size, off_t offset) {
+        return mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, fd, offset);
+    };
+    engine->sq_ring_size_ =
+        params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    engine->cq_ring_size_ =
+        params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    engine->sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+    engine->sq_ring_ = map(engine->sq_ring_size_, IORING_OFF_SQ_RING);
+    engine->cq_ring_ = map(engine->cq_ring_size_, IORING_OFF_CQ_RING);
+    engine->sqes_ = static_cast<io_uring_sqe *>(
+        map(engine->sqes_size_, IORING_OFF_SQES));
+    if (engine->sq_ring_ == MAP_FAILED || engine->cq_ring_ == MAP_FAILED ||
+        engine->sqes_ == MAP_FAILED) {
+        return nullptr;
+    }
+
+    auto sq = static_cast<char *>(engine->sq_ring_);
+    auto cq = static_cast<char *>(engine->cq_ring_);
+    engine->sq_head_ = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+    engine->sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+    engine->sq_mask_ =
+        *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+    engine->sq_array_ =
+        reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+    engine->cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+    engine->cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+    engine->cq_mask_ =
+        *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+    engine->cq_entries_ = params.cq_entries;
+    engine->cqes_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+
+    // Completions are signaled to the event loop through eventfd.
+    engine->event_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (engine->event_fd_ == -1 ||
+        syscall(SYS_io_uring_register, engine->ring_fd_,
+                IORING_REGISTER_EVENTFD, &engine->event_fd_, 1) == -1) {
+        return nullptr;
+    }
+
+    // Buffers are registered once, so that kernel does not pin and unpin
+    // pages on every request.
+    auto num_buffers = std::max<size_t>(opts.num_buffers, 1);
+    engine->buffer_size_ = std::max<size_t>(opts.buffer_size, 4096);
+    engine->buffers_size_ = num_buffers * engine->buffer_size_;
+    engine->buffers_ = static_cast<char *>(
+        mmap(nullptr, engine->buffers_size_, PROT_READ | PROT_WRITE,
+             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+    if (engine->buffers_ == MAP_FAILED) {
+        return nullptr;
+    }
+    std::vector<iovec> iovs(num_buffers);
+    for (size_t ix = 0; ix != num_buffers; ++ix) {
+        iovs[ix] = {engine->buffers_ + ix * engine->buffer_size_,
+                    engine->buffer_size_};
+        engine->free_buffers_.push_back(num_buffers - ix - 1);
+    }
+    if (syscall(SYS_io_uring_register, engine->ring_fd_,
+                IORING_REGISTER_BUFFERS, iovs.data(), iovs.size()) == -1) {
+        return nullptr;
+    }
+    return engine;
+}
+
+UringEngine::~UringEngine(void) {
+    if (ring_fd_ != -1) {
+        Drain();
+    }
+    if (buffers_ != MAP_FAILED) {
+        munmap(buffers_, buffers_size_);
+    }
+    if (sqes_ != MAP_FAILED) {
+        munmap(sqes_, sqes_size_);
+    }
+    if (cq_ring_ != MAP_FAILED) {
+        munmap(cq_ring_, cq_ring_size_);
+    }
+    if (sq_ring_ != MAP_FAILED) {
+        munmap(sq_ring_, sq_ring_size_);
+    }
+    for (int fd : {event_fd_, ring_fd_}) {
+        if (fd != -1) {
+            close(fd);
+        }
+    }
+}
+
+void UringEngine::Read(int fd, char *buf, size_t size, int64_t offset,
+                       Callback cb) {
+    Queue(IORING_OP_READ, fd, buf, size, offset,
+          new Request{Op::Transfer, std::move(cb)});
+}
+
+void UringEngine::Write(int fd, char const *buf, size_t size, int64_t offset,
+                        Callback cb) {
+    Queue(IORING_OP_WRITE, fd, buf, size, offset,
+          new Request{Op::Transfer, std::move(cb)});
+}
+
+void UringEngine::Copy(int in_fd, int64_t in_offset, int out_fd,
+                       int64_t out_offset, size_t size, Callback cb) {
+    copies_.push_back(new CopyState{in_fd, out_fd, in_offset, out_offset,
+                                    size, 0, 0, 0, false, std::move(cb)});
+    Schedule();
+}
+
+void UringEngine::Queue(int op, int fd, void const *addr, size_t size,
+                        int64_t offset, Request *req, int buf) {
+    Submission sub = {};
+    auto &sqe = sub.sqes[0];
+    sqe.opcode = op;
+    sqe.fd = fd;
+    sqe.addr = reinterpret_cast<uint64_t>(addr);
+    sqe.len = size;
+    sqe.off = static_cast<uint64_t>(offset);
+    sqe.user_data = reinterpret_cast<uint64_t>(req);
+    if (buf != -1) {
+        sqe.buf_index = buf;
+    }
+    sub.num_sqes = 1;
+    backlog_.push_back(sub);
+}
+
+void UringEngine::QueueChunk(Chunk *chunk) {
+    auto buf = buffers_ + chunk->buf * buffer_size_;
+    Queue(IORING_OP_READ_FIXED, chunk->copy->in_fd, buf, chunk->size,
+          chunk->in_offset, &chunk->read, chunk->buf);
+    Queue(IORING_OP_WRITE_FIXED, chunk->copy->out_fd, buf, chunk->size,
+          chunk->out_offset, &chunk->write, chunk->buf);
+
+    // Merge two submissions into a linked one: write is started only if read
+    // fills the whole chunk.
+    auto write = backlog_.back();
+    backlog_.pop_back();
+    auto &read = backlog_.back();
+    read.sqes[0].flags |= IOSQE_IO_LINK;
+    read.sqes[1] = write.sqes[0];
+    read.num_sqes = 2;
+}
+
+void UringEngine::QueueChunkWrite(Chunk *chunk) {
+    auto buf = buffers_ + chunk->buf * buffer_size_ + chunk->written;
+    Queue(IORING_OP_WRITE_FIXED, chunk->copy->out_fd, buf,
+          *chunk->read_res - chunk->written,
+          chunk->out_offset + chunk->written, &chunk->write, chunk->buf);
+}
+
+void UringEngine::Schedule(void) {
+    while (!copies_.empty() && !free_buffers_.empty()) {
+        auto copy = copies_.front();
+        if (copy->IsScheduled()) {
+            copies_.pop_front();
+            if (copy->num_chunks == 0) {
+                auto res = copy->error ? -copy->error : copy->copied;
+                auto cb = std::move(copy->cb);
+                delete copy;
+                cb(res);
+            }
+            continue;
+        }
+        auto size = std::min(copy->remaining, buffer_size_);
+        auto chunk = new Chunk{copy, free_buffers_.back(), copy->in_offset,
+                               copy->out_offset, size};
+        chunk->read.chunk = chunk->write.chunk = chunk;
+        free_buffers_.pop_back();
+        copy->in_offset += size;
+        copy->out_offset += size;
+        copy->remaining -= size;
+        copy->num_chunks += 1;
+        QueueChunk(chunk);
+    }
+}
+
+void UringEngine::OnChunk(Chunk *chunk) {
+    // Both parts of a linked pair complete (write is canceled on short read)
+    // and they are handled together.
+    if (!chunk->read_res || !chunk->write_res) {
+        return;
+    }
+    auto copy = chunk->copy;
+    auto read = *chunk->read_res;
+    auto write = *std::exchange(chunk->write_res, std::nullopt);
+    if (read < 0) {
+        copy->error = -read;
+    } else if (read == 0) {
+        copy->eof = true;
+    } else if (write < 0 && write != -ECANCELED) {
+        copy->error = -write;
+    } else if (write == 0) {
+        copy->error = EIO;
+    } else {
+        if (write > 0) {
+            chunk->written += write;
+            copy->copied += write;
+        }
+        if (chunk->written < static_cast<size_t>(read)) {
+            QueueChunkWrite(chunk);
+            return;
+        }
+        if (static_cast<size_t>(read) < chunk->size) {
+            // Short read: continue with the rest of chunk.
+            chunk->in_offset += read;
+            chunk->out_offset += read;
+            chunk->size -= read;
+            chunk->written = 0;
+            chunk->read_res.reset();
+            QueueChunk(chunk);
+            return;
+        }
+    }
+
+    free_buffers_.push_back(chunk->buf);
+    copy->num_chunks -= 1;
+    delete chunk;
+    if (copy->num_chunks == 0 && copy->IsScheduled()) {
+        auto it = std::find(copies_.begin(), copies_.end(), copy);
+        if (it != copies_.end()) {
+            copies_.erase(it);
+        }
+        auto res = copy->error ? -copy->error : copy->copied;
+        auto cb = std::move(copy->cb);
+        delete copy;
+        cb(res);
+    }
+    Schedule();
+}
+
+int UringEngine::Enter(unsigned min_complete) {
+    // Entries which kernel has not consumed yet (e.g. on EAGAIN) are
+    // submitted again.
+    auto flags = min_complete > 0 ? IORING_ENTER_GETEVENTS : 0;
+    int res;
+    do {
+        auto head = std::atomic_ref{*sq_head_}.load(std::memory_order_acquire);
+        res = syscall(SYS_io_uring_enter, ring_fd_, *sq_tail_ - head,
+                      min_complete, flags, nullptr, 0);
+    } while (res == -1 && errno == EINTR);
+    return res;
+}
+
+size_t UringEngine::Submit(void) {
+    // Number of requests in flight is limited by size of completion queue.
+    auto tail = *sq_tail_;
+    auto head = std::atomic_ref{*sq_head_}.load(std::memory_order_acquire);
+    unsigned num_sqes = 0;
+    while (!backlog_.empty()) {
+        auto const &sub = backlog_.front();
+        if (tail - head + sub.num_sqes > num_entries_ ||
+            num_inflight_ + sub.num_sqes > cq_entries_) {
+            break;
+        }
+        for (unsigned ix = 0; ix != sub.num_sqes; ++ix, ++tail) {
+            auto index = tail & sq_mask_;
+            sqes_[index] = sub.sqes[ix];
+            sq_array_[index] = index;
+        }
+        num_sqes += sub.num_sqes;
+        num_inflight_ += sub.num_sqes;
+        backlog_.pop_front();
+    }
+    if (num_sqes == 0) {
+        return 0;
+    }
+    std::atomic_ref{*sq_tail_}.store(tail, std::memory_order_release);
+    if (Enter(0) == -1) {
+        LOG_WARN("failed to submit io requests: %s", std::strerror(errno));
+    }
+    return num_sqes;
+}
+
+size_t UringEngine::Reap(bool wait) {
+    ClearEvent(event_fd_);
+    auto head = *cq_head_;
+    auto tail = std::atomic_ref{*cq_tail_}.load(std::memory_order_acquire);
+    if (head == tail && wait && num_inflight_ > 0) {
+        if (Enter(1) == -1) {
+            LOG_WARN("failed to wait for io requests: %s",
+                     std::strerror(errno));
+        }
+        tail = std::atomic_ref{*cq_tail_}.load(std::memory_order_acquire);
+    }
+
+    // Completions are copied out first since callbacks submit requests.
+    std::vector<std::pair<Request *, ssize_t>> done;
+    done.reserve(tail - head);
+    for (; head != tail; ++head) {
+        auto const &cqe = cqes_[head & cq_mask_];
+        done.emplace_back(reinterpret_cast<Request *>(cqe.user_data),
+                          cqe.res);
+    }
+    std::atomic_ref{*cq_head_}.store(head, std::memory_order_release);
+    num_inflight_ -= done.size();
+
+    for (auto [req, res] : done) {
+        switch (req->op) {
+        case Op::Transfer: {
+            auto cb = std::move(req->cb);
+            delete req;
+            cb(res);
+            break;
+        }
+        case Op::CopyRead:
+            req->chunk->read_res = res;
+            OnChunk(req->chunk);
+            break;
+        case Op::CopyWrite:
+            req->chunk->write_res = res;
+            OnChunk(req->chunk);
+            break;
+        }
+    }
+    Submit();
+    return done.size();
+}
+
+// ThreadEngine performs blocking syscalls on a pool of threads. It is a
+// fallback if io_uring is not available (e.g. disabled by seccomp).
+class ThreadEngine : public IoEngine {
+public:
+    explicit ThreadEngine(Options const &opts);
+
+    ~ThreadEngine(void) override;
+
+    IoEngineKind kind(void) const override {
+        return IoEngineKind::Threads;
+    }
+
+    int fd(void) const override {
+        return event_fd_;
+    }
+
+    void Read(int fd, char *buf, size_t size, int64_t offset,
+              Callback cb) override {
+        backlog_.push_back(
+            {Op::Read, fd, -1, buf, size, offset, 0, std::move(cb)});
+    }
+
+    void Write(int fd, char const *buf, size_t size, int64_t offset,
+               Callback cb) override {
+        backlog_.push_back({Op::Write, fd, -1, const_cast<char *>(buf), size,
+                            offset, 0, std::move(cb)});
+    }
+
+    void Copy(int in_fd, int64_t in_offset, int out_fd, int64_t out_offset,
+              size_t size, Callback cb) override {
+        backlog_.push_back({Op::Copy, in_fd, out_fd, nullptr, size,
+                            in_offset, out_offset, std::move(cb)});
+    }
+
+    size_t Submit(void) override;
+
+    size_t Reap(bool wait) override;
+
+    size_t NumPending(void) const override {
+        return backlog_.size() + num_inflight_;
+    }
+
+private:
+    enum class Op : uint8_t {
+        Read,
+        Write,
+        Copy,
+    };
+
+    struct Request {
+        Op op;
+        int fd;
+        int out_fd;
+        char *buf;
+        size_t size;
+        int64_t offset;
+        int64_t out_offset;
+        Callback cb;
+        ssize_t res = 0;
+    };
+
+    void Work(void);
+
+    ssize_t Execute(Request const &req, std::vector<char> &buf);
+
+    int event_fd_ = -1;
+    size_t buffer_size_;
+    std::deque<Request> backlog_;
+    size_t num_inflight_ = 0;
+
+    std::mutex mutex_;
+    std::condition_variable queued_;
+    std::condition_variable completed_;
+    std::deque<Request> queue_;
+    std::vector<Request> done_;
+    bool stopping_ = false;
+    std::vector<std::thread> threads_;
+};
+
+ThreadEngine::ThreadEngine(Options const &opts)
+    : event_fd_{eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)},
+      buffer_size_{std::max<size_t>(opts.buffer_size, 4096)} {
+    auto num_threads = std::max<size_t>(opts.num_threads, 1);
+    for (size_t ix = 0; ix != num_threads; ++ix) {
+        threads_.emplace_back([this]() { Work(); });
+    }
+}
+
+ThreadEngine::~ThreadEngine(void) {
+    Drain();
+    {
+        std::lock_guard lock(mutex_);
+        stopping_ = true;
+    }
+    queued_.notify_all();
+    for (auto &thread : threads_) {
+        thread.join();
+    }
+    if (event_fd_ != -1) {
+        close(event_fd_);
+    }
+}
+
+size_t ThreadEngine::Submit(void) {
+    auto num_reqs = backlog_.size();
+    if (num_reqs == 0) {
+        return 0;
+    }
+    {
+        std::lock_guard lock(mutex_);
+        std::move(backlog_.begin(), backlog_.end(),
+                  std::back_inserter(queue_));
+    }
+    backlog_.clear();
+    num_inflight_ += num_reqs;
+    queued_.notify_all();
+    return num_reqs;
+}
+
+size_t ThreadEngine::Reap(bool wait) {
+    ClearEvent(event_fd_);
+    std::vector<Request> done;
+    {
+        std::unique_lock lock(mutex_);
+        if (wait && num_inflight_ > 0) {
+            completed_.wait(lock, [this]() { return !done_.empty(); });
+        }
+        done.swap(done_);
+    }
+    num_inflight_ -= done.size();
+    for (auto &req : done) {
+        req.cb(req.res);
+    }
+    Submit();
+    return done.size();
+}
+
+void ThreadEngine::Work(void) {
+    std::vector<char> buf;
+    while (true) {
+        Request req;
+        {
+            std::unique_lock lock(mutex_);
+            queued_.wait(lock,
+                         [this]() { return stopping_ || !queue_.empty(); });
+            if (queue_.empty()) {
+                return;
+            }
+            req = std::move(queue_.front());
+            queue_.pop_front();
+        }
+        req.res = Execute(req, buf);
+        {
+            std::lock_guard lock(mutex_);
+            done_.push_back(std::move(req));
+        }
+        completed_.notify_one();
+        SignalEvent(event_fd_);
+    }
+}
+
+ssize_t ThreadEngine::Execute(Request const &req, std::vector<char> &buf) {
+    auto retry = [](auto fn) {
+        ssize_t res;
+        while ((res = fn()) == -1 && errno == EINTR) {
+        }
+        return res == -1 ? -errno : res;
+    };
+    switch (req.op) {
+    case Op::Read:
+        return retry([&]() {
+            return req.offset == -1
+                       ? read(req.fd, req.buf, req.size)
+                       : pread(req.fd, req.buf, req.size, req.offset);
+        });
+    case Op::Write:
+        return retry([&]() {
+            return req.offset == -1
+                       ? write(req.fd, req.buf, req.size)
+                       : pwrite(req.fd, req.buf, req.size, req.offset);
+        });
+    case Op::Copy:
+        break;
+    }
+
+    buf.resize(buffer_size_);
+    size_t copied = 0;
+    while (copied < req.size) {
+        auto size = std::min(req.size - copied, buf.size());
+        auto num_read = retry([&]() {
+            return pread(req.fd, buf.data(), size, req.offset + copied);
+        });
+        if (num_read <= 0) {
+            return num_read < 0 ? num_read : copied;
+        }
+        for (ssize_t done = 0; done < num_read;) {
+            auto res = retry([&]() {
+                return pwrite(req.out_fd, buf.data() + done, num_read - done,
+                              req.out_offset + copied + done);
+            });
+            if (res <= 0) {
+                return res < 0 ? res : -EIO;
+            }
+            done += res;
+        }
+        copied += num_read;
+    }
+    return copied;
+}
+
+} // namespace
+
+std::string_view ToString(IoEngineKind kind) {
+    switch (kind) {
+    case IoEngineKind::Auto:
+        return "auto";
+    case IoEngineKind::Uring:
+        return "io_uring";
+    case IoEngineKind::Threads:
+        return "threads";
+    }
+    return "unknown";
+}
+
+std::unique_ptr<IoEngine> IoEngine::Create(Options const &opts) {
+    if (opts.kind != IoEngineKind::Threads) {
+        if (auto engine = UringEngine::Create(opts)) {
+            return engine;
+        }
+        LOG_DEBUG("io_uring is not available: %s", std::strerror(errno));
+        if (opts.kind == IoEngineKind::Uring) {
+            return nullptr;
+        }
+    }
+    auto engine = std::make_unique<ThreadEngine>(opts);
+    if (engine->fd() == -1) {
+        return nullptr;
+    }
+    return engine;
+}
+
+void IoEngine::Drain(void) {
+    Submit();
+    while (NumPending() > 0) {
+        Reap(true);
+    }
+}
+
+ssize_t CopyFile(IoEngine &engine, char const *src, char const *dst) {
+    int in_fd = open(src, O_RDONLY | O_CLOEXEC);
+    if (in_fd == -1) {
+        return -errno;
+    }
+    struct stat st;
+    if (fstat(in_fd, &st) == -1) {
+        auto err = errno;
+        close(in_fd);
+        return -err;
+    }
+    int out_fd = open(dst, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+                      st.st_mode & 0777);
+    if (out_fd == -1) {
+        auto err = errno;
+        close(in_fd);
+        return -err;
+    }
+    ssize_t result = 0;
+    engine.Copy(in_fd, 0, out_fd, 0, st.st_size,
+                [&result](ssize_t res) { result = res; });
+    engine.Drain();
+    close(in_fd);
+    if (close(out_fd) == -1 && result >= 0) {
+        result = -errno;
+    }
+    return result;
+}
+
+LogWriter::LogWriter(IoEngine &engine, int fd, ErrorCallback on_error)
+    : engine_{engine}, fd_{fd}, on_error_{std::move(on_error)} {
+}
+
+LogWriter::~LogWriter(void) {
+    Flush();
+}
+
+void LogWriter::Append(std::string_view data) {
+    if (failed_) {
+        on_error_(EIO, data);
+        return;
+    }
+    pending_.append(data);
+    if (!busy_) {
+        Start();
+    }
+    while (busy_ && num_pending() > max_pending) {
+        engine_.Reap(true);
+    }
+}
+
+void LogWriter::Flush(void) {
+    while (busy_) {
+        engine_.Submit();
+        engine_.Reap(true);
+    }
+}
+
+void LogWriter::Start(void) {
+    if (written_ == writing_.size()) {
+        writing_.clear();
+        written_ = 0;
+        writing_.swap(pending_);
+    }
+    if (writing_.empty()) {
+        busy_ = false;
+        return;
+    }
+    busy_ = true;
+    num_writes_ += 1;
+    engine_.Write(fd_, writing_.data() + written_, writing_.size() - written_,
+                  -1, [this](ssize_t res) { OnWritten(res); });
+    engine_.Submit();
+}
+
+void LogWriter::OnWritten(ssize_t res) {
+    if (res <= 0) {
+        failed_ = true;
+        busy_ = false;
+        std::string unwritten = writing_.substr(written_) + pending_;
+        writing_.clear();
+        pending_.clear();
+        written_ = 0;
+        on_error_(res < 0 ? -res : EIO, unwritten);
+        return;
+    }
+    written_ += res;
+    Start();
+}
+
+} // namespace mlspace
@@ -0,0 +1,155 @@
+// Copyright 2025 Daniel Bershatsky
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include <sys/types.h>
+
+namespace mlspace {
+
+enum class IoEngineKind {
+    Auto,    // io_uring if available and thread pool otherwise.
+    Uring,   // io_uring(7) with registered buffers.
+    Threads, // Blocking syscalls on a thread pool.
+};
+
+std::string_view ToString(IoEngineKind kind);
+
+// IoEngine performs file I/O asynchronously so that the event loop does not
+// block on slow disks. Requests are queued and then submitted in batches by
+// `Submit`. Completions are reaped by `Reap` in the caller thread so that
+// callbacks run in the event loop; descriptor `fd` becomes readable when
+// there are completions to reap.
+//
+// Requests are not ordered with respect to each other. Buffers must outlive
+// requests.
+class IoEngine {
+public:
+    // Callback receives number of bytes transferred or negated errno.
+    using Callback = std::function<void(ssize_t res)>;
+
+    struct Options {
+        IoEngineKind kind = IoEngineKind::Auto;
+        unsigned depth = 64;
+        // Buffers for copying. They are registered with io_uring.
+        size_t num_buffers = 8;
+        size_t buffer_size = 256 << 10;
+        size_t num_threads = 2;
+    };
+
+    // Create returns an engine or `nullptr` if there is no engine of kind.
+    static std::unique_ptr<IoEngine> Create(Options const &opts);
+
+    virtual ~IoEngine(void) = default;
+
+    virtual IoEngineKind kind(void) const = 0;
+
+    // Fd is an eventfd which is signaled on completions.
+    virtual int fd(void) const = 0;
+
+    // Read and Write queue transfer at `offset` or at file position if
+    // `offset` is -1.
+    virtual void Read(int fd, char *buf, size_t size, int64_t offset,
+                      Callback cb) = 0;
+
+    virtual void Write(int fd, char const *buf, size_t size, int64_t offset,
+                       Callback cb) = 0;
+
+    // Copy queues copy of `size` bytes from `in_fd` to `out_fd` at given
+    // offsets through engine buffers. It completes with number of bytes
+    // copied which is less than `size` if input ends earlier.
+    virtual void Copy(int in_fd, int64_t in_offset, int out_fd,
+                      int64_t out_offset, size_t size, Callback cb) = 0;
+
+    // Submit submits queued requests and returns their number.
+    virtual size_t Submit(void) = 0;
+
+    // Reap runs callbacks of completed requests and returns their number.
+    // It blocks until some request completes if `wait` is set.
+    virtual size_t Reap(bool wait) = 0;
+
+    // NumPending returns number of requests which are not reaped yet.
+    virtual size_t NumPending(void) const = 0;
+
+    // Drain submits all requests and waits for their completion including
+    // the ones which are queued by callbacks.
+    void Drain(void);
+};
+
+// CopyFile copies regular file `src` to `dst` with `engine` and blocks until
+// it is done. It returns number of bytes or negated errno.
+ssize_t CopyFile(IoEngine &engine, char const *src, char const *dst);
+
+// LogWriter appends stream of data to a file with `IoEngine`. There is at
+// most one write in flight so that order is preserved; data appended in the
+// meantime is accumulated and written by the next request. Unwritten data
+// is passed to `on_error` if writing fails.
+class LogWriter {
+public:
+    using ErrorCallback = std::function<void(int err, std::string_view data)>;
+
+    // Append blocks until some data is written if more than `max_pending`
+    // bytes are not written yet.
+    static constexpr size_t max_pending = 16 << 20;
+
+    LogWriter(IoEngine &engine, int fd, ErrorCallback on_error);
+
+    // ~LogWriter waits until all data is written.
+    ~LogWriter(void);
+
+    LogWriter(LogWriter const &) = delete;
+
+    LogWriter &operator=(LogWriter const &) = delete;
+
+    void Append(std::string_view data);
+
+    // Flush blocks until all appended data is written.
+    void Flush(void);
+
+    bool IsFailed(void) const {
+        return failed_;
+    }
+
+    size_t num_pending(void) const {
+        return writing_.size() - written_ + pending_.size();
+    }
+
+    size_t num_writes(void) const {
+        return num_writes_;
+    }
+
+private:
+    void Start(void);
+
+    void OnWritten(ssize_t res);
+
+    IoEngine &engine_;
+    int fd_;
+    ErrorCallback on_error_;
+    std::string writing_; // In flight.
+    std::string pending_; // Appended while writing.
+    size_t written_ = 0;
+    bool busy_ = false;
+    bool failed_ = false;
+    size_t num_writes_ = 0;
+};
+
+} // namespace mlspace
@@ -0,0 +1,132 @@
+// Copyright 2025 Daniel Bershatsky
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Benchmark of I/O engines on copying a file and writing a log of small
+// records. Usage: io_engine_bench [<dir> [<size in MiB> [<num records>]]].
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <mlspace/cc/io_engine.h>
+
+using mlspace::IoEngine;
+using mlspace::IoEngineKind;
+
+namespace {
+
+// Measurement is wall and CPU time (of all threads) of a run.
+struct Measurement {
+    double wall;
+    double cpu;
+};
+
+double CpuSeconds(void) {
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    auto seconds = [](timeval const &tv) {
+        return tv.tv_sec + tv.tv_usec * 1e-6;
+    };
+    return seconds(usage.ru_utime) + seconds(usage.ru_stime);
+}
+
+template <typename F> Measurement Measure(F &&fn) {
+    auto cpu = CpuSeconds();
+    auto started_at = std::chrono::steady_clock::now();
+    fn();
+    std::chrono::duration<double> wall =
+        std::chrono::steady_clock::now() - started_at;
+    return {wall.count(), CpuSeconds() - cpu};
+}
+
+void Report(char const *name, IoEngineKind kind, size_t bytes,
+            Measurement const &m) {
+    std::printf("%-6s %-9s %8.1f MiB/s  wall %.3fs  cpu %.3fs\n", name,
+                ToString(kind).data(), bytes / m.wall / (1 << 20), m.wall,
+                m.cpu);
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    std::filesystem::path dir =
+        argc > 1 ? argv[1] : std::filesystem::temp_directory_path();
+    size_t size = (argc > 2 ? std::atol(argv[2]) : 256) << 20;
+    size_t num_records = argc > 3 ? std::atol(argv[3]) : 1'000'000;
+
+    auto src = dir / "mlspace-io-bench.src";
+    auto dst = dir / "mlspace-io-bench.dst";
+    {
+        std::vector<char> chunk(1 << 20, 'x');
+        int fd = open(src.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        for (size_t offset = 0; offset < size; offset += chunk.size()) {
+            if (write(fd, chunk.data(), chunk.size()) == -1) {
+                std::perror("failed to write source file");
+                return 1;
+            }
+        }
+        close(fd);
+    }
+
+    std::string record(120, 'r');
+    record.push_back('\n');
+    for (auto kind : {IoEngineKind::Uring, IoEngineKind::Threads}) {
+        IoEngine::Options opts;
+        opts.kind = kind;
+        auto engine = IoEngine::Create(opts);
+        if (!engine) {
+            std::printf("%s is not available\n", ToString(kind).data());
+            continue;
+        }
+
+        ssize_t copied = 0;
+        auto copy = Measure([&]() {
+            copied = mlspace::CopyFile(*engine, src.c_str(), dst.c_str());
+        });
+        if (copied < 0) {
+            std::fprintf(stderr, "failed to copy: %s\n",
+                         std::strerror(-copied));
+            return 1;
+        }
+        Report("copy", kind, copied, copy);
+
+        int fd = open(dst.c_str(), O_WRONLY | O_TRUNC | O_APPEND);
+        auto log = Measure([&]() {
+            mlspace::LogWriter writer(*engine, fd, [](int err, auto) {
+                std::fprintf(stderr, "failed to write: %s\n",
+                             std::strerror(err));
+            });
+            for (size_t ix = 0; ix != num_records; ++ix) {
+                writer.Append(record);
+                if (ix % 64 == 0) {
+                    engine->Reap(false); // As event loop does.
+                }
+            }
+        });
+        close(fd);
+        Report("log", kind, num_records * record.size(), log);
+    }
+
+    std::filesystem::remove(src);
+    std::filesystem::remove(dst);
+    return 0;
+}
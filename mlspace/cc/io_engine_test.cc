@@ -0,0 +1,179 @@
+// Copyright 2025 Daniel Bershatsky
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <mlspace/cc/io_engine.h>
+
+using mlspace::IoEngine;
+using mlspace::IoEngineKind;
+using mlspace::LogWriter;
+
+namespace {
+
+class IoEngineTest : public testing::TestWithParam<IoEngineKind> {
+protected:
+    void SetUp(void) override {
+        IoEngine::Options opts;
+        opts.kind = GetParam();
+        opts.num_buffers = 2;
+        opts.buffer_size = 64 << 10;
+        if (!(engine_ = IoEngine::Create(opts))) {
+            GTEST_SKIP() << "engine is not available";
+        }
+        ASSERT_EQ(engine_->kind(), GetParam());
+        dir_ = std::filesystem::temp_directory_path() /
+               ("mlspace-io-" + std::to_string(getpid()));
+        std::filesystem::create_directories(dir_);
+    }
+
+    void TearDown(void) override {
+        engine_.reset();
+        if (!dir_.empty()) {
+            std::filesystem::remove_all(dir_);
+        }
+    }
+
+    std::string Path(char const *name) const {
+        return (dir_ / name).string();
+    }
+
+    static std::string ReadAll(std::string const &path) {
+        std::ifstream file(path, std::ios::binary);
+        return {std::istreambuf_iterator<char>(file), {}};
+    }
+
+    std::unique_ptr<IoEngine> engine_;
+    std::filesystem::path dir_;
+};
+
+} // namespace
+
+TEST_P(IoEngineTest, ReadWrite) {
+    int fd = open(Path("rw").c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    ASSERT_NE(fd, -1);
+    std::string data = "0123456789";
+    std::vector<ssize_t> results;
+    auto cb = [&](ssize_t res) { results.push_back(res); };
+    engine_->Write(fd, data.data(), 5, 5, cb);
+    engine_->Write(fd, data.data(), 5, 0, cb);
+    EXPECT_EQ(engine_->NumPending(), 2);
+    engine_->Drain();
+    EXPECT_EQ(results, (std::vector<ssize_t>{5, 5}));
+
+    char buf[16] = {};
+    engine_->Read(fd, buf, sizeof(buf), 2, cb);
+    engine_->Drain();
+    close(fd);
+    EXPECT_EQ(results.back(), 8);
+    EXPECT_EQ(std::string(buf), "23401234");
+
+    engine_->Read(fd, buf, sizeof(buf), 0, cb);
+    engine_->Drain();
+    EXPECT_EQ(results.back(), -EBADF);
+    EXPECT_EQ(engine_->NumPending(), 0);
+}
+
+TEST_P(IoEngineTest, CopyFile) {
+    // Size is not a multiple of buffer size and there are more chunks than
+    // buffers.
+    std::string data(1'000'003, '\0');
+    for (size_t ix = 0; ix != data.size(); ++ix) {
+        data[ix] = static_cast<char>(ix * 7 + ix / 4096);
+    }
+    std::ofstream(Path("src"), std::ios::binary) << data;
+    auto res = mlspace::CopyFile(*engine_, Path("src").c_str(),
+                                 Path("dst").c_str());
+    EXPECT_EQ(res, data.size());
+    EXPECT_EQ(ReadAll(Path("dst")), data);
+
+    // Copy ends at the end of input.
+    int in_fd = open(Path("src").c_str(), O_RDONLY | O_CLOEXEC);
+    int out_fd = open(Path("part").c_str(), O_WRONLY | O_CREAT | O_CLOEXEC,
+                      0644);
+    ssize_t copied = 0;
+    engine_->Copy(in_fd, 999'000, out_fd, 0, 1 << 20,
+                  [&](ssize_t res) { copied = res; });
+    engine_->Drain();
+    close(in_fd);
+    close(out_fd);
+    EXPECT_EQ(copied, 1003);
+    EXPECT_EQ(ReadAll(Path("part")), data.substr(999'000));
+
+    EXPECT_EQ(mlspace::CopyFile(*engine_, Path("missing").c_str(),
+                                Path("dst").c_str()),
+              -ENOENT);
+}
+
+TEST_P(IoEngineTest, LogWriter) {
+    int fd = open(Path("log").c_str(),
+                  O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    ASSERT_NE(fd, -1);
+    std::string expected;
+    {
+        LogWriter writer(*engine_, fd, [](int, std::string_view) {
+            FAIL() << "unexpected write error";
+        });
+        for (int ix = 0; ix != 10'000; ++ix) {
+            auto line = "line " + std::to_string(ix) + '\n';
+            writer.Append(line);
+            expected += line;
+            if (ix % 100 == 0) {
+                engine_->Reap(false);
+            }
+        }
+        writer.Flush();
+        EXPECT_EQ(writer.num_pending(), 0);
+        EXPECT_LT(writer.num_writes(), 10'000); // Appends are batched.
+    }
+    close(fd);
+    EXPECT_EQ(ReadAll(Path("log")), expected);
+}
+
+TEST_P(IoEngineTest, LogWriterError) {
+    int fd = open(Path("ro").c_str(), O_RDONLY | O_CREAT | O_CLOEXEC, 0644);
+    ASSERT_NE(fd, -1);
+    std::string unwritten;
+    int error = 0;
+    LogWriter writer(*engine_, fd, [&](int err, std::string_view data) {
+        error = err;
+        unwritten += data;
+    });
+    writer.Append("abc");
+    writer.Append("def");
+    writer.Flush();
+    EXPECT_TRUE(writer.IsFailed());
+    EXPECT_EQ(error, EBADF);
+    EXPECT_EQ(unwritten, "abcdef");
+    close(fd);
+}
+
+INSTANTIATE_TEST_SUITE_P(Engines, IoEngineTest,
+                         testing::Values(IoEngineKind::Uring,
+                                         IoEngineKind::Threads),
+                         [](auto const &info) {
+                             return std::string{ToString(info.param)} ==
+                                            "io_uring"
+                                        ? "Uring"
+                                        : "Threads";
+                         });
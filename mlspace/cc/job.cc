@@ -14,15 +14,20 @@
 
 #include "job.h"
 
+#include <algorithm>
+#include <string_view>
+
 #include <nlohmann/json.hpp>
 
+#include <mlspace/cc/control.h>
+
 namespace mlspace {
 
 bool JsonPathInto(nlohmann::json const &json, std::string const &key,
                   std::optional<std::filesystem::path> &path) {
     if (!json.contains(key)) {
         return false;
-    } else if (auto tmp = json.at(key); !tmp.is_string()) {
+    } else if (auto const &tmp = json.at(key); !tmp.is_string()) {
         return true;
     } else {
         path = std::move(tmp.template get<std::string>());
@@ -34,7 +39,7 @@ bool JsonStringInto(nlohmann::json const &json, std::string const &key,
                     std::string &val) {
     if (!json.contains(key)) {
         return false;
-    } else if (auto tmp = json.at(key); !tmp.is_string()) {
+    } else if (auto const &tmp = json.at(key); !tmp.is_string()) {
         return false;
     } else {
         val = tmp.template get<std::string>();
@@ -46,7 +51,7 @@ bool JsonVectorInto(nlohmann::json const &json, std::string const &key,
                     std::vector<std::string> &val) {
     if (!json.contains(key)) {
         return false;
-    } else if (auto tmp = json.at(key); !tmp.is_array()) {
+    } else if (auto const &tmp = json.at(key); !tmp.is_array()) {
         return false;
     } else {
         val = tmp.template get<std::vector<std::string>>();
@@ -59,7 +64,7 @@ bool JsonDictInto(nlohmann::json const &json, std::string const &key,
     using T = std::unordered_map<std::string, std::string>;
     if (!json.contains(key)) {
         return false;
-    } else if (auto tmp = json.at(key); !tmp.is_object()) {
+    } else if (auto const &tmp = json.at(key); !tmp.is_object()) {
         return false;
     } else {
         val = tmp.template get<T>();
@@ -67,6 +72,192 @@ bool JsonDictInto(nlohmann::json const &json, std::string const &key,
     }
 }
 
+std::optional<Checkpoint> Checkpoint::FromJSON(nlohmann::json const &json) {
+    if (!json.is_object()) {
+        return std::nullopt;
+    }
+
+    Checkpoint checkpoint;
+    if (auto it = json.find("signal"); it != json.end()) {
+        std::optional<int> signo;
+        if (it->is_number_integer()) {
+            signo = ParseSignal(std::to_string(it->template get<int>()));
+        } else if (it->is_string()) {
+            signo = ParseSignal(it->template get<std::string>());
+        }
+        if (!signo) {
+            printf("unknown checkpoint signal: %s\n", it->dump().data());
+            return std::nullopt;
+        }
+        checkpoint.signal = *signo;
+    }
+
+    JsonPathInto(json, "marker", checkpoint.marker);
+
+    // Timeout is in seconds like everywhere in Python.
+    if (auto it = json.find("timeout"); it != json.end()) {
+        if (!it->is_number() || it->template get<double>() <= 0) {
+            printf("checkpoint timeout must be positive number\n");
+            return std::nullopt;
+        }
+        auto ms = 1000 * it->template get<double>();
+        checkpoint.timeout =
+            std::chrono::milliseconds{static_cast<int64_t>(ms)};
+    }
+
+    if (json.contains("flush") && !json.at("flush").is_null() &&
+        !JsonVectorInto(json, "flush", checkpoint.flush)) {
+        return std::nullopt;
+    }
+
+    return checkpoint;
+}
+
+std::optional<ProfileMode> ParseProfileMode(std::string_view str) {
+    if (str == "auto") {
+        return ProfileMode::Auto;
+    } else if (str == "perf") {
+        return ProfileMode::Perf;
+    } else if (str == "proc") {
+        return ProfileMode::Proc;
+    }
+    return std::nullopt;
+}
+
+std::string_view ToString(ProfileMode mode) {
+    switch (mode) {
+    case ProfileMode::Auto:
+        return "auto";
+    case ProfileMode::Perf:
+        return "perf";
+    case ProfileMode::Proc:
+        return "proc";
+    }
+    return "unknown";
+}
+
+std::optional<Profile> Profile::FromJSON(nlohmann::json const &json) {
+    if (!json.is_object()) {
+        return std::nullopt;
+    }
+
+    Profile profile;
+    std::optional<std::filesystem::path> output;
+    if (JsonPathInto(json, "output", output); !output) {
+        printf("profile output must be a path\n");
+        return std::nullopt;
+    }
+    profile.output = std::move(*output);
+
+    if (auto it = json.find("frequency"); it != json.end()) {
+        if (!it->is_number_unsigned() || it->template get<int>() == 0) {
+            printf("profile frequency must be positive integer\n");
+            return std::nullopt;
+        }
+        profile.frequency = it->template get<int>();
+    }
+
+    if (auto it = json.find("mode"); it != json.end() && !it->is_null()) {
+        std::optional<ProfileMode> mode;
+        if (it->is_string()) {
+            mode = ParseProfileMode(it->template get<std::string>());
+        }
+        if (!mode) {
+            printf("profile mode must be auto, perf, or proc\n");
+            return std::nullopt;
+        }
+        profile.mode = *mode;
+    }
+
+    return profile;
+}
+
+std::optional<SharedMemory>
+SharedMemory::FromJSON(nlohmann::json const &json) {
+    if (!json.is_object()) {
+        return std::nullopt;
+    }
+
+    SharedMemory shm;
+    if (auto it = json.find("size");
+        it == json.end() || !it->is_number_unsigned() ||
+        (shm.size = it->template get<size_t>()) == 0) {
+        printf("shared memory size must be positive integer\n");
+        return std::nullopt;
+    }
+
+    if (auto it = json.find("huge_pages"); it != json.end()) {
+        if (!it->is_boolean()) {
+            printf("shared memory huge_pages must be boolean\n");
+            return std::nullopt;
+        }
+        shm.huge_pages = it->template get<bool>();
+    }
+
+    if (auto it = json.find("numa_node"); it != json.end() && !it->is_null()) {
+        if (!it->is_number_unsigned()) {
+            printf("shared memory numa_node must be node number\n");
+            return std::nullopt;
+        }
+        shm.numa_node = it->template get<int>();
+    }
+
+    return shm;
+}
+
+std::optional<Allocation> Allocation::FromJSON(nlohmann::json const &json) {
+    if (!json.is_object()) {
+        return std::nullopt;
+    }
+
+    Allocation alloc;
+    if (auto it = json.find("cpus"); it != json.end()) {
+        if (!it->is_number_unsigned()) {
+            printf("allocation cpus must be number of cpus\n");
+            return std::nullopt;
+        }
+        alloc.cpus = it->template get<size_t>();
+    }
+
+    if (auto it = json.find("memory"); it != json.end()) {
+        if (!it->is_number_unsigned()) {
+            printf("allocation memory must be number of bytes\n");
+            return std::nullopt;
+        }
+        alloc.memory = it->template get<size_t>();
+    }
+
+    if (alloc.cpus == 0 && alloc.memory == 0) {
+        printf("allocation must claim cpus or memory\n");
+        return std::nullopt;
+    }
+
+    if (auto it = json.find("same_node"); it != json.end()) {
+        if (!it->is_boolean()) {
+            printf("allocation same_node must be boolean\n");
+            return std::nullopt;
+        }
+        alloc.same_node = it->template get<bool>();
+    }
+
+    // Timeout is in seconds like everywhere in Python.
+    if (auto it = json.find("timeout"); it != json.end()) {
+        if (!it->is_number() || it->template get<double>() < 0) {
+            printf("allocation timeout must be non-negative number\n");
+            return std::nullopt;
+        }
+        auto ms = 1000 * it->template get<double>();
+        alloc.timeout = std::chrono::milliseconds{static_cast<int64_t>(ms)};
+    }
+
+    std::optional<std::filesystem::path> registry;
+    if (JsonPathInto(json, "registry", registry) && registry) {
+        alloc.registry = std::move(*registry);
+    }
+
+    return alloc;
+}
+
 std::optional<Job> Job::FromJSON(std::string const &str) {
     auto json = nlohmann::json::parse(str, nullptr, false);
     if (json.is_discarded()) {
@@ -92,7 +283,122 @@ std::optional<Job> Job::FromJSON(std::string const &str) {
         return std::nullopt;
     }
 
+    // Supervisor options are optional.
+    JsonPathInto(json, "control_socket", job.control_socket);
+    JsonPathInto(json, "metrics", job.metrics);
+    JsonPathInto(json, "journal", job.journal);
+
+    if (auto it = json.find("checkpoint"); it != json.end() && !it->is_null()) {
+        if (!(job.checkpoint = Checkpoint::FromJSON(*it))) {
+            printf("failed to parse checkpoint spec\n");
+            return std::nullopt;
+        }
+    }
+
+    if (auto it = json.find("profile"); it != json.end() && !it->is_null()) {
+        if (!(job.profile = Profile::FromJSON(*it))) {
+            printf("failed to parse profile spec\n");
+            return std::nullopt;
+        }
+    }
+
+    if (auto it = json.find("shm"); it != json.end() && !it->is_null()) {
+        if (!(job.shm = SharedMemory::FromJSON(*it))) {
+            printf("failed to parse shared memory spec\n");
+            return std::nullopt;
+        }
+    }
+
+    if (auto it = json.find("cpus"); it != json.end() && !it->is_null()) {
+        if (!it->is_array()) {
+            printf("cpus must be a list of cpu numbers\n");
+            return std::nullopt;
+        }
+        for (auto const &cpu : *it) {
+            if (!cpu.is_number_unsigned()) {
+                printf("cpus must be a list of cpu numbers\n");
+                return std::nullopt;
+            }
+            job.cpus.push_back(cpu.template get<int>());
+        }
+    }
+
+    if (auto it = json.find("allocation"); it != json.end() && !it->is_null()) {
+        if (!(job.allocation = Allocation::FromJSON(*it))) {
+            printf("failed to parse allocation spec\n");
+            return std::nullopt;
+        }
+    }
+
+    // Parse templates once in order to instantiate them for many processes.
+    job.argv_template.reserve(job.args.size() + 1);
+    job.argv_template.push_back(Template::Parse(job.executable));
+    for (auto const &arg : job.args) {
+        job.argv_template.push_back(Template::Parse(arg));
+    }
+    job.env_template.reserve(job.env.size());
+    for (auto const &[key, value] : job.env) {
+        job.env_template.emplace_back(key, Template::Parse(value));
+    }
+    std::sort(job.env_template.begin(), job.env_template.end(),
+              [](auto const &a, auto const &b) { return a.first < b.first; });
+
     return job;
 }
 
+void ExecBuffer::Build(Job const &job, TemplateVars const &vars,
+                       char *const *environ) {
+    auto const &env = job.env_template;
+
+    // Calculate size in advance so that pointers to buffer stay valid.
+    size_t size = 0;
+    for (auto const &arg : job.argv_template) {
+        size += arg.Size(vars) + 1;
+    }
+    for (auto const &[key, value] : env) {
+        size += key.size() + value.Size(vars) + 2;
+    }
+    buf_.resize(size);
+
+    // Reserve pointer arrays as well so that rebuild does not allocate.
+    size_t num_environ = 0;
+    for (auto it = environ; it && *it; ++it) {
+        ++num_environ;
+    }
+    argv_.clear();
+    argv_.reserve(job.argv_template.size() + 1);
+    envp_.clear();
+    envp_.reserve(env.size() + num_environ + 1);
+    auto ptr = buf_.data();
+    for (auto const &arg : job.argv_template) {
+        argv_.push_back(ptr);
+        ptr = arg.Render(vars, ptr);
+        *ptr++ = '\0';
+    }
+    argv_.push_back(nullptr);
+
+    for (auto const &[key, value] : env) {
+        envp_.push_back(ptr);
+        ptr = std::copy(key.begin(), key.end(), ptr);
+        *ptr++ = '=';
+        ptr = value.Render(vars, ptr);
+        *ptr++ = '\0';
+    }
+
+    // Add environment variables of parent process which are not overridden.
+    // Job env is sorted so lookup does not allocate.
+    auto less = [](auto const &entry, std::string_view key) {
+        return entry.first < key;
+    };
+    for (auto it = environ; it && *it; ++it) {
+        std::string_view key{*it};
+        key = key.substr(0, key.find('='));
+        auto pos = std::lower_bound(env.begin(), env.end(), key, less);
+        if (pos == env.end() || pos->first != key) {
+            envp_.push_back(*it);
+        }
+    }
+    envp_.push_back(nullptr);
+}
+
 } // namespace mlspace
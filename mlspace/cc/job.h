@@ -14,16 +14,87 @@
 
 #pragma once
 
+#include <chrono>
+#include <csignal>
 #include <filesystem>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include <nlohmann/json_fwd.hpp>
 
+#include <mlspace/cc/template.h>
+
 namespace mlspace {
 
+// Checkpoint describes a handshake which is performed on preemption: the job
+// is asked with `signal` to save a checkpoint and the checkpoint is considered
+// committed once `marker` file is touched or the job reports it to progress
+// channel. Then `flush` command (e.g. uploader) is run. Everything must be
+// done in `timeout`.
+struct Checkpoint {
+    int signal = SIGUSR1;
+    std::optional<std::filesystem::path> marker;
+    std::chrono::milliseconds timeout{60'000};
+    std::vector<std::string> flush;
+
+    static std::optional<Checkpoint> FromJSON(nlohmann::json const &json);
+};
+
+// ProfileMode selects how call stacks are sampled: with perf events, with
+// procfs thread states, or with perf events falling back to procfs if perf
+// events are not allowed (e.g. by `perf_event_paranoid` or seccomp).
+enum class ProfileMode {
+    Auto,
+    Perf,
+    Proc,
+};
+
+std::optional<ProfileMode> ParseProfileMode(std::string_view str);
+
+std::string_view ToString(ProfileMode mode);
+
+// Profile describes sampling profiler which records call stacks of the job
+// `frequency` times per second and writes them to `output` in folded format
+// (one `frame;frame;...;frame count` per line) on exit.
+struct Profile {
+    std::filesystem::path output;
+    int frequency = 99;
+    ProfileMode mode = ProfileMode::Auto;
+
+    static std::optional<Profile> FromJSON(nlohmann::json const &json);
+};
+
+// SharedMemory describes a memory region which is allocated by supervisor and
+// shared with all processes of a job through inherited file descriptor (see
+// `SharedRegion`). Huge pages are used if `huge_pages` is set and they are
+// available. Region is placed on `numa_node` or on the node of job CPUs.
+struct SharedMemory {
+    size_t size = 0;
+    bool huge_pages = true;
+    std::optional<int> numa_node;
+
+    static std::optional<SharedMemory> FromJSON(nlohmann::json const &json);
+};
+
+// Allocation describes resources which a job claims in node-local registry
+// at `registry` path (see `ResourceClaim`), so that concurrent `launch`
+// instances on a node get disjoint CPUs and memory budgets. CPUs and memory
+// are taken from a single NUMA node unless `same_node` is unset and no node
+// fits. If resources are busy, `launch` waits for them up to `timeout`.
+struct Allocation {
+    size_t cpus = 0;
+    size_t memory = 0; // In bytes.
+    bool same_node = true;
+    std::chrono::milliseconds timeout{0};
+    std::filesystem::path registry = "/dev/shm/mlspace-registry";
+
+    static std::optional<Allocation> FromJSON(nlohmann::json const &json);
+};
+
 // Job is an internal representation of job launching parameters.
 struct Job {
     std::string executable;
@@ -35,7 +106,67 @@ struct Job {
     std::string shell;
     std::string image;
 
+    // Path to Unix domain socket for controlling running supervisor.
+    std::optional<std::filesystem::path> control_socket;
+
+    // Time series file of supervisor metrics (see `SeriesWriter`).
+    std::optional<std::filesystem::path> metrics;
+
+    // Compressed journal of job output (see `JournalWriter`). Path is a
+    // template, e.g. `logs/${RANK}.mljn`.
+    std::optional<std::filesystem::path> journal;
+
+    // Preemption handshake is performed on SIGTERM if specified.
+    std::optional<Checkpoint> checkpoint;
+
+    // Call stacks are sampled and written on exit if specified.
+    std::optional<Profile> profile;
+
+    // Shared memory region for intra-node IPC if specified.
+    std::optional<SharedMemory> shm;
+
+    // CPUs which the job is pinned to. All CPUs are allowed if it is empty.
+    std::vector<int> cpus;
+
+    // Resources claimed in node-local registry if specified. CPUs are
+    // claimed among `cpus` if they are set.
+    std::optional<Allocation> allocation;
+
+    // Executable with args and env values (sorted by name) parsed as
+    // templates (see `Template`). They are instantiated with `ExecBuffer`.
+    std::vector<Template> argv_template;
+    std::vector<std::pair<std::string, Template>> env_template;
+
     static std::optional<Job> FromJSON(std::string const &json);
 };
 
+// ExecBuffer holds argv and envp of a process in a single contiguous buffer.
+// It is rebuilt for every process from job templates; capacity is reused.
+class ExecBuffer {
+public:
+    // Build instantiates templates of `job` for a process with `vars` and
+    // appends entries of `environ` which are not overridden by `job`. Entries
+    // of `environ` are not copied.
+    void Build(Job const &job, TemplateVars const &vars,
+               char *const *environ);
+
+    char *const *argv(void) const {
+        return argv_.data();
+    }
+
+    char *const *envp(void) const {
+        return envp_.data();
+    }
+
+    // Size returns number of bytes of rendered strings.
+    size_t size(void) const {
+        return buf_.size();
+    }
+
+private:
+    std::vector<char> buf_;
+    std::vector<char *> argv_;
+    std::vector<char *> envp_;
+};
+
 } // namespace mlspace
@@ -0,0 +1,316 @@
+// Copyright 2025 Daniel Bershatsky
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "journal.h"
+
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <mlspace/cc/codec.h>
+#include <mlspace/cc/log.h>
+#include <mlspace/cc/proc.h>
+
+namespace mlspace {
+
+namespace {
+
+constexpr char end_magic[8] = {'M', 'L', 'J', 'N', '_', 'E', 'N', 'D'};
+constexpr uint16_t version = 1;
+constexpr uint32_t codec_lz = 1;
+constexpr uint32_t codec_lz_huffman = 2;
+
+// Little-endian host is assumed like everywhere in `launch`.
+template <typename T> void Put(std::string &buf, T value) {
+    buf.append(reinterpret_cast<char const *>(&value), sizeof(value));
+}
+
+template <typename T> T Get(char const *ptr) {
+    T value;
+    std::memcpy(&value, ptr, sizeof(value));
+    return value;
+}
+
+int64_t Align(int64_t offset) {
+    return (offset + 7) / 8 * 8;
+}
+
+bool ReadAt(int fd, char *buf, size_t size, int64_t offset) {
+    return pread(fd, buf, size, offset) == static_cast<ssize_t>(size);
+}
+
+} // namespace
+
+std::optional<JournalWriter> JournalWriter::Open(int fd, Sink sink,
+                                                 Options opts) {
+    if (opts.frame_size == 0 || opts.frame_size > UINT32_MAX ||
+        opts.frames_per_index == 0) {
+        errno = EINVAL;
+        return std::nullopt;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+        return std::nullopt;
+    }
+
+    // Walk through block headers. It reads a few bytes per block since
+    // frames are large.
+    char buf[24];
+    if (st.st_size > 0) {
+        // Neither truncate nor append to a file of other kind.
+        size_t size = st.st_size < 4 ? st.st_size : 4;
+        if (!ReadAt(fd, buf, size, 0)) {
+            return std::nullopt;
+        }
+        if (std::memcmp(buf, "HEAD", size) != 0) {
+            errno = EINVAL;
+            return std::nullopt;
+        }
+    }
+
+    JournalWriter writer;
+    int64_t offset = 0;
+    int32_t rank = 0;
+    while (st.st_size - offset >= 8) {
+        if (!ReadAt(fd, buf, 8, offset)) {
+            return std::nullopt;
+        }
+        std::string_view tag{buf, 4};
+        auto size = Get<uint32_t>(buf + 4);
+        auto next = Align(offset + 8 + size);
+        if (next > st.st_size) {
+            break;
+        }
+        if (tag == "HEAD" && size >= 8) {
+            if (!ReadAt(fd, buf, 8, offset + 8)) {
+                return std::nullopt;
+            }
+            if (Get<uint16_t>(buf) != version) {
+                errno = EINVAL;
+                return std::nullopt;
+            }
+            rank = Get<int32_t>(buf + 4);
+        } else if (tag == "FRAM" && size >= 24) {
+            if (!ReadAt(fd, buf, 24, offset + 8)) {
+                return std::nullopt;
+            }
+            writer.index_.push_back({offset, Get<int64_t>(buf),
+                                     Get<int64_t>(buf + 8), rank,
+                                     Get<uint32_t>(buf + 16)});
+        } else if (tag == "INDX") {
+            writer.index_.clear();
+            writer.prev_index_ = offset;
+        } else {
+            break;
+        }
+        offset = next;
+    }
+    if (offset != st.st_size) {
+        LOG_WARN("truncate journal at offset %lld of %lld: torn block",
+                 static_cast<long long>(offset),
+                 static_cast<long long>(st.st_size));
+        if (ftruncate(fd, offset) == -1) {
+            return std::nullopt;
+        }
+    }
+
+    writer.sink_ = std::move(sink);
+    writer.closed_ = false;
+    writer.opts_ = opts;
+    writer.offset_ = offset;
+    writer.raw_.reserve(opts.frame_size);
+    writer.BeginBlock("HEAD");
+    Put<uint16_t>(writer.block_, version);
+    Put<uint16_t>(writer.block_, 0);
+    Put<int32_t>(writer.block_, opts.rank);
+    if (!writer.EndBlock()) {
+        writer.closed_ = true;
+        return std::nullopt;
+    }
+    return writer;
+}
+
+std::optional<JournalWriter>
+JournalWriter::Create(std::filesystem::path const &path, Options opts) {
+    int fd = open(path.c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd == -1) {
+        return std::nullopt;
+    }
+    auto sink = [fd](std::string_view data) { return WriteAll(fd, data); };
+    auto writer = Open(fd, std::move(sink), opts);
+    if (!writer) {
+        int err = errno;
+        close(fd);
+        errno = err;
+        return std::nullopt;
+    }
+    writer->fd_ = fd;
+    return writer;
+}
+
+JournalWriter::JournalWriter(JournalWriter &&other)
+    : sink_{std::move(other.sink_)}, fd_{std::exchange(other.fd_, -1)},
+      closed_{std::exchange(other.closed_, true)}, opts_{other.opts_},
+      offset_{other.offset_}, num_frames_{other.num_frames_},
+      raw_bytes_{other.raw_bytes_}, stored_bytes_{other.stored_bytes_},
+      raw_{std::move(other.raw_)}, first_time_{other.first_time_},
+      last_time_{other.last_time_}, index_{std::move(other.index_)},
+      prev_index_{other.prev_index_}, indexed_{other.indexed_},
+      block_{std::move(other.block_)} {
+}
+
+JournalWriter &JournalWriter::operator=(JournalWriter &&other) {
+    if (this != &other) {
+        Close();
+        sink_ = std::move(other.sink_);
+        fd_ = std::exchange(other.fd_, -1);
+        closed_ = std::exchange(other.closed_, true);
+        opts_ = other.opts_;
+        offset_ = other.offset_;
+        num_frames_ = other.num_frames_;
+        raw_bytes_ = other.raw_bytes_;
+        stored_bytes_ = other.stored_bytes_;
+        raw_ = std::move(other.raw_);
+        first_time_ = other.first_time_;
+        last_time_ = other.last_time_;
+        index_ = std::move(other.index_);
+        prev_index_ = other.prev_index_;
+        indexed_ = other.indexed_;
+        block_ = std::move(other.block_);
+    }
+    return *this;
+}
+
+JournalWriter::~JournalWriter(void) {
+    Close();
+}
+
+bool JournalWriter::Append(int64_t time, std::string_view data) {
+    if (closed_) {
+        return false;
+    }
+    if (raw_.empty()) {
+        first_time_ = time;
+    }
+    last_time_ = time;
+    raw_.append(data);
+    raw_bytes_ += data.size();
+    while (raw_.size() >= opts_.frame_size) {
+        // Cut frame after the last complete line if there is any.
+        auto size = opts_.frame_size;
+        if (auto pos = raw_.rfind('\n', size - 1); pos != raw_.npos) {
+            size = pos + 1;
+        }
+        if (!WriteFrame(size, time)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool JournalWriter::Flush(void) {
+    if (closed_) {
+        return false;
+    }
+    return raw_.empty() || WriteFrame(raw_.size(), last_time_);
+}
+
+bool JournalWriter::Close(void) {
+    if (closed_) {
+        return true;
+    }
+    bool ok = Flush() && (indexed_ || WriteIndex());
+    closed_ = true;
+    if (fd_ != -1 && close(std::exchange(fd_, -1)) == -1) {
+        ok = false;
+    }
+    return ok;
+}
+
+bool JournalWriter::WriteFrame(size_t size, int64_t next_time) {
+    IndexEntry entry{offset_, first_time_, last_time_, opts_.rank,
+                     static_cast<uint32_t>(size)};
+    BeginBlock("FRAM");
+    Put<int64_t>(block_, first_time_);
+    Put<int64_t>(block_, last_time_);
+    Put<uint32_t>(block_, size);
+    Put<uint32_t>(block_, codec_lz_huffman);
+    lz_.resize(LzBound(size));
+    lz_.resize(LzCompress({raw_.data(), size}, lz_.data()));
+    auto pos = block_.size();
+    block_.resize(pos + HuffmanBound(lz_.size()));
+    auto len = HuffmanEncode(lz_, block_.data() + pos);
+    if (len < lz_.size()) {
+        block_.resize(pos + len);
+    } else {
+        block_.replace(pos - 4, 4, reinterpret_cast<char const *>(&codec_lz),
+                       4);
+        block_.replace(pos, block_.npos, lz_);
+    }
+    raw_.erase(0, size);
+    first_time_ = next_time; // Remainder is received at that time.
+    if (!EndBlock()) {
+        return false;
+    }
+    index_.push_back(entry);
+    num_frames_ += 1;
+    indexed_ = false;
+    if (index_.size() >= opts_.frames_per_index) {
+        return WriteIndex();
+    }
+    return true;
+}
+
+void JournalWriter::BeginBlock(char const *tag) {
+    block_.assign(tag, 4);
+    Put<uint32_t>(block_, 0); // Size is set on end.
+}
+
+bool JournalWriter::EndBlock(void) {
+    uint32_t size = block_.size() - 8;
+    std::memcpy(block_.data() + 4, &size, sizeof(size));
+    block_.append((8 - block_.size() % 8) % 8, '\0');
+    if (!sink_(block_)) {
+        LOG_WARN("failed to write journal block: %s", std::strerror(errno));
+        return false;
+    }
+    offset_ += block_.size();
+    stored_bytes_ += block_.size();
+    return true;
+}
+
+bool JournalWriter::WriteIndex(void) {
+    auto offset = offset_;
+    BeginBlock("INDX");
+    Put<int64_t>(block_, prev_index_);
+    Put<uint32_t>(block_, index_.size());
+    Put<uint32_t>(block_, 0);
+    block_.append(reinterpret_cast<char const *>(index_.data()),
+                  index_.size() * sizeof(IndexEntry));
+    Put<int64_t>(block_, offset);
+    block_.append(end_magic, sizeof(end_magic));
+    if (!EndBlock()) {
+        return false;
+    }
+    index_.clear();
+    prev_index_ = offset;
+    indexed_ = true;
+    return true;
+}
+
+} // namespace mlspace
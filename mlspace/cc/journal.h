@@ -0,0 +1,153 @@
+// Copyright 2025 Daniel Bershatsky
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace mlspace {
+
+// Journal is an append-only file of job output which is compressed in
+// independent frames and indexed by time and rank, so that a reader decodes
+// only frames of a time window or a rank (see `mlspace/journal.py`). All
+// integers are little-endian and blocks are aligned to 8 bytes.
+//
+//     block    u32:tag u32:size payload[size] <pad>
+//
+// Header block (tag "HEAD") starts every writing session, so that output of
+// restarted job is appended to the same file.
+//
+//     payload  u16:version u16:0 i32:rank
+//
+// Frame block (tag "FRAM") holds output received in a time range. It ends at
+// line boundary unless a line is longer than a frame or the frame is flushed.
+// Frame is compressed with `LzCompress` (codec 1) and then it is encoded with
+// `HuffmanEncode` (codec 2) if that makes it smaller (see `codec.h`).
+//
+//     payload  i64:first_time i64:last_time u32:raw_size u32:codec data[]
+//
+// Index block (tag "INDX") lists frames written after the previous index
+// block and refers to it. It is written after every `frames_per_index`
+// frames and on close. Frames of a session which is not closed (e.g. killed
+// job) are indexed by the next session, so that a reader follows the chain
+// from the end of file or scans blocks if the file does not end with index.
+//
+//     payload  i64:prev_offset u32:num_entries u32:0
+//              {i64:offset i64:first_time i64:last_time i32:rank
+//               u32:raw_size}* i64:offset "MLJN_END"
+class JournalWriter {
+public:
+    struct Options {
+        int32_t rank = 0;
+        size_t frame_size = 256 << 10; // Before compression.
+        size_t frames_per_index = 64;
+    };
+
+    // Sink writes encoded blocks to the end of file.
+    using Sink = std::function<bool(std::string_view)>;
+
+    // Open prepares `fd` opened for reading and appending. Blocks of
+    // existing journal are validated, a torn block at the end is truncated,
+    // and frames which are not indexed are kept for the next index block. It
+    // fails with `EINVAL` if `fd` is not a journal. Blocks are written with
+    // `sink` and `fd` is not closed.
+    static std::optional<JournalWriter> Open(int fd, Sink sink, Options opts);
+
+    // Create opens (or creates) journal at `path` and writes blocks to it
+    // synchronously.
+    static std::optional<JournalWriter>
+    Create(std::filesystem::path const &path, Options opts);
+
+    JournalWriter(JournalWriter &&other);
+
+    JournalWriter &operator=(JournalWriter &&other);
+
+    // ~JournalWriter closes journal if it is not closed.
+    ~JournalWriter(void);
+
+    // Append adds output received at `time`. Frames are written once there
+    // are `frame_size` bytes.
+    bool Append(int64_t time, std::string_view data);
+
+    // Flush writes output accumulated so far as a frame.
+    bool Flush(void);
+
+    // Close flushes output and writes the final index block.
+    bool Close(void);
+
+    size_t num_frames(void) const {
+        return num_frames_;
+    }
+
+    // Number of bytes of output.
+    size_t raw_bytes(void) const {
+        return raw_bytes_;
+    }
+
+    // Number of bytes written to file.
+    size_t stored_bytes(void) const {
+        return stored_bytes_;
+    }
+
+private:
+    struct IndexEntry {
+        int64_t offset;
+        int64_t first_time;
+        int64_t last_time;
+        int32_t rank;
+        uint32_t raw_size;
+    };
+
+    JournalWriter(void) = default;
+
+    // WriteFrame compresses the first `size` bytes of output to a frame.
+    bool WriteFrame(size_t size, int64_t next_time);
+
+    // Block is built in scratch buffer and written with sink on end.
+    void BeginBlock(char const *tag);
+
+    bool EndBlock(void);
+
+    bool WriteIndex(void);
+
+    Sink sink_;
+    int fd_ = -1; // Owned descriptor or -1.
+    bool closed_ = true;
+    Options opts_;
+    int64_t offset_ = 0; // Offset of the next block.
+    size_t num_frames_ = 0;
+    size_t raw_bytes_ = 0;
+    size_t stored_bytes_ = 0;
+
+    // Output of the current frame.
+    std::string raw_;
+    int64_t first_time_ = 0;
+    int64_t last_time_ = 0;
+
+    std::vector<IndexEntry> index_;
+    int64_t prev_index_ = -1;
+    bool indexed_ = false; // Whether file ends with an index block.
+
+    std::string block_; // Scratch buffer for blocks.
+    std::string lz_;    // Scratch buffer for frame before entropy coding.
+};
+
+} // namespace mlspace
@@ -0,0 +1,207 @@
+// Copyright 2025 Daniel Bershatsky
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <mlspace/cc/journal.h>
+#include <mlspace/cc/codec.h>
+
+using mlspace::JournalWriter;
+
+namespace {
+
+template <typename T> T Get(std::string const &buf, size_t offset) {
+    T value;
+    std::memcpy(&value, buf.data() + offset, sizeof(value));
+    return value;
+}
+
+std::string ReadAll(std::filesystem::path const &path) {
+    std::ifstream file(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(file), {}};
+}
+
+struct Frame {
+    int64_t offset;
+    int64_t first_time;
+    int64_t last_time;
+    int32_t rank;
+    std::string data;
+};
+
+// Tags returns first letters of block tags.
+std::string Tags(std::string const &buf) {
+    std::string tags;
+    for (size_t offset = 0; offset + 8 <= buf.size();) {
+        tags += buf[offset];
+        offset += (8 + Get<uint32_t>(buf, offset + 4) + 7) / 8 * 8;
+    }
+    return tags;
+}
+
+// ReadIndex follows chain of index blocks from the end of file and decodes
+// indexed frames.
+std::vector<Frame> ReadIndex(std::string const &buf) {
+    std::vector<Frame> frames;
+    if (buf.size() < 16 || buf.substr(buf.size() - 8) != "MLJN_END") {
+        return frames;
+    }
+    auto offset = Get<int64_t>(buf, buf.size() - 16);
+    while (offset != -1) {
+        EXPECT_EQ(buf.substr(offset, 4), "INDX");
+        auto num_entries = Get<uint32_t>(buf, offset + 16);
+        std::vector<Frame> chunk;
+        for (size_t ix = 0; ix != num_entries; ++ix) {
+            auto entry = offset + 24 + 32 * ix;
+            Frame frame{Get<int64_t>(buf, entry),
+                        Get<int64_t>(buf, entry + 8),
+                        Get<int64_t>(buf, entry + 16),
+                        Get<int32_t>(buf, entry + 24)};
+            auto raw_size = Get<uint32_t>(buf, entry + 28);
+            EXPECT_EQ(buf.substr(frame.offset, 4), "FRAM");
+            EXPECT_EQ(Get<uint32_t>(buf, frame.offset + 24), raw_size);
+            auto codec = Get<uint32_t>(buf, frame.offset + 28);
+            std::string data = buf.substr(
+                frame.offset + 32, Get<uint32_t>(buf, frame.offset + 4) - 24);
+            if (codec == 2) {
+                std::string lz(mlspace::LzBound(raw_size), '\0');
+                auto size = mlspace::HuffmanDecode(data, lz.data(), lz.size());
+                EXPECT_TRUE(size);
+                lz.resize(size.value_or(0));
+                data = std::move(lz);
+            } else {
+                EXPECT_EQ(codec, 1);
+            }
+            frame.data.resize(raw_size);
+            auto res = mlspace::LzDecompress(data, frame.data.data(),
+                                             raw_size);
+            EXPECT_EQ(res, raw_size);
+            chunk.push_back(std::move(frame));
+        }
+        frames.insert(frames.begin(), chunk.begin(), chunk.end());
+        offset = Get<int64_t>(buf, offset + 8);
+    }
+    return frames;
+}
+
+class JournalTest : public ::testing::Test {
+protected:
+    void SetUp(void) override {
+        path_ = std::filesystem::temp_directory_path() /
+                ("mlspace-journal-" + std::to_string(getpid()) + ".mljn");
+        std::filesystem::remove(path_);
+    }
+
+    void TearDown(void) override {
+        std::filesystem::remove(path_);
+    }
+
+    std::filesystem::path path_;
+};
+
+} // namespace
+
+TEST_F(JournalTest, Layout) {
+    JournalWriter::Options opts;
+    opts.rank = 3;
+    opts.frame_size = 32;
+    opts.frames_per_index = 2;
+    auto writer = JournalWriter::Create(path_, opts);
+    ASSERT_TRUE(writer);
+    ASSERT_TRUE(writer->Append(100, "line 1\nline 2\n"));
+    ASSERT_TRUE(writer->Append(200, "line 3\nline 4\nline 5\n"));
+    ASSERT_TRUE(writer->Append(300, "long line without newline at all\n"));
+    ASSERT_TRUE(writer->Append(400, "partial"));
+    ASSERT_TRUE(writer->Close());
+    EXPECT_FALSE(writer->Append(500, "closed"));
+    EXPECT_EQ(writer->num_frames(), 4);
+    EXPECT_EQ(writer->raw_bytes(), 75);
+
+    auto buf = ReadAll(path_);
+    EXPECT_EQ(buf.size(), writer->stored_bytes());
+    EXPECT_EQ(Tags(buf), "HFFIFFI");
+    auto frames = ReadIndex(buf);
+    ASSERT_EQ(frames.size(), 4);
+    EXPECT_EQ(frames[0].data, "line 1\nline 2\nline 3\nline 4\n");
+    EXPECT_EQ(frames[0].first_time, 100);
+    EXPECT_EQ(frames[0].last_time, 200);
+    EXPECT_EQ(frames[1].data, "line 5\n");
+    EXPECT_EQ(frames[1].first_time, 200);
+    EXPECT_EQ(frames[1].last_time, 300);
+    EXPECT_EQ(frames[2].data, "long line without newline at all");
+    EXPECT_EQ(frames[3].data, "\npartial");
+    EXPECT_EQ(frames[3].first_time, 300);
+    EXPECT_EQ(frames[3].last_time, 400);
+    for (auto const &frame : frames) {
+        EXPECT_EQ(frame.rank, 3);
+        EXPECT_EQ(frame.offset % 8, 0);
+    }
+}
+
+TEST_F(JournalTest, Recover) {
+    JournalWriter::Options opts;
+    opts.rank = 1;
+    auto writer = JournalWriter::Create(path_, opts);
+    ASSERT_TRUE(writer);
+    ASSERT_TRUE(writer->Append(100, "first session\n"));
+    ASSERT_TRUE(writer->Flush());
+
+    // Session is killed: there is no index and the last block is torn.
+    auto crashed = ReadAll(path_);
+    writer.reset();
+    crashed += std::string{"FRAM\xff\x00\x00\x00", 8};
+    std::ofstream(path_, std::ios::binary | std::ios::trunc) << crashed;
+
+    opts.rank = 2;
+    writer = JournalWriter::Create(path_, opts);
+    ASSERT_TRUE(writer);
+    ASSERT_TRUE(writer->Append(200, "second session\n"));
+    ASSERT_TRUE(writer->Close());
+    writer.reset();
+
+    opts.rank = 3;
+    writer = JournalWriter::Create(path_, opts);
+    ASSERT_TRUE(writer);
+    ASSERT_TRUE(writer->Append(300, "third session\n"));
+    ASSERT_TRUE(writer->Close());
+
+    auto buf = ReadAll(path_);
+    EXPECT_EQ(Tags(buf), "HFHFIHFI");
+    auto frames = ReadIndex(buf);
+    ASSERT_EQ(frames.size(), 3);
+    EXPECT_EQ(frames[0].data, "first session\n");
+    EXPECT_EQ(frames[0].rank, 1);
+    EXPECT_EQ(frames[1].data, "second session\n");
+    EXPECT_EQ(frames[1].rank, 2);
+    EXPECT_EQ(frames[2].data, "third session\n");
+    EXPECT_EQ(frames[2].first_time, 300);
+}
+
+TEST_F(JournalTest, NotJournal) {
+    std::ofstream(path_) << "plain text log\n";
+    errno = 0;
+    EXPECT_FALSE(JournalWriter::Create(path_, {}));
+    EXPECT_EQ(errno, EINVAL);
+    EXPECT_EQ(ReadAll(path_), "plain text log\n");
+}
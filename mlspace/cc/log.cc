@@ -0,0 +1,89 @@
+// Copyright 2025 Daniel Bershatsky
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "log.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdarg>
+#include <cstdio>
+#include <ctime>
+
+namespace mlspace {
+
+namespace {
+
+std::atomic<LogLevel> log_level = LogLevel::Info;
+
+} // namespace
+
+std::optional<LogLevel> ParseLogLevel(std::string_view str) {
+    if (str == "debug") {
+        return LogLevel::Debug;
+    } else if (str == "info") {
+        return LogLevel::Info;
+    } else if (str == "warn") {
+        return LogLevel::Warn;
+    } else if (str == "error") {
+        return LogLevel::Error;
+    } else {
+        return std::nullopt;
+    }
+}
+
+std::string_view ToString(LogLevel level) {
+    switch (level) {
+    case LogLevel::Debug:
+        return "debug";
+    case LogLevel::Info:
+        return "info";
+    case LogLevel::Warn:
+        return "warn";
+    case LogLevel::Error:
+        return "error";
+    }
+    return "unknown";
+}
+
+LogLevel GetLogLevel(void) {
+    return log_level.load(std::memory_order_relaxed);
+}
+
+void SetLogLevel(LogLevel level) {
+    log_level.store(level, std::memory_order_relaxed);
+}
+
+void Log(LogLevel level, char const *fmt, ...) {
+    // Format prefix and message into a single buffer in order to issue exactly
+    // one write and do not interleave with records of other processes.
+    char buf[4096];
+    time_t now = time(nullptr);
+    struct tm tm;
+    localtime_r(&now, &tm);
+    int len = strftime(buf, sizeof(buf), "? %m-%d %H:%M:%S launch ", &tm);
+    buf[0] = "DIWE"[static_cast<int>(level)];
+
+    va_list args;
+    va_start(args, fmt);
+    int ret = vsnprintf(buf + len, sizeof(buf) - len - 1, fmt, args);
+    va_end(args);
+    if (ret < 0) {
+        return;
+    }
+    len = std::min<int>(len + ret, sizeof(buf) - 2);
+    buf[len++] = '\n';
+    fwrite(buf, 1, len, stderr);
+}
+
+} // namespace mlspace
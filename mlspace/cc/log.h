@@ -0,0 +1,55 @@
+// Copyright 2025 Daniel Bershatsky
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <optional>
+#include <string_view>
+
+namespace mlspace {
+
+// LogLevel mirrors logging levels of Python CLI (see `mlspace/cli.py`).
+enum class LogLevel : int {
+    Debug = 0,
+    Info = 1,
+    Warn = 2,
+    Error = 3,
+};
+
+std::optional<LogLevel> ParseLogLevel(std::string_view str);
+
+std::string_view ToString(LogLevel level);
+
+LogLevel GetLogLevel(void);
+
+void SetLogLevel(LogLevel level);
+
+// Log writes a single record to stderr in the same format as Python CLI does,
+// i.e. `<level> <month>-<day> <time> <module> <message>`.
+void Log(LogLevel level, char const *fmt, ...)
+    __attribute__((format(printf, 2, 3)));
+
+} // namespace mlspace
+
+#define MLSPACE_LOG(level, ...)                                                \
+    do {                                                                       \
+        if (::mlspace::LogLevel::level >= ::mlspace::GetLogLevel()) {          \
+            ::mlspace::Log(::mlspace::LogLevel::level, __VA_ARGS__);           \
+        }                                                                      \
+    } while (0)
+
+#define LOG_DEBUG(...) MLSPACE_LOG(Debug, __VA_ARGS__)
+#define LOG_INFO(...) MLSPACE_LOG(Info, __VA_ARGS__)
+#define LOG_WARN(...) MLSPACE_LOG(Warn, __VA_ARGS__)
+#define LOG_ERROR(...) MLSPACE_LOG(Error, __VA_ARGS__)
@@ -0,0 +1,377 @@
+// Copyright 2025 Daniel Bershatsky
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "prewarm.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <unordered_set>
+
+#include <fcntl.h>
+#include <glob.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <mlspace/cc/log.h>
+#include <mlspace/cc/proc.h>
+
+namespace mlspace {
+
+namespace {
+
+// Kernel follows at most 4 levels of interpreters (`BINPRM_MAX_RECURSION`).
+constexpr int max_interp_depth = 4;
+
+// Depth of nested includes of `ld.so.conf` as a guard against cycles.
+constexpr int max_include_depth = 8;
+
+constexpr char const *default_lib_dirs[] = {"/lib64", "/usr/lib64", "/lib",
+                                            "/usr/lib"};
+
+template <typename F> void SplitPath(std::string_view str, F &&fn) {
+    while (!str.empty()) {
+        auto end = str.find(':');
+        if (auto dir = str.substr(0, end); !dir.empty()) {
+            fn(dir);
+        }
+        str.remove_prefix(end == str.npos ? str.size() : end + 1);
+    }
+}
+
+bool IsExecutable(std::string const &path) {
+    struct stat st;
+    return stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode) &&
+           access(path.c_str(), X_OK) == 0;
+}
+
+bool IsRegular(std::string const &path) {
+    struct stat st;
+    return stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode);
+}
+
+void ReadLdSoConf(char const *path, std::vector<std::string> &dirs,
+                  int depth = 0) {
+    auto content = ReadFile(path);
+    if (!content || depth > max_include_depth) {
+        return;
+    }
+    std::string_view rest{*content};
+    while (!rest.empty()) {
+        auto end = rest.find('\n');
+        auto line = rest.substr(0, end);
+        rest.remove_prefix(end == rest.npos ? rest.size() : end + 1);
+        line = line.substr(0, line.find('#'));
+        auto begin = line.find_first_not_of(" \t");
+        if (begin == line.npos) {
+            continue;
+        }
+        line = line.substr(begin, line.find_last_not_of(" \t") - begin + 1);
+
+        if (line.starts_with("include") && line.size() > 7 &&
+            (line[7] == ' ' || line[7] == '\t')) {
+            std::string pattern{line.substr(line.find_first_not_of(" \t", 7))};
+            if (!pattern.starts_with('/')) {
+                pattern.insert(0, "/etc/");
+            }
+            glob_t paths;
+            if (glob(pattern.c_str(), 0, nullptr, &paths) == 0) {
+                for (size_t ix = 0; ix != paths.gl_pathc; ++ix) {
+                    ReadLdSoConf(paths.gl_pathv[ix], dirs, depth + 1);
+                }
+            }
+            globfree(&paths);
+        } else if (line.starts_with('/')) {
+            dirs.emplace_back(line);
+        }
+    }
+}
+
+// ExpandOrigin substitutes `$ORIGIN` (directory of object) in a search path.
+std::string ExpandOrigin(std::string_view dir, std::string const &origin) {
+    std::string result;
+    auto parent = origin.substr(0, origin.find_last_of('/'));
+    while (!dir.empty()) {
+        auto pos = dir.find('$');
+        result.append(dir.substr(0, pos));
+        if (pos == dir.npos) {
+            break;
+        }
+        dir.remove_prefix(pos);
+        if (dir.starts_with("$ORIGIN")) {
+            result.append(parent);
+            dir.remove_prefix(7);
+        } else if (dir.starts_with("${ORIGIN}")) {
+            result.append(parent);
+            dir.remove_prefix(9);
+        } else {
+            result.push_back('$');
+            dir.remove_prefix(1);
+        }
+    }
+    return result;
+}
+
+} // namespace
+
+std::optional<std::string>
+FindExecutable(std::string_view name, std::string_view path,
+               std::optional<std::filesystem::path> const &work_dir) {
+    if (name.empty()) {
+        return std::nullopt;
+    }
+    if (name.find('/') != name.npos) {
+        std::string exe{name};
+        if (!name.starts_with('/') && work_dir) {
+            exe = (*work_dir / name).lexically_normal().string();
+        }
+        return IsExecutable(exe) ? std::make_optional(exe) : std::nullopt;
+    }
+    std::optional<std::string> found;
+    SplitPath(path, [&](std::string_view dir) {
+        if (found) {
+            return;
+        }
+        std::string exe{dir};
+        exe.push_back('/');
+        exe.append(name);
+        if (IsExecutable(exe)) {
+            found = std::move(exe);
+        }
+    });
+    return found;
+}
+
+std::optional<Shebang> ReadShebang(std::string const &path) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        return std::nullopt;
+    }
+    char buf[256];
+    auto size = read(fd, buf, sizeof(buf));
+    close(fd);
+    if (size < 3 || buf[0] != '#' || buf[1] != '!') {
+        return std::nullopt;
+    }
+
+    // Interpreter and the rest of line as a single argument like kernel does.
+    std::string_view line{buf + 2, static_cast<size_t>(size - 2)};
+    line = line.substr(0, line.find('\n'));
+    auto begin = line.find_first_not_of(" \t");
+    if (begin == line.npos) {
+        return std::nullopt;
+    }
+    line.remove_prefix(begin);
+    auto end = line.find_first_of(" \t");
+    Shebang shebang{std::string{line.substr(0, end)}, {}};
+    if (end != line.npos) {
+        auto arg = line.substr(end);
+        if (auto pos = arg.find_first_not_of(" \t"); pos != arg.npos) {
+            arg = arg.substr(pos, arg.find_last_not_of(" \t\r") - pos + 1);
+            shebang.arg = arg;
+        }
+    }
+    return shebang;
+}
+
+LibraryResolver::LibraryResolver(std::string_view library_path) {
+    SplitPath(library_path,
+              [this](auto dir) { library_path_.emplace_back(dir); });
+    ReadLdSoConf("/etc/ld.so.conf", system_dirs_);
+    for (auto dir : default_lib_dirs) {
+        system_dirs_.emplace_back(dir);
+    }
+}
+
+std::optional<std::string>
+LibraryResolver::Resolve(std::string_view name, std::string const &origin,
+                         ElfDeps const &deps) const {
+    // Library of another architecture (e.g. 32-bit one in `/lib`) is
+    // skipped by loader.
+    auto match = [&deps](std::string const &path) {
+        auto lib = ReadElfDeps(path);
+        return lib && lib->machine == deps.machine;
+    };
+    if (name.find('/') != name.npos) {
+        std::string path{name};
+        return match(path) ? std::make_optional(path) : std::nullopt;
+    }
+
+    auto find = [&](std::vector<std::string> const &dirs,
+                    bool expand) -> std::optional<std::string> {
+        for (auto const &dir : dirs) {
+            auto path = expand ? ExpandOrigin(dir, origin) : dir;
+            path.push_back('/');
+            path.append(name);
+            if (IsRegular(path) && match(path)) {
+                return path;
+            }
+        }
+        return std::nullopt;
+    };
+    for (auto [dirs, expand] : {std::pair{&deps.rpath, true},
+                                std::pair{&library_path_, false},
+                                std::pair{&deps.runpath, true},
+                                std::pair{&system_dirs_, false}}) {
+        if (auto path = find(*dirs, expand)) {
+            return path;
+        }
+    }
+    return std::nullopt;
+}
+
+std::vector<std::string>
+Prewarmer::ListFiles(Options const &opts,
+                     std::function<void(std::string const &)> const &visit) {
+    std::vector<std::string> files;
+    std::unordered_set<std::string> seen;
+    auto add = [&](std::string path) {
+        if (seen.insert(path).second) {
+            if (visit) {
+                visit(path);
+            }
+            files.push_back(std::move(path));
+        }
+    };
+
+    // Follow interpreters of scripts (e.g. `#!/usr/bin/env python3`) down to
+    // an ELF file.
+    auto exe = FindExecutable(opts.executable, opts.path, opts.work_dir);
+    for (int depth = 0; exe && depth != max_interp_depth; ++depth) {
+        auto shebang = ReadShebang(*exe);
+        add(*exe);
+        if (!shebang) {
+            break;
+        }
+        exe = FindExecutable(shebang->interp, opts.path);
+        if (exe && shebang->interp.ends_with("/env") && !shebang->arg.empty() &&
+            !shebang->arg.starts_with('-')) {
+            add(*exe);
+            exe = FindExecutable(shebang->arg, opts.path);
+        }
+    }
+    if (files.empty()) {
+        return files;
+    }
+
+    // Walk closure of needed libraries in breadth-first order like loader.
+    LibraryResolver resolver(opts.library_path);
+    for (size_t ix = files.size() - 1; ix < files.size(); ++ix) {
+        auto deps = ReadElfDeps(files[ix]);
+        if (!deps) {
+            continue;
+        }
+        if (!deps->interp.empty() && IsRegular(deps->interp)) {
+            add(deps->interp);
+        }
+        auto origin = files[ix];
+        for (auto const &name : deps->needed) {
+            if (auto path = resolver.Resolve(name, origin, *deps)) {
+                add(std::move(*path));
+            } else {
+                LOG_DEBUG("prewarm: library %s needed by %s is not found",
+                          name.data(), origin.data());
+            }
+        }
+    }
+    return files;
+}
+
+Prewarmer::Prewarmer(Options opts)
+    : opts_{std::move(opts)}, started_at_{std::chrono::steady_clock::now()} {
+    // Threads block all signals: supervisor blocks signals which it reads
+    // from signalfd in the calling thread only, so that otherwise SIGTERM
+    // would kill launch and SIGCHLD would be lost in a reading thread.
+    sigset_t mask;
+    sigset_t orig_mask;
+    sigfillset(&mask);
+    pthread_sigmask(SIG_BLOCK, &mask, &orig_mask);
+    auto num_threads = std::max<size_t>(opts_.num_threads, 1);
+    num_running_ = num_threads;
+    threads_.reserve(num_threads + 1);
+    threads_.emplace_back([this]() { Resolve(); });
+    for (size_t ix = 0; ix != num_threads; ++ix) {
+        threads_.emplace_back([this]() { ReadAhead(); });
+    }
+    pthread_sigmask(SIG_SETMASK, &orig_mask, nullptr);
+}
+
+Prewarmer::~Prewarmer(void) {
+    Wait();
+}
+
+void Prewarmer::Wait(void) {
+    for (auto &thread : threads_) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+}
+
+void Prewarmer::Resolve(void) {
+    ListFiles(opts_, [this](std::string const &path) {
+        {
+            std::lock_guard lock(mutex_);
+            queue_.push_back(path);
+        }
+        cv_.notify_one();
+    });
+    {
+        std::lock_guard lock(mutex_);
+        resolved_ = true;
+    }
+    cv_.notify_all();
+}
+
+void Prewarmer::ReadAhead(void) {
+    while (true) {
+        std::string path;
+        {
+            std::unique_lock lock(mutex_);
+            cv_.wait(lock, [this]() { return resolved_ || !queue_.empty(); });
+            if (queue_.empty()) {
+                break;
+            }
+            path = std::move(queue_.front());
+            queue_.pop_front();
+        }
+
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        struct stat st;
+        if (fd == -1 || fstat(fd, &st) == -1) {
+            LOG_DEBUG("prewarm: failed to open %s: %s", path.data(),
+                      std::strerror(errno));
+        } else if (readahead(fd, 0, st.st_size) == 0 ||
+                   posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED) == 0) {
+            num_files_ += 1;
+            num_bytes_ += st.st_size;
+        }
+        if (fd != -1) {
+            close(fd);
+        }
+    }
+
+    // The last thread reports.
+    std::lock_guard lock(mutex_);
+    if (--num_running_ == 0) {
+        std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - started_at_;
+        LOG_DEBUG("prewarmed %zu files of %zu bytes in %.3fs",
+                  num_files_.load(), num_bytes_.load(), elapsed.count());
+    }
+}
+
+} // namespace mlspace
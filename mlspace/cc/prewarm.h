@@ -0,0 +1,129 @@
+// Copyright 2025 Daniel Bershatsky
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <mlspace/cc/symbols.h>
+
+namespace mlspace {
+
+// FindExecutable resolves command `name` like `execvp(3)` does: names with a
+// slash are relative to `work_dir` and others are searched in directories of
+// `path` (i.e. `PATH` variable).
+std::optional<std::string>
+FindExecutable(std::string_view name, std::string_view path,
+               std::optional<std::filesystem::path> const &work_dir = {});
+
+// Shebang is an interpreter line `#!<interp> [<arg>]` of a script.
+struct Shebang {
+    std::string interp;
+    std::string arg;
+};
+
+std::optional<Shebang> ReadShebang(std::string const &path);
+
+// LibraryResolver locates shared libraries in the same order as dynamic
+// loader (see `man 8 ld.so`): `DT_RPATH`, `LD_LIBRARY_PATH`, `DT_RUNPATH`,
+// directories of `/etc/ld.so.conf`, and default directories. Loader cache is
+// not read, so that the result may differ if the cache is stale.
+class LibraryResolver {
+public:
+    explicit LibraryResolver(std::string_view library_path);
+
+    // Resolve returns path to library `name` needed by ELF file at `origin`.
+    std::optional<std::string> Resolve(std::string_view name,
+                                       std::string const &origin,
+                                       ElfDeps const &deps) const;
+
+private:
+    std::vector<std::string> library_path_;
+    std::vector<std::string> system_dirs_;
+};
+
+// Prewarmer reads ahead files which are touched by `execve(2)` of a job, so
+// that the loader finds them in page cache. These are interpreters of
+// scripts, the executable, its program interpreter, and closure of needed
+// shared libraries. Files are resolved by one thread and read ahead by a few
+// others concurrently with the rest of launch. Threads block all signals, so
+// that signals are left to supervisor.
+class Prewarmer {
+public:
+    struct Options {
+        std::string executable;
+        std::optional<std::filesystem::path> work_dir;
+
+        // Executable is searched in `PATH` of launcher (like `execvpe(3)`)
+        // while libraries are searched in `LD_LIBRARY_PATH` of job.
+        std::string path;
+        std::string library_path;
+
+        size_t num_threads = 4;
+    };
+
+    // ListFiles resolves files to read ahead and calls `visit` as soon as a
+    // file is found. Paths are unique.
+    static std::vector<std::string>
+    ListFiles(Options const &opts,
+              std::function<void(std::string const &)> const &visit = {});
+
+    // Prewarmer starts reading ahead immediately.
+    explicit Prewarmer(Options opts);
+
+    ~Prewarmer(void);
+
+    // Wait blocks until all files are read ahead.
+    void Wait(void);
+
+    size_t num_files(void) const {
+        return num_files_;
+    }
+
+    size_t num_bytes(void) const {
+        return num_bytes_;
+    }
+
+private:
+    void Resolve(void);
+
+    void ReadAhead(void);
+
+    Options opts_;
+    std::chrono::steady_clock::time_point started_at_;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::string> queue_;
+    bool resolved_ = false;
+    size_t num_running_ = 0; // Number of threads which read ahead.
+
+    std::atomic<size_t> num_files_ = 0;
+    std::atomic<size_t> num_bytes_ = 0;
+    std::vector<std::thread> threads_;
+};
+
+} // namespace mlspace
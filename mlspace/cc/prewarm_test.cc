@@ -0,0 +1,157 @@
+// Copyright 2025 Daniel Bershatsky
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <csignal>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <mlspace/cc/prewarm.h>
+
+using mlspace::FindExecutable;
+using mlspace::Prewarmer;
+using mlspace::ReadElfDeps;
+using mlspace::ReadShebang;
+
+namespace {
+
+class ScriptTest : public testing::Test {
+protected:
+    void SetUp(void) override {
+        dir_ = std::filesystem::temp_directory_path() /
+               ("mlspace-prewarm-" + std::to_string(getpid()));
+        std::filesystem::create_directories(dir_);
+    }
+
+    void TearDown(void) override {
+        std::filesystem::remove_all(dir_);
+    }
+
+    std::string Write(std::string const &name, std::string const &content) {
+        auto path = dir_ / name;
+        std::ofstream(path) << content;
+        std::filesystem::permissions(path, std::filesystem::perms::owner_all);
+        return path.string();
+    }
+
+    std::filesystem::path dir_;
+};
+
+bool Contains(std::vector<std::string> const &files, std::string_view name) {
+    return std::any_of(files.begin(), files.end(), [name](auto const &path) {
+        return std::filesystem::path(path).filename().string().starts_with(
+            name);
+    });
+}
+
+} // namespace
+
+TEST_F(ScriptTest, FindExecutable) {
+    auto exe = Write("tool", "#!/bin/sh\n");
+    auto path = "/nonexistent:" + dir_.string();
+    EXPECT_EQ(FindExecutable("tool", path), exe);
+    EXPECT_EQ(FindExecutable("./tool", "", dir_), exe);
+    EXPECT_EQ(FindExecutable(exe, ""), exe);
+    EXPECT_FALSE(FindExecutable("tool", "/nonexistent"));
+    EXPECT_FALSE(FindExecutable("", path));
+}
+
+TEST_F(ScriptTest, ReadShebang) {
+    auto shebang = ReadShebang(Write("a", "#! /usr/bin/env  python3 -u \n"));
+    ASSERT_TRUE(shebang);
+    EXPECT_EQ(shebang->interp, "/usr/bin/env");
+    EXPECT_EQ(shebang->arg, "python3 -u");
+
+    shebang = ReadShebang(Write("b", "#!/bin/sh\necho\n"));
+    ASSERT_TRUE(shebang);
+    EXPECT_EQ(shebang->interp, "/bin/sh");
+    EXPECT_EQ(shebang->arg, "");
+
+    EXPECT_FALSE(ReadShebang(Write("c", "echo\n")));
+}
+
+TEST(ElfDeps, Self) {
+    auto deps = ReadElfDeps("/proc/self/exe");
+    ASSERT_TRUE(deps);
+    EXPECT_NE(deps->interp, "");
+    EXPECT_TRUE(Contains(deps->needed, "libc.so"));
+    EXPECT_FALSE(ReadElfDeps("/proc/self/status"));
+}
+
+TEST_F(ScriptTest, ListFiles) {
+    auto script = Write("job", "#!/usr/bin/env sh\n");
+    Prewarmer::Options opts;
+    opts.executable = "job";
+    opts.path = dir_.string() + ":/usr/bin:/bin";
+    std::vector<std::string> visited;
+    auto files = Prewarmer::ListFiles(
+        opts, [&](auto const &path) { visited.push_back(path); });
+    EXPECT_EQ(files, visited);
+    ASSERT_GE(files.size(), 5);
+    EXPECT_EQ(files[0], script);
+    EXPECT_TRUE(files[1].ends_with("/env"));
+    EXPECT_TRUE(files[2].ends_with("/sh"));
+    EXPECT_TRUE(Contains(files, "ld-linux"));
+    EXPECT_TRUE(Contains(files, "libc.so"));
+}
+
+TEST(Prewarmer, ReadAhead) {
+    Prewarmer::Options opts;
+    opts.executable = "sh";
+    opts.path = "/usr/bin:/bin";
+    auto files = Prewarmer::ListFiles(opts);
+    Prewarmer prewarmer(opts);
+    prewarmer.Wait();
+    EXPECT_EQ(prewarmer.num_files(), files.size());
+    EXPECT_GT(prewarmer.num_bytes(), 0);
+}
+
+TEST(Prewarmer, Signals) {
+    // Prewarmer is started before supervisor blocks SIGTERM in the main
+    // thread. SIGTERM must stay pending rather than be delivered to a
+    // prewarming thread with default action.
+    auto pid = fork();
+    ASSERT_NE(pid, -1);
+    if (pid == 0) {
+        Prewarmer::Options opts;
+        opts.executable = "sh";
+        opts.path = "/usr/bin:/bin";
+        opts.num_threads = 8;
+        // Resolution is slowed down with a long library path in order to
+        // keep threads running.
+        for (int ix = 0; ix != 50'000; ++ix) {
+            opts.library_path += "/nonexistent/" + std::to_string(ix) + ':';
+        }
+        Prewarmer prewarmer(opts);
+        sigset_t mask;
+        sigemptyset(&mask);
+        sigaddset(&mask, SIGTERM);
+        sigprocmask(SIG_BLOCK, &mask, nullptr);
+        kill(getpid(), SIGTERM);
+        prewarmer.Wait();
+        sigset_t pending;
+        sigpending(&pending);
+        _exit(sigismember(&pending, SIGTERM) ? 0 : 1);
+    }
+    int status;
+    ASSERT_EQ(waitpid(pid, &status, 0), pid);
+    ASSERT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(WEXITSTATUS(status), 0);
+}
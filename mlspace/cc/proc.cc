@@ -0,0 +1,220 @@
+// Copyright 2025 Daniel Bershatsky
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "proc.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstdio>
+
+#include <fcntl.h>
+#include <sched.h>
+#include <unistd.h>
+
+namespace mlspace {
+
+namespace {
+
+// Fields splits space-separated fields of stat file one by one.
+struct Fields {
+    std::string_view rest;
+
+    std::string_view Next(void) {
+        auto begin = rest.find_first_not_of(' ');
+        if (begin == rest.npos) {
+            rest = {};
+            return {};
+        }
+        auto end = rest.find_first_of(' ', begin);
+        if (end == rest.npos) {
+            end = rest.size();
+        }
+        auto field = rest.substr(begin, end - begin);
+        rest.remove_prefix(end);
+        return field;
+    }
+
+    template <typename T> bool Next(T &value) {
+        auto field = Next();
+        auto [ptr, ec] =
+            std::from_chars(field.data(), field.data() + field.size(), value);
+        return ec == std::errc() && ptr == field.data() + field.size();
+    }
+
+    bool Skip(int num_fields) {
+        for (int ix = 0; ix != num_fields; ++ix) {
+            if (Next().empty()) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+} // namespace
+
+std::optional<ProcStat> ParseProcStat(std::string_view str) {
+    // Command name is enclosed in parenthesis and could contain spaces and
+    // parenthesis itself so we look for the last closing one.
+    auto lparen = str.find_first_of('(');
+    auto rparen = str.find_last_of(')');
+    if (lparen == str.npos || rparen == str.npos || rparen < lparen) {
+        return std::nullopt;
+    }
+
+    ProcStat stat;
+    Fields head{str.substr(0, lparen)};
+    if (!head.Next(stat.pid)) {
+        return std::nullopt;
+    }
+    stat.comm = str.substr(lparen + 1, rparen - lparen - 1);
+
+    // Fields are enumerated from 1 in `man 5 proc`; state is the 3rd one.
+    Fields fields{str.substr(rparen + 1)};
+    if (auto state = fields.Next(); state.size() == 1) {
+        stat.state = state[0];
+    } else {
+        return std::nullopt;
+    }
+    bool ok = fields.Next(stat.ppid)          // (4) ppid
+              && fields.Skip(5)               // (5-9) pgrp..flags
+              && fields.Next(stat.minflt)     // (10) minflt
+              && fields.Skip(1)               // (11) cminflt
+              && fields.Next(stat.majflt)     // (12) majflt
+              && fields.Skip(1)               // (13) cmajflt
+              && fields.Next(stat.utime)      // (14) utime
+              && fields.Next(stat.stime)      // (15) stime
+              && fields.Skip(4)               // (16-19) cutime..nice
+              && fields.Next(stat.num_threads) // (20) num_threads
+              && fields.Skip(1)               // (21) itrealvalue
+              && fields.Next(stat.starttime)  // (22) starttime
+              && fields.Next(stat.vsize)      // (23) vsize
+              && fields.Next(stat.rss)        // (24) rss
+              && fields.Skip(14)              // (25-38) rsslim..exit_signal
+              && fields.Next(stat.processor); // (39) processor
+    if (!ok) {
+        return std::nullopt;
+    }
+    return stat;
+}
+
+std::optional<ProcStat> ReadProcStat(pid_t pid, pid_t tid) {
+    char path[64];
+    if (tid == 0) {
+        snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+    } else {
+        snprintf(path, sizeof(path), "/proc/%d/task/%d/stat", pid, tid);
+    }
+    if (auto content = ReadFile(path)) {
+        return ParseProcStat(*content);
+    }
+    return std::nullopt;
+}
+
+std::optional<std::string> ReadFile(char const *path) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        return std::nullopt;
+    }
+    std::string content;
+    char buf[4096];
+    ssize_t len;
+    while ((len = read(fd, buf, sizeof(buf))) > 0) {
+        content.append(buf, len);
+    }
+    close(fd);
+    if (len == -1) {
+        return std::nullopt;
+    }
+    return content;
+}
+
+bool WriteAll(int fd, std::string_view data) {
+    while (!data.empty()) {
+        auto len = write(fd, data.data(), data.size());
+        if (len == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data.remove_prefix(len);
+    }
+    return true;
+}
+
+double TicksToSeconds(uint64_t ticks) {
+    static long const ticks_per_second = sysconf(_SC_CLK_TCK);
+    return static_cast<double>(ticks) / ticks_per_second;
+}
+
+bool SetAffinity(pid_t pid, std::vector<int> const &cpus) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (auto cpu : cpus) {
+        if (cpu < 0 || cpu >= CPU_SETSIZE) {
+            return false;
+        }
+        CPU_SET(cpu, &set);
+    }
+    return sched_setaffinity(pid, sizeof(set), &set) == 0;
+}
+
+std::optional<std::vector<int>> GetAffinity(pid_t pid) {
+    cpu_set_t set;
+    if (sched_getaffinity(pid, sizeof(set), &set) == -1) {
+        return std::nullopt;
+    }
+    std::vector<int> cpus;
+    for (int cpu = 0; cpu != CPU_SETSIZE; ++cpu) {
+        if (CPU_ISSET(cpu, &set)) {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+std::optional<std::vector<int>> ParseCpuList(std::string_view str) {
+    std::vector<int> cpus;
+    auto ptr = str.data();
+    auto end = ptr + str.size();
+    while (ptr != end && *ptr != '\n') {
+        int first, last;
+        auto res = std::from_chars(ptr, end, first);
+        if (res.ec != std::errc{} || first < 0) {
+            return std::nullopt;
+        }
+        last = first;
+        ptr = res.ptr;
+        if (ptr != end && *ptr == '-') {
+            res = std::from_chars(ptr + 1, end, last);
+            if (res.ec != std::errc{} || last < first) {
+                return std::nullopt;
+            }
+            ptr = res.ptr;
+        }
+        for (int cpu = first; cpu <= last; ++cpu) {
+            cpus.push_back(cpu);
+        }
+        if (ptr != end && *ptr == ',') {
+            ++ptr;
+        }
+    }
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+    return cpus;
+}
+
+} // namespace mlspace
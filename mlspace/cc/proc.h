@@ -0,0 +1,72 @@
+// Copyright 2025 Daniel Bershatsky
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <sys/types.h>
+
+namespace mlspace {
+
+// ProcStat is a subset of fields of `/proc/<pid>/stat` (see `man 5 proc`).
+// Times are in clock ticks and memory is in pages.
+struct ProcStat {
+    pid_t pid = 0;
+    std::string comm;
+    char state = '?';
+    pid_t ppid = 0;
+    uint64_t minflt = 0;
+    uint64_t majflt = 0;
+    uint64_t utime = 0;
+    uint64_t stime = 0;
+    int64_t num_threads = 0;
+    uint64_t starttime = 0;
+    uint64_t vsize = 0;
+    int64_t rss = 0;
+    int processor = -1;
+};
+
+std::optional<ProcStat> ParseProcStat(std::string_view str);
+
+// ReadProcStat reads stat of a process (`/proc/<pid>/stat`) or a thread
+// (`/proc/<pid>/task/<tid>/stat`) if `tid` is non-zero.
+std::optional<ProcStat> ReadProcStat(pid_t pid, pid_t tid = 0);
+
+// ReadFile reads small files from procfs or sysfs which do not report their
+// sizes. It returns `std::nullopt` on failure.
+std::optional<std::string> ReadFile(char const *path);
+
+// WriteAll writes the whole `data` to `fd` retrying on short writes and
+// interruptions. It returns false on failure with errno set.
+bool WriteAll(int fd, std::string_view data);
+
+double TicksToSeconds(uint64_t ticks);
+
+// SetAffinity pins a process (or the calling one if `pid` is zero) to `cpus`.
+// The mask is inherited by threads and children spawned afterwards.
+bool SetAffinity(pid_t pid, std::vector<int> const &cpus);
+
+// GetAffinity returns sorted list of CPUs a process is allowed to run on.
+std::optional<std::vector<int>> GetAffinity(pid_t pid);
+
+// ParseCpuList parses CPU list format of sysfs (e.g. `0-3,8,10-11`) to sorted
+// list of CPUs.
+std::optional<std::vector<int>> ParseCpuList(std::string_view str);
+
+} // namespace mlspace
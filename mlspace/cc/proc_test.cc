@@ -0,0 +1,90 @@
+// Copyright 2025 Daniel Bershatsky
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <mlspace/cc/proc.h>
+
+using mlspace::ParseProcStat;
+using mlspace::ReadProcStat;
+
+TEST(ProcStat, Parse) {
+    auto stat = ParseProcStat(
+        "1234 (python (main)) S 1 1234 1234 0 -1 4194560 5000 0 12 0 150 30 "
+        "0 0 20 0 8 0 777 1048576 256 18446744073709551615 1 1 0 0 0 0 0 "
+        "16781312 16386 0 0 0 17 5 0 0 0 0 0\n");
+    ASSERT_TRUE(stat);
+    EXPECT_EQ(stat->pid, 1234);
+    EXPECT_EQ(stat->comm, "python (main)");
+    EXPECT_EQ(stat->state, 'S');
+    EXPECT_EQ(stat->ppid, 1);
+    EXPECT_EQ(stat->minflt, 5000);
+    EXPECT_EQ(stat->majflt, 12);
+    EXPECT_EQ(stat->utime, 150);
+    EXPECT_EQ(stat->stime, 30);
+    EXPECT_EQ(stat->num_threads, 8);
+    EXPECT_EQ(stat->starttime, 777);
+    EXPECT_EQ(stat->vsize, 1048576);
+    EXPECT_EQ(stat->rss, 256);
+    EXPECT_EQ(stat->processor, 5);
+}
+
+TEST(ProcStat, ParseMalformed) {
+    EXPECT_FALSE(ParseProcStat(""));
+    EXPECT_FALSE(ParseProcStat("1234 (comm"));
+    EXPECT_FALSE(ParseProcStat("1234 (comm) S 1 2 3"));
+}
+
+TEST(ProcStat, ReadSelf) {
+    auto stat = ReadProcStat(getpid());
+    ASSERT_TRUE(stat);
+    EXPECT_EQ(stat->pid, getpid());
+    EXPECT_EQ(stat->state, 'R');
+    EXPECT_GE(stat->num_threads, 1);
+}
+
+TEST(Affinity, SetGet) {
+    auto cpus = mlspace::GetAffinity(0);
+    ASSERT_TRUE(cpus);
+    ASSERT_FALSE(cpus->empty());
+
+    // Pin a child to a single CPU in order not to affect other tests.
+    auto pid = fork();
+    ASSERT_NE(pid, -1);
+    if (pid == 0) {
+        std::vector<int> first = {cpus->front()};
+        bool ok = mlspace::SetAffinity(0, first) &&
+                  mlspace::GetAffinity(0) == first &&
+                  !mlspace::SetAffinity(0, {-1});
+        _exit(ok ? 0 : 1);
+    }
+    int status;
+    ASSERT_EQ(waitpid(pid, &status, 0), pid);
+    EXPECT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(WEXITSTATUS(status), 0);
+}
+
+TEST(Affinity, ParseCpuList) {
+    using mlspace::ParseCpuList;
+    EXPECT_EQ(ParseCpuList("0-3,8,10-11\n"),
+              (std::vector<int>{0, 1, 2, 3, 8, 10, 11}));
+    EXPECT_EQ(ParseCpuList("5"), std::vector<int>{5});
+    EXPECT_EQ(ParseCpuList("\n"), std::vector<int>{});
+    EXPECT_FALSE(ParseCpuList("3-1"));
+    EXPECT_FALSE(ParseCpuList("0-"));
+    EXPECT_FALSE(ParseCpuList("a"));
+}
@@ -0,0 +1,376 @@
+// Copyright 2025 Daniel Bershatsky
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "profiler.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <fcntl.h>
+#include <linux/perf_event.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <mlspace/cc/log.h>
+#include <mlspace/cc/proc.h>
+
+namespace mlspace {
+
+namespace {
+
+constexpr std::chrono::milliseconds drain_period{100};
+
+// Ring buffer size per CPU in pages. It is halved until it fits into locked
+// memory limit (see `perf_event_mlock_kb`).
+constexpr size_t max_ring_pages = 16;
+
+constexpr int module_shift = 48;
+
+constexpr uint64_t offset_mask = (uint64_t{1} << module_shift) - 1;
+
+constexpr uint32_t unknown_module = 0xffff;
+
+int PerfEventOpen(perf_event_attr *attr, pid_t pid, int cpu) {
+    return syscall(SYS_perf_event_open, attr, pid, cpu, -1,
+                   PERF_FLAG_FD_CLOEXEC);
+}
+
+// CopyRing copies `size` bytes at `pos` from ring buffer which wraps around.
+void CopyRing(char const *ring, uint64_t ring_size, uint64_t pos, void *dst,
+              size_t size) {
+    auto begin = pos & (ring_size - 1);
+    auto len = std::min<uint64_t>(size, ring_size - begin);
+    std::memcpy(dst, ring + begin, len);
+    std::memcpy(static_cast<char *>(dst) + len, ring, size - len);
+}
+
+} // namespace
+
+Profiler::Profiler(EventLoop &loop, Profile opts)
+    : loop_{loop}, opts_{std::move(opts)} {
+}
+
+Profiler::~Profiler(void) {
+    Stop();
+}
+
+bool Profiler::Attach(pid_t pid) {
+    pid_ = pid;
+    if (opts_.mode != ProfileMode::Proc && OpenEvents(pid)) {
+        sampler_ = "perf";
+        timer_ = loop_.AddTimer(drain_period, drain_period,
+                                [this]() { Drain(); });
+        LOG_INFO("profile job command with perf events at %d Hz on %zu cpus",
+                 opts_.frequency, rings_.size());
+        return true;
+    } else if (opts_.mode == ProfileMode::Perf) {
+        return false;
+    }
+
+    auto period = std::chrono::milliseconds{
+        std::max(1, 1000 / opts_.frequency)};
+    sampler_ = "proc";
+    timer_ = loop_.AddTimer(period, period, [this]() { SampleProc(); });
+    LOG_INFO("profile job command with procfs sampler every %lldms",
+             static_cast<long long>(period.count()));
+    return true;
+}
+
+bool Profiler::OpenEvents(pid_t pid) {
+    auto cpus = GetAffinity(pid);
+    if (!cpus || cpus->empty()) {
+        LOG_WARN("failed to get cpu affinity of pid %d: %s", pid,
+                 std::strerror(errno));
+        return false;
+    }
+
+    perf_event_attr attr = {};
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_SOFTWARE;
+    attr.config = PERF_COUNT_SW_CPU_CLOCK;
+    attr.freq = 1;
+    attr.sample_freq = opts_.frequency;
+    attr.sample_type =
+        PERF_SAMPLE_IP | PERF_SAMPLE_TID | PERF_SAMPLE_CALLCHAIN;
+    attr.disabled = 1;
+    attr.enable_on_exec = 1;
+    attr.inherit = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.exclude_callchain_kernel = 1;
+
+    static long const page_size = sysconf(_SC_PAGESIZE);
+    for (int cpu : *cpus) {
+        Ring ring;
+        if (ring.fd = PerfEventOpen(&attr, pid, cpu); ring.fd == -1) {
+            LOG_WARN("failed to open perf event on cpu %d: %s", cpu,
+                     std::strerror(errno));
+            break;
+        }
+        for (auto pages = max_ring_pages; pages != 0; pages /= 2) {
+            ring.mmap_size = (pages + 1) * page_size;
+            ring.base = mmap(nullptr, ring.mmap_size, PROT_READ | PROT_WRITE,
+                             MAP_SHARED, ring.fd, 0);
+            if (ring.base != MAP_FAILED || errno != EPERM) {
+                break;
+            }
+        }
+        if (ring.base == MAP_FAILED) {
+            LOG_WARN("failed to map perf ring buffer on cpu %d: %s", cpu,
+                     std::strerror(errno));
+            close(ring.fd);
+            break;
+        }
+        rings_.push_back(ring);
+    }
+
+    if (rings_.size() != cpus->size()) {
+        for (auto &ring : rings_) {
+            munmap(ring.base, ring.mmap_size);
+            close(ring.fd);
+        }
+        rings_.clear();
+        return false;
+    }
+    return true;
+}
+
+void Profiler::Stop(void) {
+    if (timer_ != -1) {
+        loop_.RemoveTimer(timer_);
+        timer_ = -1;
+    }
+    Drain();
+    for (auto &ring : rings_) {
+        munmap(ring.base, ring.mmap_size);
+        close(ring.fd);
+    }
+    rings_.clear();
+}
+
+void Profiler::Drain(void) {
+    ++num_drains_;
+    for (auto &ring : rings_) {
+        Drain(ring);
+    }
+}
+
+void Profiler::Drain(Ring &ring) {
+    auto meta = static_cast<perf_event_mmap_page *>(ring.base);
+    auto data = static_cast<char const *>(ring.base) + meta->data_offset;
+    auto size = meta->data_size;
+    auto head = __atomic_load_n(&meta->data_head, __ATOMIC_ACQUIRE);
+    auto tail = meta->data_tail;
+    while (head - tail >= sizeof(perf_event_header)) {
+        perf_event_header hdr;
+        CopyRing(data, size, tail, &hdr, sizeof(hdr));
+        if (hdr.size < sizeof(hdr) || hdr.size > head - tail) {
+            break;
+        }
+        record_.resize((hdr.size + 7) / 8);
+        CopyRing(data, size, tail, record_.data(), hdr.size);
+        OnRecord(record_.data(), hdr.size);
+        tail += hdr.size;
+    }
+    __atomic_store_n(&meta->data_tail, tail, __ATOMIC_RELEASE);
+}
+
+void Profiler::OnRecord(uint64_t const *record, size_t size) {
+    // Layouts of records are described in `linux/perf_event.h`. Words after
+    // header are `ip, pid|tid, nr, ips[nr]` for samples and `id, lost` for
+    // lost records.
+    perf_event_header hdr;
+    std::memcpy(&hdr, record, sizeof(hdr));
+    auto words = record + 1;
+    auto num_words = size / 8 - 1;
+    switch (hdr.type) {
+    case PERF_RECORD_SAMPLE: {
+        if (num_words < 3 || words[2] > num_words - 3) {
+            return;
+        }
+        uint32_t pid;
+        std::memcpy(&pid, words + 1, sizeof(pid));
+        OnSample(pid, words[0], words + 3, words[2]);
+        break;
+    }
+    case PERF_RECORD_LOST:
+        if (num_words >= 2) {
+            num_lost_ += words[1];
+        }
+        break;
+    }
+}
+
+void Profiler::OnSample(pid_t pid, uint64_t ip, uint64_t const *ips,
+                        size_t nr) {
+    auto &proc = Lookup(pid);
+    std::vector<uint64_t> stack{proc.comm};
+    for (size_t ix = 0; ix != nr; ++ix) {
+        // Skip context markers (e.g. PERF_CONTEXT_USER). Return addresses
+        // point to the next instruction after call so that they are moved
+        // back into the call.
+        if (ips[ix] >= PERF_CONTEXT_MAX) {
+            continue;
+        }
+        auto addr = stack.size() == 1 ? ips[ix] : ips[ix] - 1;
+        stack.push_back(Frame(proc, pid, addr));
+    }
+    if (stack.size() == 1) {
+        stack.push_back(Frame(proc, pid, ip));
+    }
+    ++stacks_[stack];
+    ++num_samples_;
+}
+
+Profiler::Process &Profiler::Lookup(pid_t pid) {
+    auto it = procs_.find(pid);
+    if (it != procs_.end()) {
+        return it->second;
+    }
+    char path[32];
+    snprintf(path, sizeof(path), "/proc/%d/comm", pid);
+    std::string comm;
+    if (auto content = ReadFile(path); content && !content->empty()) {
+        comm = content->substr(0, content->find('\n'));
+    } else {
+        comm = "[pid " + std::to_string(pid) + ']';
+    }
+    auto maps = ProcMaps::Read(pid);
+    Process proc{maps ? std::move(*maps) : ProcMaps{},
+                 Intern(comms_, comm_index_, comm), num_drains_};
+    return procs_.emplace(pid, std::move(proc)).first->second;
+}
+
+uint64_t Profiler::Frame(Process &proc, pid_t pid, uint64_t addr) {
+    // Maps are reread at most once per drain in order to catch up with
+    // libraries loaded after the first sample.
+    auto mapping = proc.maps.Find(addr);
+    if (mapping == nullptr && proc.refreshed_at != num_drains_) {
+        proc.refreshed_at = num_drains_;
+        if (auto maps = ProcMaps::Read(pid)) {
+            proc.maps = std::move(*maps);
+            mapping = proc.maps.Find(addr);
+        }
+    }
+    if (mapping == nullptr || mapping->path.empty() ||
+        modules_.size() >= unknown_module) {
+        return (uint64_t{unknown_module} << module_shift) |
+               (addr & offset_mask);
+    }
+    uint64_t module = Intern(modules_, module_index_, mapping->path);
+    auto offset = addr - mapping->start + mapping->offset;
+    return (module << module_shift) | (offset & offset_mask);
+}
+
+uint32_t Profiler::Intern(std::vector<std::string> &names,
+                          std::unordered_map<std::string, uint32_t> &index,
+                          std::string const &name) {
+    auto [it, inserted] = index.emplace(name, names.size());
+    if (inserted) {
+        names.push_back(name);
+    }
+    return it->second;
+}
+
+void Profiler::SampleProc(void) {
+    for (auto pid : ListProcessTree(pid_)) {
+        threads_.clear();
+        ReadThreads(pid, threads_);
+        auto main = std::find_if(threads_.begin(), threads_.end(),
+                                 [pid](auto const &t) { return t.tid == pid; });
+        if (main == threads_.end()) {
+            continue;
+        }
+        for (auto const &thread : threads_) {
+            auto stack = main->stat.comm + ';' + thread.stat.comm + ";[";
+            stack += ToString(thread.state);
+            stack += ']';
+            if (!thread.wchan.empty()) {
+                stack += ';' + thread.wchan;
+            }
+            ++folded_[stack];
+            ++num_samples_;
+        }
+    }
+}
+
+std::string Profiler::Folded(void) {
+    Symbolizer symbolizer;
+    std::unordered_map<uint64_t, std::string> names;
+    auto name = [&](uint64_t frame) -> std::string const & {
+        auto [it, inserted] = names.try_emplace(frame);
+        if (!inserted) {
+            return it->second;
+        }
+        auto module = frame >> module_shift;
+        auto offset = frame & offset_mask;
+        if (module == unknown_module) {
+            it->second = "[unknown]";
+        } else if (auto const &path = modules_[module]; path[0] == '[') {
+            it->second = path; // E.g. [vdso] or [stack].
+        } else {
+            it->second = symbolizer.Resolve(path, offset);
+        }
+        return it->second;
+    };
+
+    // Different addresses in the same function are merged.
+    auto lines = folded_;
+    for (auto const &[stack, count] : stacks_) {
+        auto line = comms_[stack[0]];
+        for (auto it = stack.rbegin(); it + 1 != stack.rend(); ++it) {
+            line += ';';
+            line += name(*it);
+        }
+        lines[line] += count;
+    }
+
+    std::string folded;
+    for (auto const &[line, count] : lines) {
+        folded += line;
+        folded += ' ';
+        folded += std::to_string(count);
+        folded += '\n';
+    }
+    return folded;
+}
+
+bool Profiler::Write(void) {
+    auto folded = Folded();
+    auto const &path = opts_.output;
+    FILE *fout = fopen(path.c_str(), "we");
+    if (fout == nullptr) {
+        LOG_WARN("failed to open profile output %s: %s", path.c_str(),
+                 std::strerror(errno));
+        return false;
+    }
+    auto ok = fwrite(folded.data(), 1, folded.size(), fout) == folded.size();
+    ok = fclose(fout) == 0 && ok;
+    if (!ok) {
+        LOG_WARN("failed to write profile to %s: %s", path.c_str(),
+                 std::strerror(errno));
+        return false;
+    }
+    LOG_INFO("profile of %llu samples (%s sampler, %llu lost) is written to "
+             "%s",
+             static_cast<unsigned long long>(num_samples_), sampler_.data(),
+             static_cast<unsigned long long>(num_lost_), path.c_str());
+    return true;
+}
+
+} // namespace mlspace
@@ -0,0 +1,149 @@
+// Copyright 2025 Daniel Bershatsky
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <sys/types.h>
+
+#include <mlspace/cc/event_loop.h>
+#include <mlspace/cc/job.h>
+#include <mlspace/cc/sampler.h>
+#include <mlspace/cc/symbols.h>
+
+namespace mlspace {
+
+// Profiler samples user-space call stacks of a job command and writes them in
+// folded format which is consumed by `flamegraph.pl` or speedscope.
+//
+// The primary sampler is `perf_event_open(2)` with CPU clock and callchains.
+// Events are opened on a process which has not executed the command yet so
+// that they are enabled on exec and inherited by all threads and children.
+// Inherited events cannot be mapped per task, so there is an event and a ring
+// buffer per CPU. Ring buffers are drained by timer and frames are translated
+// to `(file, offset)` with `/proc/<pid>/maps` while processes are alive.
+// Symbols are resolved only once on `Write`.
+//
+// If perf events are not allowed then states of threads of the process tree
+// are sampled from procfs instead: every stack is `comm;thread;[state];wchan`
+// where wchan is a kernel function where a thread waits (see `ThreadState`).
+//
+// Callchains are unwound by kernel with frame pointers, so that frames of
+// code compiled without them are skipped.
+class Profiler {
+public:
+    Profiler(EventLoop &loop, Profile opts);
+
+    ~Profiler(void);
+
+    Profiler(Profiler const &) = delete;
+
+    Profiler &operator=(Profiler const &) = delete;
+
+    // Attach starts sampling of `pid`. It returns false if neither sampler is
+    // available for the configured mode.
+    bool Attach(pid_t pid);
+
+    // Stop drains pending samples and stops sampling.
+    void Stop(void);
+
+    // Folded returns `stack count` lines sorted by stack.
+    std::string Folded(void);
+
+    // Write writes folded stacks to output path.
+    bool Write(void);
+
+    // Sampler returns either "perf", "proc", or "none".
+    std::string_view Sampler(void) const {
+        return sampler_;
+    }
+
+    uint64_t num_samples(void) const {
+        return num_samples_;
+    }
+
+    uint64_t num_lost(void) const {
+        return num_lost_;
+    }
+
+private:
+    struct Ring {
+        int fd = -1;
+        void *base = nullptr;
+        size_t mmap_size = 0;
+    };
+
+    bool OpenEvents(pid_t pid);
+
+    void Drain(void);
+
+    void Drain(Ring &ring);
+
+    void OnRecord(uint64_t const *record, size_t size);
+
+    void OnSample(pid_t pid, uint64_t ip, uint64_t const *ips, size_t nr);
+
+    void SampleProc(void);
+
+    // Maps and names of processes are cached since processes could exit
+    // before their samples are drained.
+    struct Process {
+        ProcMaps maps;
+        uint32_t comm;
+        uint64_t refreshed_at; // Number of drain when maps were read.
+    };
+
+    Process &Lookup(pid_t pid);
+
+    // Frames are packed into 64-bit words: module index in top 16 bits and
+    // file offset in the rest. Unknown module keeps address as is.
+    uint64_t Frame(Process &proc, pid_t pid, uint64_t addr);
+
+    uint32_t Intern(std::vector<std::string> &names,
+                    std::unordered_map<std::string, uint32_t> &index,
+                    std::string const &name);
+
+    EventLoop &loop_;
+    Profile opts_;
+    pid_t pid_ = -1;
+    int timer_ = -1;
+    std::string_view sampler_ = "none";
+    std::vector<Ring> rings_;
+    std::vector<uint64_t> record_; // Aligned copy of a record.
+
+    uint64_t num_samples_ = 0;
+    uint64_t num_lost_ = 0;
+
+    std::unordered_map<pid_t, Process> procs_;
+    uint64_t num_drains_ = 0;
+
+    std::vector<std::string> modules_;
+    std::unordered_map<std::string, uint32_t> module_index_;
+    std::vector<std::string> comms_;
+    std::unordered_map<std::string, uint32_t> comm_index_;
+
+    // Stacks of perf samples are comm followed by frames from innermost to
+    // outermost one. Stacks of procfs samples are already folded.
+    std::map<std::vector<uint64_t>, uint64_t> stacks_;
+    std::map<std::string, uint64_t> folded_;
+    std::vector<ThreadInfo> threads_;
+};
+
+} // namespace mlspace
@@ -0,0 +1,117 @@
+// Copyright 2025 Daniel Bershatsky
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <unistd.h>
+
+#include <mlspace/cc/supervisor.h>
+#include <mlspace/cc/symbols.h>
+
+using mlspace::ProcMaps;
+using mlspace::Profile;
+using mlspace::ProfileMode;
+using mlspace::Supervisor;
+
+extern "C" [[gnu::noinline]] int ProfilerTestTarget(int value) {
+    return value * 3 + 1;
+}
+
+TEST(Mapping, Parse) {
+    auto mapping = mlspace::ParseMapping(
+        "7f2c1a000000-7f2c1a1b5000 r-xp 00028000 fd:01 1234     "
+        "/usr/lib/x86_64-linux-gnu/libc.so.6");
+    ASSERT_TRUE(mapping);
+    EXPECT_EQ(mapping->start, 0x7f2c1a000000);
+    EXPECT_EQ(mapping->end, 0x7f2c1a1b5000);
+    EXPECT_EQ(mapping->offset, 0x28000);
+    EXPECT_TRUE(mapping->executable);
+    EXPECT_EQ(mapping->path, "/usr/lib/x86_64-linux-gnu/libc.so.6");
+
+    mapping = mlspace::ParseMapping("7ffd1000-7ffd2000 rw-p 00000000 00:00 0");
+    ASSERT_TRUE(mapping);
+    EXPECT_FALSE(mapping->executable);
+    EXPECT_EQ(mapping->path, "");
+
+    EXPECT_FALSE(mlspace::ParseMapping("not a mapping"));
+}
+
+TEST(ProcMaps, Find) {
+    auto maps = ProcMaps::Parse("2000-3000 r-xp 00001000 00:00 0 /b\n"
+                                "1000-2000 r--p 00000000 00:00 0 /a\n");
+    ASSERT_EQ(maps.mappings().size(), 2);
+    EXPECT_EQ(maps.Find(0x0fff), nullptr);
+    EXPECT_EQ(maps.Find(0x1000)->path, "/a");
+    EXPECT_EQ(maps.Find(0x2fff)->path, "/b");
+    EXPECT_EQ(maps.Find(0x3000), nullptr);
+}
+
+TEST(Symbolizer, ResolveSelf) {
+    auto addr = reinterpret_cast<uint64_t>(&ProfilerTestTarget);
+    auto maps = ProcMaps::Read(getpid());
+    ASSERT_TRUE(maps);
+    auto mapping = maps->Find(addr);
+    ASSERT_NE(mapping, nullptr);
+    ASSERT_TRUE(mapping->executable);
+
+    mlspace::Symbolizer symbolizer;
+    auto offset = addr - mapping->start + mapping->offset;
+    EXPECT_EQ(symbolizer.Resolve(mapping->path, offset), "ProfilerTestTarget");
+    EXPECT_EQ(symbolizer.Resolve("[vdso]", 0x10), "[[vdso]+0x10]");
+    EXPECT_EQ(ProfilerTestTarget(1), 4);
+}
+
+class ProfilerTest : public testing::TestWithParam<ProfileMode> {};
+
+TEST_P(ProfilerTest, Folded) {
+    auto output = std::filesystem::temp_directory_path() /
+                  ("mlspace-profile-" + std::to_string(getpid()) + ".txt");
+    std::filesystem::remove(output);
+
+    char exe[] = "/bin/sh";
+    char arg0[] = "sh", arg1[] = "-c";
+    char arg2[] = "i=0; while [ $i -lt 100000 ]; do i=$((i+1)); done";
+    char *args[] = {arg0, arg1, arg2, nullptr};
+    char *env[] = {nullptr};
+
+    Profile profile{.output = output, .frequency = 499, .mode = GetParam()};
+    Supervisor supervisor({.profile = profile});
+    ASSERT_EQ(supervisor.Run(exe, args, env, std::nullopt), 0);
+
+    // Every line is `sh;...;frame count` regardless of sampler.
+    std::ifstream fin(output);
+    std::string line;
+    size_t num_lines = 0;
+    while (std::getline(fin, line)) {
+        auto pos = line.rfind(' ');
+        ASSERT_NE(pos, line.npos) << line;
+        EXPECT_TRUE(line.starts_with("sh;")) << line;
+        EXPECT_GT(std::stoul(line.substr(pos + 1)), 0) << line;
+        ++num_lines;
+    }
+    EXPECT_GT(num_lines, 0);
+    std::filesystem::remove(output);
+}
+
+INSTANTIATE_TEST_SUITE_P(Profiler, ProfilerTest,
+                         testing::Values(ProfileMode::Auto, ProfileMode::Proc),
+                         [](auto const &info) {
+                             return std::string{ToString(info.param)};
+                         });
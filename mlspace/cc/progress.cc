@@ -0,0 +1,101 @@
+// Copyright 2025 Daniel Bershatsky
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "progress.h"
+
+#include <cerrno>
+
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include <mlspace/cc/log.h>
+
+namespace mlspace {
+
+ProgressChannel::ProgressChannel(EventLoop &loop, Handler handler)
+    : loop_{loop}, handler_{std::move(handler)} {
+}
+
+ProgressChannel::~ProgressChannel(void) {
+    CloseWriteEnd();
+    if (read_fd_ != -1) {
+        loop_.Remove(read_fd_);
+        close(read_fd_);
+    }
+}
+
+bool ProgressChannel::Open(void) {
+    int fds[2];
+    if (pipe2(fds, O_CLOEXEC) == -1) {
+        return false;
+    }
+    fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+    if (!loop_.Add(fds[0], EPOLLIN, [this](auto) { Drain(); })) {
+        close(fds[0]);
+        close(fds[1]);
+        return false;
+    }
+    read_fd_ = fds[0];
+    write_fd_ = fds[1];
+    env_ = std::string{env_var} + '=' + std::to_string(write_fd_);
+    return true;
+}
+
+void ProgressChannel::CloseWriteEnd(void) {
+    if (write_fd_ != -1) {
+        close(write_fd_);
+        write_fd_ = -1;
+    }
+}
+
+void ProgressChannel::Drain(void) {
+    if (read_fd_ == -1) {
+        return;
+    }
+    char buf[4096];
+    ssize_t len;
+    while ((len = read(read_fd_, buf, sizeof(buf))) > 0) {
+        Feed({buf, static_cast<size_t>(len)});
+    }
+    if (len == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+        loop_.Remove(read_fd_);
+        close(read_fd_);
+        read_fd_ = -1;
+    }
+}
+
+void ProgressChannel::Feed(std::string_view data) {
+    input_.append(data);
+    size_t offset = 0, pos;
+    while ((pos = input_.find('\n', offset)) != input_.npos) {
+        auto line = std::string_view{input_}.substr(offset, pos - offset);
+        offset = pos + 1;
+        auto sep = line.find_first_of(' ');
+        auto event = line.substr(0, sep);
+        auto payload =
+            sep == line.npos ? std::string_view{} : line.substr(sep + 1);
+        if (!event.empty()) {
+            handler_(event, payload);
+        }
+    }
+    input_.erase(0, offset);
+    if (input_.size() > max_line_length) {
+        LOG_WARN("progress message is too long: drop %zu bytes",
+                 input_.size());
+        input_.clear();
+    }
+}
+
+} // namespace mlspace
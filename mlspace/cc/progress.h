@@ -0,0 +1,80 @@
+// Copyright 2025 Daniel Bershatsky
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <functional>
+#include <string>
+#include <string_view>
+
+#include <mlspace/cc/event_loop.h>
+
+namespace mlspace {
+
+// ProgressChannel is a pipe through which a job reports its progress to the
+// supervisor. Write end is inherited by the job and its number is passed in
+// `MLSPACE_PROGRESS_FD` environment variable. Every message is a single line
+// `<event> [<payload>]` which is shorter than `PIPE_BUF` so that writes of
+// concurrent writers are never interleaved (see `mlspace/progress.py`).
+//
+//     checkpoint [<path>]      Checkpoint is committed to persistent storage.
+class ProgressChannel {
+public:
+    using Handler =
+        std::function<void(std::string_view event, std::string_view payload)>;
+
+    static constexpr std::string_view env_var = "MLSPACE_PROGRESS_FD";
+
+    static constexpr size_t max_line_length = 4096;
+
+    ProgressChannel(EventLoop &loop, Handler handler);
+
+    ~ProgressChannel(void);
+
+    ProgressChannel(ProgressChannel const &) = delete;
+
+    ProgressChannel &operator=(ProgressChannel const &) = delete;
+
+    // Open creates a pipe and starts reading its read end. Both ends are
+    // closed on exec; the child must clear the flag on `write_fd`.
+    bool Open(void);
+
+    // CloseWriteEnd closes write end in the supervisor once child is spawned.
+    void CloseWriteEnd(void);
+
+    // Drain reads all pending messages without blocking.
+    void Drain(void);
+
+    // Feed splits data on lines and dispatches complete ones.
+    void Feed(std::string_view data);
+
+    int write_fd(void) const {
+        return write_fd_;
+    }
+
+    // Env returns `MLSPACE_PROGRESS_FD=<fd>` entry for child environment.
+    std::string const &env(void) const {
+        return env_;
+    }
+
+private:
+    EventLoop &loop_;
+    Handler handler_;
+    int read_fd_ = -1;
+    int write_fd_ = -1;
+    std::string env_;
+    std::string input_;
+};
+
+} // namespace mlspace
@@ -0,0 +1,469 @@
+// Copyright 2025 Daniel Bershatsky
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "registry.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <mlspace/cc/log.h>
+#include <mlspace/cc/proc.h>
+
+namespace mlspace {
+
+namespace {
+
+constexpr char magic[4] = {'M', 'L', 'R', 'G'};
+constexpr uint32_t version = 1;
+constexpr uint32_t slot_claimed = 1;
+constexpr int max_cpus = 1024;
+
+// Interval of polling registry while resources are busy.
+constexpr std::chrono::milliseconds poll_interval{100};
+
+struct Header {
+    char magic[4];
+    uint32_t version;
+    uint32_t slot_size;
+    uint8_t reserved[52];
+};
+
+static_assert(sizeof(Header) == 64);
+
+struct Slot {
+    uint32_t state;
+    int32_t pid;
+    int32_t node;
+    uint32_t num_cpus;
+    uint64_t memory;
+    int64_t time;
+    uint64_t cpu_mask[max_cpus / 64];
+    uint8_t reserved[96];
+};
+
+static_assert(sizeof(Slot) == 256);
+
+// Table is a snapshot of registry: live claims and offset of a free slot.
+struct Table {
+    std::vector<Claim> claims;
+    off_t free_slot = 0;
+};
+
+bool Lock(int fd, short type, off_t start, off_t len, bool wait) {
+    struct flock fl = {};
+    fl.l_type = type;
+    fl.l_whence = SEEK_SET;
+    fl.l_start = start;
+    fl.l_len = len;
+    return fcntl(fd, wait ? F_OFD_SETLKW : F_OFD_SETLK, &fl) == 0;
+}
+
+// IsLocked tests whether a range is locked through another open file
+// description (i.e. by another claim). Errors are treated as locked.
+bool IsLocked(int fd, off_t start, off_t len) {
+    struct flock fl = {};
+    fl.l_type = F_WRLCK;
+    fl.l_whence = SEEK_SET;
+    fl.l_start = start;
+    fl.l_len = len;
+    return fcntl(fd, F_OFD_GETLK, &fl) == -1 || fl.l_type != F_UNLCK;
+}
+
+void LockTable(int fd, short type) {
+    // Interrupted wait is retried since table lock is held for a moment.
+    while (!Lock(fd, type, 0, sizeof(Header), true) && errno == EINTR) {
+    }
+}
+
+void UnlockTable(int fd) {
+    Lock(fd, F_UNLCK, 0, sizeof(Header), false);
+}
+
+Slot Encode(Claim const &claim) {
+    Slot slot = {};
+    slot.state = slot_claimed;
+    slot.pid = claim.pid;
+    slot.node = claim.node;
+    slot.num_cpus = claim.cpus.size();
+    slot.memory = claim.memory;
+    auto now = std::chrono::system_clock::now().time_since_epoch();
+    slot.time = std::chrono::nanoseconds{now}.count();
+    for (auto cpu : claim.cpus) {
+        slot.cpu_mask[cpu / 64] |= uint64_t{1} << (cpu % 64);
+    }
+    return slot;
+}
+
+Claim Decode(Slot const &slot) {
+    Claim claim;
+    claim.pid = slot.pid;
+    claim.node = slot.node;
+    claim.memory = slot.memory;
+    claim.cpus.reserve(slot.num_cpus);
+    for (int cpu = 0; cpu != max_cpus; ++cpu) {
+        if (slot.cpu_mask[cpu / 64] & uint64_t{1} << (cpu % 64)) {
+            claim.cpus.push_back(cpu);
+        }
+    }
+    return claim;
+}
+
+// ReadTable reads registry under table lock. Header is written to empty
+// registry if `init` is set. It fails with `EINVAL` if `fd` is not a
+// registry.
+std::optional<Table> ReadTable(int fd, bool init) {
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+        return std::nullopt;
+    }
+    Table table;
+    table.free_slot = sizeof(Header);
+    if (st.st_size < static_cast<off_t>(sizeof(Header))) {
+        // Registry is new or its creator died before header was written.
+        if (init) {
+            Header header = {};
+            std::memcpy(header.magic, magic, sizeof(magic));
+            header.version = version;
+            header.slot_size = sizeof(Slot);
+            if (pwrite(fd, &header, sizeof(header), 0) != sizeof(header)) {
+                return std::nullopt;
+            }
+        }
+        return table;
+    }
+
+    Header header;
+    if (pread(fd, &header, sizeof(header), 0) != sizeof(header)) {
+        return std::nullopt;
+    }
+    if (std::memcmp(header.magic, magic, sizeof(magic)) != 0 ||
+        header.version != version || header.slot_size != sizeof(Slot)) {
+        errno = EINVAL;
+        return std::nullopt;
+    }
+
+    size_t num_slots = (st.st_size - sizeof(Header)) / sizeof(Slot);
+    std::vector<Slot> slots(num_slots);
+    ssize_t size = num_slots * sizeof(Slot);
+    if (pread(fd, slots.data(), size, sizeof(Header)) != size) {
+        return std::nullopt;
+    }
+    table.free_slot = -1;
+    for (size_t ix = 0; ix != num_slots; ++ix) {
+        off_t offset = sizeof(Header) + ix * sizeof(Slot);
+        if (!IsLocked(fd, offset, sizeof(Slot))) {
+            // Slot is either released or its owner died.
+            if (table.free_slot == -1) {
+                table.free_slot = offset;
+            }
+        } else if (slots[ix].state == slot_claimed) {
+            table.claims.push_back(Decode(slots[ix]));
+        }
+    }
+    if (table.free_slot == -1) {
+        table.free_slot = sizeof(Header) + num_slots * sizeof(Slot);
+    }
+    return table;
+}
+
+std::optional<size_t> ParseMemTotal(std::string_view str) {
+    auto pos = str.find("MemTotal:");
+    if (pos == str.npos) {
+        return std::nullopt;
+    }
+    pos = str.find_first_not_of(' ', pos + 9);
+    if (pos == str.npos) {
+        return std::nullopt;
+    }
+    size_t kib;
+    auto res = std::from_chars(str.data() + pos, str.data() + str.size(), kib);
+    if (res.ec != std::errc{}) {
+        return std::nullopt;
+    }
+    return kib << 10;
+}
+
+} // namespace
+
+std::optional<std::vector<NumaNode>> ReadNumaNodes(void) {
+    std::vector<NumaNode> nodes;
+    if (DIR *dir = opendir("/sys/devices/system/node")) {
+        while (auto entry = readdir(dir)) {
+            std::string_view name{entry->d_name};
+            NumaNode node;
+            if (!name.starts_with("node") ||
+                std::from_chars(name.data() + 4, name.data() + name.size(),
+                                node.id)
+                        .ptr != name.data() + name.size()) {
+                continue;
+            }
+            auto path = "/sys/devices/system/node/" + std::string{name};
+            auto cpus = ReadFile((path + "/cpulist").data());
+            auto meminfo = ReadFile((path + "/meminfo").data());
+            if (!cpus || !meminfo) {
+                continue;
+            }
+            auto cpu_list = ParseCpuList(*cpus);
+            auto memory = ParseMemTotal(*meminfo);
+            if (!cpu_list || !memory) {
+                continue;
+            }
+            node.cpus = std::move(*cpu_list);
+            node.memory = *memory;
+            nodes.push_back(std::move(node));
+        }
+        closedir(dir);
+    }
+    if (!nodes.empty()) {
+        std::sort(nodes.begin(), nodes.end(),
+                  [](auto const &a, auto const &b) { return a.id < b.id; });
+        return nodes;
+    }
+
+    // Kernel is built without NUMA support.
+    auto online = ReadFile("/sys/devices/system/cpu/online");
+    auto meminfo = ReadFile("/proc/meminfo");
+    if (!online || !meminfo) {
+        return std::nullopt;
+    }
+    auto cpus = ParseCpuList(*online);
+    auto memory = ParseMemTotal(*meminfo);
+    if (!cpus || !memory) {
+        errno = EINVAL;
+        return std::nullopt;
+    }
+    nodes.push_back({.id = 0, .cpus = std::move(*cpus), .memory = *memory});
+    return nodes;
+}
+
+std::optional<Claim> PlaceClaim(std::vector<NumaNode> const &nodes,
+                                std::vector<int> const &pool,
+                                std::vector<Claim> const &claims,
+                                Allocation const &alloc) {
+    // Memory of claims which span nodes is accounted in total only.
+    size_t total = 0;
+    size_t used = 0;
+    std::vector<int> held;
+    for (auto const &node : nodes) {
+        total += node.memory;
+    }
+    for (auto const &claim : claims) {
+        used += claim.memory;
+        held.insert(held.end(), claim.cpus.begin(), claim.cpus.end());
+    }
+    if (used > total || alloc.memory > total - used) {
+        return std::nullopt;
+    }
+    std::sort(held.begin(), held.end());
+    auto allowed = pool;
+    std::sort(allowed.begin(), allowed.end());
+
+    struct Spare {
+        int node;
+        std::vector<int> cpus;
+        size_t memory;
+    };
+    std::vector<Spare> spares;
+    spares.reserve(nodes.size());
+    for (auto const &node : nodes) {
+        Spare spare{node.id, {}, node.memory};
+        for (auto cpu : node.cpus) {
+            if (cpu < max_cpus &&
+                std::binary_search(allowed.begin(), allowed.end(), cpu) &&
+                !std::binary_search(held.begin(), held.end(), cpu)) {
+                spare.cpus.push_back(cpu);
+            }
+        }
+        for (auto const &claim : claims) {
+            if (claim.node == node.id) {
+                spare.memory -= std::min(spare.memory, claim.memory);
+            }
+        }
+        spares.push_back(std::move(spare));
+    }
+
+    // Best fit among single nodes.
+    Spare const *best = nullptr;
+    for (auto const &spare : spares) {
+        if (spare.cpus.size() < alloc.cpus || spare.memory < alloc.memory) {
+            continue;
+        }
+        if (!best || std::pair{spare.cpus.size(), spare.memory} <
+                         std::pair{best->cpus.size(), best->memory}) {
+            best = &spare;
+        }
+    }
+    Claim claim;
+    claim.memory = alloc.memory;
+    if (best) {
+        claim.node = best->node;
+        claim.cpus.assign(best->cpus.begin(), best->cpus.begin() + alloc.cpus);
+        return claim;
+    } else if (alloc.same_node) {
+        return std::nullopt;
+    }
+
+    // Spread over nodes with the most spare CPUs first.
+    std::stable_sort(spares.begin(), spares.end(), [](auto &a, auto &b) {
+        return a.cpus.size() > b.cpus.size();
+    });
+    for (auto const &spare : spares) {
+        auto num_cpus = std::min(alloc.cpus - claim.cpus.size(),
+                                 spare.cpus.size());
+        claim.cpus.insert(claim.cpus.end(), spare.cpus.begin(),
+                          spare.cpus.begin() + num_cpus);
+    }
+    if (claim.cpus.size() < alloc.cpus) {
+        return std::nullopt;
+    }
+    std::sort(claim.cpus.begin(), claim.cpus.end());
+    return claim;
+}
+
+std::optional<ResourceClaim>
+ResourceClaim::Acquire(Allocation const &alloc,
+                       std::vector<NumaNode> const &nodes,
+                       std::vector<int> const &pool) {
+    if (!PlaceClaim(nodes, pool, {}, alloc)) {
+        errno = ENOSPC;
+        return std::nullopt;
+    }
+    int fd = open(alloc.registry.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0666);
+    if (fd == -1) {
+        return std::nullopt;
+    }
+    auto fail = [fd](int err) {
+        close(fd);
+        errno = err;
+        return std::nullopt;
+    };
+
+    auto deadline = std::chrono::steady_clock::now() + alloc.timeout;
+    for (bool waiting = false;; waiting = true) {
+        LockTable(fd, F_WRLCK);
+        auto table = ReadTable(fd, true);
+        if (!table) {
+            return fail(errno);
+        }
+        if (auto claim = PlaceClaim(nodes, pool, table->claims, alloc)) {
+            claim->pid = getpid();
+            auto slot = Encode(*claim);
+            if (!Lock(fd, F_WRLCK, table->free_slot, sizeof(slot), false) ||
+                pwrite(fd, &slot, sizeof(slot), table->free_slot) !=
+                    sizeof(slot)) {
+                return fail(errno);
+            }
+            UnlockTable(fd);
+            ResourceClaim res;
+            res.fd_ = fd;
+            res.slot_ = table->free_slot;
+            res.claim_ = std::move(*claim);
+            return res;
+        }
+        UnlockTable(fd);
+
+        auto now = std::chrono::steady_clock::now();
+        if (now >= deadline) {
+            return fail(EBUSY);
+        }
+        if (!waiting) {
+            LOG_INFO("wait for %zu cpus and %zu bytes of memory held by %zu "
+                     "other claims",
+                     alloc.cpus, alloc.memory, table->claims.size());
+        }
+        std::this_thread::sleep_for(std::min<std::chrono::nanoseconds>(
+            poll_interval, deadline - now));
+    }
+}
+
+std::optional<ResourceClaim> ResourceClaim::Acquire(Allocation const &alloc) {
+    auto nodes = ReadNumaNodes();
+    if (!nodes) {
+        return std::nullopt;
+    }
+    auto pool = GetAffinity(0);
+    if (!pool) {
+        return std::nullopt;
+    }
+    return Acquire(alloc, *nodes, *pool);
+}
+
+std::optional<std::vector<Claim>>
+ResourceClaim::List(std::filesystem::path const &path) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        if (errno == ENOENT) {
+            return std::vector<Claim>{};
+        }
+        return std::nullopt;
+    }
+    LockTable(fd, F_RDLCK);
+    auto table = ReadTable(fd, false);
+    int err = errno;
+    close(fd); // Lock is released as well.
+    if (!table) {
+        errno = err;
+        return std::nullopt;
+    }
+    return std::move(table->claims);
+}
+
+ResourceClaim::ResourceClaim(ResourceClaim &&other)
+    : fd_{std::exchange(other.fd_, -1)}, slot_{other.slot_},
+      claim_{std::move(other.claim_)} {
+}
+
+ResourceClaim &ResourceClaim::operator=(ResourceClaim &&other) {
+    if (this != &other) {
+        Release();
+        fd_ = std::exchange(other.fd_, -1);
+        slot_ = other.slot_;
+        claim_ = std::move(other.claim_);
+    }
+    return *this;
+}
+
+ResourceClaim::~ResourceClaim(void) {
+    Release();
+}
+
+void ResourceClaim::Release(void) {
+    if (fd_ == -1) {
+        return;
+    }
+    // Slot is cleared for readers and then both locks are dropped on close.
+    LockTable(fd_, F_WRLCK);
+    Slot slot = {};
+    if (pwrite(fd_, &slot, sizeof(slot), slot_) != sizeof(slot)) {
+        LOG_WARN("failed to clear claim in registry: %s",
+                 std::strerror(errno));
+    }
+    close(fd_);
+    fd_ = -1;
+}
+
+} // namespace mlspace
@@ -0,0 +1,110 @@
+// Copyright 2025 Daniel Bershatsky
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <vector>
+
+#include <sys/types.h>
+
+#include <mlspace/cc/job.h>
+
+namespace mlspace {
+
+// NumaNode is CPUs and memory (in bytes) of a NUMA node.
+struct NumaNode {
+    int id = 0;
+    std::vector<int> cpus;
+    size_t memory = 0;
+};
+
+// ReadNumaNodes reads NUMA topology from sysfs. A machine without NUMA
+// support is a single node with all online CPUs and memory.
+std::optional<std::vector<NumaNode>> ReadNumaNodes(void);
+
+// Claim is a set of resources held by a process. Claim spans several nodes
+// if `node` is -1.
+struct Claim {
+    pid_t pid = 0;
+    int node = -1;
+    std::vector<int> cpus;
+    size_t memory = 0;
+};
+
+// PlaceClaim chooses resources for `alloc` among CPUs of `pool` and memory of
+// `nodes` which are not held by `claims`. It prefers a single node which
+// fits the best (i.e. has the least spare resources left) so that large
+// claims are not fragmented by small ones.
+std::optional<Claim> PlaceClaim(std::vector<NumaNode> const &nodes,
+                                std::vector<int> const &pool,
+                                std::vector<Claim> const &claims,
+                                Allocation const &alloc);
+
+// ResourceClaim holds resources in node-local registry, so that concurrent
+// `launch` instances get disjoint CPUs, NUMA nodes and memory budgets.
+// Registry is a file of fixed-size slots which is shared by all instances.
+// All integers are little-endian.
+//
+//     header   "MLRG" u32:version u32:slot_size u8[52]:0
+//     slot     u32:state i32:pid i32:node u32:num_cpus u64:memory
+//              i64:time u64[16]:cpu_mask u8[96]:0
+//
+// Claims are guarded by open file description locks (`F_OFD_SETLK`): the
+// table is scanned and updated under a lock of header and an owner holds a
+// lock of its slot until it releases a claim. Kernel drops locks once the
+// owner dies, so that a slot without lock is free whatever it contains.
+class ResourceClaim {
+public:
+    // Acquire claims resources for `alloc` among CPUs of `pool` and memory of
+    // `nodes`. It retries until `alloc.timeout` expires and fails with
+    // `EBUSY` if resources are held by others or with `ENOSPC` if `alloc`
+    // does not fit even to an idle node.
+    static std::optional<ResourceClaim>
+    Acquire(Allocation const &alloc, std::vector<NumaNode> const &nodes,
+            std::vector<int> const &pool);
+
+    // Acquire claims resources of the machine among CPUs which the calling
+    // process is allowed to run on.
+    static std::optional<ResourceClaim> Acquire(Allocation const &alloc);
+
+    // List returns live claims in registry at `path`.
+    static std::optional<std::vector<Claim>>
+    List(std::filesystem::path const &path);
+
+    ResourceClaim(ResourceClaim &&other);
+
+    ResourceClaim &operator=(ResourceClaim &&other);
+
+    // ~ResourceClaim releases resources.
+    ~ResourceClaim(void);
+
+    Claim const &claim(void) const {
+        return claim_;
+    }
+
+private:
+    ResourceClaim(void) = default;
+
+    void Release(void);
+
+    int fd_ = -1;
+    off_t slot_ = 0; // Offset of the slot.
+    Claim claim_;
+};
+
+} // namespace mlspace
@@ -0,0 +1,207 @@
+// Copyright 2025 Daniel Bershatsky
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <mlspace/cc/registry.h>
+
+using mlspace::Allocation;
+using mlspace::Claim;
+using mlspace::NumaNode;
+using mlspace::PlaceClaim;
+using mlspace::ResourceClaim;
+
+namespace {
+
+constexpr size_t GiB = size_t{1} << 30;
+
+// Two nodes of four CPUs and 8 GiB each.
+std::vector<NumaNode> const nodes = {
+    {.id = 0, .cpus = {0, 1, 2, 3}, .memory = 8 * GiB},
+    {.id = 1, .cpus = {4, 5, 6, 7}, .memory = 8 * GiB},
+};
+
+std::vector<int> const pool = {0, 1, 2, 3, 4, 5, 6, 7};
+
+class RegistryTest : public ::testing::Test {
+protected:
+    void SetUp(void) override {
+        path_ = std::filesystem::temp_directory_path() /
+                ("mlspace-registry-" + std::to_string(getpid()));
+        std::filesystem::remove(path_);
+    }
+
+    void TearDown(void) override {
+        std::filesystem::remove(path_);
+    }
+
+    Allocation Alloc(size_t cpus, size_t memory = 0) const {
+        return {.cpus = cpus, .memory = memory, .registry = path_};
+    }
+
+    std::filesystem::path path_;
+};
+
+} // namespace
+
+TEST(PlaceClaim, BestFit) {
+    auto claim = PlaceClaim(nodes, pool, {}, {.cpus = 2});
+    ASSERT_TRUE(claim);
+    EXPECT_EQ(claim->node, 0);
+    EXPECT_EQ(claim->cpus, (std::vector<int>{0, 1}));
+
+    // Partially used node is filled up first.
+    std::vector<Claim> claims = {{.node = 0, .cpus = {0, 1}}};
+    claim = PlaceClaim(nodes, pool, claims, {.cpus = 2});
+    ASSERT_TRUE(claim);
+    EXPECT_EQ(claim->cpus, (std::vector<int>{2, 3}));
+    claim = PlaceClaim(nodes, pool, claims, {.cpus = 3});
+    ASSERT_TRUE(claim);
+    EXPECT_EQ(claim->node, 1);
+    EXPECT_EQ(claim->cpus, (std::vector<int>{4, 5, 6}));
+
+    // Memory budget of a node is exhausted.
+    claims = {{.node = 0, .memory = 6 * GiB}};
+    claim = PlaceClaim(nodes, pool, claims, {.cpus = 1, .memory = 4 * GiB});
+    ASSERT_TRUE(claim);
+    EXPECT_EQ(claim->node, 1);
+    EXPECT_FALSE(PlaceClaim(nodes, pool, claims, {.memory = 11 * GiB}));
+
+    // Only allowed CPUs are claimed.
+    claim = PlaceClaim(nodes, {5, 7}, {}, {.cpus = 2});
+    ASSERT_TRUE(claim);
+    EXPECT_EQ(claim->cpus, (std::vector<int>{5, 7}));
+}
+
+TEST(PlaceClaim, Spread) {
+    std::vector<Claim> claims = {{.node = 0, .cpus = {0, 1}}};
+    EXPECT_FALSE(PlaceClaim(nodes, pool, claims, {.cpus = 6}));
+    auto claim =
+        PlaceClaim(nodes, pool, claims, {.cpus = 5, .same_node = false});
+    ASSERT_TRUE(claim);
+    EXPECT_EQ(claim->node, -1);
+    EXPECT_EQ(claim->cpus, (std::vector<int>{2, 4, 5, 6, 7}));
+    EXPECT_FALSE(
+        PlaceClaim(nodes, pool, claims, {.cpus = 7, .same_node = false}));
+}
+
+TEST_F(RegistryTest, Disjoint) {
+    auto a = ResourceClaim::Acquire(Alloc(3, GiB), nodes, pool);
+    ASSERT_TRUE(a);
+    auto b = ResourceClaim::Acquire(Alloc(3, GiB), nodes, pool);
+    ASSERT_TRUE(b);
+    EXPECT_EQ(a->claim().pid, getpid());
+    EXPECT_EQ(a->claim().cpus, (std::vector<int>{0, 1, 2}));
+    EXPECT_EQ(b->claim().cpus, (std::vector<int>{4, 5, 6}));
+
+    // Neither node has two spare CPUs.
+    errno = 0;
+    EXPECT_FALSE(ResourceClaim::Acquire(Alloc(2), nodes, pool));
+    EXPECT_EQ(errno, EBUSY);
+    errno = 0;
+    EXPECT_FALSE(ResourceClaim::Acquire(Alloc(5), nodes, pool));
+    EXPECT_EQ(errno, ENOSPC);
+
+    auto claims = ResourceClaim::List(path_);
+    ASSERT_TRUE(claims);
+    ASSERT_EQ(claims->size(), 2);
+    EXPECT_EQ((*claims)[1].cpus, b->claim().cpus);
+    EXPECT_EQ((*claims)[1].memory, GiB);
+
+    // Released slot is reused.
+    a.reset();
+    auto c = ResourceClaim::Acquire(Alloc(2), nodes, pool);
+    ASSERT_TRUE(c);
+    EXPECT_EQ(c->claim().cpus, (std::vector<int>{0, 1}));
+    EXPECT_EQ(std::filesystem::file_size(path_), 64 + 2 * 256);
+}
+
+TEST_F(RegistryTest, OwnerDies) {
+    int fds[2];
+    ASSERT_EQ(pipe(fds), 0);
+    auto pid = fork();
+    ASSERT_NE(pid, -1);
+    if (pid == 0) {
+        // Claim is not released explicitly.
+        auto alloc = Alloc(8);
+        alloc.same_node = false;
+        auto claim = ResourceClaim::Acquire(alloc, nodes, pool);
+        char ok = claim ? 1 : 0;
+        write(fds[1], &ok, 1);
+        if (claim) {
+            pause();
+        }
+        _exit(0);
+    }
+    close(fds[1]);
+    char ok = 0;
+    ASSERT_EQ(read(fds[0], &ok, 1), 1);
+    close(fds[0]);
+    ASSERT_TRUE(ok);
+
+    errno = 0;
+    EXPECT_FALSE(ResourceClaim::Acquire(Alloc(1), nodes, pool));
+    EXPECT_EQ(errno, EBUSY);
+    auto claims = ResourceClaim::List(path_);
+    ASSERT_TRUE(claims);
+    ASSERT_EQ(claims->size(), 1);
+    EXPECT_EQ(claims->front().pid, pid);
+
+    // Claim is waited for and it is dropped once its owner is killed.
+    auto alloc = Alloc(1);
+    alloc.timeout = std::chrono::seconds{10};
+    auto killer = fork();
+    ASSERT_NE(killer, -1);
+    if (killer == 0) {
+        usleep(100'000);
+        kill(pid, SIGKILL);
+        _exit(0);
+    }
+    auto claim = ResourceClaim::Acquire(alloc, nodes, pool);
+    ASSERT_TRUE(claim);
+    EXPECT_EQ(claim->claim().cpus, (std::vector<int>{0}));
+    ASSERT_EQ(waitpid(killer, nullptr, 0), killer);
+    ASSERT_EQ(waitpid(pid, nullptr, 0), pid);
+}
+
+TEST_F(RegistryTest, NotRegistry) {
+    std::ofstream(path_) << "not a registry of claims at all, "
+                            "but it is long enough for header";
+    errno = 0;
+    EXPECT_FALSE(ResourceClaim::Acquire(Alloc(1), nodes, pool));
+    EXPECT_EQ(errno, EINVAL);
+}
+
+TEST(Registry, ReadNumaNodes) {
+    auto nodes = mlspace::ReadNumaNodes();
+    ASSERT_TRUE(nodes);
+    ASSERT_FALSE(nodes->empty());
+    size_t num_cpus = 0;
+    for (auto const &node : *nodes) {
+        num_cpus += node.cpus.size();
+        EXPECT_GT(node.memory, 0);
+    }
+    EXPECT_GT(num_cpus, 0);
+}
@@ -0,0 +1,288 @@
+// Copyright 2025 Daniel Bershatsky
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "sampler.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <cstdlib>
+
+#include <dirent.h>
+
+#include <nlohmann/json.hpp>
+
+namespace mlspace {
+
+namespace {
+
+constexpr std::array<std::string_view, num_thread_states> state_names = {
+    "running", "runnable", "io", "futex", "sleeping", "other",
+};
+
+// ForEachTask invokes `fn` with every thread id of `pid`.
+template <typename Fn> void ForEachTask(pid_t pid, Fn &&fn) {
+    char path[32];
+    snprintf(path, sizeof(path), "/proc/%d/task", pid);
+    DIR *dir = opendir(path);
+    if (dir == nullptr) {
+        return;
+    }
+    while (auto entry = readdir(dir)) {
+        if (pid_t tid = std::atoi(entry->d_name); tid > 0) {
+            fn(tid);
+        }
+    }
+    closedir(dir);
+}
+
+// ReadSchedStat reads time on CPU and time on runqueue in nanoseconds.
+bool ReadSchedStat(pid_t pid, pid_t tid, uint64_t &run_ns, uint64_t &wait_ns) {
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%d/task/%d/schedstat", pid, tid);
+    auto content = ReadFile(path);
+    if (!content) {
+        return false;
+    }
+    auto begin = content->data();
+    auto end = begin + content->size();
+    auto res = std::from_chars(begin, end, run_ns);
+    if (res.ec != std::errc{} || res.ptr == end) {
+        return false;
+    }
+    res = std::from_chars(res.ptr + 1, end, wait_ns);
+    return res.ec == std::errc{};
+}
+
+nlohmann::json ToJSON(ThreadStates const &states) {
+    auto obj = nlohmann::json::object();
+    for (size_t ix = 0; ix != num_thread_states; ++ix) {
+        obj[state_names[ix]] = states.seconds[ix];
+    }
+    return obj;
+}
+
+} // namespace
+
+std::string_view ToString(ThreadState state) {
+    return state_names[static_cast<size_t>(state)];
+}
+
+ThreadState ClassifyThread(char state, std::string_view wchan) {
+    switch (state) {
+    case 'R':
+        return ThreadState::Running;
+    case 'D':
+        return ThreadState::IO;
+    case 'S':
+    case 'I':
+        // Wait channel is e.g. futex_wait_queue_me or futex_do_wait
+        // depending on kernel version.
+        if (wchan.starts_with("futex")) {
+            return ThreadState::Futex;
+        }
+        return ThreadState::Sleeping;
+    default:
+        return ThreadState::Other;
+    }
+}
+
+std::vector<pid_t> ListProcessTree(pid_t root) {
+    // Children are listed per thread, so that we walk over all threads. It
+    // requires CONFIG_PROC_CHILDREN; otherwise, only root is listed.
+    std::vector<pid_t> pids = {root};
+    for (size_t ix = 0; ix != pids.size(); ++ix) {
+        auto pid = pids[ix];
+        ForEachTask(pid, [&](pid_t tid) {
+            char path[64];
+            snprintf(path, sizeof(path), "/proc/%d/task/%d/children", pid,
+                     tid);
+            auto content = ReadFile(path);
+            if (!content) {
+                return;
+            }
+            char const *ptr = content->data();
+            auto end = ptr + content->size();
+            while (ptr < end) {
+                pid_t child;
+                auto res = std::from_chars(ptr, end, child);
+                if (res.ec != std::errc{}) {
+                    break;
+                }
+                pids.push_back(child);
+                ptr = res.ptr + 1;
+            }
+        });
+    }
+    return pids;
+}
+
+void ReadThreads(pid_t pid, std::vector<ThreadInfo> &threads) {
+    ForEachTask(pid, [&](pid_t tid) {
+        auto stat = ReadProcStat(pid, tid);
+        if (!stat) {
+            return; // Thread has exited.
+        }
+        ThreadInfo info{pid, tid, std::move(*stat)};
+        if (info.stat.state != 'R') {
+            char path[64];
+            snprintf(path, sizeof(path), "/proc/%d/task/%d/wchan", pid, tid);
+            if (auto wchan = ReadFile(path); wchan && *wchan != "0") {
+                info.wchan = std::move(*wchan);
+            }
+        }
+        info.state = ClassifyThread(info.stat.state, info.wchan);
+        threads.push_back(std::move(info));
+    });
+}
+
+double ThreadStates::Total(void) const {
+    double total = 0;
+    for (auto value : seconds) {
+        total += value;
+    }
+    return total;
+}
+
+ThreadStates &ThreadStates::operator+=(ThreadStates const &other) {
+    for (size_t ix = 0; ix != num_thread_states; ++ix) {
+        seconds[ix] += other.seconds[ix];
+    }
+    return *this;
+}
+
+ThreadSampler::ThreadSampler(EventLoop &loop,
+                             std::chrono::milliseconds interval)
+    : loop_{loop}, interval_{interval} {
+}
+
+ThreadSampler::~ThreadSampler(void) {
+    Stop();
+}
+
+void ThreadSampler::Start(pid_t root) {
+    root_ = root;
+    sampled_at_ = std::chrono::steady_clock::now();
+    timer_ = loop_.AddTimer(interval_, interval_, [this]() { Sample(); });
+}
+
+void ThreadSampler::Stop(void) {
+    if (timer_ != -1) {
+        loop_.RemoveTimer(timer_);
+        timer_ = -1;
+    }
+}
+
+void ThreadSampler::Sample(void) {
+    using seconds = std::chrono::duration<double>;
+    auto now = std::chrono::steady_clock::now();
+    snapshot_.clear();
+    for (auto pid : ListProcessTree(root_)) {
+        ReadThreads(pid, snapshot_);
+    }
+
+    for (auto const &info : snapshot_) {
+        auto [it, inserted] = threads_.try_emplace(info.tid);
+        auto &thread = it->second;
+        if (inserted || thread.starttime != info.stat.starttime) {
+            // A new thread has been started since the last sample. If its tid
+            // is reused then time of the previous thread is kept in total.
+            if (!inserted) {
+                retired_ += thread.states;
+            }
+            thread = {info.pid, info.stat.comm, info.stat.starttime};
+            ++num_threads_;
+            thread.seen_at = sampled_at_;
+        }
+        thread.comm = info.stat.comm;
+
+        double elapsed = seconds(now - thread.seen_at).count();
+        uint64_t run_ns, wait_ns;
+        if (ReadSchedStat(info.pid, info.tid, run_ns, wait_ns) &&
+            run_ns >= thread.run_ns && wait_ns >= thread.wait_ns) {
+            double run = (run_ns - thread.run_ns) * 1e-9;
+            double wait = (wait_ns - thread.wait_ns) * 1e-9;
+            thread.states[ThreadState::Running] += run;
+            thread.states[ThreadState::Runnable] += wait;
+            thread.run_ns = run_ns;
+            thread.wait_ns = wait_ns;
+            if (auto rest = elapsed - run - wait;
+                info.state != ThreadState::Running && rest > 0) {
+                thread.states[info.state] += rest;
+            }
+        } else {
+            thread.states[info.state] += elapsed;
+        }
+        thread.seen_at = now;
+    }
+
+    // Threads which have exited are evicted, so that respawned workers do not
+    // grow the table, but their time is kept in total.
+    std::erase_if(threads_, [&](auto const &entry) {
+        auto const &thread = entry.second;
+        if (thread.seen_at == now) {
+            return false;
+        }
+        retired_ += thread.states;
+        return true;
+    });
+    sampled_at_ = now;
+    ++num_samples_;
+}
+
+ThreadStates ThreadSampler::Total(void) const {
+    ThreadStates total = retired_;
+    for (auto const &[tid, thread] : threads_) {
+        total += thread.states;
+    }
+    return total;
+}
+
+std::string ThreadSampler::Summary(void) const {
+    auto total = Total();
+    auto sum = std::max(total.Total(), 1e-9);
+    std::string summary;
+    for (size_t ix = 0; ix != num_thread_states; ++ix) {
+        char buf[64];
+        snprintf(buf, sizeof(buf), "%s%s=%.3fs (%.1f%%)",
+                 summary.empty() ? "" : " ", state_names[ix].data(),
+                 total.seconds[ix], 100 * total.seconds[ix] / sum);
+        summary += buf;
+    }
+    return summary;
+}
+
+std::string ThreadSampler::ToJSON(void) const {
+    auto threads = nlohmann::json::array();
+    for (auto const &[tid, thread] : threads_) {
+        threads.push_back({
+            {"pid", thread.pid},
+            {"tid", tid},
+            {"comm", thread.comm},
+            {"states", mlspace::ToJSON(thread.states)},
+        });
+    }
+    nlohmann::json res = {
+        {"interval", std::chrono::duration<double>(interval_).count()},
+        {"num_samples", num_samples_},
+        {"num_threads", num_threads_},
+        {"states", mlspace::ToJSON(Total())},
+        {"retired", mlspace::ToJSON(retired_)},
+        {"threads", std::move(threads)},
+    };
+    // Thread names are arbitrary bytes rather than UTF-8.
+    return res.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace);
+}
+
+} // namespace mlspace
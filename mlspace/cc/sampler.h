@@ -0,0 +1,158 @@
+// Copyright 2025 Daniel Bershatsky
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <sys/types.h>
+
+#include <mlspace/cc/event_loop.h>
+#include <mlspace/cc/proc.h>
+
+namespace mlspace {
+
+// ThreadState is what a thread spends its time on.
+enum class ThreadState : uint8_t {
+    Running,  // On CPU.
+    Runnable, // Ready to run but waiting for CPU.
+    IO,       // Uninterruptible sleep (D state) which is mostly disk I/O.
+    Futex,    // Waiting on a lock or a condition variable.
+    Sleeping, // Any other interruptible sleep (e.g. poll or socket read).
+    Other,    // Stopped, traced, zombie, etc.
+};
+
+inline constexpr size_t num_thread_states = 6;
+
+std::string_view ToString(ThreadState state);
+
+// ClassifyThread classifies a thread by state letter from `/proc/.../stat`
+// and kernel function where it waits (`/proc/.../wchan`). On-CPU and
+// runqueue time cannot be told apart by the state letter, so that `R` is
+// always running.
+ThreadState ClassifyThread(char state, std::string_view wchan);
+
+// ThreadInfo is a snapshot of a thread.
+struct ThreadInfo {
+    pid_t pid = 0;
+    pid_t tid = 0;
+    ProcStat stat;
+    std::string wchan; // Read only if a thread is not running.
+    ThreadState state = ThreadState::Other;
+};
+
+// ListProcessTree returns `root` followed by all its living descendants.
+std::vector<pid_t> ListProcessTree(pid_t root);
+
+// ReadThreads appends snapshots of all threads of `pid` to `threads`.
+void ReadThreads(pid_t pid, std::vector<ThreadInfo> &threads);
+
+// ThreadStates is a histogram of thread time in seconds by state.
+struct ThreadStates {
+    std::array<double, num_thread_states> seconds = {};
+
+    double &operator[](ThreadState state) {
+        return seconds[static_cast<size_t>(state)];
+    }
+
+    double operator[](ThreadState state) const {
+        return seconds[static_cast<size_t>(state)];
+    }
+
+    double Total(void) const;
+
+    ThreadStates &operator+=(ThreadStates const &other);
+};
+
+// ThreadSampler periodically reads states of all threads of a process tree
+// from procfs and accumulates per-thread histograms of thread states.
+// Histograms of exited threads are folded into a single one of retired
+// threads, so that only living threads are kept.
+//
+// On-CPU and runqueue time are taken exactly from `schedstat` counters while
+// the rest of the sampling interval is attributed to the state a thread is
+// observed in. So, the histogram is accurate for running and runnable time
+// and it is statistical for waits.
+class ThreadSampler {
+public:
+    ThreadSampler(EventLoop &loop, std::chrono::milliseconds interval);
+
+    ~ThreadSampler(void);
+
+    ThreadSampler(ThreadSampler const &) = delete;
+
+    ThreadSampler &operator=(ThreadSampler const &) = delete;
+
+    void Start(pid_t root);
+
+    void Stop(void);
+
+    // Sample takes a single sample. It is called by timer.
+    void Sample(void);
+
+    // Total returns histogram over all threads ever seen.
+    ThreadStates Total(void) const;
+
+    // Summary returns histogram in human-readable form for exit summary.
+    std::string Summary(void) const;
+
+    // ToJSON returns total and per-thread histograms of living threads as
+    // JSON object.
+    std::string ToJSON(void) const;
+
+    size_t num_samples(void) const {
+        return num_samples_;
+    }
+
+    // num_threads returns number of threads ever seen.
+    size_t num_threads(void) const {
+        return num_threads_;
+    }
+
+    // num_live_threads returns number of threads seen in the last sample.
+    size_t num_live_threads(void) const {
+        return threads_.size();
+    }
+
+private:
+    struct Thread {
+        pid_t pid;
+        std::string comm;
+        uint64_t starttime; // In order to detect reused tids.
+        uint64_t run_ns = 0;
+        uint64_t wait_ns = 0;
+        std::chrono::steady_clock::time_point seen_at;
+        ThreadStates states;
+    };
+
+    EventLoop &loop_;
+    std::chrono::milliseconds interval_;
+    pid_t root_ = -1;
+    int timer_ = -1;
+    std::chrono::steady_clock::time_point sampled_at_;
+    size_t num_samples_ = 0;
+    size_t num_threads_ = 0;
+    std::vector<ThreadInfo> snapshot_;
+    std::unordered_map<pid_t, Thread> threads_; // Living threads.
+    ThreadStates retired_;
+};
+
+} // namespace mlspace
@@ -0,0 +1,179 @@
+// Copyright 2025 Daniel Bershatsky
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <mutex>
+#include <thread>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <nlohmann/json.hpp>
+
+#include <mlspace/cc/sampler.h>
+
+using mlspace::ClassifyThread;
+using mlspace::EventLoop;
+using mlspace::ThreadSampler;
+using mlspace::ThreadState;
+
+TEST(ThreadState, Classify) {
+    EXPECT_EQ(ClassifyThread('R', ""), ThreadState::Running);
+    EXPECT_EQ(ClassifyThread('D', "folio_wait_bit"), ThreadState::IO);
+    EXPECT_EQ(ClassifyThread('S', "futex_wait_queue_me"), ThreadState::Futex);
+    EXPECT_EQ(ClassifyThread('S', "futex_do_wait"), ThreadState::Futex);
+    EXPECT_EQ(ClassifyThread('S', "do_epoll_wait"), ThreadState::Sleeping);
+    EXPECT_EQ(ClassifyThread('S', ""), ThreadState::Sleeping);
+    EXPECT_EQ(ClassifyThread('Z', ""), ThreadState::Other);
+}
+
+TEST(ThreadState, ReadFutex) {
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool done = false;
+    std::atomic<pid_t> tid = 0;
+    std::thread thread([&]() {
+        tid = gettid();
+        std::unique_lock lock(mutex);
+        cv.wait(lock, [&]() { return done; });
+    });
+
+    // Wait until the thread blocks on condition variable.
+    std::optional<ThreadState> state;
+    for (int ix = 0; ix != 100 && state != ThreadState::Futex; ++ix) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{10});
+        std::vector<mlspace::ThreadInfo> threads;
+        mlspace::ReadThreads(getpid(), threads);
+        for (auto const &info : threads) {
+            if (info.tid == tid) {
+                state = info.state;
+            }
+        }
+    }
+    {
+        std::lock_guard lock(mutex);
+        done = true;
+    }
+    cv.notify_one();
+    thread.join();
+    EXPECT_EQ(state, ThreadState::Futex);
+}
+
+TEST(ListProcessTree, Descendants) {
+    int ready[2];
+    ASSERT_EQ(pipe(ready), 0);
+    auto pid = fork();
+    ASSERT_NE(pid, -1);
+    if (pid == 0) {
+        if (fork() == 0) {
+            close(ready[0]);
+            close(ready[1]);
+            pause();
+            _exit(0);
+        }
+        close(ready[1]); // Notify parent that grandchild is forked.
+        pause();
+        _exit(0);
+    }
+    close(ready[1]);
+    char byte;
+    ASSERT_EQ(read(ready[0], &byte, 1), 0);
+    close(ready[0]);
+
+    auto pids = mlspace::ListProcessTree(pid);
+    kill(pid, SIGKILL);
+    waitpid(pid, nullptr, 0);
+    ASSERT_EQ(pids.size(), 2);
+    EXPECT_EQ(pids[0], pid);
+    kill(pids[1], SIGKILL); // Grandchild is reaped by init.
+}
+
+TEST(ThreadSampler, BusyThenSleep) {
+    auto pid = fork();
+    ASSERT_NE(pid, -1);
+    if (pid == 0) {
+        auto until = std::chrono::steady_clock::now() +
+                     std::chrono::milliseconds{200};
+        while (std::chrono::steady_clock::now() < until) {
+        }
+        pause();
+        _exit(0);
+    }
+
+    EventLoop loop;
+    ThreadSampler sampler(loop, std::chrono::milliseconds{20});
+    sampler.Start(pid);
+    loop.AddTimer(std::chrono::milliseconds{500}, {}, [&]() { loop.Stop(); });
+    loop.Run();
+    sampler.Stop();
+    kill(pid, SIGKILL);
+    waitpid(pid, nullptr, 0);
+
+    auto total = sampler.Total();
+    EXPECT_GT(sampler.num_samples(), 5);
+    EXPECT_EQ(sampler.num_threads(), 1);
+    EXPECT_EQ(sampler.num_live_threads(), 1);
+    EXPECT_GT(total[ThreadState::Running], 0.1);
+    EXPECT_GT(total[ThreadState::Sleeping], 0.1);
+    EXPECT_LT(total.Total(), 0.6);
+
+    auto json = nlohmann::json::parse(sampler.ToJSON());
+    EXPECT_EQ(json["threads"].size(), 1);
+    EXPECT_EQ(json["threads"][0]["pid"], pid);
+    EXPECT_GT(json["states"]["running"].get<double>(), 0.1);
+
+    // Reaped threads are not counted as live ones but they are kept in
+    // histograms.
+    sampler.Sample();
+    EXPECT_EQ(sampler.num_threads(), 1);
+    EXPECT_EQ(sampler.num_live_threads(), 0);
+    EXPECT_EQ(sampler.Total().Total(), total.Total());
+}
+
+TEST(ThreadSampler, RespawnedThreads) {
+    // Shell spawns short-lived children one after another like data loader
+    // respawns its workers.
+    auto pid = fork();
+    ASSERT_NE(pid, -1);
+    if (pid == 0) {
+        execl("/bin/sh", "sh", "-c",
+              "for i in 1 2 3 4 5 6 7 8 9 10; do sleep 0.05; done", nullptr);
+        _exit(127);
+    }
+
+    EventLoop loop;
+    ThreadSampler sampler(loop, std::chrono::milliseconds{10});
+    sampler.Start(pid);
+    loop.AddTimer(std::chrono::milliseconds{400}, {}, [&]() { loop.Stop(); });
+    loop.Run();
+    sampler.Stop();
+    kill(pid, SIGKILL);
+    waitpid(pid, nullptr, 0);
+
+    // Exited children are evicted but their time is kept in total.
+    EXPECT_GT(sampler.num_threads(), 3);
+    EXPECT_LE(sampler.num_live_threads(), 2);
+    auto json = nlohmann::json::parse(sampler.ToJSON());
+    EXPECT_EQ(json["num_threads"], sampler.num_threads());
+    EXPECT_LE(json["threads"].size(), 2);
+    EXPECT_GT(json["retired"]["sleeping"].get<double>(), 0.1);
+    EXPECT_GT(sampler.Total()[ThreadState::Sleeping],
+              json["retired"]["sleeping"].get<double>());
+}
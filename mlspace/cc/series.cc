@@ -0,0 +1,276 @@
+// Copyright 2025 Daniel Bershatsky
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "series.h"
+
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <mlspace/cc/log.h>
+#include <mlspace/cc/proc.h>
+
+namespace mlspace {
+
+namespace {
+
+constexpr char magic[4] = {'M', 'L', 'T', 'S'};
+constexpr char end_magic[8] = {'M', 'L', 'T', 'S', '_', 'E', 'N', 'D'};
+constexpr uint16_t version = 1;
+
+// Little-endian host is assumed like everywhere in `launch`.
+template <typename T> void Put(std::string &buf, T value) {
+    buf.append(reinterpret_cast<char const *>(&value), sizeof(value));
+}
+
+void Pad(std::string &buf) {
+    buf.append((8 - buf.size() % 8) % 8, '\0');
+}
+
+void PutVarint(std::string &buf, int64_t value) {
+    auto zigzag = (static_cast<uint64_t>(value) << 1) ^
+                  static_cast<uint64_t>(value >> 63);
+    while (zigzag >= 0x80) {
+        buf.push_back(static_cast<char>(zigzag | 0x80));
+        zigzag >>= 7;
+    }
+    buf.push_back(static_cast<char>(zigzag));
+}
+
+} // namespace
+
+std::string_view ToString(SeriesType type) {
+    switch (type) {
+    case SeriesType::Int64:
+        return "int64";
+    case SeriesType::Float64:
+        return "float64";
+    case SeriesType::Int32:
+        return "int32";
+    case SeriesType::Float32:
+        return "float32";
+    }
+    return "unknown";
+}
+
+size_t SizeOf(SeriesType type) {
+    switch (type) {
+    case SeriesType::Int64:
+    case SeriesType::Float64:
+        return 8;
+    case SeriesType::Int32:
+    case SeriesType::Float32:
+        return 4;
+    }
+    return 0;
+}
+
+std::optional<SeriesWriter>
+SeriesWriter::Create(std::filesystem::path const &path,
+                     std::vector<SeriesColumn> columns, Options opts) {
+    if (columns.size() > UINT16_MAX || opts.rows_per_block == 0) {
+        errno = EINVAL;
+        return std::nullopt;
+    }
+    std::string header{magic, sizeof(magic)};
+    Put<uint16_t>(header, version);
+    Put<uint16_t>(header, columns.size());
+    Put<uint32_t>(header, 0); // Size is set below.
+    Put<uint32_t>(header, 0);
+    for (auto const &column : columns) {
+        if (column.name.size() > UINT8_MAX || SizeOf(column.type) == 0) {
+            errno = EINVAL;
+            return std::nullopt;
+        }
+        Put<uint8_t>(header, static_cast<uint8_t>(column.type));
+        Put<uint8_t>(header, column.name.size());
+        header.append(column.name);
+    }
+    Pad(header);
+    uint32_t size = header.size();
+    std::memcpy(header.data() + 8, &size, sizeof(size));
+
+    SeriesWriter writer;
+    writer.fd_ = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+                      0644);
+    if (writer.fd_ == -1) {
+        return std::nullopt;
+    }
+    if (!WriteAll(writer.fd_, header)) {
+        close(std::exchange(writer.fd_, -1));
+        return std::nullopt;
+    }
+    writer.opts_ = opts;
+    writer.columns_ = std::move(columns);
+    writer.offset_ = header.size();
+    writer.times_.reserve(opts.rows_per_block);
+    writer.values_.resize(writer.columns_.size());
+    for (size_t ix = 0; ix != writer.columns_.size(); ++ix) {
+        auto width = SizeOf(writer.columns_[ix].type);
+        writer.values_[ix].reserve(width * opts.rows_per_block);
+    }
+    return writer;
+}
+
+SeriesWriter::SeriesWriter(SeriesWriter &&other)
+    : fd_{std::exchange(other.fd_, -1)}, opts_{other.opts_},
+      columns_{std::move(other.columns_)}, offset_{other.offset_},
+      num_rows_{other.num_rows_}, num_blocks_{other.num_blocks_},
+      times_{std::move(other.times_)}, values_{std::move(other.values_)},
+      index_{std::move(other.index_)}, prev_index_{other.prev_index_},
+      indexed_{other.indexed_}, payload_{std::move(other.payload_)} {
+}
+
+SeriesWriter &SeriesWriter::operator=(SeriesWriter &&other) {
+    if (this != &other) {
+        Close();
+        fd_ = std::exchange(other.fd_, -1);
+        opts_ = other.opts_;
+        columns_ = std::move(other.columns_);
+        offset_ = other.offset_;
+        num_rows_ = other.num_rows_;
+        num_blocks_ = other.num_blocks_;
+        times_ = std::move(other.times_);
+        values_ = std::move(other.values_);
+        index_ = std::move(other.index_);
+        prev_index_ = other.prev_index_;
+        indexed_ = other.indexed_;
+        payload_ = std::move(other.payload_);
+    }
+    return *this;
+}
+
+SeriesWriter::~SeriesWriter(void) {
+    Close();
+}
+
+bool SeriesWriter::Append(int64_t time, std::span<SeriesValue const> values) {
+    if (fd_ == -1 || values.size() != columns_.size()) {
+        return false;
+    }
+    times_.push_back(time);
+    for (size_t ix = 0; ix != values.size(); ++ix) {
+        auto const &value = values[ix];
+        auto &buf = values_[ix];
+        auto as_int = value.is_float ? static_cast<int64_t>(value.f) : value.i;
+        auto as_float = value.is_float ? value.f : static_cast<double>(value.i);
+        switch (columns_[ix].type) {
+        case SeriesType::Int64:
+            Put<int64_t>(buf, as_int);
+            break;
+        case SeriesType::Float64:
+            Put<double>(buf, as_float);
+            break;
+        case SeriesType::Int32:
+            Put<int32_t>(buf, as_int);
+            break;
+        case SeriesType::Float32:
+            Put<float>(buf, as_float);
+            break;
+        }
+    }
+    num_rows_ += 1;
+    if (times_.size() >= opts_.rows_per_block) {
+        return Flush();
+    }
+    return true;
+}
+
+bool SeriesWriter::Flush(void) {
+    if (fd_ == -1 || times_.empty()) {
+        return fd_ != -1;
+    }
+    payload_.clear();
+    Put<uint32_t>(payload_, times_.size());
+    Put<uint32_t>(payload_, 0); // Size of timestamps is set below.
+    Put<int64_t>(payload_, times_.front());
+    Put<int64_t>(payload_, times_.back());
+    auto prev = times_.front();
+    for (auto time : times_) {
+        PutVarint(payload_, time - prev);
+        prev = time;
+    }
+    uint32_t time_size = payload_.size() - 24;
+    std::memcpy(payload_.data() + 4, &time_size, sizeof(time_size));
+    Pad(payload_);
+    for (auto const &buf : values_) {
+        payload_.append(buf);
+        Pad(payload_);
+    }
+
+    IndexEntry entry{offset_, times_.front(), times_.back(),
+                     static_cast<uint32_t>(times_.size())};
+    times_.clear();
+    for (auto &buf : values_) {
+        buf.clear();
+    }
+    if (!WriteBlock("DATA", payload_)) {
+        return false;
+    }
+    index_.push_back(entry);
+    num_blocks_ += 1;
+    indexed_ = false;
+    if (index_.size() >= opts_.blocks_per_index) {
+        return WriteIndex();
+    }
+    return true;
+}
+
+bool SeriesWriter::Close(void) {
+    if (fd_ == -1) {
+        return true;
+    }
+    bool ok = Flush() && (indexed_ || WriteIndex());
+    if (close(fd_) == -1) {
+        ok = false;
+    }
+    fd_ = -1;
+    return ok;
+}
+
+bool SeriesWriter::WriteBlock(char const *tag, std::string const &payload) {
+    std::string header{tag, 4};
+    Put<uint32_t>(header, payload.size());
+    if (!WriteAll(fd_, header) || !WriteAll(fd_, payload)) {
+        LOG_WARN("failed to write time series block: %s",
+                 std::strerror(errno));
+        return false;
+    }
+    offset_ += header.size() + payload.size();
+    return true;
+}
+
+bool SeriesWriter::WriteIndex(void) {
+    auto offset = offset_;
+    payload_.clear();
+    Put<int64_t>(payload_, prev_index_);
+    Put<uint32_t>(payload_, index_.size());
+    Put<uint32_t>(payload_, 0);
+    payload_.append(reinterpret_cast<char const *>(index_.data()),
+                    index_.size() * sizeof(IndexEntry));
+    Put<int64_t>(payload_, offset);
+    payload_.append(end_magic, sizeof(end_magic));
+    if (!WriteBlock("INDX", payload_)) {
+        return false;
+    }
+    index_.clear();
+    prev_index_ = offset;
+    indexed_ = true;
+    return true;
+}
+
+} // namespace mlspace
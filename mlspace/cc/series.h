@@ -0,0 +1,175 @@
+// Copyright 2025 Daniel Bershatsky
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <initializer_list>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace mlspace {
+
+// Time series file is an append-only columnar file which is read by mapping
+// it to memory (see `mlspace/series.py`). All integers are little-endian and
+// all sections are aligned to 8 bytes.
+//
+//     header   "MLTS" u16:version u16:num_columns u32:size u32:0
+//              {u8:type u8:len name[len]}*num_columns <pad>
+//     block    u32:tag u32:size payload[size]
+//
+// Data block (tag "DATA") holds up to `rows_per_block` rows. Timestamps are
+// zigzag varints of differences to previous ones and values are arrays of
+// fixed width, one per column.
+//
+//     payload  u32:num_rows u32:time_size i64:first_time i64:last_time
+//              varint[time_size] <pad> {value[num_rows] <pad>}*num_columns
+//
+// Index block (tag "INDX") is written after every `blocks_per_index` data
+// blocks and on close. It lists preceding data blocks and refers to the
+// previous index block, so that a reader follows the chain from the end of
+// file. File which ends with a data block (e.g. writer crashed) is scanned
+// block by block instead.
+//
+//     payload  i64:prev_offset u32:num_entries u32:0
+//              {i64:offset i64:first_time i64:last_time u32:num_rows u32:0}*
+//              i64:offset "MLTS_END"
+enum class SeriesType : uint8_t {
+    Int64 = 1,
+    Float64 = 2,
+    Int32 = 3,
+    Float32 = 4,
+};
+
+std::string_view ToString(SeriesType type);
+
+size_t SizeOf(SeriesType type);
+
+struct SeriesColumn {
+    std::string name;
+    SeriesType type;
+};
+
+// SeriesValue is a value of any column type. It is converted to the type of
+// column on append.
+struct SeriesValue {
+    SeriesValue(void) = default;
+
+    template <std::integral T>
+    SeriesValue(T value) : i{static_cast<int64_t>(value)} {
+    }
+
+    template <std::floating_point T>
+    SeriesValue(T value) : f{static_cast<double>(value)}, is_float{true} {
+    }
+
+    int64_t i = 0;
+    double f = 0;
+    bool is_float = false;
+};
+
+// SeriesWriter appends rows to a time series file. Rows are accumulated in
+// memory and written as a data block once there are `rows_per_block` rows or
+// on `Flush`.
+class SeriesWriter {
+public:
+    struct Options {
+        size_t rows_per_block = 4096;
+        size_t blocks_per_index = 16;
+    };
+
+    // Create creates (or truncates) file at `path` and writes its header.
+    static std::optional<SeriesWriter>
+    Create(std::filesystem::path const &path,
+           std::vector<SeriesColumn> columns, Options opts);
+
+    static std::optional<SeriesWriter>
+    Create(std::filesystem::path const &path,
+           std::vector<SeriesColumn> columns) {
+        return Create(path, std::move(columns), Options{});
+    }
+
+    SeriesWriter(SeriesWriter &&other);
+
+    SeriesWriter &operator=(SeriesWriter &&other);
+
+    // ~SeriesWriter closes file if it is not closed.
+    ~SeriesWriter(void);
+
+    // Append adds a row of values in order of columns. It fails if number
+    // of values differs from number of columns or block is not written.
+    bool Append(int64_t time, std::span<SeriesValue const> values);
+
+    bool Append(int64_t time, std::initializer_list<SeriesValue> values) {
+        return Append(time, std::span{values.begin(), values.size()});
+    }
+
+    // Flush writes accumulated rows as a data block.
+    bool Flush(void);
+
+    // Close flushes rows, writes the final index block, and closes file.
+    bool Close(void);
+
+    std::vector<SeriesColumn> const &columns(void) const {
+        return columns_;
+    }
+
+    size_t num_rows(void) const {
+        return num_rows_;
+    }
+
+    size_t num_blocks(void) const {
+        return num_blocks_;
+    }
+
+private:
+    struct IndexEntry {
+        int64_t offset;
+        int64_t first_time;
+        int64_t last_time;
+        uint32_t num_rows;
+        uint32_t reserved = 0;
+    };
+
+    SeriesWriter(void) = default;
+
+    bool WriteBlock(char const *tag, std::string const &payload);
+
+    bool WriteIndex(void);
+
+    int fd_ = -1;
+    Options opts_;
+    std::vector<SeriesColumn> columns_;
+    int64_t offset_ = 0; // Offset of the next block.
+    size_t num_rows_ = 0;
+    size_t num_blocks_ = 0;
+
+    // Rows of the current block.
+    std::vector<int64_t> times_;
+    std::vector<std::string> values_;
+
+    std::vector<IndexEntry> index_;
+    int64_t prev_index_ = -1;
+    bool indexed_ = false; // Whether file ends with an index block.
+
+    std::string payload_; // Scratch buffer for blocks.
+};
+
+} // namespace mlspace
@@ -0,0 +1,84 @@
+// Copyright 2025 Daniel Bershatsky
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <mlspace/cc/series.h>
+
+using mlspace::SeriesColumn;
+using mlspace::SeriesType;
+using mlspace::SeriesWriter;
+
+namespace {
+
+template <typename T> T Get(std::string const &buf, size_t offset) {
+    T value;
+    std::memcpy(&value, buf.data() + offset, sizeof(value));
+    return value;
+}
+
+} // namespace
+
+TEST(SeriesWriter, Layout) {
+    auto path = std::filesystem::temp_directory_path() /
+                ("mlspace-series-" + std::to_string(getpid()) + ".mlts");
+    SeriesWriter::Options opts;
+    opts.rows_per_block = 3;
+    opts.blocks_per_index = 2;
+    std::vector<SeriesColumn> columns = {{"loss", SeriesType::Float64},
+                                         {"step", SeriesType::Int32}};
+    auto writer = SeriesWriter::Create(path, columns, opts);
+    ASSERT_TRUE(writer);
+    for (int ix = 0; ix != 8; ++ix) {
+        ASSERT_TRUE(writer->Append(1'000 + 10 * ix, {0.5 * ix, ix}));
+    }
+    EXPECT_FALSE(writer->Append(2'000, {1.0}));
+    ASSERT_TRUE(writer->Close());
+    EXPECT_EQ(writer->num_rows(), 8);
+    EXPECT_EQ(writer->num_blocks(), 3);
+
+    std::ifstream file(path, std::ios::binary);
+    std::string buf{std::istreambuf_iterator<char>(file), {}};
+    std::filesystem::remove(path);
+    ASSERT_EQ(buf.substr(0, 4), "MLTS");
+    EXPECT_EQ(Get<uint16_t>(buf, 6), 2);
+    auto offset = Get<uint32_t>(buf, 8);
+    EXPECT_EQ(offset % 8, 0);
+
+    // Blocks: two data blocks, index, data block, and the final index.
+    std::string tags;
+    std::vector<uint32_t> num_rows;
+    while (offset + 8 <= buf.size()) {
+        auto tag = buf.substr(offset, 4);
+        tags += tag[0];
+        if (tag == "DATA") {
+            auto first_time = 1'000 + 30 * num_rows.size();
+            num_rows.push_back(Get<uint32_t>(buf, offset + 8));
+            EXPECT_EQ(Get<int64_t>(buf, offset + 16), first_time);
+        }
+        offset += 8 + Get<uint32_t>(buf, offset + 4);
+    }
+    EXPECT_EQ(offset, buf.size());
+    EXPECT_EQ(tags, "DDIDI");
+    EXPECT_EQ(num_rows, (std::vector<uint32_t>{3, 3, 2}));
+    EXPECT_EQ(buf.substr(buf.size() - 8), "MLTS_END");
+}
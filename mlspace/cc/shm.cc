@@ -0,0 +1,234 @@
+// Copyright 2025 Daniel Bershatsky
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "shm.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include <dirent.h>
+#include <linux/mempolicy.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <mlspace/cc/log.h>
+#include <mlspace/cc/proc.h>
+
+namespace mlspace {
+
+namespace {
+
+constexpr size_t default_huge_page_size = 2 << 20;
+
+size_t HugePageSize(void) {
+    auto content = ReadFile("/proc/meminfo");
+    if (!content) {
+        return default_huge_page_size;
+    }
+    auto pos = content->find("Hugepagesize:");
+    if (pos == content->npos) {
+        return default_huge_page_size;
+    }
+    auto kb = std::strtoull(content->data() + pos + 13, nullptr, 10);
+    return kb > 0 ? kb << 10 : default_huge_page_size;
+}
+
+// ShmemHugePages is true if transparent huge pages are allowed for shmem
+// mappings with `MADV_HUGEPAGE` (the current mode is in brackets).
+bool ShmemHugePages(void) {
+    auto content =
+        ReadFile("/sys/kernel/mm/transparent_hugepage/shmem_enabled");
+    if (!content) {
+        return false;
+    }
+    for (auto mode : {"[always]", "[within_size]", "[advise]", "[force]"}) {
+        if (content->find(mode) != content->npos) {
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t RoundUp(size_t size, size_t align) {
+    return (size + align - 1) / align * align;
+}
+
+// Bind sets preferred NUMA node for pages of a shared mapping. Policy is kept
+// by the memory file, so that it applies to all processes which map it.
+bool Bind(void *base, size_t size, int node) {
+    constexpr size_t bits = 8 * sizeof(unsigned long);
+    std::vector<unsigned long> mask(node / bits + 1);
+    mask[node / bits] = 1UL << (node % bits);
+    return syscall(SYS_mbind, base, size, MPOL_PREFERRED, mask.data(),
+                   mask.size() * bits + 1, 0) == 0;
+}
+
+// Populate allocates all pages of a mapping. It fails rather than crashes
+// with SIGBUS if there is not enough memory (since Linux 5.14).
+bool Populate(void *base, size_t size, size_t page_size) {
+    if (madvise(base, size, MADV_POPULATE_WRITE) == 0) {
+        return true;
+    } else if (errno != EINVAL) {
+        return false;
+    }
+    for (size_t offset = 0; offset < size; offset += page_size) {
+        static_cast<volatile char *>(base)[offset] = 0;
+    }
+    return true;
+}
+
+// Allocate creates a memory file of `size` bytes and prefaults it. It
+// returns file descriptor or -1 on failure.
+int Allocate(unsigned flags, size_t size, size_t page_size, bool thp,
+             std::optional<int> node) {
+    int fd = memfd_create("mlspace-shm", MFD_CLOEXEC | flags);
+    if (fd == -1) {
+        return -1;
+    }
+    if (ftruncate(fd, size) == -1) {
+        close(fd);
+        return -1;
+    }
+
+    // Hugetlbfs reserves huge pages on mmap, so that it fails if there are
+    // not enough free pages.
+    void *base =
+        mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+        close(fd);
+        return -1;
+    }
+    if (thp && madvise(base, size, MADV_HUGEPAGE) == -1) {
+        LOG_DEBUG("failed to advise huge pages: %s", std::strerror(errno));
+    }
+    if (node && !Bind(base, size, *node)) {
+        LOG_DEBUG("failed to bind shared memory to node %d: %s", *node,
+                  std::strerror(errno));
+    }
+    bool ok = Populate(base, size, page_size);
+    int err = errno;
+    munmap(base, size);
+    if (!ok) {
+        close(fd);
+        errno = err;
+        return -1;
+    }
+    return fd;
+}
+
+} // namespace
+
+std::string_view ToString(ShmBacking backing) {
+    switch (backing) {
+    case ShmBacking::HugeTLB:
+        return "hugetlb";
+    case ShmBacking::THP:
+        return "thp";
+    case ShmBacking::Pages:
+        return "pages";
+    }
+    return "unknown";
+}
+
+std::optional<int> CpuNode(int cpu) {
+    char path[64];
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d", cpu);
+    DIR *dir = opendir(path);
+    if (dir == nullptr) {
+        return std::nullopt;
+    }
+    std::optional<int> node;
+    while (auto entry = readdir(dir)) {
+        std::string_view name{entry->d_name};
+        if (name.starts_with("node") && name.size() > 4) {
+            node = std::atoi(entry->d_name + 4);
+            break;
+        }
+    }
+    closedir(dir);
+    return node;
+}
+
+std::optional<SharedRegion> SharedRegion::Create(SharedMemory const &opts) {
+    static long const page_size = sysconf(_SC_PAGESIZE);
+    SharedRegion region;
+    region.numa_node_ = opts.numa_node;
+    if (!region.numa_node_) {
+        if (auto cpus = GetAffinity(0); cpus && !cpus->empty()) {
+            region.numa_node_ = CpuNode(cpus->front());
+        }
+    }
+
+    if (opts.huge_pages) {
+        auto huge_page_size = HugePageSize();
+        auto size = RoundUp(opts.size, huge_page_size);
+        region.fd_ = Allocate(MFD_HUGETLB, size, huge_page_size, false,
+                              region.numa_node_);
+        if (region.fd_ != -1) {
+            region.size_ = size;
+            region.backing_ = ShmBacking::HugeTLB;
+            return region;
+        }
+        LOG_DEBUG("failed to allocate hugetlb pages: %s; fallback to thp",
+                  std::strerror(errno));
+
+        // Size is aligned in order to back the whole region with huge pages.
+        region.size_ = size;
+        region.backing_ = ShmemHugePages() ? ShmBacking::THP
+                                           : ShmBacking::Pages;
+    } else {
+        region.size_ = RoundUp(opts.size, page_size);
+        region.backing_ = ShmBacking::Pages;
+    }
+
+    region.fd_ = Allocate(0, region.size_, page_size, opts.huge_pages,
+                          region.numa_node_);
+    if (region.fd_ == -1) {
+        LOG_ERROR("failed to allocate shared memory of %zu bytes: %s",
+                  region.size_, std::strerror(errno));
+        return std::nullopt;
+    }
+    return region;
+}
+
+SharedRegion::SharedRegion(SharedRegion &&other)
+    : fd_{std::exchange(other.fd_, -1)}, size_{other.size_},
+      backing_{other.backing_}, numa_node_{other.numa_node_} {
+}
+
+SharedRegion &SharedRegion::operator=(SharedRegion &&other) {
+    if (this != &other) {
+        if (fd_ != -1) {
+            close(fd_);
+        }
+        fd_ = std::exchange(other.fd_, -1);
+        size_ = other.size_;
+        backing_ = other.backing_;
+        numa_node_ = other.numa_node_;
+    }
+    return *this;
+}
+
+SharedRegion::~SharedRegion(void) {
+    if (fd_ != -1) {
+        close(fd_);
+    }
+}
+
+} // namespace mlspace
@@ -0,0 +1,88 @@
+// Copyright 2025 Daniel Bershatsky
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include <mlspace/cc/job.h>
+
+namespace mlspace {
+
+// ShmBacking is kind of pages which back shared region.
+enum class ShmBacking {
+    HugeTLB, // Preallocated huge pages (`MFD_HUGETLB`).
+    THP,     // Transparent huge pages of shmem (`MADV_HUGEPAGE`).
+    Pages,   // Regular pages.
+};
+
+std::string_view ToString(ShmBacking backing);
+
+// CpuNode returns NUMA node of `cpu` or `std::nullopt` if unknown.
+std::optional<int> CpuNode(int cpu);
+
+// SharedRegion is an anonymous memory file (memfd) which is created and
+// prefaulted by supervisor and inherited by a job as `MLSPACE_SHM_FD` of
+// `MLSPACE_SHM_SIZE` bytes. Processes map it with `mmap(2)` and share pages
+// without filesystem (e.g. `/dev/shm`) involved. Descendants which do not
+// inherit the descriptor (e.g. spawned with `close_fds`) open it through
+// procfs of supervisor `MLSPACE_SHM_PID`.
+//
+// Backing is chosen in order: hugetlbfs pages, transparent huge pages, and
+// regular pages. Pages are allocated on a NUMA node in advance so that the
+// first touch by a job is neither slow nor on a wrong node.
+class SharedRegion {
+public:
+    static constexpr char const *env_fd = "MLSPACE_SHM_FD";
+    static constexpr char const *env_size = "MLSPACE_SHM_SIZE";
+    static constexpr char const *env_pid = "MLSPACE_SHM_PID";
+
+    static std::optional<SharedRegion> Create(SharedMemory const &opts);
+
+    SharedRegion(SharedRegion &&other);
+
+    SharedRegion &operator=(SharedRegion &&other);
+
+    ~SharedRegion(void);
+
+    int fd(void) const {
+        return fd_;
+    }
+
+    // Size is requested size rounded up to page size.
+    size_t size(void) const {
+        return size_;
+    }
+
+    ShmBacking backing(void) const {
+        return backing_;
+    }
+
+    std::optional<int> numa_node(void) const {
+        return numa_node_;
+    }
+
+private:
+    SharedRegion(void) = default;
+
+    int fd_ = -1;
+    size_t size_ = 0;
+    ShmBacking backing_ = ShmBacking::Pages;
+    std::optional<int> numa_node_;
+};
+
+} // namespace mlspace
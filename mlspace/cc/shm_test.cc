@@ -0,0 +1,75 @@
+// Copyright 2025 Daniel Bershatsky
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <mlspace/cc/shm.h>
+#include <mlspace/cc/supervisor.h>
+
+using mlspace::SharedRegion;
+using mlspace::ShmBacking;
+using mlspace::Supervisor;
+
+TEST(SharedRegion, Pages) {
+    auto region = SharedRegion::Create({.size = 5000, .huge_pages = false});
+    ASSERT_TRUE(region);
+    EXPECT_EQ(region->backing(), ShmBacking::Pages);
+    EXPECT_EQ(region->size() % sysconf(_SC_PAGESIZE), 0);
+    EXPECT_GE(region->size(), 5000);
+
+    struct stat st;
+    ASSERT_EQ(fstat(region->fd(), &st), 0);
+    EXPECT_EQ(st.st_size, region->size());
+}
+
+TEST(SharedRegion, HugePagesFallback) {
+    // Any backing is fine but region must be usable and shared.
+    auto region = SharedRegion::Create({.size = 3 << 20});
+    ASSERT_TRUE(region);
+    EXPECT_EQ(region->size(), 4 << 20);
+
+    auto size = region->size();
+    auto base = static_cast<char *>(mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                                         MAP_SHARED, region->fd(), 0));
+    ASSERT_NE(base, MAP_FAILED);
+    auto pid = fork();
+    ASSERT_NE(pid, -1);
+    if (pid == 0) {
+        std::strcpy(base + size - 16, "hello");
+        _exit(0);
+    }
+    ASSERT_EQ(waitpid(pid, nullptr, 0), pid);
+    EXPECT_STREQ(base + size - 16, "hello");
+    munmap(base, size);
+}
+
+TEST(SharedRegion, Supervisor) {
+    char exe[] = "/bin/sh";
+    char arg0[] = "sh", arg1[] = "-c";
+    char arg2[] = "test -e /proc/self/fd/$MLSPACE_SHM_FD && "
+                  "test \"$MLSPACE_SHM_SIZE\" = 2097152";
+    char *args[] = {arg0, arg1, arg2, nullptr};
+    char *env[] = {nullptr};
+
+    mlspace::SharedMemory shm{.size = 1 << 20};
+    Supervisor supervisor({.shm = shm});
+    EXPECT_EQ(supervisor.Run(exe, args, env, std::nullopt), 0);
+}
@@ -0,0 +1,990 @@
+// Copyright 2025 Daniel Bershatsky
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "supervisor.h"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <charconv>
+#include <csignal>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <nlohmann/json.hpp>
+
+#include <mlspace/cc/log.h>
+#include <mlspace/cc/proc.h>
+
+namespace mlspace {
+
+namespace {
+
+// Signals which are handled by supervisor via signalfd rather than default
+// handlers. They are unblocked in the child right before exec.
+constexpr int handled_signals[] = {SIGCHLD, SIGHUP, SIGINT, SIGTERM};
+
+// Output of a quiet job is written to journal at least that often.
+constexpr std::chrono::seconds journal_flush_interval{30};
+
+sigset_t orig_sigmask;
+
+// SameFile checks whether descriptors refer to the same file.
+bool SameFile(int fd, int other) {
+    struct stat st, other_st;
+    return fstat(fd, &st) == 0 && fstat(other, &other_st) == 0 &&
+           st.st_dev == other_st.st_dev && st.st_ino == other_st.st_ino;
+}
+
+double ToSeconds(timeval const &tv) {
+    return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+double ToSeconds(std::chrono::steady_clock::duration d) {
+    return std::chrono::duration<double>(d).count();
+}
+
+template <typename T> std::optional<T> ParseNumber(std::string_view str) {
+    T value;
+    auto [ptr, ec] = std::from_chars(str.begin(), str.end(), value);
+    if (ec != std::errc() || ptr != str.end()) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+} // namespace
+
+void TailBuffer::Append(std::string_view data) {
+    if (buf_.empty()) {
+        return;
+    }
+    if (data.size() >= buf_.size()) {
+        data = data.substr(data.size() - buf_.size());
+    }
+    auto len = std::min(data.size(), buf_.size() - head_);
+    std::copy_n(data.begin(), len, buf_.begin() + head_);
+    std::copy(data.begin() + len, data.end(), buf_.begin());
+    head_ = (head_ + data.size()) % buf_.size();
+    size_ = std::min(size_ + data.size(), buf_.size());
+}
+
+std::string TailBuffer::Dump(size_t limit) const {
+    auto len = std::min(limit, size_);
+    auto begin = (head_ + buf_.size() - len) % buf_.size();
+    std::string str;
+    str.reserve(len);
+    if (begin + len <= buf_.size()) {
+        str.append(buf_.begin() + begin, buf_.begin() + begin + len);
+    } else {
+        str.append(buf_.begin() + begin, buf_.end());
+        str.append(buf_.begin(), buf_.begin() + (begin + len) % buf_.size());
+    }
+    return str;
+}
+
+std::string_view ToString(OutputRoute route) {
+    switch (route) {
+    case OutputRoute::Console:
+        return "console";
+    case OutputRoute::File:
+        return "file";
+    case OutputRoute::Journal:
+        return "journal";
+    case OutputRoute::Null:
+        return "null";
+    }
+    return "unknown";
+}
+
+Supervisor::Supervisor(Options opts)
+    : opts_{std::move(opts)},
+      progress_{loop_, [this](auto event,
+                              auto payload) { OnProgress(event, payload); }},
+      tail_{opts_.tail_size} {
+    sigset_t mask;
+    sigemptyset(&mask);
+    for (auto signo : handled_signals) {
+        sigaddset(&mask, signo);
+    }
+    sigprocmask(SIG_BLOCK, &mask, &orig_sigmask);
+    signal_fd_ = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+}
+
+Supervisor::~Supervisor(void) {
+    control_.reset();
+    if (journal_) {
+        CloseJournal();
+    }
+    route_writer_.reset();
+    if (io_) {
+        loop_.Remove(io_->fd());
+        io_.reset();
+    }
+    for (int fd : {signal_fd_, stdout_fd_, stderr_fd_, route_fd_}) {
+        if (fd != -1) {
+            loop_.Remove(fd);
+            close(fd);
+        }
+    }
+    sigprocmask(SIG_SETMASK, &orig_sigmask, nullptr);
+}
+
+int Supervisor::Run(char const *exe, char *const *args, char *const *env,
+                    std::optional<std::filesystem::path> const &work_dir) {
+    if (!loop_.IsValid() || signal_fd_ == -1) {
+        LOG_ERROR("failed to initialize event loop: %s", strerror(errno));
+        return 1;
+    }
+    loop_.Add(signal_fd_, EPOLLIN, [this](auto) { OnSignal(); });
+
+    // Control socket is auxiliary so we do not fail if it is not available.
+    if (opts_.control_socket) {
+        control_ = std::make_unique<ControlServer>(
+            loop_, [this](auto const &req) { return Handle(req); });
+        if (!control_->Listen(*opts_.control_socket)) {
+            LOG_WARN("continue without control socket");
+            control_.reset();
+        }
+    }
+
+    if (!progress_.Open()) {
+        LOG_WARN("failed to open progress channel: %s", strerror(errno));
+    }
+
+    // Shared memory is an optimization, so we do not fail without it.
+    if (opts_.shm) {
+        if ((shm_ = SharedRegion::Create(*opts_.shm))) {
+            LOG_INFO("shared memory of %zu bytes is allocated with %s",
+                     shm_->size(), ToString(shm_->backing()).data());
+        } else {
+            LOG_WARN("continue without shared memory");
+        }
+    }
+
+    if (opts_.journal && !Route(OutputRoute::Journal, *opts_.journal)) {
+        LOG_WARN("continue without journal");
+    }
+
+    if (!Spawn(exe, args, env, work_dir)) {
+        return 1;
+    }
+
+    if (!loop_.Run()) {
+        LOG_ERROR("event loop failed: %s", strerror(errno));
+        kill(pid_, SIGKILL);
+        waitpid(pid_, &status_, 0);
+    }
+
+    Summarize();
+    if (profiler_) {
+        profiler_->Write();
+    }
+    if (preemption_ == Preemption::Done) {
+        return exit_checkpointed;
+    } else if (WIFSIGNALED(status_)) {
+        return 128 + WTERMSIG(status_);
+    }
+    return WEXITSTATUS(status_);
+}
+
+bool Supervisor::Spawn(char const *exe, char *const *args, char *const *env,
+                       std::optional<std::filesystem::path> const &work_dir) {
+    int out[2], err[2];
+    if (pipe2(out, O_CLOEXEC) == -1) {
+        LOG_ERROR("failed to create pipe: %s", strerror(errno));
+        return false;
+    }
+    if (pipe2(err, O_CLOEXEC) == -1) {
+        LOG_ERROR("failed to create pipe: %s", strerror(errno));
+        close(out[0]);
+        close(out[1]);
+        return false;
+    }
+
+    // Everything below should be prepared before fork since child must only
+    // issue async-signal-safe calls.
+    for (auto ptr = env; *ptr != nullptr; ++ptr) {
+        env_.push_back(*ptr);
+    }
+    int progress_fd = progress_.write_fd();
+    if (progress_fd != -1) {
+        env_.push_back(const_cast<char *>(progress_.env().data()));
+    }
+    int shm_fd = shm_ ? shm_->fd() : -1;
+    if (shm_fd != -1) {
+        shm_env_[0] = SharedRegion::env_fd + ('=' + std::to_string(shm_fd));
+        shm_env_[1] =
+            SharedRegion::env_size + ('=' + std::to_string(shm_->size()));
+        shm_env_[2] = SharedRegion::env_pid + ('=' + std::to_string(getpid()));
+        env_.push_back(shm_env_[0].data());
+        env_.push_back(shm_env_[1].data());
+        env_.push_back(shm_env_[2].data());
+    }
+    env_.push_back(nullptr);
+
+    // Profiler attaches to the child before exec so that the child waits on
+    // the gate until the write end is closed by the parent.
+    int gate[2] = {-1, -1};
+    if (opts_.profile && pipe2(gate, O_CLOEXEC) == -1) {
+        LOG_WARN("failed to create pipe: %s; continue without profiler",
+                 strerror(errno));
+    }
+
+    if (opts_.before_fork) {
+        opts_.before_fork();
+    }
+
+    char const *dir = work_dir ? work_dir->c_str() : nullptr;
+    started_at_ = std::chrono::steady_clock::now();
+    if (pid_ = fork(); pid_ == 0) {
+        if (gate[0] != -1) {
+            char byte;
+            close(gate[1]);
+            while (read(gate[0], &byte, 1) == -1 && errno == EINTR) {
+            }
+        }
+        sigprocmask(SIG_SETMASK, &orig_sigmask, nullptr);
+        dup2(out[1], STDOUT_FILENO);
+        dup2(err[1], STDERR_FILENO);
+        if (progress_fd != -1) {
+            fcntl(progress_fd, F_SETFD, 0);
+        }
+        if (shm_fd != -1) {
+            fcntl(shm_fd, F_SETFD, 0);
+        }
+        if (dir != nullptr && chdir(dir) == -1) {
+            dprintf(STDERR_FILENO, "failed to change work dir: %s\n",
+                    strerror(errno));
+            _exit(127);
+        }
+        execvpe(exe, args, env_.data());
+        dprintf(STDERR_FILENO, "failed to launch: %s\n", strerror(errno));
+        _exit(127);
+    }
+
+    close(out[1]);
+    close(err[1]);
+    progress_.CloseWriteEnd();
+    if (pid_ != -1 && gate[0] != -1) {
+        profiler_ = std::make_unique<Profiler>(loop_, *opts_.profile);
+        if (!profiler_->Attach(pid_)) {
+            LOG_WARN("continue without profiler");
+            profiler_.reset();
+        }
+    }
+    if (gate[0] != -1) {
+        close(gate[0]);
+        close(gate[1]);
+    }
+    if (pid_ == -1) {
+        LOG_ERROR("failed to fork: %s", strerror(errno));
+        close(out[0]);
+        close(err[0]);
+        return false;
+    }
+
+    LOG_INFO("job command spawned: pid=%d", pid_);
+    state_ = State::Running;
+    if (opts_.sample_interval.count() > 0) {
+        sampler_ =
+            std::make_unique<ThreadSampler>(loop_, opts_.sample_interval);
+        sampler_->Start(pid_);
+    }
+    if (opts_.metrics) {
+        std::vector<SeriesColumn> columns;
+        for (size_t ix = 0; ix != num_thread_states; ++ix) {
+            auto state = ToString(static_cast<ThreadState>(ix));
+            columns.push_back({std::string{state}, SeriesType::Float64});
+        }
+        columns.push_back({"threads", SeriesType::Int32});
+        columns.push_back({"output_bytes", SeriesType::Int64});
+        columns.push_back({"progress", SeriesType::Int64});
+
+        // Block is written every minute or so to survive crash of launch.
+        auto interval = opts_.sample_interval.count() > 0
+                            ? opts_.sample_interval
+                            : std::chrono::milliseconds{1000};
+        SeriesWriter::Options series_opts;
+        series_opts.rows_per_block =
+            std::max<size_t>(60'000 / interval.count(), 1);
+        metrics_ = SeriesWriter::Create(*opts_.metrics, std::move(columns),
+                                        series_opts);
+        if (metrics_) {
+            metrics_timer_ = loop_.AddTimer(interval, interval,
+                                            [this]() { RecordMetrics(); });
+        } else {
+            LOG_WARN("failed to create metrics file %s: %s",
+                     opts_.metrics->c_str(), strerror(errno));
+        }
+    }
+    stdout_fd_ = out[0];
+    stderr_fd_ = err[0];
+    for (auto [fd, console_fd] :
+         {std::pair{stdout_fd_, STDOUT_FILENO},
+          std::pair{stderr_fd_, STDERR_FILENO}}) {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        loop_.Add(fd, EPOLLIN, [this, fd, console_fd](auto) {
+            OnOutput(fd, console_fd);
+        });
+    }
+    return true;
+}
+
+void Supervisor::OnSignal(void) {
+    signalfd_siginfo info;
+    while (read(signal_fd_, &info, sizeof(info)) == sizeof(info)) {
+        switch (int signo = info.ssi_signo; signo) {
+        case SIGCHLD: {
+            int status;
+            rusage usage;
+            if (flush_pid_ != -1 &&
+                waitpid(flush_pid_, &status, WNOHANG) == flush_pid_) {
+                OnFlushed(status);
+            }
+            if (state_ != State::Exited &&
+                wait4(pid_, &status, WNOHANG, &usage) == pid_) {
+                OnExit(status, usage);
+            }
+            break;
+        }
+        case SIGTERM:
+            if (preemption_ != Preemption::None) {
+                LOG_INFO("received SIGTERM: preemption is in progress");
+            } else if (opts_.checkpoint && state_ == State::Running) {
+                LOG_INFO("received SIGTERM: start checkpoint handshake");
+                Preempt();
+            } else {
+                LOG_INFO("received SIGTERM: stop job command");
+                Stop(opts_.stop_timeout);
+            }
+            break;
+        default:
+            LOG_INFO("forward signal %d (%s)", signo, strsignal(signo));
+            Signal(signo);
+            break;
+        }
+    }
+}
+
+void Supervisor::OnOutput(int fd, int console_fd) {
+    char buf[64 << 10];
+    ssize_t len;
+    while ((len = read(fd, buf, sizeof(buf))) > 0) {
+        Forward(console_fd, {buf, static_cast<size_t>(len)});
+    }
+    if (len == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+        loop_.Remove(fd);
+        close(fd);
+        (fd == stdout_fd_ ? stdout_fd_ : stderr_fd_) = -1;
+    }
+}
+
+void Supervisor::OnExit(int status, rusage const &usage) {
+    state_ = State::Exited;
+    status_ = status;
+    usage_ = usage;
+    exited_at_ = std::chrono::steady_clock::now();
+    if (stop_timer_ != -1) {
+        loop_.RemoveTimer(stop_timer_);
+        stop_timer_ = -1;
+    }
+    if (profiler_) {
+        profiler_->Stop();
+    }
+    if (sampler_) {
+        sampler_->Stop();
+    }
+    if (metrics_) {
+        loop_.RemoveTimer(metrics_timer_);
+        metrics_timer_ = -1;
+        RecordMetrics();
+        metrics_->Close();
+    }
+
+    // Drain output left in pipes. Descendants of the child may still hold
+    // write ends so we do not wait for EOF.
+    if (stdout_fd_ != -1) {
+        OnOutput(stdout_fd_, STDOUT_FILENO);
+    }
+    if (stderr_fd_ != -1) {
+        OnOutput(stderr_fd_, STDERR_FILENO);
+    }
+    if (journal_) {
+        journal_->Flush();
+    }
+    if (route_writer_) {
+        route_writer_->Flush();
+    }
+
+    // Job could commit checkpoint and exit right away so that we should look
+    // at the progress channel and marker for the last time.
+    if (preemption_ == Preemption::Waiting) {
+        progress_.Drain();
+        CheckMarker();
+        if (preemption_ == Preemption::Waiting) {
+            LOG_WARN("job command exited without committing checkpoint");
+            preemption_ = Preemption::Failed;
+        }
+    }
+
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        if (preemption_ == Preemption::None) {
+            DumpTail();
+        }
+    }
+    Finish();
+}
+
+void Supervisor::OnProgress(std::string_view event, std::string_view payload) {
+    LOG_DEBUG("progress: %.*s %.*s", static_cast<int>(event.size()),
+              event.data(), static_cast<int>(payload.size()), payload.data());
+    num_progress_ += 1;
+    if (event == "checkpoint") {
+        if (preemption_ == Preemption::Waiting) {
+            OnCommitted("progress channel");
+        } else {
+            LOG_INFO("checkpoint committed: %.*s",
+                     static_cast<int>(payload.size()), payload.data());
+        }
+    }
+}
+
+void Supervisor::Preempt(void) {
+    auto const &ckpt = *opts_.checkpoint;
+    preemption_ = Preemption::Waiting;
+    preempted_at_ = std::chrono::system_clock::now();
+    deadline_ = std::chrono::steady_clock::now() + ckpt.timeout;
+    deadline_timer_ = loop_.AddTimer(ckpt.timeout, {}, [this]() {
+        deadline_timer_ = -1;
+        OnPreemptionDeadline();
+    });
+
+    // Marker is polled rather than watched with inotify since it is usually
+    // placed on network filesystem.
+    if (ckpt.marker) {
+        constexpr std::chrono::milliseconds period{100};
+        marker_timer_ =
+            loop_.AddTimer(period, period, [this]() { CheckMarker(); });
+    }
+
+    LOG_INFO("ask job command to checkpoint with signal %d (%s) in %.3fs",
+             ckpt.signal, strsignal(ckpt.signal),
+             std::chrono::duration<double>(ckpt.timeout).count());
+    if (!Signal(ckpt.signal)) {
+        LOG_WARN("failed to send checkpoint signal: %s", strerror(errno));
+    }
+}
+
+void Supervisor::CheckMarker(void) {
+    auto const &marker = opts_.checkpoint->marker;
+    if (preemption_ != Preemption::Waiting || !marker) {
+        return;
+    }
+
+    // Marker must be touched after preemption; otherwise, it is stale. We
+    // compare with second precision since some filesystems are coarse.
+    struct stat st;
+    if (stat(marker->c_str(), &st) == -1) {
+        return;
+    }
+    auto mtime = std::chrono::system_clock::time_point{
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(
+            std::chrono::seconds{st.st_mtim.tv_sec} +
+            std::chrono::nanoseconds{st.st_mtim.tv_nsec})};
+    if (mtime >= std::chrono::floor<std::chrono::seconds>(preempted_at_)) {
+        OnCommitted("marker");
+    }
+}
+
+void Supervisor::OnCommitted(char const *source) {
+    if (marker_timer_ != -1) {
+        loop_.RemoveTimer(marker_timer_);
+        marker_timer_ = -1;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+        deadline_ - now);
+    LOG_INFO("checkpoint is committed (reported by %s) with %.3fs left",
+             source, std::chrono::duration<double>(left).count());
+
+    // Job has done its part so we terminate it while flushing.
+    Stop(std::max(left, std::chrono::milliseconds{1}));
+
+    auto &flush = opts_.checkpoint->flush;
+    if (flush.empty()) {
+        preemption_ = Preemption::Done;
+        Finish();
+        return;
+    }
+
+    std::vector<char *> args;
+    for (auto &arg : flush) {
+        args.push_back(arg.data());
+    }
+    args.push_back(nullptr);
+
+    preemption_ = Preemption::Flushing;
+    if (flush_pid_ = fork(); flush_pid_ == 0) {
+        sigprocmask(SIG_SETMASK, &orig_sigmask, nullptr);
+        execvpe(args[0], args.data(), env_.data());
+        dprintf(STDERR_FILENO, "failed to launch flush command: %s\n",
+                strerror(errno));
+        _exit(127);
+    } else if (flush_pid_ == -1) {
+        LOG_ERROR("failed to fork flush command: %s", strerror(errno));
+        preemption_ = Preemption::Failed;
+        Finish();
+    } else {
+        LOG_INFO("flush command spawned: pid=%d", flush_pid_);
+    }
+}
+
+void Supervisor::OnFlushed(int status) {
+    flush_pid_ = -1;
+    if (WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+        LOG_INFO("flush command completed");
+        preemption_ = Preemption::Done;
+    } else {
+        LOG_WARN("flush command failed with status %d", status);
+        preemption_ = Preemption::Failed;
+    }
+    Finish();
+}
+
+void Supervisor::OnPreemptionDeadline(void) {
+    if (marker_timer_ != -1) {
+        loop_.RemoveTimer(marker_timer_);
+        marker_timer_ = -1;
+    }
+    switch (preemption_) {
+    case Preemption::Waiting:
+        LOG_WARN("checkpoint is not committed in time");
+        break;
+    case Preemption::Flushing:
+        LOG_WARN("flush command is not completed in time: kill it");
+        kill(flush_pid_, SIGKILL);
+        break;
+    default:
+        return;
+    }
+    preemption_ = Preemption::Failed;
+    if (state_ != State::Exited) {
+        kill(pid_, SIGKILL);
+    }
+}
+
+void Supervisor::Finish(void) {
+    if (state_ != State::Exited || flush_pid_ != -1) {
+        return;
+    }
+    if (deadline_timer_ != -1) {
+        loop_.RemoveTimer(deadline_timer_);
+        deadline_timer_ = -1;
+    }
+    if (marker_timer_ != -1) {
+        loop_.RemoveTimer(marker_timer_);
+        marker_timer_ = -1;
+    }
+    loop_.Stop();
+}
+
+void Supervisor::Forward(int console_fd, std::string_view data) {
+    tail_.Append(data);
+    output_bytes_ += data.size();
+    if (route_writer_ && route_writer_->IsFailed()) {
+        Route(OutputRoute::Console);
+    }
+    switch (route_) {
+    case OutputRoute::Console:
+        WriteAll(console_fd, data);
+        break;
+    case OutputRoute::File:
+        if (route_writer_) {
+            route_writer_->Append(data);
+        } else if (!WriteAll(route_fd_, data)) {
+            LOG_WARN("failed to write output to %s: %s; route to console",
+                     route_path_.c_str(), strerror(errno));
+            Route(OutputRoute::Console);
+            WriteAll(console_fd, data);
+        }
+        break;
+    case OutputRoute::Journal: {
+        auto now = std::chrono::system_clock::now().time_since_epoch();
+        auto time = std::chrono::duration_cast<std::chrono::nanoseconds>(now);
+        if (!journal_->Append(time.count(), data)) {
+            LOG_WARN("failed to write output to journal %s; route to console",
+                     route_path_.c_str());
+            Route(OutputRoute::Console);
+            WriteAll(console_fd, data);
+        }
+        break;
+    }
+    case OutputRoute::Null:
+        break;
+    }
+}
+
+void Supervisor::CloseJournal(void) {
+    loop_.RemoveTimer(journal_timer_);
+    journal_timer_ = -1;
+    journal_->Close();
+    auto ratio = journal_->stored_bytes() > 0
+                     ? static_cast<double>(journal_->raw_bytes()) /
+                           journal_->stored_bytes()
+                     : 0.0;
+    LOG_INFO("journal %s: %zu bytes of output in %zu frames are compressed to "
+             "%zu bytes (%.1fx)",
+             route_path_.c_str(), journal_->raw_bytes(), journal_->num_frames(),
+             journal_->stored_bytes(), ratio);
+    journal_.reset();
+}
+
+void Supervisor::RecordMetrics(void) {
+    std::array<SeriesValue, num_thread_states + 3> row;
+    row[num_thread_states + 1] = output_bytes_;
+    row[num_thread_states + 2] = num_progress_;
+    if (sampler_) {
+        auto total = sampler_->Total();
+        std::copy(total.seconds.begin(), total.seconds.end(), row.begin());
+        row[num_thread_states] = sampler_->num_live_threads();
+    }
+    auto now = std::chrono::system_clock::now().time_since_epoch();
+    auto time = std::chrono::duration_cast<std::chrono::nanoseconds>(now);
+    metrics_->Append(time.count(), row);
+}
+
+void Supervisor::Summarize(void) {
+    if (preemption_ == Preemption::Done) {
+        LOG_INFO("job command is preempted after checkpoint handshake");
+    } else if (preemption_ == Preemption::Failed) {
+        LOG_WARN("job command is preempted but checkpoint handshake failed");
+    }
+    auto wall = ToSeconds(exited_at_ - started_at_);
+    auto user = ToSeconds(usage_.ru_utime);
+    auto sys = ToSeconds(usage_.ru_stime);
+    if (WIFSIGNALED(status_)) {
+        int signo = WTERMSIG(status_);
+        LOG_INFO("job command terminated by signal %d (%s): wall=%.3fs "
+                 "user=%.3fs sys=%.3fs maxrss=%ldkB",
+                 signo, strsignal(signo), wall, user, sys, usage_.ru_maxrss);
+    } else {
+        LOG_INFO("job command completed with exit code %d: wall=%.3fs "
+                 "user=%.3fs sys=%.3fs maxrss=%ldkB",
+                 WEXITSTATUS(status_), wall, user, sys, usage_.ru_maxrss);
+    }
+    if (sampler_ && sampler_->num_samples() > 0) {
+        LOG_INFO("thread states of %zu threads: %s", sampler_->num_threads(),
+                 sampler_->Summary().data());
+    }
+}
+
+ControlResponse Supervisor::Handle(ControlRequest const &req) {
+    auto const &args = req.args;
+    switch (req.verb) {
+    case ControlVerb::Status:
+        return ControlResponse::Ok(Status());
+    case ControlVerb::Rusage:
+        return ControlResponse::Ok(Rusage());
+    case ControlVerb::LogLevel: {
+        std::optional<LogLevel> level;
+        if (args.size() != 1 || !(level = ParseLogLevel(args[0]))) {
+            return ControlResponse::Err("expected one of debug, info, warn, "
+                                        "or error");
+        }
+        SetLogLevel(*level);
+        LOG_INFO("log level is set to %s", args[0].data());
+        return ControlResponse::Ok();
+    }
+    case ControlVerb::Route: {
+        bool ok = false;
+        if (args.size() == 1 && args[0] == "console") {
+            ok = Route(OutputRoute::Console);
+        } else if (args.size() == 1 && args[0] == "null") {
+            ok = Route(OutputRoute::Null);
+        } else if (args.size() == 2 && args[0] == "file") {
+            if (!Route(OutputRoute::File, args[1])) {
+                return ControlResponse::Err("failed to open " + args[1]);
+            }
+            ok = true;
+        } else if (args.size() == 2 && args[0] == "journal") {
+            if (!Route(OutputRoute::Journal, args[1])) {
+                return ControlResponse::Err("failed to open journal " +
+                                            args[1]);
+            }
+            ok = true;
+        }
+        if (!ok) {
+            return ControlResponse::Err("expected console, null, file <path>, "
+                                        "or journal <path>");
+        }
+        return ControlResponse::Ok();
+    }
+    case ControlVerb::Signal: {
+        std::optional<int> signo;
+        if (args.size() != 1 || !(signo = ParseSignal(args[0]))) {
+            return ControlResponse::Err("expected signal name or number");
+        }
+        if (!Signal(*signo)) {
+            return ControlResponse::Err(strerror(errno));
+        }
+        return ControlResponse::Ok();
+    }
+    case ControlVerb::Dump: {
+        std::optional<size_t> limit = SIZE_MAX;
+        if (args.size() > 1 ||
+            (args.size() == 1 && !(limit = ParseNumber<size_t>(args[0])))) {
+            return ControlResponse::Err("expected number of bytes");
+        }
+        nlohmann::json res = {{"bytes", DumpTail(*limit)}};
+        return ControlResponse::Ok(res.dump());
+    }
+    case ControlVerb::Stop: {
+        std::optional<int64_t> timeout = opts_.stop_timeout.count();
+        if (args.size() > 1 ||
+            (args.size() == 1 && !(timeout = ParseNumber<int64_t>(args[0])))) {
+            return ControlResponse::Err("expected timeout in milliseconds");
+        }
+        if (state_ == State::Exited) {
+            return ControlResponse::Err("job command has already exited");
+        }
+        Stop(std::chrono::milliseconds{*timeout});
+        return ControlResponse::Ok();
+    }
+    case ControlVerb::Metrics:
+        if (!sampler_) {
+            return ControlResponse::Err("thread sampler is disabled");
+        }
+        return ControlResponse::Ok(sampler_->ToJSON());
+    }
+    return ControlResponse::Err("unknown request");
+}
+
+std::string Supervisor::Status(void) const {
+    static constexpr char const *states[] = {"starting", "running", "stopping",
+                                             "exited"};
+    auto now = std::chrono::steady_clock::now();
+    nlohmann::json res = {
+        {"pid", pid_},
+        {"state", states[static_cast<int>(state_)]},
+        {"log_level", ToString(GetLogLevel())},
+        {"route", ToString(route_)},
+        {"output_bytes", output_bytes_},
+        {"tail_bytes", tail_.size()},
+    };
+    if (route_ == OutputRoute::File || route_ == OutputRoute::Journal) {
+        res["route_path"] = route_path_.native();
+    }
+    if (journal_) {
+        res["journal"] = {
+            {"frames", journal_->num_frames()},
+            {"raw_bytes", journal_->raw_bytes()},
+            {"stored_bytes", journal_->stored_bytes()},
+        };
+    }
+    if (shm_) {
+        res["shm"] = {
+            {"size", shm_->size()},
+            {"backing", ToString(shm_->backing())},
+            {"numa_node", shm_->numa_node() ? *shm_->numa_node() : -1},
+        };
+    }
+    if (preemption_ != Preemption::None) {
+        static constexpr char const *preemptions[] = {
+            "none", "waiting", "flushing", "done", "failed"};
+        res["preemption"] = preemptions[static_cast<int>(preemption_)];
+    }
+    if (state_ == State::Exited) {
+        res["uptime"] = ToSeconds(exited_at_ - started_at_);
+        if (WIFSIGNALED(status_)) {
+            res["signal"] = WTERMSIG(status_);
+        } else {
+            res["exit_code"] = WEXITSTATUS(status_);
+        }
+    } else {
+        res["uptime"] = ToSeconds(now - started_at_);
+    }
+    return res.dump();
+}
+
+std::string Supervisor::Rusage(void) const {
+    rusage self;
+    getrusage(RUSAGE_SELF, &self);
+    nlohmann::json res = {
+        {"self",
+         {
+             {"utime", ToSeconds(self.ru_utime)},
+             {"stime", ToSeconds(self.ru_stime)},
+             {"maxrss", self.ru_maxrss * 1024},
+         }},
+    };
+
+    // Kernel accounts resource usage of children only once they are waited so
+    // that we read live statistics from procfs.
+    if (state_ == State::Exited) {
+        res["child"] = {
+            {"utime", ToSeconds(usage_.ru_utime)},
+            {"stime", ToSeconds(usage_.ru_stime)},
+            {"maxrss", usage_.ru_maxrss * 1024},
+            {"minflt", usage_.ru_minflt},
+            {"majflt", usage_.ru_majflt},
+        };
+    } else if (auto stat = ReadProcStat(pid_)) {
+        static long const page_size = sysconf(_SC_PAGESIZE);
+        res["child"] = {
+            {"utime", TicksToSeconds(stat->utime)},
+            {"stime", TicksToSeconds(stat->stime)},
+            {"rss", stat->rss * page_size},
+            {"minflt", stat->minflt},
+            {"majflt", stat->majflt},
+            {"num_threads", stat->num_threads},
+        };
+    }
+    return res.dump();
+}
+
+bool Supervisor::Route(OutputRoute route, std::filesystem::path const &path) {
+    int fd = -1;
+    if (route == OutputRoute::File) {
+        fd = open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC,
+                  0644);
+    } else if (route == OutputRoute::Journal) {
+        // Journal is read in order to append to it after restart.
+        fd = open(path.c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    }
+    if (fd == -1 && route != OutputRoute::Console &&
+        route != OutputRoute::Null) {
+        LOG_WARN("failed to open %s: %s", path.c_str(), strerror(errno));
+        return false;
+    }
+
+    // Journal blocks are written synchronously until the journal becomes the
+    // current route.
+    std::optional<JournalWriter> journal;
+    if (route == OutputRoute::Journal) {
+        // Current journal and pending writes must land before the file is
+        // scanned if it is the same file. Otherwise, an in-flight block is
+        // truncated as torn and the rest follows the new header.
+        if (route_fd_ != -1 && SameFile(fd, route_fd_)) {
+            if (journal_) {
+                CloseJournal();
+            }
+            route_writer_.reset();
+        }
+        auto sink = [this, fd](std::string_view data) {
+            if (route_writer_ && route_fd_ == fd) {
+                route_writer_->Append(data);
+                return !route_writer_->IsFailed();
+            }
+            return WriteAll(fd, data);
+        };
+        JournalWriter::Options journal_opts;
+        journal_opts.rank = opts_.rank;
+        journal = JournalWriter::Open(fd, std::move(sink), journal_opts);
+        if (!journal) {
+            LOG_WARN("failed to open journal %s: %s", path.c_str(),
+                     strerror(errno));
+            close(fd);
+            if (route_ == OutputRoute::Journal && !journal_) {
+                Route(OutputRoute::Console); // Current journal is closed.
+            }
+            return false;
+        }
+    }
+
+    if (journal_) {
+        CloseJournal();
+    }
+    route_writer_.reset(); // Wait for pending writes.
+    if (route_fd_ != -1) {
+        close(route_fd_);
+    }
+    route_ = route;
+    route_fd_ = fd;
+    route_path_ = fd != -1 ? path : std::filesystem::path{};
+
+    // File is written asynchronously so that slow disk does not stall the
+    // event loop. Blocking writes are used if there is no engine.
+    if (fd != -1 && !io_) {
+        IoEngine::Options io_opts;
+        io_opts.kind = opts_.io_engine;
+        if ((io_ = IoEngine::Create(io_opts))) {
+            loop_.Add(io_->fd(), EPOLLIN, [this](auto) { io_->Reap(false); });
+            LOG_DEBUG("write job output with %s engine",
+                      ToString(io_->kind()).data());
+        }
+    }
+    if (fd != -1 && io_) {
+        route_writer_ = std::make_unique<LogWriter>(
+            *io_, fd, [this, route](int err, std::string_view data) {
+                LOG_WARN("failed to write output to %s: %s; route to console",
+                         route_path_.c_str(), strerror(err));
+                if (route == OutputRoute::File) {
+                    WriteAll(STDOUT_FILENO, data); // Journal is binary.
+                }
+            });
+    }
+    if (journal) {
+        journal_ = std::move(journal);
+        journal_timer_ = loop_.AddTimer(
+            journal_flush_interval, journal_flush_interval,
+            [this]() { journal_->Flush(); });
+    }
+    LOG_INFO("job output is routed to %s%s%s", ToString(route).data(),
+             route_path_.empty() ? "" : " ", route_path_.c_str());
+    return true;
+}
+
+bool Supervisor::Signal(int signo) {
+    if (state_ == State::Starting || state_ == State::Exited) {
+        errno = ESRCH;
+        return false;
+    }
+    return kill(pid_, signo) == 0;
+}
+
+size_t Supervisor::DumpTail(size_t limit) {
+    auto tail = tail_.Dump(limit);
+    LOG_INFO("tail of job output (last %zu bytes of %zu) follows",
+             tail.size(), output_bytes_);
+    WriteAll(STDERR_FILENO, tail);
+    if (!tail.empty() && tail.back() != '\n') {
+        WriteAll(STDERR_FILENO, "\n");
+    }
+    return tail.size();
+}
+
+void Supervisor::Stop(std::chrono::milliseconds timeout) {
+    if (state_ != State::Running) {
+        return;
+    }
+    state_ = State::Stopping;
+    kill(pid_, SIGTERM);
+    stop_timer_ = loop_.AddTimer(timeout, {}, [this]() {
+        stop_timer_ = -1;
+        if (state_ == State::Stopping) {
+            LOG_WARN("job command is not stopped in time: kill it");
+            kill(pid_, SIGKILL);
+        }
+    });
+}
+
+} // namespace mlspace
@@ -0,0 +1,235 @@
+// Copyright 2025 Daniel Bershatsky
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <sys/resource.h>
+#include <sys/types.h>
+
+#include <mlspace/cc/control.h>
+#include <mlspace/cc/event_loop.h>
+#include <mlspace/cc/io_engine.h>
+#include <mlspace/cc/job.h>
+#include <mlspace/cc/journal.h>
+#include <mlspace/cc/profiler.h>
+#include <mlspace/cc/progress.h>
+#include <mlspace/cc/sampler.h>
+#include <mlspace/cc/series.h>
+#include <mlspace/cc/shm.h>
+
+namespace mlspace {
+
+// TailBuffer is a ring buffer which keeps the last bytes of child output in
+// order to dump them on crash or on request.
+class TailBuffer {
+public:
+    explicit TailBuffer(size_t capacity) : buf_(capacity) {
+    }
+
+    void Append(std::string_view data);
+
+    // Dump returns at most `limit` last bytes in order they were appended.
+    std::string Dump(size_t limit = SIZE_MAX) const;
+
+    size_t size(void) const {
+        return size_;
+    }
+
+    size_t capacity(void) const {
+        return buf_.size();
+    }
+
+private:
+    std::vector<char> buf_;
+    size_t head_ = 0; // Position of the next byte to write.
+    size_t size_ = 0;
+};
+
+// OutputRoute is where the supervisor forwards output of the child.
+enum class OutputRoute {
+    Console, // Stdout and stderr of `launch` itself.
+    File,    // Both streams are appended to a file.
+    Journal, // Both streams are compressed to a journal file.
+    Null,    // Output is discarded (it still goes to tail buffer).
+};
+
+std::string_view ToString(OutputRoute route);
+
+// Supervisor spawns a child process and serves its output, signals, and
+// control requests from a single event loop until the child exits.
+//
+// If checkpoint handshake is configured then SIGTERM is treated as preemption.
+// Supervisor asks the child to save checkpoint, waits until the checkpoint is
+// committed, runs flush command, and exits with `exit_checkpointed` code. So,
+// the next restart can safely resume from the latest checkpoint.
+class Supervisor {
+public:
+    // Exit code on successful checkpoint handshake (EX_TEMPFAIL).
+    static constexpr int exit_checkpointed = 75;
+
+    struct Options {
+        std::optional<std::filesystem::path> control_socket;
+        std::optional<Checkpoint> checkpoint;
+        std::optional<Profile> profile;
+        std::optional<SharedMemory> shm;
+        size_t tail_size = 64 << 10;
+        std::chrono::milliseconds stop_timeout{10'000};
+        // Thread states of process tree are sampled unless it is zero.
+        std::chrono::milliseconds sample_interval{250};
+        // Thread states, output and progress counters are recorded every
+        // sample interval (or every second) to time series if specified.
+        std::optional<std::filesystem::path> metrics;
+        // Output is routed to journal since start if specified. Frames of
+        // journal are tagged with rank.
+        std::optional<std::filesystem::path> journal;
+        int32_t rank = 0;
+        // Engine for writing output routed to file.
+        IoEngineKind io_engine = IoEngineKind::Auto;
+        // Called right before the job is forked when the rest of setup is
+        // done (e.g. to wait until files of the job are read ahead).
+        std::function<void(void)> before_fork;
+    };
+
+    explicit Supervisor(Options opts);
+
+    ~Supervisor(void);
+
+    Supervisor(Supervisor const &) = delete;
+
+    Supervisor &operator=(Supervisor const &) = delete;
+
+    // Run spawns `exe` and serves it until completion. It returns exit code
+    // of `launch`: either exit code of the child or `128 + signo` if the child
+    // is terminated by a signal or `exit_checkpointed` on preemption.
+    int Run(char const *exe, char *const *args, char *const *env,
+            std::optional<std::filesystem::path> const &work_dir);
+
+    // Control handlers. They are invoked from the event loop.
+
+    ControlResponse Handle(ControlRequest const &req);
+
+    std::string Status(void) const;
+
+    std::string Rusage(void) const;
+
+    bool Route(OutputRoute route, std::filesystem::path const &path = {});
+
+    bool Signal(int signo);
+
+    size_t DumpTail(size_t limit = SIZE_MAX);
+
+    void Stop(std::chrono::milliseconds timeout);
+
+private:
+    enum class State {
+        Starting,
+        Running,
+        Stopping,
+        Exited,
+    };
+
+    enum class Preemption {
+        None,
+        Waiting,  // Waiting for checkpoint to be committed.
+        Flushing, // Waiting for flush command.
+        Done,
+        Failed,
+    };
+
+    bool Spawn(char const *exe, char *const *args, char *const *env,
+               std::optional<std::filesystem::path> const &work_dir);
+
+    void OnSignal(void);
+
+    void OnOutput(int fd, int console_fd);
+
+    void OnExit(int status, rusage const &usage);
+
+    void OnProgress(std::string_view event, std::string_view payload);
+
+    void Preempt(void);
+
+    void CheckMarker(void);
+
+    void OnCommitted(char const *source);
+
+    void OnFlushed(int status);
+
+    void OnPreemptionDeadline(void);
+
+    // Finish stops event loop once the child and auxiliary commands exit.
+    void Finish(void);
+
+    void Forward(int console_fd, std::string_view data);
+
+    void CloseJournal(void);
+
+    void RecordMetrics(void);
+
+    void Summarize(void);
+
+    Options opts_;
+    EventLoop loop_;
+    std::unique_ptr<ControlServer> control_;
+    ProgressChannel progress_;
+    std::unique_ptr<Profiler> profiler_;
+    std::unique_ptr<ThreadSampler> sampler_;
+    std::optional<SeriesWriter> metrics_;
+    int metrics_timer_ = -1;
+    uint64_t num_progress_ = 0;
+    std::optional<SharedRegion> shm_;
+    std::string shm_env_[3]; // Descriptor, size, and supervisor pid.
+
+    State state_ = State::Starting;
+    pid_t pid_ = -1;
+    int status_ = 0;
+    rusage usage_ = {};
+    std::chrono::steady_clock::time_point started_at_;
+    std::chrono::steady_clock::time_point exited_at_;
+
+    int signal_fd_ = -1;
+    int stdout_fd_ = -1;
+    int stderr_fd_ = -1;
+    int stop_timer_ = -1;
+
+    Preemption preemption_ = Preemption::None;
+    std::chrono::system_clock::time_point preempted_at_;
+    std::chrono::steady_clock::time_point deadline_;
+    int marker_timer_ = -1;
+    int deadline_timer_ = -1;
+    pid_t flush_pid_ = -1;
+    std::vector<char *> env_;
+
+    OutputRoute route_ = OutputRoute::Console;
+    std::filesystem::path route_path_;
+    int route_fd_ = -1;
+    std::unique_ptr<IoEngine> io_;
+    std::unique_ptr<LogWriter> route_writer_;
+    std::optional<JournalWriter> journal_;
+    int journal_timer_ = -1;
+    uint64_t output_bytes_ = 0;
+    TailBuffer tail_;
+};
+
+} // namespace mlspace
@@ -0,0 +1,356 @@
+// Copyright 2025 Daniel Bershatsky
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <nlohmann/json.hpp>
+
+#include <mlspace/cc/codec.h>
+#include <mlspace/cc/supervisor.h>
+
+using mlspace::Supervisor;
+using mlspace::TailBuffer;
+
+TEST(TailBuffer, Append) {
+    TailBuffer tail(8);
+    EXPECT_EQ(tail.Dump(), "");
+
+    tail.Append("abc");
+    EXPECT_EQ(tail.Dump(), "abc");
+    EXPECT_EQ(tail.Dump(2), "bc");
+
+    tail.Append("defghij");
+    EXPECT_EQ(tail.size(), 8);
+    EXPECT_EQ(tail.Dump(), "cdefghij");
+    EXPECT_EQ(tail.Dump(3), "hij");
+
+    tail.Append("0123456789");
+    EXPECT_EQ(tail.Dump(), "23456789");
+}
+
+TEST(Supervisor, ExitCode) {
+    char exe[] = "/bin/sh";
+    char arg0[] = "sh", arg1[] = "-c", arg2[] = "echo hello; exit 3";
+    char *args[] = {arg0, arg1, arg2, nullptr};
+    char *env[] = {nullptr};
+    Supervisor supervisor({});
+    EXPECT_EQ(supervisor.Run(exe, args, env, std::nullopt), 3);
+}
+
+TEST(Supervisor, KilledBySignal) {
+    char exe[] = "/bin/sh";
+    char arg0[] = "sh", arg1[] = "-c", arg2[] = "kill -USR1 $$";
+    char *args[] = {arg0, arg1, arg2, nullptr};
+    char *env[] = {nullptr};
+    Supervisor supervisor({});
+    EXPECT_EQ(supervisor.Run(exe, args, env, std::nullopt), 128 + SIGUSR1);
+}
+
+TEST(Supervisor, BeforeFork) {
+    auto path = std::filesystem::temp_directory_path() /
+                ("mlspace-fork-" + std::to_string(getpid()));
+    std::filesystem::remove(path);
+    char exe[] = "/bin/sh";
+    char arg0[] = "sh", arg1[] = "-c", arg2[] = "test -f \"$0\"";
+    std::string arg3 = path;
+    char *args[] = {arg0, arg1, arg2, arg3.data(), nullptr};
+    char *env[] = {nullptr};
+    int num_calls = 0;
+    Supervisor::Options opts;
+    opts.before_fork = [&]() {
+        ++num_calls;
+        std::ofstream{path};
+    };
+    Supervisor supervisor(std::move(opts));
+    EXPECT_EQ(supervisor.Run(exe, args, env, std::nullopt), 0);
+    EXPECT_EQ(num_calls, 1);
+    std::filesystem::remove(path);
+}
+
+class RouteTest : public testing::TestWithParam<mlspace::IoEngineKind> {};
+
+TEST_P(RouteTest, File) {
+    auto path = std::filesystem::temp_directory_path() /
+                ("mlspace-route-" + std::to_string(getpid()) + ".log");
+    char exe[] = "/bin/sh";
+    char arg0[] = "sh", arg1[] = "-c",
+         arg2[] = "seq 1 20000; echo error >&2; seq 20001 40000";
+    char *args[] = {arg0, arg1, arg2, nullptr};
+    char *env[] = {nullptr};
+    Supervisor::Options opts;
+    opts.io_engine = GetParam();
+    Supervisor supervisor(std::move(opts));
+    ASSERT_TRUE(supervisor.Route(mlspace::OutputRoute::File, path));
+    EXPECT_EQ(supervisor.Run(exe, args, env, std::nullopt), 0);
+
+    std::ifstream file(path);
+    std::string content{std::istreambuf_iterator<char>(file), {}};
+    std::filesystem::remove(path);
+    std::string expected;
+    for (int ix = 1; ix <= 40000; ++ix) {
+        expected += std::to_string(ix) + '\n';
+    }
+    EXPECT_EQ(content.size(), expected.size() + 6);
+    auto pos = content.find("error\n");
+    ASSERT_NE(pos, content.npos);
+    EXPECT_EQ(content.erase(pos, 6), expected);
+}
+
+INSTANTIATE_TEST_SUITE_P(Engines, RouteTest,
+                         testing::Values(mlspace::IoEngineKind::Uring,
+                                         mlspace::IoEngineKind::Threads));
+
+TEST(Supervisor, CheckpointMarker) {
+    auto marker = std::filesystem::temp_directory_path() / "mlspace-marker";
+    auto flushed = std::filesystem::temp_directory_path() / "mlspace-flushed";
+    std::filesystem::remove(flushed);
+
+    char exe[] = "/bin/sh";
+    char arg0[] = "sh", arg1[] = "-c";
+    std::string script = "trap 'touch " + marker.native() +
+                         "; exit 0' USR1; kill -TERM $PPID; "
+                         "while true; do sleep 0.01; done";
+    char *args[] = {arg0, arg1, script.data(), nullptr};
+    char *env[] = {nullptr};
+
+    mlspace::Checkpoint ckpt;
+    ckpt.marker = marker;
+    ckpt.timeout = std::chrono::seconds{5};
+    ckpt.flush = {"touch", flushed.native()};
+    Supervisor supervisor({.checkpoint = ckpt});
+    EXPECT_EQ(supervisor.Run(exe, args, env, std::nullopt),
+              Supervisor::exit_checkpointed);
+    EXPECT_TRUE(std::filesystem::exists(flushed));
+}
+
+TEST(Supervisor, CheckpointProgress) {
+    char exe[] = "/bin/sh";
+    char arg0[] = "sh", arg1[] = "-c";
+    char arg2[] = "trap 'echo checkpoint > /proc/self/fd/$MLSPACE_PROGRESS_FD'"
+                  " USR1; kill -TERM $PPID; while true; do sleep 0.01; done";
+    char *args[] = {arg0, arg1, arg2, nullptr};
+    char *env[] = {nullptr};
+
+    mlspace::Checkpoint ckpt;
+    ckpt.timeout = std::chrono::seconds{5};
+    Supervisor supervisor({.checkpoint = ckpt});
+    EXPECT_EQ(supervisor.Run(exe, args, env, std::nullopt),
+              Supervisor::exit_checkpointed);
+}
+
+TEST(Supervisor, CheckpointTimeout) {
+    char exe[] = "/bin/sh";
+    char arg0[] = "sh", arg1[] = "-c";
+    char arg2[] = "trap '' USR1; kill -TERM $PPID; while true; do sleep 0.01; "
+                  "done";
+    char *args[] = {arg0, arg1, arg2, nullptr};
+    char *env[] = {nullptr};
+
+    mlspace::Checkpoint ckpt;
+    ckpt.timeout = std::chrono::milliseconds{200};
+    Supervisor supervisor({.checkpoint = ckpt});
+    EXPECT_EQ(supervisor.Run(exe, args, env, std::nullopt), 128 + SIGKILL);
+}
+
+TEST(Supervisor, Metrics) {
+    auto path = std::filesystem::temp_directory_path() / "mlspace-metrics";
+    std::filesystem::remove(path);
+
+    char exe[] = "/bin/sh";
+    char arg0[] = "sh", arg1[] = "-c", arg2[] = "sleep 0.2";
+    char *args[] = {arg0, arg1, arg2, nullptr};
+    char *env[] = {nullptr};
+
+    Supervisor::Options opts;
+    opts.sample_interval = std::chrono::milliseconds{20};
+    opts.metrics = path;
+    Supervisor supervisor(std::move(opts));
+    EXPECT_EQ(supervisor.Run(exe, args, env, std::nullopt), 0);
+
+    std::ifstream in(path, std::ios::binary);
+    std::string content{std::istreambuf_iterator<char>(in), {}};
+    ASSERT_GT(content.size(), 8);
+    EXPECT_TRUE(content.starts_with("MLTS"));
+    EXPECT_TRUE(content.ends_with("MLTS_END"));
+    EXPECT_NE(content.find("DATA"), content.npos);
+    std::filesystem::remove(path);
+}
+
+TEST(Supervisor, Journal) {
+    auto path = std::filesystem::temp_directory_path() / "mlspace-journal";
+    std::filesystem::remove(path);
+
+    char exe[] = "/bin/sh";
+    char arg0[] = "sh", arg1[] = "-c";
+    char arg2[] = "for i in $(seq 1000); do echo step $i loss 0.5; done";
+    char *args[] = {arg0, arg1, arg2, nullptr};
+    char *env[] = {nullptr};
+
+    Supervisor::Options opts;
+    opts.journal = path;
+    opts.rank = 7;
+    {
+        Supervisor supervisor(std::move(opts));
+        EXPECT_EQ(supervisor.Run(exe, args, env, std::nullopt), 0);
+        auto status = nlohmann::json::parse(supervisor.Status());
+        EXPECT_EQ(status["route"], "journal");
+        EXPECT_EQ(status["journal"]["raw_bytes"], status["output_bytes"]);
+    }
+
+    std::ifstream in(path, std::ios::binary);
+    std::string content{std::istreambuf_iterator<char>(in), {}};
+    ASSERT_GT(content.size(), 16);
+    EXPECT_TRUE(content.starts_with("HEAD"));
+    EXPECT_TRUE(content.ends_with("MLJN_END"));
+    EXPECT_LT(content.size(), 4'000); // There are 19 KB of output.
+    std::filesystem::remove(path);
+}
+
+namespace {
+
+template <typename T> T Get(std::string const &buf, size_t offset) {
+    T value;
+    std::memcpy(&value, buf.data() + offset, sizeof(value));
+    return value;
+}
+
+// ReadJournal decodes output of frames which are listed in index chain of
+// journal (see `journal.h`).
+std::string ReadJournal(std::string const &buf) {
+    std::vector<std::string> chunks;
+    auto offset = Get<int64_t>(buf, buf.size() - 16);
+    while (offset != -1) {
+        EXPECT_EQ(buf.substr(offset, 4), "INDX");
+        std::string chunk;
+        for (size_t ix = 0; ix != Get<uint32_t>(buf, offset + 16); ++ix) {
+            auto frame = Get<int64_t>(buf, offset + 24 + 32 * ix);
+            EXPECT_EQ(buf.substr(frame, 4), "FRAM");
+            auto raw_size = Get<uint32_t>(buf, frame + 24);
+            std::string data = buf.substr(
+                frame + 32, Get<uint32_t>(buf, frame + 4) - 24);
+            if (Get<uint32_t>(buf, frame + 28) == 2) {
+                std::string lz(mlspace::LzBound(raw_size), '\0');
+                auto size = mlspace::HuffmanDecode(data, lz.data(), lz.size());
+                lz.resize(size.value_or(0));
+                data = std::move(lz);
+            }
+            std::string raw(raw_size, '\0');
+            mlspace::LzDecompress(data, raw.data(), raw_size);
+            chunk += raw;
+        }
+        chunks.push_back(std::move(chunk));
+        offset = Get<int64_t>(buf, offset + 8);
+    }
+    std::string output;
+    for (auto it = chunks.rbegin(); it != chunks.rend(); ++it) {
+        output += *it;
+    }
+    return output;
+}
+
+// Request sends a control request over a new connection and returns
+// response.
+std::string Request(std::filesystem::path const &socket_path,
+                    std::string const &line) {
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    sockaddr_un addr = {.sun_family = AF_UNIX};
+    std::strncpy(addr.sun_path, socket_path.c_str(),
+                 sizeof(addr.sun_path) - 1);
+    for (int ix = 0; ix != 500; ++ix) {
+        if (connect(fd, reinterpret_cast<sockaddr *>(&addr),
+                    sizeof(addr)) == 0) {
+            break;
+        }
+        usleep(10'000);
+    }
+    write(fd, line.data(), line.size());
+    std::string response;
+    char buf[4096];
+    ssize_t len;
+    while ((len = read(fd, buf, sizeof(buf))) > 0) {
+        response.append(buf, len);
+        if (response.ends_with('\n')) {
+            break;
+        }
+    }
+    close(fd);
+    return response;
+}
+
+} // namespace
+
+TEST(Supervisor, JournalReroute) {
+    auto dir = std::filesystem::temp_directory_path() /
+               ("mlspace-reroute-" + std::to_string(getpid()));
+    std::filesystem::create_directories(dir);
+    auto path = dir / "output.mljn";
+    auto marker = dir / "marker";
+    auto socket_path = dir / "control.sock";
+
+    // Job waits for re-route in the middle of output.
+    char exe[] = "/bin/sh";
+    char arg0[] = "sh", arg1[] = "-c";
+    std::string script = "seq 1 20000; while [ ! -e " + marker.string() +
+                         " ]; do sleep 0.01; done; seq 20001 40000";
+    char *args[] = {arg0, arg1, script.data(), nullptr};
+    char *env[] = {nullptr};
+    std::string expected;
+    for (int ix = 1; ix <= 40000; ++ix) {
+        expected += std::to_string(ix) + '\n';
+    }
+    size_t first_part = expected.find("20001\n");
+
+    Supervisor::Options opts;
+    opts.journal = path;
+    opts.control_socket = socket_path;
+    std::string response;
+    {
+        Supervisor supervisor(std::move(opts));
+        std::thread client([&]() {
+            // Route to the same journal once the first part is in journal.
+            for (int ix = 0; ix != 500; ++ix) {
+                auto status = Request(socket_path, "status\n");
+                if (status.starts_with("ok ") &&
+                    nlohmann::json::parse(status.substr(3))["output_bytes"] ==
+                        first_part) {
+                    break;
+                }
+                usleep(10'000);
+            }
+            response =
+                Request(socket_path, "route journal " + path.string() + "\n");
+            std::ofstream{marker};
+        });
+        EXPECT_EQ(supervisor.Run(exe, args, env, std::nullopt), 0);
+        client.join();
+    }
+    EXPECT_TRUE(response.starts_with("ok")) << response;
+
+    std::ifstream in(path, std::ios::binary);
+    std::string content{std::istreambuf_iterator<char>(in), {}};
+    std::filesystem::remove_all(dir);
+    ASSERT_TRUE(content.ends_with("MLJN_END"));
+    EXPECT_EQ(ReadJournal(content), expected);
+}
@@ -0,0 +1,379 @@
+// Copyright 2025 Daniel Bershatsky
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "symbols.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <cxxabi.h>
+#include <elf.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <mlspace/cc/proc.h>
+
+namespace mlspace {
+
+namespace {
+
+std::string_view NextField(std::string_view &rest) {
+    auto begin = rest.find_first_not_of(' ');
+    if (begin == rest.npos) {
+        rest = {};
+        return {};
+    }
+    auto end = rest.find_first_of(' ', begin);
+    if (end == rest.npos) {
+        end = rest.size();
+    }
+    auto field = rest.substr(begin, end - begin);
+    rest.remove_prefix(end);
+    return field;
+}
+
+bool ParseHex(std::string_view str, uint64_t &value) {
+    auto end = str.data() + str.size();
+    auto res = std::from_chars(str.data(), end, value, 16);
+    return res.ec == std::errc{} && res.ptr == end;
+}
+
+// MappedFile is a read-only memory mapping of a whole file.
+struct MappedFile {
+    void *data = MAP_FAILED;
+    size_t size = 0;
+
+    explicit MappedFile(char const *path) {
+        int fd = open(path, O_RDONLY | O_CLOEXEC);
+        if (fd == -1) {
+            return;
+        }
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            size = st.st_size;
+            data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        }
+        close(fd);
+    }
+
+    ~MappedFile(void) {
+        if (data != MAP_FAILED) {
+            munmap(data, size);
+        }
+    }
+
+    bool IsValid(void) const {
+        return data != MAP_FAILED;
+    }
+
+    // At returns a pointer to `count` objects at `offset` if they are within
+    // the file.
+    template <typename T> T const *At(uint64_t offset, size_t count = 1) const {
+        if (offset > size || count > (size - offset) / sizeof(T)) {
+            return nullptr;
+        }
+        return reinterpret_cast<T const *>(static_cast<char *>(data) + offset);
+    }
+};
+
+} // namespace
+
+std::optional<Mapping> ParseMapping(std::string_view line) {
+    // Format: start-end perms offset dev inode [path].
+    auto rest = line;
+    auto range = NextField(rest);
+    auto perms = NextField(rest);
+    auto offset = NextField(rest);
+    NextField(rest); // dev
+    NextField(rest); // inode
+
+    Mapping mapping;
+    auto dash = range.find('-');
+    if (dash == range.npos || perms.size() < 4 ||
+        !ParseHex(range.substr(0, dash), mapping.start) ||
+        !ParseHex(range.substr(dash + 1), mapping.end) ||
+        !ParseHex(offset, mapping.offset)) {
+        return std::nullopt;
+    }
+    mapping.executable = perms[2] == 'x';
+    if (auto pos = rest.find_first_not_of(' '); pos != rest.npos) {
+        mapping.path = rest.substr(pos);
+        if (mapping.path.ends_with('\n')) {
+            mapping.path.pop_back();
+        }
+    }
+    return mapping;
+}
+
+std::optional<ProcMaps> ProcMaps::Read(pid_t pid) {
+    char path[32];
+    snprintf(path, sizeof(path), "/proc/%d/maps", pid);
+    auto content = ReadFile(path);
+    if (!content) {
+        return std::nullopt;
+    }
+    return Parse(*content);
+}
+
+ProcMaps ProcMaps::Parse(std::string_view content) {
+    ProcMaps maps;
+    while (!content.empty()) {
+        auto end = content.find('\n');
+        auto line = content.substr(0, end);
+        content.remove_prefix(end == content.npos ? content.size() : end + 1);
+        if (auto mapping = ParseMapping(line)) {
+            maps.mappings_.push_back(std::move(*mapping));
+        }
+    }
+    std::sort(maps.mappings_.begin(), maps.mappings_.end(),
+              [](auto const &a, auto const &b) { return a.start < b.start; });
+    return maps;
+}
+
+Mapping const *ProcMaps::Find(uint64_t addr) const {
+    auto less = [](uint64_t addr, auto const &mapping) {
+        return addr < mapping.start;
+    };
+    auto it = std::upper_bound(mappings_.begin(), mappings_.end(), addr, less);
+    if (it == mappings_.begin() || addr >= (--it)->end) {
+        return nullptr;
+    }
+    return &*it;
+}
+
+std::optional<ElfDeps> ReadElfDeps(std::string const &path) {
+    MappedFile file(path.c_str());
+    if (!file.IsValid()) {
+        return std::nullopt;
+    }
+    auto ehdr = file.At<Elf64_Ehdr>(0);
+    if (ehdr == nullptr || std::memcmp(ehdr->e_ident, ELFMAG, SELFMAG) != 0 ||
+        ehdr->e_ident[EI_CLASS] != ELFCLASS64 ||
+        ehdr->e_ident[EI_DATA] != ELFDATA2LSB) {
+        return std::nullopt;
+    }
+    auto phdrs = file.At<Elf64_Phdr>(ehdr->e_phoff, ehdr->e_phnum);
+    if (phdrs == nullptr) {
+        return std::nullopt;
+    }
+
+    ElfDeps deps;
+    deps.machine = ehdr->e_machine;
+    Elf64_Phdr const *dynamic = nullptr;
+    for (size_t ix = 0; ix != ehdr->e_phnum; ++ix) {
+        auto const &phdr = phdrs[ix];
+        if (phdr.p_type == PT_DYNAMIC) {
+            dynamic = &phdr;
+        } else if (phdr.p_type != PT_INTERP) {
+            continue;
+        } else if (auto str = file.At<char>(phdr.p_offset, phdr.p_filesz)) {
+            deps.interp.assign(str, strnlen(str, phdr.p_filesz));
+        }
+    }
+    if (dynamic == nullptr) {
+        return deps;
+    }
+
+    auto num_dyns = dynamic->p_filesz / sizeof(Elf64_Dyn);
+    auto dyns = file.At<Elf64_Dyn>(dynamic->p_offset, num_dyns);
+    if (dyns == nullptr) {
+        return deps;
+    }
+
+    // String table is referred by virtual address, so that it is translated
+    // to file offset with loadable segments.
+    uint64_t strtab = 0, strsz = 0;
+    for (size_t ix = 0; ix != num_dyns && dyns[ix].d_tag != DT_NULL; ++ix) {
+        if (dyns[ix].d_tag == DT_STRTAB) {
+            strtab = dyns[ix].d_un.d_ptr;
+        } else if (dyns[ix].d_tag == DT_STRSZ) {
+            strsz = dyns[ix].d_un.d_val;
+        }
+    }
+    char const *strs = nullptr;
+    for (size_t ix = 0; ix != ehdr->e_phnum; ++ix) {
+        auto const &phdr = phdrs[ix];
+        if (phdr.p_type == PT_LOAD && phdr.p_vaddr <= strtab &&
+            strtab < phdr.p_vaddr + phdr.p_filesz) {
+            strs = file.At<char>(strtab - phdr.p_vaddr + phdr.p_offset, strsz);
+            break;
+        }
+    }
+    if (strs == nullptr) {
+        return deps;
+    }
+
+    auto split = [](std::string_view str, std::vector<std::string> &out) {
+        while (!str.empty()) {
+            auto end = str.find(':');
+            if (auto dir = str.substr(0, end); !dir.empty()) {
+                out.emplace_back(dir);
+            }
+            str.remove_prefix(end == str.npos ? str.size() : end + 1);
+        }
+    };
+    for (size_t ix = 0; ix != num_dyns && dyns[ix].d_tag != DT_NULL; ++ix) {
+        auto offset = dyns[ix].d_un.d_val;
+        if (offset >= strsz) {
+            continue;
+        }
+        std::string_view str{strs + offset, strnlen(strs + offset,
+                                                    strsz - offset)};
+        switch (dyns[ix].d_tag) {
+        case DT_NEEDED:
+            deps.needed.emplace_back(str);
+            break;
+        case DT_RPATH:
+            split(str, deps.rpath);
+            break;
+        case DT_RUNPATH:
+            split(str, deps.runpath);
+            break;
+        }
+    }
+
+    // Loader ignores `DT_RPATH` if `DT_RUNPATH` is present.
+    if (!deps.runpath.empty()) {
+        deps.rpath.clear();
+    }
+    return deps;
+}
+
+std::optional<ElfSymbols> ElfSymbols::Load(std::string const &path) {
+    MappedFile file(path.c_str());
+    if (!file.IsValid()) {
+        return std::nullopt;
+    }
+    auto ehdr = file.At<Elf64_Ehdr>(0);
+    if (ehdr == nullptr || std::memcmp(ehdr->e_ident, ELFMAG, SELFMAG) != 0 ||
+        ehdr->e_ident[EI_CLASS] != ELFCLASS64 ||
+        ehdr->e_ident[EI_DATA] != ELFDATA2LSB) {
+        return std::nullopt;
+    }
+
+    ElfSymbols elf;
+    if (auto phdrs = file.At<Elf64_Phdr>(ehdr->e_phoff, ehdr->e_phnum)) {
+        for (size_t ix = 0; ix != ehdr->e_phnum; ++ix) {
+            if (auto const &phdr = phdrs[ix]; phdr.p_type == PT_LOAD) {
+                elf.segments_.push_back(
+                    {phdr.p_offset, phdr.p_vaddr, phdr.p_filesz});
+            }
+        }
+    }
+
+    auto shdrs = file.At<Elf64_Shdr>(ehdr->e_shoff, ehdr->e_shnum);
+    for (size_t ix = 0; shdrs && ix != ehdr->e_shnum; ++ix) {
+        auto const &shdr = shdrs[ix];
+        if (shdr.sh_type != SHT_SYMTAB && shdr.sh_type != SHT_DYNSYM) {
+            continue;
+        }
+        if (shdr.sh_link >= ehdr->e_shnum) {
+            continue;
+        }
+        auto const &strtab = shdrs[shdr.sh_link];
+        auto strs = file.At<char>(strtab.sh_offset, strtab.sh_size);
+        auto num_syms = shdr.sh_size / sizeof(Elf64_Sym);
+        auto syms = file.At<Elf64_Sym>(shdr.sh_offset, num_syms);
+        if (strs == nullptr || syms == nullptr) {
+            continue;
+        }
+        for (size_t jx = 0; jx != num_syms; ++jx) {
+            auto const &sym = syms[jx];
+            auto type = ELF64_ST_TYPE(sym.st_info);
+            if ((type != STT_FUNC && type != STT_GNU_IFUNC) ||
+                sym.st_shndx == SHN_UNDEF || sym.st_value == 0 ||
+                sym.st_name >= strtab.sh_size) {
+                continue;
+            }
+            auto name = strs + sym.st_name;
+            auto len = strnlen(name, strtab.sh_size - sym.st_name);
+            elf.symbols_.push_back({sym.st_value, sym.st_size,
+                                    static_cast<uint32_t>(elf.names_.size())});
+            elf.names_.append(name, len);
+            elf.names_.push_back('\0');
+        }
+    }
+
+    // Symbols of `.symtab` and `.dynsym` usually overlap.
+    auto &syms = elf.symbols_;
+    auto less = [](auto const &a, auto const &b) { return a.addr < b.addr; };
+    std::stable_sort(syms.begin(), syms.end(), less);
+    auto same = [](auto const &a, auto const &b) { return a.addr == b.addr; };
+    syms.erase(std::unique(syms.begin(), syms.end(), same), syms.end());
+    return elf;
+}
+
+std::optional<std::string_view> ElfSymbols::Lookup(uint64_t offset) const {
+    // Translate file offset to virtual address with loadable segments.
+    auto vaddr = offset;
+    for (auto const &seg : segments_) {
+        if (seg.offset <= offset && offset < seg.offset + seg.size) {
+            vaddr = offset - seg.offset + seg.vaddr;
+            break;
+        }
+    }
+    auto it = std::upper_bound(
+        symbols_.begin(), symbols_.end(), vaddr,
+        [](uint64_t addr, auto const &sym) { return addr < sym.addr; });
+    if (it == symbols_.begin()) {
+        return std::nullopt;
+    }
+    --it;
+    if (it->size != 0 && vaddr >= it->addr + it->size) {
+        return std::nullopt;
+    }
+    return std::string_view{names_.data() + it->name};
+}
+
+std::string Symbolizer::Resolve(std::string const &path, uint64_t offset) {
+    auto it = files_.find(path);
+    if (it == files_.end()) {
+        std::unique_ptr<ElfSymbols> elf;
+        if (!path.empty() && path.front() == '/') {
+            if (auto res = ElfSymbols::Load(path)) {
+                elf = std::make_unique<ElfSymbols>(std::move(*res));
+            }
+        }
+        it = files_.emplace(path, std::move(elf)).first;
+    }
+
+    if (it->second) {
+        if (auto name = it->second->Lookup(offset)) {
+            std::string mangled{*name};
+            int status;
+            char *demangled =
+                abi::__cxa_demangle(mangled.c_str(), nullptr, nullptr, &status);
+            if (status == 0 && demangled != nullptr) {
+                mangled = demangled;
+            }
+            std::free(demangled);
+            return mangled;
+        }
+    }
+
+    auto basename = path.substr(path.find_last_of('/') + 1);
+    if (basename.empty()) {
+        basename = "unknown";
+    }
+    char buf[32];
+    snprintf(buf, sizeof(buf), "+0x%lx]", static_cast<unsigned long>(offset));
+    return '[' + basename + buf;
+}
+
+} // namespace mlspace
@@ -0,0 +1,117 @@
+// Copyright 2025 Daniel Bershatsky
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <sys/types.h>
+
+namespace mlspace {
+
+// Mapping is a line of `/proc/<pid>/maps` (see `man 5 proc`).
+struct Mapping {
+    uint64_t start = 0;
+    uint64_t end = 0;
+    uint64_t offset = 0; // File offset of the start.
+    bool executable = false;
+    std::string path; // Empty for anonymous mappings.
+};
+
+std::optional<Mapping> ParseMapping(std::string_view line);
+
+// ProcMaps is a sorted list of memory mappings of a process.
+class ProcMaps {
+public:
+    static std::optional<ProcMaps> Read(pid_t pid);
+
+    static ProcMaps Parse(std::string_view content);
+
+    // Find returns a mapping which contains `addr` or `nullptr`.
+    Mapping const *Find(uint64_t addr) const;
+
+    std::vector<Mapping> const &mappings(void) const {
+        return mappings_;
+    }
+
+private:
+    std::vector<Mapping> mappings_;
+};
+
+// ElfSymbols is a table of function symbols of an ELF64 file (both `.symtab`
+// and `.dynsym`) together with its loadable segments.
+class ElfSymbols {
+public:
+    static std::optional<ElfSymbols> Load(std::string const &path);
+
+    // Lookup returns raw (mangled) name of function which contains `offset`
+    // in the file or `std::nullopt`. Names are demangled by `Symbolizer`.
+    std::optional<std::string_view> Lookup(uint64_t offset) const;
+
+    size_t size(void) const {
+        return symbols_.size();
+    }
+
+private:
+    struct Symbol {
+        uint64_t addr;
+        uint64_t size;
+        uint32_t name; // Offset in `names_`.
+    };
+
+    struct Segment {
+        uint64_t offset;
+        uint64_t vaddr;
+        uint64_t size;
+    };
+
+    std::vector<Symbol> symbols_; // Sorted by address.
+    std::vector<Segment> segments_;
+    std::string names_; // Null-terminated names one after another.
+};
+
+// ElfDeps are what dynamic loader needs to run an ELF64 file: program
+// interpreter (`PT_INTERP`), needed libraries (`DT_NEEDED`), and library
+// search paths. Dynamic string tokens (e.g. `$ORIGIN`) are not substituted.
+struct ElfDeps {
+    uint16_t machine = 0;
+    std::string interp; // Empty for static executables and libraries.
+    std::vector<std::string> needed;
+    std::vector<std::string> rpath;   // `DT_RPATH` without `DT_RUNPATH`.
+    std::vector<std::string> runpath; // `DT_RUNPATH`.
+};
+
+// ReadElfDeps reads dependencies of ELF64 file or returns `std::nullopt` if
+// it is not an ELF64 file.
+std::optional<ElfDeps> ReadElfDeps(std::string const &path);
+
+// Symbolizer resolves frames `(path, file offset)` to function names. ELF
+// files are loaded once and cached.
+class Symbolizer {
+public:
+    // Resolve returns a demangled function name or `[<basename>+0x<offset>]`
+    // if there is no symbol.
+    std::string Resolve(std::string const &path, uint64_t offset);
+
+private:
+    std::unordered_map<std::string, std::unique_ptr<ElfSymbols>> files_;
+};
+
+} // namespace mlspace
@@ -0,0 +1,179 @@
+// Copyright 2025 Daniel Bershatsky
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "template.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+
+namespace mlspace {
+
+namespace {
+
+constexpr std::array<std::string_view, num_template_vars> var_names = {
+    "RANK",
+    "LOCAL_RANK",
+    "NODE_RANK",
+    "TASK_ID",
+};
+
+// Environment variables which identify a process. The first one found wins.
+constexpr std::array<std::array<std::string_view, 4>, num_template_vars>
+    var_sources = {{
+        {"RANK", "OMPI_COMM_WORLD_RANK", "PMIX_RANK", "SLURM_PROCID"},
+        {"LOCAL_RANK", "OMPI_COMM_WORLD_LOCAL_RANK", "SLURM_LOCALID"},
+        {"NODE_RANK", "GROUP_RANK", "SLURM_NODEID"},
+        {"TASK_ID", "SLURM_ARRAY_TASK_ID"},
+    }};
+
+std::optional<std::string_view> GetEnv(char const *const *env,
+                                       std::string_view name) {
+    for (auto ptr = env; ptr && *ptr; ++ptr) {
+        std::string_view entry{*ptr};
+        if (entry.size() > name.size() && entry[name.size()] == '=' &&
+            entry.starts_with(name)) {
+            return entry.substr(name.size() + 1);
+        }
+    }
+    return std::nullopt;
+}
+
+} // namespace
+
+std::optional<TemplateVar> ParseTemplateVar(std::string_view name) {
+    auto it = std::find(var_names.begin(), var_names.end(), name);
+    if (it == var_names.end()) {
+        return std::nullopt;
+    }
+    return static_cast<TemplateVar>(it - var_names.begin());
+}
+
+std::string_view ToString(TemplateVar var) {
+    return var_names[static_cast<size_t>(var)];
+}
+
+TemplateVars::TemplateVars(void) {
+    values_.fill("0");
+}
+
+void TemplateVars::Set(TemplateVar var, int64_t value) {
+    values_[static_cast<size_t>(var)] = std::to_string(value);
+}
+
+TemplateVars TemplateVars::FromEnv(char const *const *env) {
+    TemplateVars vars;
+    for (size_t ix = 0; ix != num_template_vars; ++ix) {
+        for (auto name : var_sources[ix]) {
+            auto value = name.empty() ? std::nullopt : GetEnv(env, name);
+            int64_t number;
+            if (!value) {
+                continue;
+            }
+            auto end = value->data() + value->size();
+            auto res = std::from_chars(value->data(), end, number);
+            if (res.ec == std::errc{} && res.ptr == end) {
+                vars.Set(static_cast<TemplateVar>(ix), number);
+                break;
+            }
+        }
+    }
+    return vars;
+}
+
+Template Template::Parse(std::string_view str) {
+    Template tmpl;
+    tmpl.text_.reserve(str.size());
+    while (!str.empty()) {
+        auto pos = str.find('$');
+        if (pos == str.npos) {
+            tmpl.Append(str);
+            break;
+        }
+        tmpl.Append(str.substr(0, pos));
+        str.remove_prefix(pos);
+        if (str.starts_with("$${")) {
+            tmpl.Append("${");
+            str.remove_prefix(3);
+            continue;
+        }
+        if (str.starts_with("${")) {
+            auto end = str.find('}');
+            std::optional<TemplateVar> var;
+            if (end != str.npos) {
+                var = ParseTemplateVar(str.substr(2, end - 2));
+            }
+            if (var) {
+                tmpl.Flush();
+                tmpl.segments_.push_back({0, 0, static_cast<int8_t>(*var)});
+                str.remove_prefix(end + 1);
+                continue;
+            }
+        }
+        tmpl.Append(str.substr(0, 1));
+        str.remove_prefix(1);
+    }
+    tmpl.Flush();
+    return tmpl;
+}
+
+bool Template::IsConstant(void) const {
+    return std::none_of(segments_.begin(), segments_.end(),
+                        [](auto const &seg) { return seg.var >= 0; });
+}
+
+size_t Template::Size(TemplateVars const &vars) const {
+    size_t size = 0;
+    for (auto const &seg : segments_) {
+        if (seg.var < 0) {
+            size += seg.size;
+        } else {
+            size += vars[static_cast<TemplateVar>(seg.var)].size();
+        }
+    }
+    return size;
+}
+
+char *Template::Render(TemplateVars const &vars, char *out) const {
+    for (auto const &seg : segments_) {
+        std::string_view value;
+        if (seg.var < 0) {
+            value = std::string_view{text_}.substr(seg.offset, seg.size);
+        } else {
+            value = vars[static_cast<TemplateVar>(seg.var)];
+        }
+        std::memcpy(out, value.data(), value.size());
+        out += value.size();
+    }
+    return out;
+}
+
+std::string Template::ToString(TemplateVars const &vars) const {
+    std::string str(Size(vars), '\0');
+    Render(vars, str.data());
+    return str;
+}
+
+void Template::Append(std::string_view literal) {
+    text_.append(literal);
+}
+
+void Template::Flush(void) {
+    if (auto size = text_.size() - flushed_; size > 0) {
+        segments_.push_back({flushed_, static_cast<uint32_t>(size), -1});
+        flushed_ = text_.size();
+    }
+}
+
+} // namespace mlspace
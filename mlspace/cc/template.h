@@ -0,0 +1,100 @@
+// Copyright 2025 Daniel Bershatsky
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace mlspace {
+
+// TemplateVar is a variable which job args and env values can refer to as
+// `${RANK}`, `${LOCAL_RANK}`, `${NODE_RANK}`, or `${TASK_ID}`.
+enum class TemplateVar : uint8_t {
+    Rank,
+    LocalRank,
+    NodeRank,
+    TaskId,
+};
+
+inline constexpr size_t num_template_vars = 4;
+
+std::optional<TemplateVar> ParseTemplateVar(std::string_view name);
+
+std::string_view ToString(TemplateVar var);
+
+// TemplateVars are values of template variables for a single process. They
+// are kept as strings in order to render templates without formatting.
+class TemplateVars {
+public:
+    TemplateVars(void);
+
+    std::string_view operator[](TemplateVar var) const {
+        return values_[static_cast<size_t>(var)];
+    }
+
+    void Set(TemplateVar var, int64_t value);
+
+    // FromEnv reads process identity provided by platform (or by MPI or
+    // Slurm). Missing variables are zeros.
+    static TemplateVars FromEnv(char const *const *env);
+
+private:
+    std::array<std::string, num_template_vars> values_;
+};
+
+// Template is a string with references to template variables. It is parsed
+// once into a list of segments (either literal or variable) and then it is
+// rendered many times without reparsing. Unknown variables are kept as is
+// (e.g. `${HOME}` for shell) and `$${` is an escaped `${`.
+class Template {
+public:
+    static Template Parse(std::string_view str);
+
+    // IsConstant is true if there are no variables.
+    bool IsConstant(void) const;
+
+    // Size returns size of rendered string without null terminator.
+    size_t Size(TemplateVars const &vars) const;
+
+    // Render writes exactly `Size(vars)` bytes to `out` and returns the end.
+    char *Render(TemplateVars const &vars, char *out) const;
+
+    std::string ToString(TemplateVars const &vars) const;
+
+    size_t num_segments(void) const {
+        return segments_.size();
+    }
+
+private:
+    struct Segment {
+        uint32_t offset; // Offset of literal in `text_`.
+        uint32_t size;
+        int8_t var; // Negative for literal.
+    };
+
+    void Append(std::string_view literal);
+
+    void Flush(void);
+
+    std::string text_; // All literals one after another.
+    uint32_t flushed_ = 0;
+    std::vector<Segment> segments_;
+};
+
+} // namespace mlspace
@@ -0,0 +1,107 @@
+// Copyright 2025 Daniel Bershatsky
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <mlspace/cc/job.h>
+#include <mlspace/cc/template.h>
+
+using mlspace::ExecBuffer;
+using mlspace::Job;
+using mlspace::Template;
+using mlspace::TemplateVar;
+using mlspace::TemplateVars;
+
+TEST(Template, Parse) {
+    TemplateVars vars;
+    vars.Set(TemplateVar::Rank, 12);
+    vars.Set(TemplateVar::LocalRank, 4);
+    vars.Set(TemplateVar::NodeRank, 1);
+    vars.Set(TemplateVar::TaskId, 7);
+
+    auto tmpl = Template::Parse("out/${NODE_RANK}/${LOCAL_RANK}-${RANK}.log");
+    EXPECT_FALSE(tmpl.IsConstant());
+    EXPECT_EQ(tmpl.num_segments(), 7);
+    EXPECT_EQ(tmpl.ToString(vars), "out/1/4-12.log");
+    EXPECT_EQ(tmpl.Size(vars), 14);
+
+    EXPECT_EQ(Template::Parse("${TASK_ID}").ToString(vars), "7");
+    EXPECT_EQ(Template::Parse("").ToString(vars), "");
+    EXPECT_EQ(Template::Parse("").num_segments(), 0);
+}
+
+TEST(Template, Literal) {
+    TemplateVars vars;
+    for (auto str : {"plain", "$HOME", "${HOME}", "$$", "${RANK", "$", "${}"}) {
+        auto tmpl = Template::Parse(str);
+        EXPECT_TRUE(tmpl.IsConstant()) << str;
+        EXPECT_EQ(tmpl.num_segments(), 1) << str;
+        EXPECT_EQ(tmpl.ToString(vars), str);
+    }
+    auto tmpl = Template::Parse("$${RANK}=${RANK}");
+    EXPECT_EQ(tmpl.ToString(vars), "${RANK}=0");
+}
+
+TEST(TemplateVars, FromEnv) {
+    char const *env[] = {"RANKING=9", "OMPI_COMM_WORLD_RANK=5",
+                         "LOCAL_RANK=x", "OMPI_COMM_WORLD_LOCAL_RANK=2",
+                         "NODE_RANK=3", nullptr};
+    auto vars = TemplateVars::FromEnv(env);
+    EXPECT_EQ(vars[TemplateVar::Rank], "5");
+    EXPECT_EQ(vars[TemplateVar::LocalRank], "2");
+    EXPECT_EQ(vars[TemplateVar::NodeRank], "3");
+    EXPECT_EQ(vars[TemplateVar::TaskId], "0");
+}
+
+TEST(ExecBuffer, Build) {
+    auto job = Job::FromJSON(R"({
+        "executable": "python",
+        "args": ["train.py", "--seed=${RANK}", "--out=${TASK_ID}/${RANK}"],
+        "env": {"RANK_FILE": "/tmp/${RANK}", "HOME": "/home/user"},
+        "work_dir": null
+    })");
+    ASSERT_TRUE(job);
+    ASSERT_EQ(job->argv_template.size(), 4);
+    ASSERT_EQ(job->env_template.size(), 2);
+
+    char home[] = "HOME=/root", path[] = "PATH=/bin";
+    char *environ[] = {home, path, nullptr};
+
+    ExecBuffer exec;
+    TemplateVars vars;
+    for (int rank = 0; rank != 256; ++rank) {
+        vars.Set(TemplateVar::Rank, rank);
+        vars.Set(TemplateVar::TaskId, 3);
+        exec.Build(*job, vars, environ);
+
+        std::vector<std::string> argv, envp;
+        for (auto ptr = exec.argv(); *ptr; ++ptr) {
+            argv.emplace_back(*ptr);
+        }
+        for (auto ptr = exec.envp(); *ptr; ++ptr) {
+            envp.emplace_back(*ptr);
+        }
+        auto r = std::to_string(rank);
+        ASSERT_EQ(argv, (std::vector<std::string>{
+                            "python", "train.py", "--seed=" + r,
+                            "--out=3/" + r}));
+        ASSERT_EQ(envp, (std::vector<std::string>{
+                            "HOME=/home/user", "RANK_FILE=/tmp/" + r,
+                            "PATH=/bin"}));
+        ASSERT_EQ(exec.envp()[2], path); // Parent entries are not copied.
+    }
+}
@@ -16,6 +16,7 @@
 
 import json
 import logging
+import shlex
 import sys
 from argparse import ArgumentParser, FileType, Namespace
 from pathlib import Path
@@ -88,9 +89,35 @@ def launch(ns: Namespace) -> int:
                 launch_bin)
 
     # Import all related subpackages as late as possible for better UX.
-    from mlspace.launch import launch
+    from mlspace.launch import (Allocation, Checkpoint, Profile,
+                                SharedMemory, launch)
+
+    checkpoint = None
+    if ns.checkpoint_signal is not None or ns.checkpoint_marker is not None:
+        checkpoint = Checkpoint(
+            signal=ns.checkpoint_signal or 'USR1',
+            marker=ns.checkpoint_marker,
+            timeout=ns.checkpoint_timeout,
+            flush=shlex.split(ns.checkpoint_flush or ''))
+
+    profile = None
+    if ns.profile is not None:
+        profile = Profile(ns.profile, ns.profile_frequency, ns.profile_mode)
+
+    shm = None
+    if ns.shm_size is not None:
+        shm = SharedMemory(ns.shm_size)
+
+    allocation = None
+    if ns.claim_cpus is not None or ns.claim_memory is not None:
+        allocation = Allocation(cpus=ns.claim_cpus or 0,
+                                memory=ns.claim_memory or 0,
+                                timeout=ns.claim_timeout)
+
     with launch(image, command, env, region=ns.region,
-                run_local=ns.local) as job:
+                run_local=ns.local, control_socket=ns.control_socket,
+                metrics=ns.metrics, journal=ns.journal, checkpoint=checkpoint,
+                profile=profile, shm=shm, allocation=allocation) as job:
         if ns.detach:
             job.detach
             return 0
@@ -156,6 +183,53 @@ g_job.add_argument(
     '--launch-bin', type=Path, metavar='PATH',
     help='override path to `launch` binary to use to spawn job')
 
+g_sup = parser.add_argument_group('supervisor options')
+g_sup.add_argument(
+    '--control-socket', type=Path, metavar='PATH',
+    help='listen for control requests on unix socket (see mlspace.control)')
+g_sup.add_argument(
+    '--metrics', type=Path, metavar='PATH',
+    help='record thread states and progress to time series file '
+         '(see mlspace.series)')
+g_sup.add_argument(
+    '--journal', metavar='PATH',
+    help='compress job output to seekable journal; path can refer to '
+         '${RANK} (see mlspace.journal)')
+g_sup.add_argument(
+    '--checkpoint-signal', metavar='SIGNAL',
+    help='on preemption, ask job to checkpoint with signal (default: USR1)')
+g_sup.add_argument(
+    '--checkpoint-marker', type=Path, metavar='PATH',
+    help='file which job touches once checkpoint is committed')
+g_sup.add_argument(
+    '--checkpoint-timeout', type=float, default=60.0, metavar='SECONDS',
+    help='deadline for checkpoint handshake (default: 60)')
+g_sup.add_argument(
+    '--checkpoint-flush', metavar='COMMAND',
+    help='command to run once checkpoint is committed (e.g. uploader)')
+g_sup.add_argument(
+    '--profile', type=Path, metavar='PATH',
+    help='sample call stacks of job and write them in folded format to file')
+g_sup.add_argument(
+    '--profile-frequency', type=int, default=99, metavar='HZ',
+    help='sampling frequency of profiler (default: 99)')
+g_sup.add_argument(
+    '--profile-mode', default='auto', choices=('auto', 'perf', 'proc'),
+    help='sample with perf events, procfs, or perf events with fallback '
+         '(default: auto)')
+g_sup.add_argument(
+    '--shm-size', type=int, metavar='BYTES',
+    help='allocate shared memory for job processes (see mlspace.shm)')
+g_sup.add_argument(
+    '--claim-cpus', type=int, metavar='NUM',
+    help='claim CPUs which are not used by other jobs on the node')
+g_sup.add_argument(
+    '--claim-memory', type=int, metavar='BYTES',
+    help='claim memory budget on the node')
+g_sup.add_argument(
+    '--claim-timeout', type=float, default=0.0, metavar='SECONDS',
+    help='wait for claimed resources to be released (default: 0)')
+
 g_log = parser.add_argument_group('logging options')
 g_log.add_argument(
     '--log-level', default='info', choices=sorted(LOGGING_LEVELS.keys()),
@@ -0,0 +1,139 @@
+# Copyright 2025 Daniel Bershatsky
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Client for control socket of a running `launch` supervisor.
+
+Protocol is line-oriented: a request is a line of space-separated words and a
+response is a line either `ok [<json>]` or `err <message>` (see
+`mlspace/cc/control.h` for the list of requests).
+"""
+
+import json
+import socket
+import sys
+from argparse import ArgumentParser, Namespace
+from os import PathLike
+from typing import Any
+
+__all__ = ('Control', 'ControlError')
+
+LOG_LEVELS = ('debug', 'info', 'warn', 'error')
+
+
+class ControlError(RuntimeError):
+    pass
+
+
+class Control:
+    """Connection to control socket of `launch` supervisor."""
+
+    def __init__(self, path: PathLike | str, timeout: float | None = 5.0):
+        self.path = path
+        self.sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        self.sock.settimeout(timeout)
+        try:
+            self.sock.connect(str(path))
+        except OSError:
+            self.sock.close()
+            raise
+        self.reader = self.sock.makefile('r', encoding='utf-8')
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *args):
+        self.close()
+
+    def close(self):
+        self.reader.close()
+        self.sock.close()
+
+    def request(self, verb: str, *args: Any) -> Any:
+        words = [verb, *(str(x) for x in args)]
+        if any(not w or any(c.isspace() for c in w) for w in words):
+            raise ValueError(f'Words must be non-empty and have no spaces: '
+                             f'{words}.')
+        self.sock.sendall((' '.join(words) + '\n').encode('utf-8'))
+        if not (line := self.reader.readline()):
+            raise ConnectionError('Control socket is closed by supervisor.')
+        status, _, payload = line.rstrip('\n').partition(' ')
+        match status:
+            case 'ok':
+                return json.loads(payload) if payload else None
+            case 'err':
+                raise ControlError(payload)
+            case _:
+                raise ControlError(f'Malformed response: {line!r}.')
+
+    def status(self) -> dict[str, Any]:
+        return self.request('status')
+
+    def rusage(self) -> dict[str, Any]:
+        return self.request('rusage')
+
+    def set_log_level(self, level: str):
+        if level not in LOG_LEVELS:
+            raise ValueError(f'Unknown log level: {level}.')
+        self.request('log-level', level)
+
+    def route(self, target: str, path: PathLike | str | None = None):
+        """Route job output to `console`, `null`, `file` at `path`, or
+        compressed `journal` at `path`.
+        """
+        if target in ('file', 'journal'):
+            if path is None:
+                raise ValueError(f'Path is required to route to {target}.')
+            self.request('route', target, path)
+        else:
+            self.request('route', target)
+
+    def signal(self, sig: int | str):
+        self.request('signal', sig)
+
+    def dump(self, num_bytes: int | None = None) -> int:
+        """Dump tail of job output to supervisor log."""
+        args = () if num_bytes is None else (num_bytes,)
+        return self.request('dump', *args)['bytes']
+
+    def metrics(self) -> dict[str, Any]:
+        """Histogram of thread states (in seconds) of job process tree."""
+        return self.request('metrics')
+
+    def stop(self, timeout: float | None = None):
+        """Terminate job gracefully and kill it in `timeout` seconds."""
+        args = () if timeout is None else (int(timeout * 1000),)
+        self.request('stop', *args)
+
+
+parser = ArgumentParser(description='Send request to control socket.')
+parser.add_argument('socket', help='path to control socket')
+parser.add_argument('verb', help='request verb (e.g. status)')
+parser.add_argument('args', nargs='*', help='request arguments')
+
+
+def main() -> None:
+    ns: Namespace = parser.parse_args()
+    with Control(ns.socket) as ctl:
+        try:
+            res = ctl.request(ns.verb, *ns.args)
+        except ControlError as e:
+            print(f'error: {e}', file=sys.stderr)
+            sys.exit(1)
+    if res is not None:
+        json.dump(res, sys.stdout, ensure_ascii=False, indent=2)
+        print()
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,75 @@
+# Copyright 2025 Daniel Bershatsky
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import socket
+from pathlib import Path
+from threading import Thread
+
+import pytest
+
+from mlspace.control import Control, ControlError
+
+
+def serve(sock: socket.socket, responses: dict[str, str],
+          requests: list[str]):
+    conn, _ = sock.accept()
+    with conn, conn.makefile('rw') as f:
+        for line in f:
+            requests.append(line := line.rstrip('\n'))
+            f.write(responses.get(line, 'err unknown request') + '\n')
+            f.flush()
+
+
+class TestControl:
+
+    RESPONSES = {
+        'status': 'ok {"pid":42,"state":"running"}',
+        'route file /tmp/job.log': 'ok',
+        'route journal /tmp/job.mljn': 'ok',
+        'dump 10': 'ok {"bytes":10}',
+        'stop 1500': 'ok',
+        'metrics': 'ok {"states":{"io":1.5}}',
+        'signal USR1': 'err no such process',
+    }
+
+    def test_requests(self, tmp_path: Path):
+        path = tmp_path / 'control.sock'
+        sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        sock.bind(str(path))
+        sock.listen(1)
+        requests: list[str] = []
+        thread = Thread(target=serve, args=(sock, self.RESPONSES, requests))
+        thread.start()
+        try:
+            with Control(path) as ctl:
+                assert ctl.status() == {'pid': 42, 'state': 'running'}
+                assert ctl.route('file', '/tmp/job.log') is None
+                assert ctl.route('journal', '/tmp/job.mljn') is None
+                with pytest.raises(ValueError):
+                    ctl.route('journal')
+                assert ctl.dump(10) == 10
+                ctl.stop(1.5)
+                assert ctl.metrics()['states'] == {'io': 1.5}
+                with pytest.raises(ControlError, match='no such process'):
+                    ctl.signal('USR1')
+                with pytest.raises(ValueError):
+                    ctl.request('route', 'file', 'with space')
+        finally:
+            thread.join()
+            sock.close()
+        assert requests == [
+            'status', 'route file /tmp/job.log',
+            'route journal /tmp/job.mljn', 'dump 10', 'stop 1500', 'metrics',
+            'signal USR1',
+        ]
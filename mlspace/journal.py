@@ -0,0 +1,347 @@
+# Copyright 2025 Daniel Bershatsky
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""Reader of job output journals which are written by `launch` supervisor
+(see `mlspace/cc/journal.h` for the format).
+
+Output is stored in independently compressed frames. Frames are selected by
+time range and rank with index only, so that only relevant frames are
+decompressed. Decoders are pure Python and need no extra packages.
+
+    with Journal('logs/0.mljn') as journal:
+        for frame in journal.frames(since=t0, until=t1):
+            sys.stdout.buffer.write(journal.read(frame))
+
+Journals of several ranks are merged in order of time from command line.
+
+    python -m mlspace.journal logs/*.mljn --since 2025-01-01T12:00 --rank 3
+"""
+
+import mmap
+import os
+import struct
+import sys
+from argparse import ArgumentParser, Namespace
+from dataclasses import dataclass
+from datetime import datetime
+from heapq import merge
+from os import PathLike
+from typing import Iterable, Iterator
+
+__all__ = ('Frame', 'Journal', 'decompress', 'huffman_decode',
+           'lz_decompress', 'merge_frames')
+
+END_MAGIC = b'MLJN_END'
+
+VERSION = 1
+
+CODEC_LZ = 1
+
+CODEC_LZ_HUFFMAN = 2
+
+MAX_CODE_LEN = 11
+
+BLOCK_HEADER = struct.Struct('<4sI')
+
+HEAD = struct.Struct('<HHi')
+
+FRAME_HEADER = struct.Struct('<qqII')
+
+INDEX_HEADER = struct.Struct('<qII')
+
+INDEX_ENTRY = struct.Struct('<qqqiI')
+
+
+def align(offset: int) -> int:
+    return (offset + 7) & ~7
+
+
+def lz_decompress(src: bytes | memoryview, size: int) -> bytes:
+    """Decompress block in LZ4 format to exactly `size` bytes."""
+    out = bytearray()
+    pos, end = 0, len(src)
+    try:
+        while pos < end:
+            token = src[pos]
+            pos += 1
+            length = token >> 4
+            if length == 15:
+                while (byte := src[pos]) == 255:
+                    length += byte
+                    pos += 1
+                length += byte
+                pos += 1
+            if pos + length > end:
+                raise ValueError('Literals are out of block.')
+            out += src[pos:pos + length]
+            pos += length
+            if pos == end:
+                break  # The last sequence has no match.
+            offset = src[pos] | src[pos + 1] << 8
+            pos += 2
+            length = token & 15
+            if length == 15:
+                while (byte := src[pos]) == 255:
+                    length += byte
+                    pos += 1
+                length += byte
+                pos += 1
+            length += 4
+            if offset == 0 or offset > len(out):
+                raise ValueError(f'Invalid match offset: {offset}.')
+            start = len(out) - offset
+            if offset >= length:
+                out += out[start:start + length]
+            else:
+                # Overlapping match repeats the last `offset` bytes.
+                times, rest = divmod(length, offset)
+                pattern = out[start:]
+                out += pattern * times + pattern[:rest]
+    except IndexError:
+        raise ValueError('Block is truncated.') from None
+    if len(out) != size:
+        raise ValueError(f'Expected {size} bytes but decompressed '
+                         f'{len(out)}.')
+    return bytes(out)
+
+
+def huffman_decode(src: bytes | memoryview) -> bytes:
+    """Decode bytes which are encoded with canonical Huffman codes."""
+    if len(src) < 132:
+        raise ValueError('Header is truncated.')
+    (size,) = struct.unpack_from('<I', src)
+    lens = []
+    for byte in src[4:132]:
+        lens += (byte & 15, byte >> 4)
+    if max(lens) > MAX_CODE_LEN:
+        raise ValueError('Code is too long.')
+
+    # Assign canonical codes and fill table of the next bits (least
+    # significant bit first) to byte and code length.
+    counts = [0] * (MAX_CODE_LEN + 1)
+    for length in lens:
+        counts[length] += 1
+    counts[0] = 0
+    next_code = [0] * (MAX_CODE_LEN + 1)
+    code = 0
+    for length in range(1, MAX_CODE_LEN + 1):
+        code = (code + counts[length - 1]) << 1
+        next_code[length] = code
+        if code + counts[length] > 1 << length:
+            raise ValueError('Code lengths are not a prefix code.')
+    mask = (1 << MAX_CODE_LEN) - 1
+    table = [0] * (mask + 1)
+    for sym, length in enumerate(lens):
+        if length == 0:
+            continue
+        value = next_code[length]
+        next_code[length] += 1
+        reversed_code = int(f'{value:0{length}b}'[::-1], 2)
+        for ix in range(reversed_code, mask + 1, 1 << length):
+            table[ix] = sym << 4 | length
+
+    out = bytearray(size)
+    data = bytes(src[132:])
+    bits, num_bits, pos = 0, 0, 0
+    for ix in range(size):
+        if num_bits < MAX_CODE_LEN and pos < len(data):
+            chunk = data[pos:pos + 6]
+            bits |= int.from_bytes(chunk, 'little') << num_bits
+            num_bits += 8 * len(chunk)
+            pos += len(chunk)
+        entry = table[bits & mask]
+        length = entry & 15
+        if length == 0 or length > num_bits:
+            raise ValueError('Invalid code.')
+        out[ix] = entry >> 4
+        bits >>= length
+        num_bits -= length
+    return bytes(out)
+
+
+def decompress(codec: int, data: bytes | memoryview, size: int) -> bytes:
+    if codec == CODEC_LZ:
+        return lz_decompress(data, size)
+    elif codec == CODEC_LZ_HUFFMAN:
+        return lz_decompress(huffman_decode(data), size)
+    raise ValueError(f'Unknown codec: {codec}.')
+
+
+@dataclass(frozen=True)
+class Frame:
+    offset: int
+
+    first_time: int
+
+    last_time: int
+
+    rank: int
+
+    raw_size: int
+
+
+class Journal:
+    """Journal file mapped to memory for reading."""
+
+    def __init__(self, path: PathLike | str):
+        self.path = path
+        with open(path, 'rb') as fin:
+            if os.fstat(fin.fileno()).st_size < 16:
+                raise ValueError(f'File is too short: {path}.')
+            self.buf = mmap.mmap(fin.fileno(), 0, access=mmap.ACCESS_READ)
+        tag, _ = BLOCK_HEADER.unpack_from(self.buf)
+        if tag != b'HEAD':
+            self.close()
+            raise ValueError(f'Not a journal file: {path}.')
+        self._index: list[Frame] | None = None
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *args):
+        self.close()
+
+    def close(self):
+        self.buf.close()
+
+    def index(self) -> list[Frame]:
+        """List frames in order. Index blocks are followed from the end of
+        file if it is closed properly and file is scanned otherwise.
+        """
+        if self._index is None:
+            if self.buf[-8:] == END_MAGIC:
+                self._index = self._read_index()
+            else:
+                self._index = self._scan()
+        return self._index
+
+    def _read_index(self) -> list[Frame]:
+        chunks: list[list[Frame]] = []
+        (offset,) = struct.unpack_from('<q', self.buf, len(self.buf) - 16)
+        while offset != -1:
+            tag, _ = BLOCK_HEADER.unpack_from(self.buf, offset)
+            if tag != b'INDX':
+                raise ValueError(f'Broken index at offset {offset}.')
+            prev, num_entries, _ = INDEX_HEADER.unpack_from(
+                self.buf, offset + BLOCK_HEADER.size)
+            begin = offset + BLOCK_HEADER.size + INDEX_HEADER.size
+            chunk = []
+            for ix in range(num_entries):
+                chunk.append(Frame(*INDEX_ENTRY.unpack_from(
+                    self.buf, begin + ix * INDEX_ENTRY.size)))
+            chunks.append(chunk)
+            offset = prev
+        return [frame for chunk in reversed(chunks) for frame in chunk]
+
+    def _scan(self) -> list[Frame]:
+        frames = []
+        offset, rank = 0, 0
+        while offset + BLOCK_HEADER.size <= len(self.buf):
+            tag, size = BLOCK_HEADER.unpack_from(self.buf, offset)
+            end = offset + BLOCK_HEADER.size + size
+            if end > len(self.buf):
+                break  # Block is being written or writer crashed.
+            if tag == b'HEAD':
+                version, _, rank = HEAD.unpack_from(
+                    self.buf, offset + BLOCK_HEADER.size)
+                if version != VERSION:
+                    raise ValueError(f'Unsupported version: {version}.')
+            elif tag == b'FRAM':
+                first, last, raw_size, _ = FRAME_HEADER.unpack_from(
+                    self.buf, offset + BLOCK_HEADER.size)
+                frames.append(Frame(offset, first, last, rank, raw_size))
+            offset = align(end)
+        return frames
+
+    def frames(self, since: int | None = None, until: int | None = None,
+               rank: int | None = None) -> Iterator[Frame]:
+        """Iterate over frames which have output in time range `[since,
+        until)` of `rank`. Frames are selected with index only.
+        """
+        for frame in self.index():
+            if since is not None and frame.last_time < since:
+                continue
+            if until is not None and frame.first_time >= until:
+                continue
+            if rank is not None and frame.rank != rank:
+                continue
+            yield frame
+
+    def read(self, frame: Frame) -> bytes:
+        """Decompress output of a frame."""
+        tag, size = BLOCK_HEADER.unpack_from(self.buf, frame.offset)
+        if tag != b'FRAM':
+            raise ValueError(f'No frame at offset {frame.offset}.')
+        offset = frame.offset + BLOCK_HEADER.size
+        _, _, raw_size, codec = FRAME_HEADER.unpack_from(self.buf, offset)
+        begin = offset + FRAME_HEADER.size
+        with memoryview(self.buf) as view:
+            return decompress(codec, view[begin:offset + size], raw_size)
+
+    def __len__(self) -> int:
+        return sum(frame.raw_size for frame in self.index())
+
+
+def parse_time(value: str) -> int:
+    """Parse Unix time in seconds or ISO 8601 date and time (local unless
+    time zone is specified) to nanoseconds.
+    """
+    try:
+        seconds = float(value)
+    except ValueError:
+        seconds = datetime.fromisoformat(value).timestamp()
+    return int(seconds * 1e9)
+
+
+def merge_frames(journals: Iterable[Journal], since: int | None = None,
+                 until: int | None = None, rank: int | None = None,
+                 ) -> Iterator[tuple[Journal, Frame]]:
+    """Merge frames of several journals in order of time."""
+    def frames(journal: Journal) -> Iterator[tuple[Frame, Journal]]:
+        for frame in journal.frames(since, until, rank):
+            yield frame, journal
+    for frame, journal in merge(*[frames(j) for j in journals],
+                                key=lambda x: x[0].first_time):
+        yield journal, frame
+
+
+parser = ArgumentParser(description='Print job output from journals.')
+parser.add_argument('paths', nargs='+', metavar='path',
+                    help='path to journal file')
+parser.add_argument('--since', type=parse_time,
+                    help='Unix time or ISO 8601 date of the earliest output')
+parser.add_argument('--until', type=parse_time,
+                    help='Unix time or ISO 8601 date after the latest output')
+parser.add_argument('--rank', type=int, help='print output of rank only')
+parser.add_argument('--list', action='store_true',
+                    help='list frames instead of printing output')
+
+
+def main() -> None:
+    ns: Namespace = parser.parse_args()
+    journals = [Journal(path) for path in ns.paths]
+    try:
+        frames = merge_frames(journals, ns.since, ns.until, ns.rank)
+        for journal, frame in frames:
+            if ns.list:
+                print(journal.path, frame.offset, frame.rank,
+                      frame.first_time, frame.last_time, frame.raw_size)
+            else:
+                sys.stdout.buffer.write(journal.read(frame))
+    finally:
+        for journal in journals:
+            journal.close()
+
+
+if __name__ == '__main__':
+    main()
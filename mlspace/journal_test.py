@@ -0,0 +1,131 @@
+# Copyright 2025 Daniel Bershatsky
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+import struct
+from pathlib import Path
+
+import pytest
+
+from mlspace.journal import (Journal, huffman_decode, lz_decompress,
+                             merge_frames)
+
+
+def pad(buf: bytes) -> bytes:
+    return buf + b'\0' * (-len(buf) % 8)
+
+
+def block(tag: bytes, payload: bytes) -> bytes:
+    return pad(tag + struct.pack('<I', len(payload)) + payload)
+
+
+def lz_literals(data: bytes) -> bytes:
+    """Compress to a single sequence of literals in LZ4 format."""
+    if len(data) < 15:
+        return bytes([len(data) << 4]) + data
+    length, out = len(data) - 15, bytearray([0xf0])
+    while length >= 255:
+        out.append(255)
+        length -= 255
+    return bytes(out) + bytes([length]) + data
+
+
+def huffman_bytes(data: bytes) -> bytes:
+    """Encode with codes of 8 bits for all bytes, i.e. bytes with reversed
+    bits.
+    """
+    codes = bytes(int(f'{x:08b}'[::-1], 2) for x in data)
+    return struct.pack('<I', len(data)) + b'\x88' * 128 + codes
+
+
+def write_journal(path: Path, frames: list[tuple[int, int, bytes]],
+                  rank: int, index: bool = True):
+    """Write frames of `(first_time, last_time, data)` in the same way as
+    `JournalWriter` does. Odd frames are entropy coded.
+    """
+    out = bytearray(block(b'HEAD', struct.pack('<HHi', 1, 0, rank)))
+    entries = []
+    for ix, (first, last, data) in enumerate(frames):
+        codec, encoded = 1, lz_literals(data)
+        if ix % 2 == 1:
+            codec, encoded = 2, huffman_bytes(encoded)
+        payload = struct.pack('<qqII', first, last, len(data), codec)
+        entries.append((len(out), first, last, rank, len(data)))
+        out += block(b'FRAM', payload + encoded)
+    if index:
+        offset = len(out)
+        payload = struct.pack('<qII', -1, len(entries), 0)
+        for entry in entries:
+            payload += struct.pack('<qqqiI', *entry)
+        payload += struct.pack('<q', offset) + b'MLJN_END'
+        out += block(b'INDX', payload)
+    path.write_bytes(bytes(out))
+
+
+def test_lz_decompress():
+    # Literal `a`, match of 5 bytes at offset 1, and literals.
+    assert lz_decompress(b'\x11a\x01\x00\x50bbbbb', 11) == b'aaaaaabbbbb'
+    # Match of 4 + 15 + 1 bytes at offset 2.
+    assert lz_decompress(b'\x2fab\x02\x00\x01\x00', 22) == b'ab' * 11
+    assert lz_decompress(lz_literals(b'x' * 300), 300) == b'x' * 300
+    with pytest.raises(ValueError):
+        lz_decompress(b'\x11a\x02\x00', 6)  # Offset is out of output.
+    with pytest.raises(ValueError):
+        lz_decompress(b'\x11a\x01', 6)  # Truncated.
+    with pytest.raises(ValueError):
+        lz_decompress(b'\x50abc', 5)
+
+
+def test_huffman_decode():
+    data = b'hello, world'
+    assert huffman_decode(huffman_bytes(data)) == data
+    # Single byte has code of one bit.
+    lens = b'\x00' * 48 + b'\x01' + b'\x00' * 79
+    assert huffman_decode(struct.pack('<I', 5) + lens + b'\0') == b'`' * 5
+    with pytest.raises(ValueError):
+        huffman_decode(struct.pack('<I', 5) + b'\x11' * 128)
+
+
+@pytest.mark.parametrize('index', [True, False], ids=['index', 'scan'])
+def test_journal(tmp_path: Path, index: bool):
+    frames = [(1000 + 100 * i, 1050 + 100 * i, f'frame {i}\n'.encode() * i)
+              for i in range(1, 6)]
+    write_journal(tmp_path / '0.mljn', frames, 3, index)
+    with Journal(tmp_path / '0.mljn') as journal:
+        assert len(journal.index()) == 5
+        assert len(journal) == sum(len(f[2]) for f in frames)
+        assert all(f.rank == 3 for f in journal.index())
+        assert [journal.read(f) for f in journal.frames()] == \
+            [f[2] for f in frames]
+
+        selected = list(journal.frames(since=1240, until=1400))
+        assert [f.first_time for f in selected] == [1200, 1300]
+        assert journal.read(selected[1]) == b'frame 3\n' * 3
+        assert list(journal.frames(rank=0)) == []
+
+
+def test_merge_frames(tmp_path: Path):
+    write_journal(tmp_path / '0.mljn', [(10, 20, b'a'), (30, 40, b'c')], 0)
+    write_journal(tmp_path / '1.mljn', [(20, 30, b'b'), (40, 50, b'd')], 1)
+    journals = [Journal(tmp_path / f'{r}.mljn') for r in (0, 1)]
+    output = b''.join(j.read(f) for j, f in merge_frames(journals))
+    assert output == b'abcd'
+    output = b''.join(j.read(f) for j, f in merge_frames(journals, rank=1))
+    assert output == b'bd'
+    for journal in journals:
+        journal.close()
+
+
+def test_journal_invalid(tmp_path: Path):
+    (tmp_path / 'a.log').write_text('plain text log\n')
+    with pytest.raises(ValueError):
+        Journal(tmp_path / 'a.log')
@@ -12,7 +12,11 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
 #include <cstdio>
+#include <cstdlib>
 #include <cstring>
 #include <filesystem>
 #include <optional>
@@ -20,102 +24,131 @@
 #include <string_view>
 #include <vector>
 
-#include <sys/wait.h>
 #include <unistd.h>
 
 #include <mlspace/cc/base64.h>
 #include <mlspace/cc/cli.h>
 #include <mlspace/cc/job.h>
-
-// TODO(@daskol): Signal traps: sigchild, sigkill, sig...
+#include <mlspace/cc/log.h>
+#include <mlspace/cc/prewarm.h>
+#include <mlspace/cc/proc.h>
+#include <mlspace/cc/registry.h>
+#include <mlspace/cc/supervisor.h>
 
 using mlspace::Job;
+using mlspace::Prewarmer;
+using mlspace::ResourceClaim;
 using mlspace::Spec;
+using mlspace::Supervisor;
 
 namespace {
 
-int Exec(std::string const &exe, std::vector<char *> const &args,
-         std::vector<char *> const &env) {
-    if (pid_t pid = fork(); pid == 0) {
-        if (int ret = execvpe(exe.data(), args.data(), env.data())) {
-            printf("failed to launch: [%d] %s\n", ret, strerror(errno));
-            return 1;
-        } else {
-            return 0;
-        }
-    } else if (pid == -1) {
-        printf("failed to fork: %s\n", strerror(errno));
-        return 1;
-    } else {
-        int status;
-        if (waitpid(pid, &status, 0) == -1) {
-            printf("failed to wait job command: %s\n", strerror(errno));
-            return 1;
-        }
+// Memory budget of a claim is exported to a job in bytes.
+constexpr char const *env_memory_budget = "MLSPACE_MEMORY_BUDGET";
+
+// AcquireClaim claims resources of `job` in node-local registry and narrows
+// job to them: CPUs, NUMA node of shared memory, and memory budget in
+// environment.
+std::optional<ResourceClaim> AcquireClaim(Job &job) {
+    auto const &alloc = *job.allocation;
+    auto nodes = mlspace::ReadNumaNodes();
+    auto pool = job.cpus.empty() ? mlspace::GetAffinity(0)
+                                 : std::optional{job.cpus};
+    if (!nodes || !pool) {
+        LOG_ERROR("failed to read cpu topology: %s", std::strerror(errno));
+        return std::nullopt;
+    }
+    auto claim = ResourceClaim::Acquire(alloc, *nodes, *pool);
+    if (!claim) {
+        LOG_ERROR("failed to claim %zu cpus and %zu bytes of memory in %s: %s",
+                  alloc.cpus, alloc.memory, alloc.registry.c_str(),
+                  std::strerror(errno));
+        return std::nullopt;
+    }
 
-        printf("job command completed with exit code %d\n",
-               WEXITSTATUS(status));
-        return 0;
+    auto const &res = claim->claim();
+    LOG_INFO("claimed %zu cpus and %zu bytes of memory on node %d",
+             res.cpus.size(), res.memory, res.node);
+    if (!res.cpus.empty()) {
+        job.cpus = res.cpus;
+    }
+    if (job.shm && !job.shm->numa_node && res.node != -1) {
+        job.shm->numa_node = res.node;
     }
+    if (res.memory != 0 && !job.env.contains(env_memory_budget)) {
+        auto value = std::to_string(res.memory);
+        job.env.emplace(env_memory_budget, value);
+        auto &env = job.env_template;
+        auto pos = std::lower_bound(
+            env.begin(), env.end(), env_memory_budget,
+            [](auto const &entry, auto key) { return entry.first < key; });
+        env.emplace(pos, env_memory_budget, mlspace::Template::Parse(value));
+    }
+    return claim;
 }
 
 // Spawn spawns a new process and executes in user-specified command.
 int Spawn(Job job) {
-    // Prepare subprocess command line arguments.
-    std::vector<char *> args;
-    args.reserve(job.args.size() + 2);
-    args.push_back(job.executable.data());
-    for (auto &arg : job.args) {
-        args.push_back(arg.data());
-    }
-    args.push_back(nullptr);
-
-    // Prepare subprocess environment variables.
-    std::vector<std::string> env_owner;
-    std::vector<char *> env;
-    env_owner.reserve(job.env.size() + 1);
-    env.reserve(job.env.size() + 1);
-    for (auto &[k, v] : job.env) {
-        // TODO(@daskol): Is it nessesary to join with '='?
-        env_owner.push_back(k + '=' + v);
-        env.push_back(env_owner.back().data());
+    // Instantiate args and env templates for this process. Its identity
+    // (rank, etc.) is provided by platform in environment variables.
+    auto vars = mlspace::TemplateVars::FromEnv(environ);
+    mlspace::ExecBuffer exec;
+    exec.Build(job, vars, environ);
+
+    // Page in executable and its shared libraries while the rest of job is
+    // set up (resources are claimed, shared memory is populated, etc.), so
+    // that loader does not fault on cold files after `execve`. Files are
+    // resolved from rendered executable and environment of job.
+    Prewarmer::Options prewarm_opts;
+    prewarm_opts.executable = exec.argv()[0];
+    prewarm_opts.work_dir = job.work_dir;
+    if (auto path = std::getenv("PATH")) {
+        prewarm_opts.path = path;
     }
-
-    // Add environment variables of parent process.
-    for (auto ptr = environ; *ptr != nullptr; ++ptr) {
-        std::string_view str(*ptr), key = str;
-        auto offset = str.find_first_of('=');
-        if (offset != str.npos) {
-            key = str.substr(0, offset);
-        }
-        if (!job.env.contains(std::string{key})) {
-            env.push_back(*ptr);
+    std::string_view ld_library_path = "LD_LIBRARY_PATH=";
+    for (auto it = exec.envp(); *it; ++it) {
+        if (std::string_view entry{*it}; entry.starts_with(ld_library_path)) {
+            prewarm_opts.library_path = entry.substr(ld_library_path.size());
+            break;
         }
     }
+    Prewarmer prewarmer(std::move(prewarm_opts));
 
-    // Array of environ veriables is NULL-terminated.
-    env.push_back(nullptr);
-
-    std::error_code ec;
-    std::filesystem::path curr_dir;
-    if (job.work_dir) {
-        curr_dir = std::filesystem::current_path();
-        std::filesystem::current_path(*job.work_dir, ec);
-        if (ec) {
-            printf("failed to change work dir: %s\n", ec.message().data());
+    // Resources are held until supervisor exits. Claim may add memory budget
+    // to environment of job, so templates are rendered once again.
+    std::optional<ResourceClaim> claim;
+    if (job.allocation) {
+        if (!(claim = AcquireClaim(job))) {
             return 1;
         }
+        exec.Build(job, vars, environ);
     }
 
-    int ret = Exec(job.executable, args, env);
+    // Supervisor pins itself so that the job and all its children inherit
+    // CPU mask since the very beginning.
+    if (!job.cpus.empty() && !mlspace::SetAffinity(0, job.cpus)) {
+        LOG_ERROR("failed to set cpu affinity: %s", std::strerror(errno));
+        return 1;
+    }
 
-    if (job.work_dir) {
-        std::filesystem::current_path(curr_dir, ec);
-        if (ec) {
-            printf("failed to restore work dir: %s\n", ec.message().data());
-        }
+    Supervisor::Options opts;
+    opts.control_socket = job.control_socket;
+    opts.metrics = job.metrics;
+    if (job.journal) {
+        auto path = mlspace::Template::Parse(job.journal->native());
+        opts.journal = path.ToString(vars);
+        auto rank = vars[mlspace::TemplateVar::Rank];
+        std::from_chars(rank.data(), rank.data() + rank.size(), opts.rank);
     }
-    return ret;
+    opts.checkpoint = job.checkpoint;
+    opts.profile = job.profile;
+    opts.shm = job.shm;
+    // Read ahead overlaps with setup of supervisor and it is awaited right
+    // before fork, so that `execve` hits page cache.
+    opts.before_fork = [&prewarmer]() { prewarmer.Wait(); };
+    Supervisor supervisor(std::move(opts));
+    return supervisor.Run(exec.argv()[0], exec.argv(), exec.envp(),
+                          job.work_dir);
 }
 
 int Run(std::vector<std::string_view> const &args) {
@@ -123,38 +156,40 @@ int Run(std::vector<std::string_view> const &args) {
     if (auto res = Spec::FromArgs(args)) {
         spec = std::move(*res);
     } else {
-        printf("failed to parse command line\n");
+        LOG_ERROR("failed to parse command line");
         return 1;
     }
 
-    printf("--opt-version=%zu\n", spec.version);
-    printf("--opt-num-chunks=%zu\n", spec.num_chunks);
-    printf("--opt-sha256sum=%s\n", spec.sha256sum.data());
+    LOG_DEBUG("--opt-version=%zu", spec.version);
+    LOG_DEBUG("--opt-num-chunks=%zu", spec.num_chunks);
+    LOG_DEBUG("--opt-sha256sum=%s", spec.sha256sum.data());
     for (auto ix = 0; ix != spec.chunks.size(); ++ix) {
-        printf("--opt-chunk-%d=%s\n", ix, spec.chunks[ix].data());
+        LOG_DEBUG("--opt-chunk-%d=%s", ix, spec.chunks[ix].data());
     }
 
     mlspace::Base64 base64;
-    auto decoded_chunk = base64.Decode(std::string{spec.chunks[0]});
-    printf("decoded: %s\n", decoded_chunk->data());
+    auto decoded_chunk = base64.Decode(spec.chunks[0]);
+    LOG_DEBUG("decoded: %s", decoded_chunk->data());
 
     auto job = Job::FromJSON(*decoded_chunk);
     if (!job) {
-        printf("failed to parse json to job\n");
+        LOG_ERROR("failed to parse json to job");
         return 1;
     }
-    printf("executable: %s\n", job->executable.data());
-    printf("args: [");
+
+    std::string args_str;
     for (auto const &arg : job->args) {
-        printf(" %s", arg.data());
+        args_str += ' ';
+        args_str += arg;
     }
-    printf(" ]\n");
+    LOG_INFO("executable: %s", job->executable.data());
+    LOG_INFO("args: [%s ]", args_str.data());
 
-    printf("env: [");
+    std::string env_str;
     for (auto const &[k, v] : job->env) {
-        printf(" %s=%s", k.data(), v.data());
+        env_str += ' ' + k + '=' + v;
     }
-    printf(" ]\n");
+    LOG_INFO("env: [%s ]", env_str.data());
 
     return Spawn(*job);
 }
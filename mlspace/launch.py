@@ -12,17 +12,25 @@
 # See the License for the specific language governing permissions and
 # limitations under the License.
 
+import asyncio
 import json
 import logging
+import os
+import selectors
+import signal
+import socket
 import sys
+import tempfile
+import time
 from base64 import b64encode
-from contextlib import contextmanager
+from contextlib import asynccontextmanager, contextmanager
 from copy import deepcopy
-from dataclasses import dataclass, field, fields
+from dataclasses import asdict, dataclass, field, fields, replace
+from functools import cache
 from os import PathLike
 from pathlib import Path
-from subprocess import Popen
-from typing import Any, ClassVar, Iterator, cast
+from subprocess import STDOUT, Popen
+from typing import Any, AsyncIterator, ClassVar, Iterator, Literal, cast
 from uuid import uuid4
 
 if sys.version_info >= (3, 11):
@@ -35,6 +43,30 @@ from mlspace import config
 logger = logging.getLogger(__name__)
 
 
+async def wait_process(proc: Popen):
+    """Wait for process termination without blocking event loop. Process is
+    not reaped.
+    """
+    if proc.poll() is not None:
+        return
+    try:
+        fd = os.pidfd_open(proc.pid)
+    except (AttributeError, OSError):
+        # There is no pidfd (e.g. old kernel) so we fallback to polling.
+        while proc.poll() is None:
+            await asyncio.sleep(0.1)
+        return
+
+    loop = asyncio.get_running_loop()
+    done = loop.create_future()
+    loop.add_reader(fd, lambda: done.done() or done.set_result(None))
+    try:
+        await done
+    finally:
+        loop.remove_reader(fd)
+        os.close(fd)
+
+
 class Runner:
 
     def join(self, job: 'Job'):
@@ -46,22 +78,156 @@ class Runner:
     def detach(self, job: 'Job'):
         raise NotImplementedError
 
+    async def ajoin(self, job: 'Job'):
+        """Asynchronous :meth:`join`. By default, it occupies a thread."""
+        await asyncio.to_thread(self.join, job)
+
+    async def alaunch(self, job: 'Job', launch_bin: Path):
+        """Asynchronous :meth:`launch`. By default, it occupies a thread."""
+        await asyncio.to_thread(self.launch, job, launch_bin)
+
+
+def partition_cpus(cpus_per_job: int) -> list[list[int]]:
+    """Split CPUs available to the current process on disjoint sets of
+    `cpus_per_job` adjacent CPUs.
+    """
+    if cpus_per_job <= 0:
+        raise ValueError(f'Number of CPUs must be positive: {cpus_per_job}.')
+    cpus = sorted(os.sched_getaffinity(0))
+    return [cpus[i:i + cpus_per_job]
+            for i in range(0, len(cpus) - cpus_per_job + 1, cpus_per_job)]
+
 
 class LocalRunner(Runner):
-    """Local runner execute `launch` binary directly on local system."""
+    """Local runner execute `launch` binary directly on local system.
+
+    At most `max_jobs` jobs run at once: :meth:`launch` blocks until a running
+    job finishes. If `cpus_per_job` is specified then available CPUs are
+    partitioned on disjoint sets and every job is pinned to its own set (so
+    `max_jobs` is at most number of sets). If `log_dir` is specified then
+    output of a job is redirected to `<log_dir>/<job-id>.log`.
+
+    Jobs are awaited all at once with :meth:`join_any` and :meth:`join_all`
+    which wait on pidfds of running jobs.
+    """
 
-    def __init__(self) -> None:
+    def __init__(self, max_jobs: int | None = None,
+                 cpus_per_job: int | None = None,
+                 log_dir: PathLike | None = None) -> None:
         super().__init__()
-        self.procs: dict[str, Popen] = {}
+        self.procs: dict[str, Popen] = {}  # Processes of running jobs.
+        self.jobs: dict[str, 'Job'] = {}  # Running jobs.
+        self.returncodes: dict[str, int] = {}
+        self.log_dir = Path(log_dir) if log_dir is not None else None
+
+        self.cpusets: list[list[int]] | None = None
+        self.assigned: dict[str, list[int]] = {}
+        if cpus_per_job is not None:
+            if not (cpusets := partition_cpus(cpus_per_job)):
+                raise ValueError(f'There are less than {cpus_per_job} CPUs.')
+            self.cpusets = cpusets
+            max_jobs = min(max_jobs or len(cpusets), len(cpusets))
+        if max_jobs is not None and max_jobs <= 0:
+            raise ValueError(f'Number of jobs must be positive: {max_jobs}.')
+        self.max_jobs = max_jobs
+
+        self.selector = selectors.DefaultSelector()
+        self.pidfds: dict[str, int] = {}
+
+    @property
+    def running(self) -> list['Job']:
+        return list(self.jobs.values())
+
+    def log_path(self, job: 'Job') -> Path | None:
+        if self.log_dir is None or job._id is None:
+            return None
+        return self.log_dir / f'{job._id}.log'
 
     def join(self, job: 'Job'):
         if (job_id := job._id) is None:
             raise RuntimeError('Job has no assigned identifier.')
-        proc = self.procs[job_id]
-        code = proc.wait()
-        logger.info('locally spawned job finished: retcode=%d', code)
+        if job_id in self.jobs:
+            self.procs[job_id].wait()
+            self.reap(job_id)
+
+    def join_any(self, timeout: float | None = None) -> 'Job | None':
+        """Wait until any running job finishes and return it. It returns
+        `None` on timeout or if there is no running job.
+        """
+        if not self.jobs:
+            return None
+        if len(self.pidfds) < len(self.jobs):
+            return self.poll_any(timeout)  # There is no pidfd support.
+        for key, _ in self.selector.select(timeout):
+            return self.reap(key.data)
+        return None
+
+    def join_all(self, timeout: float | None = None) -> list['Job']:
+        """Wait until all running jobs finish. Jobs are returned in order of
+        their completion. On timeout, some jobs may still run.
+        """
+        deadline = None if timeout is None else time.monotonic() + timeout
+        jobs: list['Job'] = []
+        while self.jobs:
+            if deadline is not None:
+                if (timeout := deadline - time.monotonic()) <= 0:
+                    break
+            if (job := self.join_any(timeout)) is not None:
+                jobs.append(job)
+        return jobs
+
+    def poll_any(self, timeout: float | None) -> 'Job | None':
+        deadline = None if timeout is None else time.monotonic() + timeout
+        while True:
+            for job_id, job in self.jobs.items():
+                if self.procs[job_id].poll() is not None:
+                    return self.reap(job_id)
+            if deadline is not None and time.monotonic() >= deadline:
+                return None
+            time.sleep(0.05)
+
+    def reap(self, job_id: str) -> 'Job':
+        """Collect exit code of finished job and release its resources."""
+        code = self.procs.pop(job_id).wait()
+        self.returncodes[job_id] = code
+        if (pidfd := self.pidfds.pop(job_id, None)) is not None:
+            self.selector.unregister(pidfd)
+            os.close(pidfd)
+        if (cpus := self.assigned.pop(job_id, None)) is not None:
+            cast(list, self.cpusets).append(cpus)
+        job = self.jobs.pop(job_id)
+        logger.info('locally spawned job %s finished: retcode=%d', job_id,
+                    code)
+        return job
+
+    async def ajoin(self, job: 'Job'):
+        if (job_id := job._id) is None:
+            raise RuntimeError('Job has no assigned identifier.')
+        if job_id in self.jobs:
+            await wait_process(self.procs[job_id])
+            if job_id in self.jobs:  # It could be reaped concurrently.
+                self.reap(job_id)
+
+    async def alaunch(self, job: 'Job', launch_bin: Path):
+        # Slot is released by `ajoin` or by reaping of finished jobs here.
+        while self.max_jobs is not None and len(self.jobs) >= self.max_jobs:
+            if self.join_any(0) is None:
+                await asyncio.sleep(0.05)
+        self.launch(job, launch_bin)  # Spawning does not block.
 
     def launch(self, job: 'Job', launch_bin: Path):
+        # Wait for a free slot.
+        while self.max_jobs is not None and len(self.jobs) >= self.max_jobs:
+            self.join_any()
+        self.spawn(job, launch_bin, str(uuid4()))
+
+    def spawn(self, job: 'Job', launch_bin: Path, job_id: str,
+              env: dict[str, str] | None = None):
+        """Spawn `launch` with `env` added to its environment."""
+        job._id = job_id
+        if self.cpusets is not None and job.cpus is None:
+            job.cpus = self.assigned[job_id] = self.cpusets.pop(0)
+
         # Encode job spec as chunked base64-encoded JSON.
         flags = Spec.from_job(job).to_flags_dict()
         command = [str(launch_bin.resolve())]
@@ -73,14 +239,167 @@ class LocalRunner(Runner):
             command += [flag, v]
 
         # TODO(@daskol): Find proper way to detach child process.
-        job_id = str(uuid4())
-        job._id = job_id
-        self.procs[job_id] = Popen(command, start_new_session=True)
+        if (log_path := self.log_path(job)) is None:
+            proc = Popen(command, start_new_session=True, env=env)
+        else:
+            log_path.parent.mkdir(parents=True, exist_ok=True)
+            with open(log_path, 'ab') as fout:
+                proc = Popen(command, start_new_session=True, env=env,
+                             stdout=fout, stderr=STDOUT)
+        self.procs[job_id] = proc
+        self.jobs[job_id] = job
+
+        try:
+            pidfd = os.pidfd_open(proc.pid)
+        except (AttributeError, OSError):
+            return  # Fallback to polling.
+        self.pidfds[job_id] = pidfd
+        self.selector.register(pidfd, selectors.EVENT_READ, job_id)
 
     def detach(self, job: 'Job'):
+        """Stop tracking of a job. Its slot and CPUs are released so that the
+        next job may share CPUs with detached one.
+        """
         if (job_id := job._id) is None:
             raise RuntimeError('Job has no assigned identifier.')
-        self.procs.pop(job_id)
+        self.procs.pop(job_id, None)
+        self.jobs.pop(job_id, None)
+        if (cpus := self.assigned.pop(job_id, None)) is not None:
+            cast(list, self.cpusets).append(cpus)
+        if (pidfd := self.pidfds.pop(job_id, None)) is not None:
+            self.selector.unregister(pidfd)
+            os.close(pidfd)
+
+
+@cache
+def default_runner() -> LocalRunner:
+    """Return runner of jobs which are created without one. It is created on
+    the first use and shared by all such jobs.
+    """
+    return LocalRunner()
+
+
+class LocalClusterRunner(LocalRunner):
+    """Runner which simulates multi-worker job on local machine.
+
+    Every job is run as `n_workers` instances of `launch`. Like on the
+    platform, every `launch` gets worker identity in environment variables
+    (`WORLD_SIZE`, `RANK`, `NODE_RANK`, `LOCAL_RANK`, `LOCAL_WORLD_SIZE`,
+    `MASTER_ADDR`, and `MASTER_PORT`) which are inherited by a job (and
+    substituted to templates like `${RANK}`). Each worker has its own work and
+    scratch (`TMPDIR`) directories in `<root>/<job-id>/<rank>`. Workers
+    communicate over loopback. Output of a worker goes to `output.log` in its
+    directory.
+
+    Once a worker fails, the rest workers are terminated (like on the
+    platform) unless `fail_fast` is false. Exit code of a job is exit code of
+    the first failed worker.
+
+    Other options are the same as in :class:`LocalRunner` but they apply to
+    workers (e.g. `max_jobs` is a number of workers).
+    """
+
+    def __init__(self, n_workers: int, root: PathLike | None = None,
+                 fail_fast: bool = True, **kwargs) -> None:
+        super().__init__(**kwargs)
+        if n_workers <= 0:
+            raise ValueError(f'Number of workers must be positive: '
+                             f'{n_workers}.')
+        if self.max_jobs is not None and n_workers > self.max_jobs:
+            raise ValueError(f'Number of workers ({n_workers}) exceeds '
+                             f'number of slots ({self.max_jobs}).')
+        if root is None:
+            root = tempfile.mkdtemp(prefix='mlspace-cluster-')
+        self.n_workers = n_workers
+        self.root = Path(root)
+        self.fail_fast = fail_fast
+        self.workers: dict[str, list['Job']] = {}
+        self.worker_dirs: dict[str, Path] = {}
+        self.owners: dict[str, str] = {}  # Worker to job.
+
+    def log_path(self, job: 'Job') -> Path | None:
+        if (worker_dir := self.worker_dirs.get(job._id or '')) is not None:
+            return worker_dir / 'output.log'
+        return super().log_path(job)
+
+    def launch(self, job: 'Job', launch_bin: Path):
+        # Gang scheduling: all workers start at once.
+        while (self.max_jobs is not None and
+               len(self.jobs) + self.n_workers > self.max_jobs):
+            self.join_any()
+
+        job_id = str(uuid4())
+        job._id = job_id
+        master_port = find_free_port()
+        workers = []
+        for rank in range(self.n_workers):
+            worker_dir = self.root / job_id / str(rank)
+            (scratch_dir := worker_dir / 'scratch').mkdir(parents=True)
+            (work_dir := worker_dir / 'work').mkdir()
+            env = {
+                **os.environ,
+                'WORLD_SIZE': str(self.n_workers),
+                'RANK': str(rank),
+                'NODE_RANK': str(rank),
+                'LOCAL_RANK': '0',
+                'LOCAL_WORLD_SIZE': '1',
+                'MASTER_ADDR': '127.0.0.1',
+                'MASTER_PORT': str(master_port),
+                'TMPDIR': str(scratch_dir),
+            }
+            worker = replace(job, work_dir=job.work_dir or work_dir,
+                             _runner=self, _id=None)
+            worker_id = f'{job_id}.{rank}'
+            self.worker_dirs[worker_id] = worker_dir
+            self.owners[worker_id] = job_id
+            self.spawn(worker, launch_bin, worker_id, env)
+            workers.append(worker)
+        self.workers[job_id] = workers
+        logger.info('spawned %d workers of job %s in %s', self.n_workers,
+                    job_id, self.root / job_id)
+
+    def reap(self, job_id: str) -> 'Job':
+        worker = super().reap(job_id)
+        if (owner := self.owners.get(job_id)) is None:
+            return worker
+        code = self.returncodes[job_id]
+        if code != 0 and owner not in self.returncodes:
+            self.returncodes[owner] = code
+            if self.fail_fast:
+                logger.warning('worker %s of job %s failed: terminate the '
+                               'rest workers', job_id, owner)
+                for sibling in self.workers.get(owner, []):
+                    if sibling._id in self.jobs:
+                        self.terminate(sibling)
+        return worker
+
+    def terminate(self, job: 'Job'):
+        try:
+            # Process group includes `launch` and everything it spawns.
+            os.killpg(self.procs[cast(str, job._id)].pid, signal.SIGTERM)
+        except ProcessLookupError:
+            pass
+
+    def join(self, job: 'Job'):
+        if (job_id := job._id) not in self.workers:
+            return super().join(job)
+        for worker in self.workers[job_id]:
+            while worker._id in self.jobs:
+                self.join_any()  # Detect failure of any worker early.
+        self.returncodes.setdefault(job_id, 0)
+
+    async def ajoin(self, job: 'Job'):
+        if (job_id := job._id) not in self.workers:
+            return await super().ajoin(job)
+        await asyncio.gather(*(super(LocalClusterRunner, self).ajoin(worker)
+                               for worker in self.workers[job_id]))
+        self.returncodes.setdefault(job_id, 0)
+
+
+def find_free_port(host: str = '127.0.0.1') -> int:
+    with socket.socket(socket.AF_INET, socket.SOCK_STREAM) as sock:
+        sock.bind((host, 0))
+        return sock.getsockname()[1]
 
 
 class MLSpaceRunner(Runner):
@@ -90,27 +409,60 @@ class MLSpaceRunner(Runner):
         super().__init__()
 
         self.region = region
+        self.kwargs = kwargs
 
         # Load all implementation lazily.
         from mlspace.api import Gateway
         self.gwapi = Gateway(**kwargs)
+        self._agwapi = None
+        self._poller = None
+
+    @property
+    def agwapi(self):
+        """Asynchronous client which is shared by all jobs of the runner."""
+        if self._agwapi is None:
+            from mlspace.aio import AsyncGateway
+            self._agwapi = AsyncGateway(**self.kwargs)
+        return self._agwapi
+
+    @property
+    def poller(self):
+        """Poller which batches status queries of all jobs of the runner."""
+        if self._poller is None:
+            from mlspace.poller import Poller
+            self._poller = Poller(self.gwapi, self.region)
+        return self._poller
 
     def join(self, job: 'Job'):
-        if (_job_id := job._id) is None:
+        if (job_id := job._id) is None:
             raise RuntimeError('Job has no assigned identifier.')
-        raise NotImplementedError
+        info = self.poller.wait(job_id)
+        logger.info('remote job %s finished: status=%s', job_id, info.status)
+
+    async def ajoin(self, job: 'Job'):
+        if (job_id := job._id) is None:
+            raise RuntimeError('Job has no assigned identifier.')
+        info = await asyncio.wrap_future(self.poller.watch(job_id))
+        logger.info('remote job %s finished: status=%s', job_id, info.status)
 
     def launch(self, job: 'Job', launch_bin: Path):
         # TODO(@daskol): Find proper way to detach child process.
+        job._id = self.gwapi.job_run(**self.job_run_params(job, launch_bin))
+
+    async def alaunch(self, job: 'Job', launch_bin: Path):
+        params = self.job_run_params(job, launch_bin)
+        job._id = await self.agwapi.job_run(**params)
+
+    def job_run_params(self, job: 'Job', launch_bin: Path) -> dict[str, Any]:
         if (base_image := job.image) is None:
             raise ValueError('Job image is not specified.')
-        job._id = self.gwapi.job_run(
-            script=str(launch_bin),
-            base_image=base_image,
-            instance_type='v100.1gpu',  # TODO(@daskol): Hardcoded.
-            region=self.region,
-            flags=Spec.from_job(job).to_flags_dict(),
-        )
+        return {
+            'script': str(launch_bin),
+            'base_image': base_image,
+            'instance_type': 'v100.1gpu',  # TODO(@daskol): Hardcoded.
+            'region': self.region,
+            'flags': Spec.from_job(job).to_flags_dict(),
+        }
 
     def detach(self, job: 'Job'):
         if (_job_id := job._id) is None:
@@ -150,9 +502,120 @@ class Spec:
         return flags
 
 
+@dataclass
+class Checkpoint:
+    """Checkpoint handshake on preemption.
+
+    On SIGTERM, `launch` sends `signal` to a job and waits until a job either
+    touches `marker` file or reports committed checkpoint to progress channel
+    (see :func:`mlspace.progress.checkpoint`). Then `flush` command is run.
+    Everything must complete in `timeout` seconds. On success, `launch` exits
+    with :data:`EXIT_CHECKPOINTED` code.
+    """
+
+    signal: str | int = 'USR1'
+
+    marker: PathLike | None = None
+
+    timeout: float = 60.0
+
+    flush: list[str] = field(default_factory=list)
+
+    def to_dict(self) -> dict[str, Any]:
+        obj = asdict(self)
+        if self.marker is not None:
+            obj['marker'] = str(self.marker)
+        return obj
+
+
+EXIT_CHECKPOINTED = 75  # See `Supervisor::exit_checkpointed`.
+
+
+@dataclass
+class Profile:
+    """Sampling profiler of a job.
+
+    `launch` samples user-space call stacks of a job and all its threads and
+    children `frequency` times per second and writes them to `output` on exit
+    in folded format (`frame;frame;...;frame count` per line) which is
+    rendered by ``flamegraph.pl`` or speedscope. Stacks are sampled with perf
+    events (`mode='perf'`), with thread states from procfs (`mode='proc'`), or
+    with perf events falling back to procfs if they are not allowed
+    (`mode='auto'`).
+    """
+
+    output: PathLike
+
+    frequency: int = 99
+
+    mode: Literal['auto', 'perf', 'proc'] = 'auto'
+
+    def to_dict(self) -> dict[str, Any]:
+        obj = asdict(self)
+        obj['output'] = str(self.output)
+        return obj
+
+
+@dataclass
+class SharedMemory:
+    """Shared memory region for intra-node IPC.
+
+    `launch` allocates `size` bytes of memory (backed by huge pages if
+    `huge_pages` is set and they are available) on `numa_node` (by default, a
+    node of job CPUs) before a job starts. All processes of a job map it with
+    :func:`mlspace.shm.attach`.
+    """
+
+    size: int
+
+    huge_pages: bool = True
+
+    numa_node: int | None = None
+
+    def to_dict(self) -> dict[str, Any]:
+        return asdict(self)
+
+
+@dataclass
+class Allocation:
+    """Resources claimed in node-local registry.
+
+    Concurrent `launch` instances on a node claim disjoint `cpus` (number of
+    CPUs) and `memory` budgets (in bytes) in a registry file which is shared
+    by all of them. Claims are released once `launch` exits or dies. CPUs and
+    memory are taken from a single NUMA node unless `same_node` is unset and
+    no node fits. Busy resources are waited for up to `timeout` seconds. A job
+    is pinned to claimed CPUs and its budget is exported as
+    ``MLSPACE_MEMORY_BUDGET``.
+    """
+
+    cpus: int = 0
+
+    memory: int = 0
+
+    same_node: bool = True
+
+    timeout: float = 0.0
+
+    registry: PathLike | None = None
+
+    def to_dict(self) -> dict[str, Any]:
+        obj = asdict(self)
+        if self.registry is None:
+            del obj['registry']
+        else:
+            obj['registry'] = str(self.registry)
+        return obj
+
+
 @dataclass
 class Job:
-    """Internal job representation."""
+    """Internal job representation.
+
+    Executable, args and env values may refer to identity of a process as
+    `${RANK}`, `${LOCAL_RANK}`, `${NODE_RANK}`, or `${TASK_ID}`. They are
+    substituted by `launch` for every process (`$${` is escaped `${`).
+    """
 
     executable: PathLike
 
@@ -166,7 +629,23 @@ class Job:
 
     image: str | None = None
 
-    _runner: Runner = field(default_factory=LocalRunner)
+    control_socket: PathLike | None = None
+
+    metrics: PathLike | None = None
+
+    journal: PathLike | None = None
+
+    checkpoint: Checkpoint | None = None
+
+    profile: Profile | None = None
+
+    shm: SharedMemory | None = None
+
+    cpus: list[int] | None = None
+
+    allocation: Allocation | None = None
+
+    _runner: Runner | None = None
 
     _id: str | None = None
 
@@ -182,6 +661,22 @@ class Job:
             obj[field.name] = getattr(self, field.name)
         obj = deepcopy(obj)
         obj['executable'] = str(self.executable)  # TODO(@daskol): Cast?
+        if self.work_dir is not None:
+            obj['work_dir'] = str(self.work_dir)
+        if self.control_socket is not None:
+            obj['control_socket'] = str(self.control_socket)
+        if self.metrics is not None:
+            obj['metrics'] = str(self.metrics)
+        if self.journal is not None:
+            obj['journal'] = str(self.journal)
+        if self.checkpoint is not None:
+            obj['checkpoint'] = self.checkpoint.to_dict()
+        if self.profile is not None:
+            obj['profile'] = self.profile.to_dict()
+        if self.shm is not None:
+            obj['shm'] = self.shm.to_dict()
+        if self.allocation is not None:
+            obj['allocation'] = self.allocation.to_dict()
         return obj
 
     def to_json(self) -> str:
@@ -192,8 +687,14 @@ class Job:
     def detach(self):
         raise NotImplementedError
 
+    @property
+    def runner(self) -> Runner:
+        if self._runner is None:
+            return default_runner()
+        return self._runner
+
     def join(self):
-        self._runner.join(self)
+        self.runner.join(self)
 
     def kill(self):
         raise NotImplementedError
@@ -201,23 +702,20 @@ class Job:
     def launch(self, launch_bin: PathLike | None = None):
         if (launch_bin := launch_bin or config.launch_bin) is None:
             raise RuntimeError('No `launch_bin` found.')
-        self._runner.launch(self, cast(Path, launch_bin))  # Not None!
+        self.runner.launch(self, cast(Path, launch_bin))  # Not None!
 
+    async def ajoin(self):
+        await self.runner.ajoin(self)
 
-@contextmanager
-def launch(image: str | None, command: list[str], env: dict[str, str] = {},
-           region: str | None = None, launch_bin: PathLike | None = None,
-           run_local=False, **kwargs) -> Iterator[Job]:
-    """Conctext manager for lauching and waiting jobs.
+    async def alaunch(self, launch_bin: PathLike | None = None):
+        if (launch_bin := launch_bin or config.launch_bin) is None:
+            raise RuntimeError('No `launch_bin` found.')
+        await self.runner.alaunch(self, cast(Path, launch_bin))
 
-    Args:
-      image: Container image in which job is spawned. If `image` is set to
-      `None`, then job is launched locally (useful for dry runing and testing).
-      command: Command to execute with its all arguments.
-      env: Environment variables to add to job context before launching (see
-      `man 3 execvpe` for details).
-      region: Cluster where to spawn job.
-    """
+
+def make_job(image: str | None, command: list[str], env: dict[str, str],
+             region: str | None, run_local: bool, runner: Runner | None,
+             **kwargs) -> Job:
     if len(command) == 0:
         raise RuntimeError(f'No command to run; command is empty: {command}.')
 
@@ -225,15 +723,36 @@ def launch(image: str | None, command: list[str], env: dict[str, str] = {},
     args_ = command[1:]
 
     _runner: Runner
-    if run_local:
-        _runner = LocalRunner()
+    if runner is not None:
+        _runner = runner
+    elif run_local:
+        _runner = default_runner()
     else:
         if region is None:
             raise RuntimeError(
                 'Region must be non-empty for non-local executor.')
         _runner = MLSpaceRunner(region)
 
-    job = Job(executable, args_, env, image=image, _runner=_runner, **kwargs)
+    return Job(executable, args_, env, image=image, _runner=_runner, **kwargs)
+
+
+@contextmanager
+def launch(image: str | None, command: list[str], env: dict[str, str] = {},
+           region: str | None = None, launch_bin: PathLike | None = None,
+           run_local=False, runner: Runner | None = None,
+           **kwargs) -> Iterator[Job]:
+    """Conctext manager for lauching and waiting jobs.
+
+    Args:
+      image: Container image in which job is spawned. If `image` is set to
+      `None`, then job is launched locally (useful for dry runing and testing).
+      command: Command to execute with its all arguments.
+      env: Environment variables to add to job context before launching (see
+      `man 3 execvpe` for details).
+      region: Cluster where to spawn job.
+      runner: Runner to use instead of a new one (e.g. shared one).
+    """
+    job = make_job(image, command, env, region, run_local, runner, **kwargs)
     job.launch(launch_bin)
     try:
         yield job
@@ -241,3 +760,30 @@ def launch(image: str | None, command: list[str], env: dict[str, str] = {},
         pass
     finally:
         job.join()
+
+
+@asynccontextmanager
+async def alaunch(image: str | None, command: list[str],
+                  env: dict[str, str] = {}, region: str | None = None,
+                  launch_bin: PathLike | None = None, run_local=False,
+                  runner: Runner | None = None,
+                  **kwargs) -> AsyncIterator[Job]:
+    """Asynchronous counterpart of :func:`launch`.
+
+    In order to run thousands of jobs from a single event loop, pass the same
+    `runner` to all :func:`alaunch` calls. Then submissions share a connection
+    pool which bounds number of concurrent requests to Gateway API.
+
+    Example:
+      runner = MLSpaceRunner('SR006')
+      async def run(config: str):
+          async with alaunch(image, ['train', config], runner=runner) as job:
+              pass  # Job is awaited on exit.
+      await asyncio.gather(*(run(c) for c in configs))
+    """
+    job = make_job(image, command, env, region, run_local, runner, **kwargs)
+    await job.alaunch(launch_bin)
+    try:
+        yield job
+    finally:
+        await job.ajoin()
@@ -12,13 +12,42 @@
 # See the License for the specific language governing permissions and
 # limitations under the License.
 
+import asyncio
 import base64
 import json
+import os
+import sys
 from pathlib import Path
+from subprocess import Popen
 
 import pytest
 
-from mlspace.launch import Job, Spec, launch
+from mlspace.launch import (Allocation, Job, LocalClusterRunner,
+                            LocalRunner, Profile, Spec, alaunch,
+                            default_runner, launch, partition_cpus,
+                            wait_process)
+
+# Fake `launch` binary which decodes job spec, pins itself to CPUs, changes
+# working directory and executes a job.
+FAKE_LAUNCH = f'''#!{sys.executable}
+import base64, json, os, sys
+args = dict(zip(sys.argv[1::2], sys.argv[2::2]))
+job = json.loads(base64.b64decode(args['--spec-chunk-0']))
+if job.get('cpus'):
+    os.sched_setaffinity(0, job['cpus'])
+if job.get('work_dir'):
+    os.chdir(job['work_dir'])
+os.execvpe(job['executable'], [job['executable'], *job['args']],
+           {{**os.environ, **job['env']}})
+'''
+
+
+@pytest.fixture
+def launch_bin(tmp_path: Path) -> Path:
+    path = tmp_path / 'launch'
+    path.write_text(FAKE_LAUNCH)
+    path.chmod(0o755)
+    return path
 
 
 class TestSpec:
@@ -44,9 +73,188 @@ class TestSpec:
         assert obj['args'] == job.args
         assert obj['env'] == job.env
 
+    def test_profile(self, tmp_path: Path):
+        profile = Profile(tmp_path / 'profile.txt', frequency=199)
+        job = Job(executable='true', profile=profile)
+        obj = json.loads(job.to_json())
+        assert obj['profile'] == {'output': str(tmp_path / 'profile.txt'),
+                                  'frequency': 199, 'mode': 'auto'}
+
+    def test_allocation(self):
+        job = Job(executable='true', allocation=Allocation(cpus=4))
+        obj = json.loads(job.to_json())
+        assert obj['allocation'] == {'cpus': 4, 'memory': 0,
+                                     'same_node': True, 'timeout': 0.0}
+
 
 @pytest.mark.xfail(reason='non implemented')
 def test_launch():
     command = ['python', '-m', 'mylib', 'train', 'config/example.toml']
     with launch(None, command) as job:
         assert job is not None  # Dummy assertion.
+
+
+def test_wait_process():
+    async def run() -> int:
+        proc = Popen(['sh', '-c', 'sleep 0.1; exit 3'])
+        await asyncio.wait_for(wait_process(proc), 5)
+        return proc.wait()
+    assert asyncio.run(run()) == 3
+
+
+class TestLocalRunner:
+
+    def make_job(self, runner: LocalRunner, code: int) -> Job:
+        script = f'echo job $0; exit {code}'
+        return Job(Path('sh'), ['-c', script, str(code)], _runner=runner)
+
+    def test_join_all(self, launch_bin: Path, tmp_path: Path):
+        runner = LocalRunner(max_jobs=3, log_dir=tmp_path / 'logs')
+        jobs = []
+        for code in range(8):
+            jobs.append(job := self.make_job(runner, code))
+            job.launch(launch_bin)
+            assert len(runner.running) <= 3
+        # Some jobs are reaped by `launch` while it waits for a free slot.
+        finished = runner.join_all(timeout=10)
+        assert 3 <= len(finished) <= 8
+        assert all(any(job is x for x in jobs) for job in finished)
+        assert runner.running == []
+        for code, job in enumerate(jobs):
+            assert runner.returncodes[job._id] == code
+            log_path = runner.log_path(job)
+            assert log_path is not None
+            assert log_path.read_text() == f'job {code}\n'
+
+    def test_join_any(self, launch_bin: Path):
+        runner = LocalRunner()
+        slow = Job(Path('sleep'), ['5'], _runner=runner)
+        slow.launch(launch_bin)
+        fast = self.make_job(runner, 0)
+        fast.launch(launch_bin)
+        assert runner.join_any(timeout=5) is fast
+        assert runner.join_any(timeout=0.1) is None
+        runner.procs[slow._id].kill()
+        assert runner.join_any(timeout=5) is slow
+        assert runner.join_any() is None
+
+    def test_cpus(self, launch_bin: Path, tmp_path: Path):
+        cpusets = partition_cpus(1)
+        assert len(cpusets) == len(os.sched_getaffinity(0))
+        runner = LocalRunner(max_jobs=100, cpus_per_job=1, log_dir=tmp_path)
+        assert runner.max_jobs == len(cpusets)
+        script = 'import os; print(sorted(os.sched_getaffinity(0)))'
+        jobs = [Job(Path(sys.executable), ['-c', script], _runner=runner)
+                for _ in range(2 * len(cpusets))]
+        for job in jobs:
+            job.launch(launch_bin)
+        runner.join_all()
+        assert sorted(runner.cpusets or []) == cpusets  # All are released.
+        for job in jobs:
+            assert job.cpus in cpusets
+            assert runner.log_path(job).read_text() == f'{job.cpus}\n'
+
+    def test_alaunch(self, launch_bin: Path):
+        runner = LocalRunner(max_jobs=2)
+
+        async def run(code: int) -> int:
+            job = self.make_job(runner, code)
+            await job.alaunch(launch_bin)
+            assert len(runner.running) <= 2
+            await job.ajoin()
+            return runner.returncodes[job._id]
+
+        async def main() -> list[int]:
+            return await asyncio.gather(*(run(code) for code in range(6)))
+
+        assert asyncio.run(main()) == list(range(6))
+
+    def test_alaunch_loop(self, launch_bin: Path):
+        # Submission loop without `ajoin` reaps finished jobs to free slots.
+        runner = LocalRunner(max_jobs=2)
+
+        async def main() -> list[Job]:
+            jobs = [self.make_job(runner, code) for code in range(5)]
+            for job in jobs:
+                await job.alaunch(launch_bin)
+            return jobs
+
+        jobs = asyncio.run(asyncio.wait_for(main(), timeout=10))
+        runner.join_all()
+        assert [runner.returncodes[job._id] for job in jobs] == \
+            list(range(5))
+        assert not runner.procs  # Finished processes are released.
+
+    def test_default_runner(self, launch_bin: Path):
+        # Jobs without runner share the only one instead of a runner (and its
+        # selector) per job.
+        jobs = [Job(Path('sh'), ['-c', 'exit 0']) for _ in range(2)]
+        assert all(job._runner is None for job in jobs)
+        assert jobs[0].runner is jobs[1].runner is default_runner()
+        for job in jobs:
+            job.launch(launch_bin)
+        for job in jobs:
+            job.join()
+            assert default_runner().returncodes[job._id] == 0
+
+
+# Workers sum up their ranks over loopback: rank 0 listens on master port and
+# the rest connect to it.
+ALLREDUCE = '''
+import os, socket, time
+rank, size = int(os.environ['RANK']), int(os.environ['WORLD_SIZE'])
+addr = (os.environ['MASTER_ADDR'], int(os.environ['MASTER_PORT']))
+if rank == 0:
+    with socket.create_server(addr) as srv:
+        conns = [srv.accept()[0] for _ in range(size - 1)]
+        total = sum(int(conn.recv(16)) for conn in conns)
+else:
+    for _ in range(100):
+        try:
+            conn = socket.create_connection(addr)
+            break
+        except ConnectionRefusedError:
+            time.sleep(0.05)
+    conn.sendall(str(rank).encode())
+    total = None
+print(rank, size, os.getcwd(), os.environ['TMPDIR'], total)
+'''
+
+
+class TestLocalClusterRunner:
+
+    def test_allreduce(self, launch_bin: Path, tmp_path: Path):
+        runner = LocalClusterRunner(n_workers=3, root=tmp_path)
+        job = Job(Path(sys.executable), ['-c', ALLREDUCE], _runner=runner)
+        job.launch(launch_bin)
+        job.join()
+        assert runner.returncodes[job._id] == 0
+        for rank, worker in enumerate(runner.workers[job._id]):
+            assert runner.returncodes[worker._id] == 0
+            worker_dir = tmp_path / job._id / str(rank)
+            output = (worker_dir / 'output.log').read_text().split()
+            assert output == [
+                str(rank), '3', str(worker_dir / 'work'),
+                str(worker_dir / 'scratch'), '3' if rank == 0 else 'None',
+            ]
+
+    def test_fail_fast(self, launch_bin: Path, tmp_path: Path):
+        runner = LocalClusterRunner(n_workers=3, root=tmp_path)
+        script = '[ "$RANK" = 1 ] && exit 3; exec sleep 30'
+        job = Job(Path('sh'), ['-c', script], _runner=runner)
+        job.launch(launch_bin)
+        job.join()
+        assert runner.returncodes[job._id] == 3
+        assert runner.running == []
+
+    def test_alaunch(self, launch_bin: Path, tmp_path: Path):
+        runner = LocalClusterRunner(n_workers=2, root=tmp_path)
+
+        async def main():
+            async with alaunch(None, [sys.executable, '-c', ALLREDUCE],
+                               launch_bin=launch_bin, runner=runner) as job:
+                pass
+            return job
+
+        job = asyncio.run(main())
+        assert runner.returncodes[job._id] == 0
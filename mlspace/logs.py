@@ -0,0 +1,167 @@
+# Copyright 2025 Daniel Bershatsky
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""Incremental retrieval of job logs.
+
+Logs are cached on disk so that repeated calls fetch only new bytes from the
+offset where the previous call stopped.
+
+  python -m mlspace.logs -f lm-mpi-job-00000000-0000-0000-0000-000000000000
+"""
+
+import logging
+import os
+import sys
+import time
+from argparse import ArgumentParser, Namespace
+from pathlib import Path
+from typing import Callable, Iterator
+from urllib.parse import quote
+
+from mlspace.api import GatewayV2
+
+__all__ = ('LogCache', 'LogStream')
+
+logger = logging.getLogger(__name__)
+
+
+def default_cache_dir() -> Path:
+    if (root := os.getenv('XDG_CACHE_HOME')) is None:
+        return Path.home() / '.cache' / 'mlspace' / 'logs'
+    return Path(root) / 'mlspace' / 'logs'
+
+
+class LogCache:
+    """Directory with a log file per job. Size of a file is the offset from
+    which its log continues.
+    """
+
+    def __init__(self, root: Path | str | None = None):
+        self.root = Path(root) if root is not None else default_cache_dir()
+
+    def path(self, job_name: str) -> Path:
+        return self.root / f'{quote(job_name, safe="")}.log'
+
+    def offset(self, job_name: str) -> int:
+        try:
+            return self.path(job_name).stat().st_size
+        except FileNotFoundError:
+            return 0
+
+    def read(self, job_name: str, offset: int = 0) -> bytes:
+        try:
+            with open(self.path(job_name), 'rb') as fin:
+                fin.seek(offset)
+                return fin.read()
+        except FileNotFoundError:
+            return b''
+
+    def append(self, job_name: str, offset: int, data: bytes):
+        """Write `data` at `offset`. It must not leave a gap in a file."""
+        path = self.path(job_name)
+        path.parent.mkdir(parents=True, exist_ok=True)
+        with open(path, 'ab') as fout:
+            if offset > (size := fout.tell()):
+                raise ValueError(f'Log chunk of {job_name} at {offset} is '
+                                 f'past the end of cached log ({size}).')
+            fout.truncate(offset)
+            fout.write(data)
+
+    def remove(self, job_name: str):
+        self.path(job_name).unlink(missing_ok=True)
+
+
+class LogStream:
+    """Log of a single job which is fetched incrementally.
+
+    Only bytes past the cached offset are requested so that tailing of many
+    jobs costs bandwidth proportional to new output.
+    """
+
+    def __init__(self, gwapi: GatewayV2, job_name: str,
+                 cache: LogCache | None = None,
+                 sleep: Callable[[float], None] = time.sleep):
+        self.gwapi = gwapi
+        self.job_name = job_name
+        self.cache = cache or LogCache()
+        self.sleep = sleep
+        self.offset = self.cache.offset(job_name)
+        self.complete = False
+
+    def read(self) -> bytes:
+        """Read cached log (without fetching)."""
+        return self.cache.read(self.job_name)
+
+    def fetch(self, wait: float | None = None) -> bytes:
+        """Fetch and cache new output since the last call."""
+        chunk = self.gwapi.job_logs_chunk(self.job_name, self.offset, wait)
+        if chunk.next_offset < self.offset:
+            # Log is shorter than the cached one (e.g. job is restarted).
+            logger.warning('log of job %s is truncated from %d to %d bytes',
+                           self.job_name, self.offset, chunk.next_offset)
+            self.cache.remove(self.job_name)
+            self.offset = 0
+            return self.fetch(wait)
+        if chunk.data:
+            self.cache.append(self.job_name, chunk.offset, chunk.data)
+        self.offset = chunk.next_offset
+        self.complete = chunk.complete
+        return chunk.data
+
+    def follow(self, wait: float = 10.0, min_interval: float = 0.5,
+               max_interval: float = 30.0,
+               factor: float = 2.0) -> Iterator[bytes]:
+        """Yield new output until a job finishes.
+
+        Every request is held by a server for up to `wait` seconds (it must be
+        less than client timeout). If no new output is returned then the next
+        request is delayed by interval which grows by `factor` from
+        `min_interval` to `max_interval`. Once there is no new output, status
+        of a job is checked if a server does not report log completion.
+        """
+        interval = min_interval
+        while not self.complete:
+            if data := self.fetch(wait):
+                interval = min_interval
+                yield data
+                continue
+            if not self.complete and self.gwapi.job_status(self.job_name).done:
+                # Job is finished but some output could be written in between.
+                if data := self.fetch():
+                    yield data
+                self.complete = True
+                break
+            self.sleep(interval)
+            interval = min(max_interval, interval * factor)
+
+
+parser = ArgumentParser(description='Fetch or follow logs of a job.')
+parser.add_argument('-f', '--follow', default=False, action='store_true',
+                    help='wait for new output until job finishes')
+parser.add_argument('-c', '--cache-dir', type=Path,
+                    help='directory of cached logs')
+parser.add_argument('job_name', help='name of a job')
+
+
+def main() -> None:
+    ns: Namespace = parser.parse_args()
+    stream = LogStream(GatewayV2(), ns.job_name, LogCache(ns.cache_dir))
+    sys.stdout.buffer.write(stream.read())
+    chunks = stream.follow() if ns.follow else iter([stream.fetch()])
+    for chunk in chunks:
+        sys.stdout.buffer.write(chunk)
+        sys.stdout.buffer.flush()
+
+
+if __name__ == '__main__':
+    main()
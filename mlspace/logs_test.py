@@ -0,0 +1,101 @@
+# Copyright 2025 Daniel Bershatsky
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from pathlib import Path
+from typing import Iterator
+
+import pytest
+
+from mlspace.api import GatewayV2
+from mlspace.logs import LogCache, LogStream
+from mlspace.testing import MockServer, spawn_mock_server
+
+KWARGS = {
+    'api_key': 'API_KEY',
+    'access_token': 'JWT',
+    'workspace_id': '00000000-0000-0000-0000-000000000000',
+}
+
+JOB = {
+    'script': '/home/user/.cache/mlspace/launch',
+    'base_image': 'cr.ai.cloud.ru/8ff21ec0-666d-4950/job-example',
+    'instance_type': 'v100.1gpu',
+}
+
+
+@pytest.fixture(scope='module')
+def gwapi() -> Iterator[MockServer]:
+    server, thread = spawn_mock_server()
+    try:
+        yield server
+    finally:
+        server.stop()
+        thread.join()
+
+
+class TestLogCache:
+
+    def test_append(self, tmp_path: Path):
+        cache = LogCache(tmp_path)
+        assert cache.offset('job/0') == 0
+        cache.append('job/0', 0, b'hello\n')
+        cache.append('job/0', 6, b'world\n')
+        assert cache.offset('job/0') == 12
+        assert cache.read('job/0', 6) == b'world\n'
+        cache.append('job/0', 6, b'again\n')  # Overwrite tail.
+        assert cache.read('job/0') == b'hello\nagain\n'
+        with pytest.raises(ValueError):
+            cache.append('job/0', 13, b'gap\n')
+
+
+class TestLogStream:
+
+    def submit(self, gwapi: MockServer, run: float) -> tuple[GatewayV2, str]:
+        cli = GatewayV2(**KWARGS, endpoint=gwapi.endpoint)
+        gwapi.set_durations(queue=0.05, run=run)
+        try:
+            return cli, cli.job_run(**JOB)
+        finally:
+            gwapi.set_durations()
+
+    def test_follow(self, gwapi: MockServer, tmp_path: Path):
+        cli, job_name = self.submit(gwapi, 0.3)
+        log_bytes = gwapi.log_bytes
+        stream = LogStream(cli, job_name, LogCache(tmp_path))
+        output = b''.join(stream.follow(wait=0.1, min_interval=0.01))
+        assert output.startswith(f'job {job_name} started\n'.encode())
+        assert output.endswith(f'job {job_name} is completed\n'.encode())
+        assert stream.read() == output
+        # Every byte is transferred exactly once.
+        assert gwapi.log_bytes - log_bytes == len(output)
+
+        # Cached log is not fetched again.
+        stream = LogStream(cli, job_name, LogCache(tmp_path))
+        assert stream.offset == len(output)
+        assert stream.fetch() == b''
+        assert stream.complete
+        assert gwapi.log_bytes - log_bytes == len(output)
+
+    def test_follow_no_offsets(self, gwapi: MockServer, tmp_path: Path):
+        cli, job_name = self.submit(gwapi, 0.2)
+        gwapi.server.log_offsets = False
+        try:
+            stream = LogStream(cli, job_name, LogCache(tmp_path),
+                               sleep=lambda _: None)
+            output = b''.join(stream.follow(wait=0.05))
+        finally:
+            gwapi.server.log_offsets = True
+        assert output.endswith(f'job {job_name} is completed\n'.encode())
+        assert output.count(b'started') == 1
+        assert stream.read() == output
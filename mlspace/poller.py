@@ -0,0 +1,180 @@
+# Copyright 2025 Daniel Bershatsky
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""Shared poller which watches many remote jobs at the cost of a single
+:meth:`mlspace.api.GatewayV2.job_list` request per polling interval.
+"""
+
+import logging
+import time
+from concurrent.futures import Future
+from dataclasses import dataclass, field
+from threading import Condition, Thread
+
+from mlspace.api import GatewayError, GatewayV2, Job
+
+__all__ = ('Poller',)
+
+logger = logging.getLogger(__name__)
+
+
+@dataclass
+class Watch:
+
+    name: str
+
+    interval: float
+
+    due: float
+
+    status: str | None = None
+
+    future: Future[Job] = field(default_factory=Future)
+
+
+class Poller:
+    """Poller tracks jobs until they finish.
+
+    All tracked jobs are refreshed at once with a single `job_list` request.
+    Polling interval of a job starts from `min_interval` (job status changes
+    often right after submission) and grows by `factor` up to `max_interval`
+    while its status stays the same. Poller wakes up when the earliest job is
+    due. Jobs which are missed in a list (e.g. the list is truncated) are
+    queried one by one with `job_status`.
+
+    Poller runs in a daemon thread which is started on the first
+    :meth:`watch`. Gateway client must be thread-safe.
+    """
+
+    def __init__(self, gwapi: GatewayV2, region: str | None = None,
+                 min_interval: float = 2.0, max_interval: float = 60.0,
+                 factor: float = 1.5, clock=time.monotonic):
+        if not (0 < min_interval <= max_interval):
+            raise ValueError('Polling intervals must satisfy 0 < '
+                             f'{min_interval=} <= {max_interval=}.')
+        if factor < 1:
+            raise ValueError(f'Factor must not be less than 1: {factor}.')
+        self.gwapi = gwapi
+        self.region = region
+        self.min_interval = min_interval
+        self.max_interval = max_interval
+        self.factor = factor
+        self.clock = clock
+        self.cond = Condition()
+        self.watches: dict[str, Watch] = {}
+        self.thread: Thread | None = None
+        self.closed = False
+        self.num_polls = 0
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *args):
+        self.close()
+
+    def close(self):
+        """Stop polling. Pending futures are cancelled."""
+        with self.cond:
+            self.closed = True
+            watches, self.watches = self.watches, {}
+            self.cond.notify_all()
+        for watch in watches.values():
+            watch.future.cancel()
+        if self.thread is not None:
+            self.thread.join()
+
+    def watch(self, job_name: str) -> Future[Job]:
+        """Start tracking of a job. Future resolves to the final job state."""
+        with self.cond:
+            if self.closed:
+                raise RuntimeError('Poller is closed.')
+            if (watch := self.watches.get(job_name)) is None:
+                now = self.clock()
+                watch = Watch(job_name, self.min_interval,
+                              now + self.min_interval)
+                self.watches[job_name] = watch
+                self.cond.notify_all()
+            if self.thread is None:
+                self.thread = Thread(target=self.run, name='poller',
+                                     daemon=True)
+                self.thread.start()
+            return watch.future
+
+    def wait(self, job_name: str, timeout: float | None = None) -> Job:
+        return self.watch(job_name).result(timeout)
+
+    def run(self):
+        while (batch := self.next_batch()) is not None:
+            self.poll(batch)
+
+    def next_batch(self) -> list[Watch] | None:
+        """Block until the earliest job is due and return all tracked jobs."""
+        with self.cond:
+            while not self.closed:
+                if not self.watches:
+                    self.cond.wait()
+                    continue
+                due = min(w.due for w in self.watches.values())
+                if (delay := due - self.clock()) > 0:
+                    self.cond.wait(delay)
+                    continue
+                return list(self.watches.values())
+            return None
+
+    def poll(self, batch: list[Watch]):
+        self.num_polls += 1
+        try:
+            jobs = {job.name: job
+                    for job in self.gwapi.job_list(region=self.region)}
+        except Exception as e:
+            logger.warning('failed to list jobs: %s', e)
+            with self.cond:
+                for watch in batch:
+                    self.reschedule(watch, watch.status)
+            return
+
+        for watch in batch:
+            error: Exception | None = None
+            if (job := jobs.get(watch.name)) is None:
+                try:
+                    job = self.gwapi.job_status(watch.name)
+                except GatewayError as e:
+                    if e.status == 404:
+                        error = e  # There is no such job at all.
+                    logger.warning('failed to get status of job %s: %s',
+                                   watch.name, e)
+                except Exception as e:
+                    logger.warning('failed to get status of job %s: %s',
+                                   watch.name, e)
+            with self.cond:
+                if self.watches.get(watch.name) is not watch:
+                    continue  # Poller is closed.
+                if error is not None:
+                    del self.watches[watch.name]
+                    watch.future.set_exception(error)
+                elif job is not None and job.done:
+                    del self.watches[watch.name]
+                    watch.future.set_result(job)
+                else:
+                    self.reschedule(watch, job and job.status)
+
+    def reschedule(self, watch: Watch, status: str | None):
+        if status is not None and status != watch.status:
+            logger.info('job %s status changed: %s -> %s', watch.name,
+                        watch.status, status)
+            watch.status = status
+            watch.interval = self.min_interval
+        else:
+            watch.interval = min(self.max_interval,
+                                 watch.interval * self.factor)
+        watch.due = self.clock() + watch.interval
@@ -0,0 +1,86 @@
+# Copyright 2025 Daniel Bershatsky
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from typing import Iterator
+
+import pytest
+
+from mlspace.api import GatewayError, GatewayV2
+from mlspace.poller import Poller, Watch
+from mlspace.testing import MockServer, spawn_mock_server
+
+KWARGS = {
+    'api_key': 'API_KEY',
+    'access_token': 'JWT',
+    'workspace_id': '00000000-0000-0000-0000-000000000000',
+}
+
+JOB = {
+    'script': '/home/user/.cache/mlspace/launch',
+    'base_image': 'cr.ai.cloud.ru/8ff21ec0-666d-4950/job-example',
+    'instance_type': 'v100.1gpu',
+}
+
+
+@pytest.fixture(scope='module')
+def gwapi() -> Iterator[MockServer]:
+    server, thread = spawn_mock_server()
+    try:
+        yield server
+    finally:
+        server.stop()
+        thread.join()
+
+
+class TestPoller:
+
+    def test_reschedule(self):
+        now = 0.0
+        poller = Poller(GatewayV2(**KWARGS, endpoint='http://localhost'),
+                        min_interval=1, max_interval=4, factor=2,
+                        clock=lambda: now)
+        watch = Watch('job', 1, 1)
+        intervals = []
+        for status in ('Pending', 'Pending', 'Pending', 'Pending',
+                       'Running', None):
+            poller.reschedule(watch, status)
+            intervals.append(watch.interval)
+        assert intervals == [1, 2, 4, 4, 1, 2]
+        assert watch.status == 'Running'
+        assert watch.due == 2
+
+    def test_batching(self, gwapi: MockServer):
+        cli = GatewayV2(**KWARGS, endpoint=gwapi.endpoint)
+        gwapi.set_durations(queue=0.1, run=0.2)
+        try:
+            job_names = cli.job_run_many([JOB] * 16)
+        finally:
+            gwapi.set_durations()
+
+        num_requests = gwapi.num_requests
+        with Poller(cli, min_interval=0.05, max_interval=0.2) as poller:
+            futures = [poller.watch(name) for name in job_names]
+            jobs = [future.result(timeout=10) for future in futures]
+        assert [job.name for job in jobs] == job_names
+        assert all(job.status == 'Completed' for job in jobs)
+        # Every poll is a single request regardless of number of jobs.
+        assert gwapi.num_requests - num_requests == poller.num_polls
+        assert poller.num_polls < 16
+
+    def test_unknown_job(self, gwapi: MockServer):
+        cli = GatewayV2(**KWARGS, endpoint=gwapi.endpoint)
+        with Poller(cli, min_interval=0.01) as poller:
+            with pytest.raises(GatewayError) as e:
+                poller.wait('no-such-job', timeout=10)
+        assert e.value.status == 404
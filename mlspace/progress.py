@@ -0,0 +1,55 @@
+# Copyright 2025 Daniel Bershatsky
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Report job progress to `launch` supervisor.
+
+Supervisor passes write end of a pipe to a job in `MLSPACE_PROGRESS_FD`
+environment variable. Every message is a single line shorter than `PIPE_BUF`
+so that reports from different processes (e.g. ranks) never interleave.
+"""
+
+import os
+from os import PathLike
+
+__all__ = ('checkpoint', 'report')
+
+ENV_VAR = 'MLSPACE_PROGRESS_FD'
+
+PIPE_BUF = 4096
+
+
+def report(event: str, payload: str = '') -> bool:
+    """Send an event to supervisor. It returns `False` if a job is not run by
+    `launch` or supervisor is gone.
+    """
+    if (value := os.getenv(ENV_VAR)) is None:
+        return False
+    if not event or ' ' in event or '\n' in event or '\n' in payload:
+        raise ValueError(f'Malformed event: {event!r} {payload!r}.')
+    line = f'{event} {payload}' if payload else event
+    data = (line + '\n').encode('utf-8')
+    if len(data) > PIPE_BUF:
+        raise ValueError(f'Event is too long: {len(data)} > {PIPE_BUF}.')
+    try:
+        os.write(int(value), data)
+    except OSError:
+        return False
+    return True
+
+
+def checkpoint(path: PathLike | str | None = None) -> bool:
+    """Notify supervisor that checkpoint is committed to persistent storage.
+    Call it only when checkpoint is complete (e.g. after `fsync`).
+    """
+    return report('checkpoint', '' if path is None else str(path))
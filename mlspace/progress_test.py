@@ -0,0 +1,37 @@
+# Copyright 2025 Daniel Bershatsky
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import os
+
+import pytest
+
+from mlspace.progress import ENV_VAR, checkpoint, report
+
+
+def test_report(monkeypatch: pytest.MonkeyPatch):
+    monkeypatch.delenv(ENV_VAR, raising=False)
+    assert not checkpoint()
+
+    rfd, wfd = os.pipe()
+    try:
+        monkeypatch.setenv(ENV_VAR, str(wfd))
+        assert checkpoint('/mnt/ckpt/step-100')
+        assert report('heartbeat')
+        with pytest.raises(ValueError):
+            report('bad event')
+        data = os.read(rfd, 4096)
+    finally:
+        os.close(rfd)
+        os.close(wfd)
+    assert data == b'checkpoint /mnt/ckpt/step-100\nheartbeat\n'
@@ -0,0 +1,298 @@
+# Copyright 2025 Daniel Bershatsky
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""Reader of time series files which are written by `launch` supervisor (see
+`mlspace/cc/series.h` for the format).
+
+A file is mapped to memory and values of a block are exposed as typed
+memoryviews of the mapping, so that nothing is copied or parsed until it is
+accessed. Only timestamps are decoded since they are delta-encoded.
+
+    with Series('metrics.mlts') as series:
+        for block in series.blocks(start=t0, stop=t1):
+            print(block.time[0], max(block['running']))
+        time, columns = series.read(t0, t1)
+"""
+
+import mmap
+import os
+import struct
+from argparse import ArgumentParser, Namespace
+from array import array
+from dataclasses import dataclass
+from os import PathLike
+from typing import Iterator
+from weakref import ref
+
+__all__ = ('Block', 'Column', 'IndexEntry', 'Series')
+
+MAGIC = b'MLTS'
+
+END_MAGIC = b'MLTS_END'
+
+VERSION = 1
+
+# Type codes of columns and their formats in terms of `array` and `struct`.
+TYPES = {1: 'q', 2: 'd', 3: 'i', 4: 'f'}
+
+TYPE_NAMES = {'q': 'int64', 'd': 'float64', 'i': 'int32', 'f': 'float32'}
+
+BLOCK_HEADER = struct.Struct('<4sI')
+
+DATA_HEADER = struct.Struct('<IIqq')
+
+INDEX_HEADER = struct.Struct('<qII')
+
+INDEX_ENTRY = struct.Struct('<qqqII')
+
+
+def align(offset: int) -> int:
+    return (offset + 7) & ~7
+
+
+def decode_times(buf: memoryview, first: int, num_rows: int) -> array:
+    """Decode zigzag varints of differences between timestamps."""
+    times = array('q')
+    time, shift, acc = first, 0, 0
+    for byte in buf:
+        acc |= (byte & 0x7f) << shift
+        if byte & 0x80:
+            shift += 7
+            continue
+        time += (acc >> 1) ^ -(acc & 1)
+        times.append(time)
+        shift, acc = 0, 0
+    if len(times) != num_rows:
+        raise ValueError(f'Expected {num_rows} timestamps but decoded '
+                         f'{len(times)}.')
+    return times
+
+
+@dataclass(frozen=True)
+class Column:
+    name: str
+
+    format: str  # Type code of `array` module.
+
+    @property
+    def type(self) -> str:
+        return TYPE_NAMES[self.format]
+
+    @property
+    def width(self) -> int:
+        return struct.calcsize(self.format)
+
+
+@dataclass(frozen=True)
+class IndexEntry:
+    offset: int
+
+    first_time: int
+
+    last_time: int
+
+    num_rows: int
+
+
+@dataclass
+class Block:
+    """Data block. Columns are memoryviews of the mapped file which are
+    released once the file is closed.
+    """
+
+    entry: IndexEntry
+
+    time: array
+
+    columns: dict[str, memoryview]
+
+    def __getitem__(self, name: str) -> memoryview:
+        return self.columns[name]
+
+    def __len__(self) -> int:
+        return self.entry.num_rows
+
+
+class Series:
+    """Time series file mapped to memory for reading."""
+
+    def __init__(self, path: PathLike | str):
+        self.path = path
+        with open(path, 'rb') as fin:
+            if os.fstat(fin.fileno()).st_size < 16:
+                raise ValueError(f'File is too short: {path}.')
+            self.buf = mmap.mmap(fin.fileno(), 0, access=mmap.ACCESS_READ)
+        self.view = memoryview(self.buf)
+        # Views of columns which are handed out and still alive by their ids.
+        # Mapping is not closed while any of them exports it.
+        self._views: dict[int, ref[memoryview]] = {}
+        try:
+            self.columns = self._read_header()
+        except Exception:
+            self.close()
+            raise
+        self._index: list[IndexEntry] | None = None
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *args):
+        self.close()
+
+    def close(self):
+        for view_ref in list(self._views.values()):
+            if (view := view_ref()) is not None:
+                view.release()
+        self.view.release()
+        self.buf.close()
+
+    def _read_header(self) -> list[Column]:
+        magic, version, num_columns, size, _ = \
+            struct.unpack_from('<4sHHII', self.buf)
+        if magic != MAGIC:
+            raise ValueError(f'Not a time series file: {self.path}.')
+        if version != VERSION:
+            raise ValueError(f'Unsupported version: {version}.')
+        self.header_size = size
+        columns = []
+        offset = 16
+        for _ in range(num_columns):
+            code, length = struct.unpack_from('<BB', self.buf, offset)
+            name = bytes(self.view[offset + 2:offset + 2 + length])
+            if code not in TYPES:
+                raise ValueError(f'Unknown type of column {name!r}: {code}.')
+            columns.append(Column(name.decode('utf-8'), TYPES[code]))
+            offset += 2 + length
+        return columns
+
+    def index(self) -> list[IndexEntry]:
+        """List data blocks in order. Index blocks are followed from the end
+        of file if it is closed properly and file is scanned otherwise.
+        """
+        if self._index is None:
+            if self.buf[-8:] == END_MAGIC:
+                self._index = self._read_index()
+            else:
+                self._index = self._scan()
+        return self._index
+
+    def _read_index(self) -> list[IndexEntry]:
+        chunks: list[list[IndexEntry]] = []
+        (offset,) = struct.unpack_from('<q', self.buf, len(self.buf) - 16)
+        while offset != -1:
+            tag, _ = BLOCK_HEADER.unpack_from(self.buf, offset)
+            if tag != b'INDX':
+                raise ValueError(f'Broken index at offset {offset}.')
+            prev, num_entries, _ = INDEX_HEADER.unpack_from(
+                self.buf, offset + BLOCK_HEADER.size)
+            begin = offset + BLOCK_HEADER.size + INDEX_HEADER.size
+            chunks.append([
+                IndexEntry(*INDEX_ENTRY.unpack_from(
+                    self.buf, begin + i * INDEX_ENTRY.size)[:4])
+                for i in range(num_entries)])
+            offset = prev
+        return [entry for chunk in reversed(chunks) for entry in chunk]
+
+    def _scan(self) -> list[IndexEntry]:
+        entries = []
+        offset = self.header_size
+        while offset + BLOCK_HEADER.size <= len(self.buf):
+            tag, size = BLOCK_HEADER.unpack_from(self.buf, offset)
+            end = offset + BLOCK_HEADER.size + size
+            if end > len(self.buf):
+                break  # Block is being written or writer crashed.
+            if tag == b'DATA':
+                num_rows, _, first, last = DATA_HEADER.unpack_from(
+                    self.buf, offset + BLOCK_HEADER.size)
+                entries.append(IndexEntry(offset, first, last, num_rows))
+            offset = end
+        return entries
+
+    def block(self, entry: IndexEntry) -> Block:
+        offset = entry.offset + BLOCK_HEADER.size
+        num_rows, time_size, first, _ = \
+            DATA_HEADER.unpack_from(self.buf, offset)
+        offset += DATA_HEADER.size
+        time = decode_times(self.view[offset:offset + time_size], first,
+                            num_rows)
+        offset = align(offset + time_size)
+        columns = {}
+        for column in self.columns:
+            size = num_rows * column.width
+            view = self.view[offset:offset + size].cast(column.format)
+            self._track(view)
+            columns[column.name] = view
+            offset = align(offset + size)
+        return Block(entry, time, columns)
+
+    def _track(self, view: memoryview):
+        # Callback does not refer to `self` in order not to make a cycle.
+        key, views = id(view), self._views
+        views[key] = ref(view, lambda _: views.pop(key, None))
+
+    def blocks(self, start: int | None = None,
+               stop: int | None = None) -> Iterator[Block]:
+        """Iterate over data blocks which have rows in time range
+        `[start, stop)`. Blocks are selected with index only.
+        """
+        for entry in self.index():
+            if start is not None and entry.last_time < start:
+                continue
+            if stop is not None and entry.first_time >= stop:
+                continue
+            yield self.block(entry)
+
+    def read(self, start: int | None = None, stop: int | None = None,
+             ) -> tuple[array, dict[str, array]]:
+        """Read rows in time range `[start, stop)` to arrays."""
+        time = array('q')
+        columns = {c.name: array(c.format) for c in self.columns}
+        for block in self.blocks(start, stop):
+            entry = block.entry
+            if (start is None or entry.first_time >= start) and \
+                    (stop is None or entry.last_time < stop):
+                time.extend(block.time)
+                for name, values in block.columns.items():
+                    columns[name].frombytes(values.cast('B'))
+                    values.release()
+                continue
+            rows = [i for i, t in enumerate(block.time)
+                    if (start is None or t >= start) and
+                    (stop is None or t < stop)]
+            time.extend(block.time[i] for i in rows)
+            for name, values in block.columns.items():
+                columns[name].extend(values[i] for i in rows)
+                values.release()
+        return time, columns
+
+    def __len__(self) -> int:
+        return sum(entry.num_rows for entry in self.index())
+
+
+parser = ArgumentParser(description='Print time series file as CSV.')
+parser.add_argument('path', help='path to time series file')
+parser.add_argument('--start', type=int, help='first timestamp')
+parser.add_argument('--stop', type=int, help='timestamp after the last one')
+
+
+def main() -> None:
+    ns: Namespace = parser.parse_args()
+    with Series(ns.path) as series:
+        time, columns = series.read(ns.start, ns.stop)
+    print(','.join(['time', *columns]))
+    for row in zip(time, *columns.values()):
+        print(','.join(str(x) for x in row))
+
+
+if __name__ == '__main__':
+    main()
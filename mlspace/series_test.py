@@ -0,0 +1,122 @@
+# Copyright 2025 Daniel Bershatsky
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+import struct
+from pathlib import Path
+
+import pytest
+
+from mlspace.config import config
+from mlspace.launch import Job
+from mlspace.series import Series
+
+
+def varint(value: int) -> bytes:
+    value = (value << 1) ^ (value >> 63)
+    out = bytearray()
+    while value >= 0x80:
+        out.append(value & 0x7f | 0x80)
+        value >>= 7
+    out.append(value)
+    return bytes(out)
+
+
+def pad(buf: bytes) -> bytes:
+    return buf + b'\0' * (-len(buf) % 8)
+
+
+def write_series(path: Path, rows: list[tuple[int, float, int]],
+                 rows_per_block: int, index: bool = True):
+    """Write file of columns `loss` (float64) and `step` (int32) in the same
+    way as `SeriesWriter` does.
+    """
+    header = pad(b'MLTS' + struct.pack('<HHII', 1, 2, 0, 0) +
+                 bytes([2, 4]) + b'loss' + bytes([3, 4]) + b'step')
+    header = header[:8] + struct.pack('<I', len(header)) + header[12:]
+    out = bytearray(header)
+    entries = []
+    for i in range(0, len(rows), rows_per_block):
+        chunk = rows[i:i + rows_per_block]
+        times = b''.join(varint(t - p) for p, t in zip(
+            [chunk[0][0]] + [r[0] for r in chunk[:-1]], [r[0] for r in chunk]))
+        payload = struct.pack('<IIqq', len(chunk), len(times), chunk[0][0],
+                              chunk[-1][0])
+        payload = pad(payload + times)
+        payload += pad(struct.pack(f'<{len(chunk)}d', *(r[1] for r in chunk)))
+        payload += pad(struct.pack(f'<{len(chunk)}i', *(r[2] for r in chunk)))
+        entries.append((len(out), chunk[0][0], chunk[-1][0], len(chunk)))
+        out += b'DATA' + struct.pack('<I', len(payload)) + payload
+    if index:
+        offset = len(out)
+        payload = struct.pack('<qII', -1, len(entries), 0)
+        for entry in entries:
+            payload += struct.pack('<qqqII', *entry, 0)
+        payload += struct.pack('<q', offset) + b'MLTS_END'
+        out += b'INDX' + struct.pack('<I', len(payload)) + payload
+    path.write_bytes(bytes(out))
+
+
+@pytest.mark.parametrize('index', [True, False], ids=['index', 'scan'])
+def test_series(tmp_path: Path, index: bool):
+    rows = [(1000 + 10 * i - (i % 3), 0.5 * i, i) for i in range(10)]
+    write_series(tmp_path / 'a.mlts', rows, 4, index)
+    with Series(tmp_path / 'a.mlts') as series:
+        assert [(c.name, c.type) for c in series.columns] == \
+            [('loss', 'float64'), ('step', 'int32')]
+        assert [e.num_rows for e in series.index()] == [4, 4, 2]
+        assert len(series) == 10
+
+        time, columns = series.read()
+        assert list(time) == [r[0] for r in rows]
+        assert list(columns['loss']) == [r[1] for r in rows]
+        assert list(columns['step']) == [r[2] for r in rows]
+
+        # Only the second block overlaps time range.
+        blocks = list(series.blocks(1040, 1060))
+        assert [b.entry.num_rows for b in blocks] == [4]
+        assert blocks[0]['step'].tolist() == [4, 5, 6, 7]
+
+        time, columns = series.read(1020, 1050)
+        assert list(time) == [1030, 1039, 1048]
+        assert list(columns['step']) == [3, 4, 5]
+        assert list(columns['loss']) == [1.5, 2.0, 2.5]
+
+    # Views which are still alive are released on close.
+    with pytest.raises(ValueError):
+        blocks[0]['step'].tolist()
+
+
+def test_series_invalid(tmp_path: Path):
+    (tmp_path / 'a.mlts').write_bytes(b'not a time series file')
+    with pytest.raises(ValueError):
+        Series(tmp_path / 'a.mlts')
+
+
+@pytest.mark.skipif(config.launch_bin is None,
+                    reason='Binary `launch` is not found.')
+def test_series_launch(tmp_path: Path):
+    """Read metrics which are written by supervisor of real `launch`."""
+    job = Job(executable=Path('/bin/sh'), args=['-c', 'sleep 1'],
+              metrics=tmp_path / 'metrics.mlts')
+    job.launch()
+    job.join()
+    with Series(tmp_path / 'metrics.mlts') as series:
+        names = [c.name for c in series.columns]
+        assert names[-3:] == ['threads', 'output_bytes', 'progress']
+        assert len(series) >= 2
+        time, columns = series.read()
+        assert len(time) == len(series)
+        assert list(time) == sorted(time)
+        assert all(len(values) == len(time) for values in columns.values())
+        assert max(columns['threads']) >= 1
+        assert list(columns['output_bytes']) == [0] * len(time)
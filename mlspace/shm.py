@@ -0,0 +1,81 @@
+# Copyright 2025 Daniel Bershatsky
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""Attach to shared memory region allocated by `launch` supervisor.
+
+Supervisor allocates a memory file (preferably backed by huge pages) and
+passes its descriptor and size to a job in `MLSPACE_SHM_FD` and
+`MLSPACE_SHM_SIZE` environment variables. The descriptor is inherited by
+descendants of a job unless they are spawned with descriptors closed (e.g.
+by `subprocess.Popen` which torchrun uses for ranks). Such processes still
+see the variables, so that the region is opened through procfs of supervisor
+(`MLSPACE_SHM_PID`) instead. Thus all descendants map the same pages. How
+the region is split between processes is up to a job.
+
+    buf = attach()
+    arr = np.frombuffer(buf, dtype=np.float32, count=1024, offset=4096)
+"""
+
+import mmap
+import os
+
+__all__ = ('attach', 'is_region', 'size')
+
+ENV_FD = 'MLSPACE_SHM_FD'
+
+ENV_SIZE = 'MLSPACE_SHM_SIZE'
+
+ENV_PID = 'MLSPACE_SHM_PID'
+
+MEMFD_NAME = '/memfd:mlspace-shm'
+
+
+def size() -> int:
+    """Size of shared region in bytes or zero if there is no region."""
+    return int(os.getenv(ENV_SIZE, '0'))
+
+
+def attach() -> mmap.mmap | None:
+    """Map shared region for reading and writing. It returns `None` if a job
+    is not run by `launch` or a region is not requested.
+    """
+    if (value := os.getenv(ENV_FD)) is None or size() == 0:
+        return None
+    fd = int(value)
+    if is_region(fd):
+        return mmap.mmap(fd, size(), mmap.MAP_SHARED,
+                         mmap.PROT_READ | mmap.PROT_WRITE)
+
+    # Descriptor is closed or reused by another file in this process.
+    if (pid := os.getenv(ENV_PID)) is None:
+        raise RuntimeError(f'Descriptor {fd} of shared region is not '
+                           'inherited and supervisor is unknown.')
+    fd = os.open(f'/proc/{pid}/fd/{fd}', os.O_RDWR | os.O_CLOEXEC)
+    try:
+        if not is_region(fd):
+            raise RuntimeError(f'Descriptor {value} of supervisor {pid} is '
+                               'not a shared region.')
+        return mmap.mmap(fd, size(), mmap.MAP_SHARED,
+                         mmap.PROT_READ | mmap.PROT_WRITE)
+    finally:
+        os.close(fd)
+
+
+def is_region(fd: int) -> bool:
+    """Check that descriptor refers to memory file of supervisor."""
+    try:
+        target = os.readlink(f'/proc/self/fd/{fd}')
+    except OSError:
+        return False
+    # Unlinked memory files are shown as `/memfd:<name> (deleted)`.
+    return target == MEMFD_NAME or target.startswith(MEMFD_NAME + ' ')
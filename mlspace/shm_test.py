@@ -0,0 +1,84 @@
+# Copyright 2025 Daniel Bershatsky
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+import os
+import sys
+from pathlib import Path
+from subprocess import Popen, run
+from textwrap import dedent
+
+import pytest
+
+from mlspace.shm import ENV_FD, ENV_PID, ENV_SIZE, attach, is_region, size
+
+
+def test_attach(monkeypatch: pytest.MonkeyPatch):
+    monkeypatch.delenv(ENV_FD, raising=False)
+    monkeypatch.delenv(ENV_SIZE, raising=False)
+    assert size() == 0
+    assert attach() is None
+
+    fd = os.memfd_create('mlspace-shm')
+    try:
+        os.ftruncate(fd, 8192)
+        monkeypatch.setenv(ENV_FD, str(fd))
+        monkeypatch.setenv(ENV_SIZE, '8192')
+        assert size() == 8192
+        assert is_region(fd)
+        with attach() as fst, attach() as snd:
+            fst[4096:4101] = b'hello'
+            assert snd[4096:4101] == b'hello'
+    finally:
+        os.close(fd)
+
+
+# Job spawns a rank with `Popen` (descriptors are closed) and the rank reuses
+# descriptor number of the region for another file before it attaches.
+JOB = dedent('''
+    import sys
+    from subprocess import run
+    sys.exit(run([sys.executable, '-c', sys.argv[1]]).returncode)
+''')
+
+RANK = dedent('''
+    import os
+    from mlspace.shm import ENV_FD, attach
+    fd = os.open(os.devnull, os.O_RDWR)
+    os.dup2(fd, int(os.environ[ENV_FD]))
+    with attach() as buf:
+        buf[:5] = b'hello'
+''')
+
+
+def test_attach_not_inherited(monkeypatch: pytest.MonkeyPatch):
+    fd = os.memfd_create('mlspace-shm')
+    try:
+        os.ftruncate(fd, 4096)
+        monkeypatch.setenv(ENV_FD, str(fd))
+        monkeypatch.setenv(ENV_SIZE, '4096')
+        monkeypatch.setenv(ENV_PID, str(os.getpid()))
+        root = Path(__file__).parents[1]
+        monkeypatch.setenv('PYTHONPATH', str(root))
+        with Popen([sys.executable, '-c', JOB, RANK],
+                   pass_fds=(fd,)) as proc:
+            assert proc.wait() == 0
+        with open(f'/proc/self/fd/{fd}', 'rb') as fin:
+            assert fin.read(5) == b'hello'
+
+        # Region is not found without supervisor pid.
+        monkeypatch.delenv(ENV_PID)
+        res = run([sys.executable, '-c', JOB, RANK], capture_output=True)
+        assert res.returncode != 0
+        assert b'RuntimeError' in res.stderr
+    finally:
+        os.close(fd)
@@ -12,19 +12,166 @@
 # See the License for the specific language governing permissions and
 # limitations under the License.
 
+"""Simulator of Gateway API for testing and load testing of clients.
+
+Simulated jobs are queued and run for random durations. Responses are delayed
+randomly, and throttling (429), server errors (5xx) and connection drops are
+injected at given rates. For example, the following command spawns a
+simulator where jobs run for 10 seconds on average and every tenth request is
+throttled.
+
+  python -m mlspace.testing --run exp:10 --latency uniform:0.01,0.1 \\
+      --throttle-rate 0.1 --retry-after 1
+"""
+
 import json
-from argparse import ArgumentParser, Namespace
+import math
+import time
+from argparse import ArgumentParser, ArgumentTypeError, Namespace
 from codecs import getwriter
-from http.server import BaseHTTPRequestHandler, HTTPServer
+from collections import deque
+from dataclasses import dataclass, field, replace
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
 from io import BytesIO
-from random import randint
-from threading import Thread
-from typing import Any, Sequence
+from random import Random, randint
+from threading import Lock, Thread
+from typing import Any, Literal, Sequence
+from urllib.parse import parse_qs, unquote, urlsplit
 from uuid import uuid4
 
+JOBS_PATH = '/public/v2/jobs'
+
+# Pseudo-status of injected fault which closes connection without response.
+DROP = 0
+
+ERROR_STATUSES = (500, 502, 503, 504)
+
+
+@dataclass(frozen=True)
+class Distribution:
+    """Distribution of simulated durations in seconds. It is parsed from
+    string specification as follows.
+
+      0.5                 Constant.
+      uniform:0.1,0.5     Uniform on [0.1, 0.5].
+      exp:0.2             Exponential with mean 0.2.
+      lognormal:-2,0.5    Log-normal with mu=-2 and sigma=0.5.
+    """
+
+    kind: Literal['constant', 'uniform', 'exp', 'lognormal'] = 'constant'
+
+    params: tuple[float, ...] = (0.0,)
+
+    ARITY = {'constant': 1, 'uniform': 2, 'exp': 1, 'lognormal': 2}
+
+    def __post_init__(self):
+        if (arity := self.ARITY.get(self.kind)) is None:
+            raise ValueError(f'Unknown distribution: {self.kind}.')
+        if len(self.params) != arity:
+            raise ValueError(f'Distribution {self.kind} requires {arity} '
+                             f'parameters: {self.params}.')
+
+    @classmethod
+    def constant(cls, value: float) -> 'Distribution':
+        return cls('constant', (value, ))
+
+    @classmethod
+    def parse(cls, spec: str) -> 'Distribution':
+        kind, sep, args = spec.partition(':')
+        try:
+            if not sep:
+                return cls.constant(float(kind))
+            params = tuple(float(arg) for arg in args.split(','))
+        except ValueError as e:
+            raise ValueError(f'Invalid distribution: {spec}.') from e
+        return cls(kind, params)  # type: ignore[arg-type]
+
+    def sample(self, rng: Random) -> float:
+        match self.kind, self.params:
+            case 'constant', (value, ):
+                return value
+            case 'uniform', (lo, hi):
+                return rng.uniform(lo, hi)
+            case 'exp', (mean, ):
+                return rng.expovariate(1 / mean) if mean > 0 else 0.0
+            case 'lognormal', (mu, sigma):
+                return rng.lognormvariate(mu, sigma)
+        raise RuntimeError('Unreachable.')
+
+    def __str__(self) -> str:
+        if self.kind == 'constant':
+            return str(self.params[0])
+        return f'{self.kind}:' + ','.join(str(x) for x in self.params)
+
+
+@dataclass
+class Simulation:
+    """Parameters of simulated jobs and server behaviour. Rates are
+    probabilities for every request (or for every job in case of
+    `fail_rate`).
+    """
+
+    queue: Distribution = field(default_factory=Distribution)
+
+    run: Distribution = field(default_factory=Distribution)
+
+    latency: Distribution = field(default_factory=Distribution)
+
+    fail_rate: float = 0.0
+
+    throttle_rate: float = 0.0
+
+    error_rate: float = 0.0
+
+    drop_rate: float = 0.0
+
+    retry_after: float | None = None
+
+    log_rate: float = 100.0  # Lines per second of running.
+
+    def fault(self, rng: Random) -> tuple[int, float | None] | None:
+        """Draw a random fault for a request."""
+        value = rng.random()
+        if (value := value - self.drop_rate) < 0:
+            return DROP, None
+        if (value := value - self.throttle_rate) < 0:
+            return 429, self.retry_after
+        if value - self.error_rate < 0:
+            return rng.choice(ERROR_STATUSES), None
+        return None
+
+
+def distribution(spec: str) -> Distribution:
+    try:
+        return Distribution.parse(spec)
+    except ValueError as e:
+        raise ArgumentTypeError(str(e)) from e
+
+
 parser = ArgumentParser(description='Simple mock server for testing purposes.')
 parser.add_argument('-H', '--host', default='localhost')
 parser.add_argument('-p', '--port', type=int, default=8080)
+parser.add_argument('-q', '--quiet', default=False, action='store_true',
+                    help='do not log requests')
+parser.add_argument('-s', '--seed', type=int, help='random seed')
+
+g_sim = parser.add_argument_group('simulation options')
+g_sim.add_argument('--queue', type=distribution, default=Distribution(),
+                   help='time in queue (seconds)')
+g_sim.add_argument('--run', type=distribution, default=Distribution(),
+                   help='running time (seconds)')
+g_sim.add_argument('--latency', type=distribution, default=Distribution(),
+                   help='response latency (seconds)')
+g_sim.add_argument('--fail-rate', type=float, default=0.0,
+                   help='probability that job fails')
+g_sim.add_argument('--throttle-rate', type=float, default=0.0,
+                   help='probability of 429 response')
+g_sim.add_argument('--error-rate', type=float, default=0.0,
+                   help='probability of 5xx response')
+g_sim.add_argument('--drop-rate', type=float, default=0.0,
+                   help='probability of connection drop')
+g_sim.add_argument('--retry-after', type=float,
+                   help='value of retry-after header of 429 response')
 
 
 def has_required_keys(obj: dict[str, Any], keys: Sequence[str]):
@@ -35,36 +182,160 @@ def has_required_keys(obj: dict[str, Any], keys: Sequence[str]):
 
 class RequestHandler(BaseHTTPRequestHandler):
 
+    protocol_version = 'HTTP/1.1'  # Keep-alive.
+
     def __init__(self, *args, quiet=False, **kwargs):
         self.quiet = quiet
         super().__init__(*args, **kwargs)
 
+    def parse_request(self) -> bool:
+        # Requests are counted and faults are injected here in order to cover
+        # all endpoints at once. Handler method is not called on false.
+        if not super().parse_request():
+            return False
+        server = self.mock
+        with server.lock:
+            server.num_requests += 1
+            if server.faults:
+                fault = server.faults.popleft()
+            else:
+                fault = server.sim.fault(server.rng)
+            latency = server.sim.latency.sample(server.rng)
+            if fault is not None:
+                server.num_faults += 1
+        if latency > 0:
+            time.sleep(latency)
+        if fault is None:
+            return True
+        self.read_body_if_any()
+        status, retry_after = fault
+        if status == DROP:
+            self.close_connection = True
+            return False
+        self.send_response(status)
+        if retry_after is not None:
+            self.send_header('retry-after', str(retry_after))
+        self.send_header('content-length', '0')
+        self.end_headers()
+        return False
+
+    @property
+    def mock(self) -> 'MockHTTPServer':
+        return self.server  # type: ignore[return-value]
+
+    def read_body_if_any(self):
+        if (value := self.headers.get('content-length')) is not None:
+            self.rfile.read(int(value))
+
     def log_message(self, format: str, *args):
         if not self.quiet:
             super().log_message(format, *args)
 
     def do_GET(self):
-        if self.path == '/ping':
+        url = urlsplit(self.path)
+        if url.path == '/ping':
             self.send_response(200)
+            self.send_header('content-length', '0')
             self.end_headers()
+        elif url.path == JOBS_PATH:
+            self.handle_job_list(parse_qs(url.query))
+        elif (name := self.job_name(url.path, '/logs')) is not None:
+            self.handle_job_logs(name, parse_qs(url.query))
+        elif (name := self.job_name(url.path)) is not None:
+            self.handle_job_status(name)
         else:
             self.send_error(404)
-        self.log_request
 
     def do_POST(self):
         try:
-            if self.path == '/public/v2/jobs':
+            if self.path == JOBS_PATH:
                 self.handle_job_run()
             else:
                 self.send_error(404)
         except ValueError:
             self.send_error(400)
 
+    def do_DELETE(self):
+        if (name := self.job_name(self.path)) is not None:
+            self.handle_job_kill(name)
+        else:
+            self.send_error(404)
+
+    def job_name(self, path: str, suffix: str = '') -> str | None:
+        prefix = JOBS_PATH + '/'
+        if not path.startswith(prefix) or not path.endswith(suffix):
+            return None
+        name = unquote(path[len(prefix):len(path) - len(suffix)])
+        return name if name and '/' not in name else None
+
     def handle_job_run(self):
         req = self.read_json()
         has_required_keys(req, ('script', 'base_image', 'instance_type'))
-        res = {'job_name': f'lm-mpi-job-{uuid4()}'}
-        self.send_json(res)
+        name = f'lm-mpi-job-{uuid4()}'
+        with self.mock.lock:
+            job = self.mock.spawn(name, req.get('region'))
+        self.send_json({'job_name': name})
+
+    def handle_job_kill(self, name: str):
+        with self.mock.lock:
+            if (job := self.mock.jobs.get(name)) is not None:
+                job.kill()
+        if job is None:
+            return self.send_error(404)
+        self.send_json({'job_name': name, 'status': job.status()})
+
+    def handle_job_list(self, query: dict[str, list[str]]):
+        with self.mock.lock:
+            jobs = [job.to_dict() for job in self.mock.jobs.values()]
+        for key in ('region', 'status'):
+            if (values := query.get(key)) is not None:
+                jobs = [job for job in jobs if job[key] in values]
+        self.send_json({'jobs': jobs})
+
+    def handle_job_logs(self, name: str, query: dict[str, list[str]]):
+        with self.mock.lock:
+            job = self.mock.jobs.get(name)
+        if job is None:
+            return self.send_error(404)
+        try:
+            offset = int(query.get('offset', ['0'])[0])
+            wait = float(query.get('wait', ['0'])[0])
+            tail = int(query['tail'][0]) if 'tail' in query else None
+        except ValueError:
+            return self.send_error(400)
+
+        # Hold request until new output appears (long polling).
+        deadline = time.monotonic() + min(wait, 30)
+        while True:
+            log, complete = job.log()
+            if len(log) > offset or complete or time.monotonic() >= deadline:
+                break
+            time.sleep(0.01)
+
+        if tail is not None:
+            content = b''.join(log.splitlines(True)[-tail:])
+        elif self.mock.log_offsets:
+            content = log[offset:]
+        else:
+            content = log
+        with self.mock.lock:
+            self.mock.log_bytes += len(content)
+
+        self.send_response(200)
+        self.send_header('content-type', 'text/plain; charset=utf-8')
+        self.send_header('content-length', str(len(content)))
+        if self.mock.log_offsets:
+            self.send_header('x-log-offset', str(len(log)))
+            self.send_header('x-log-complete', '1' if complete else '0')
+        self.end_headers()
+        self.wfile.write(content)
+
+    def handle_job_status(self, name: str):
+        with self.mock.lock:
+            job = self.mock.jobs.get(name)
+        if job is None:
+            return self.send_error(404)
+        self.send_json(job.to_dict())
 
     def send_json(self, obj):
         buf = BytesIO()
@@ -93,13 +364,98 @@ class RequestHandler(BaseHTTPRequestHandler):
             raise ValueError from e
 
 
+class MockJob:
+    """Job waits in a queue for `queue_duration` seconds, runs for
+    `run_duration` seconds and completes (or fails).
+    """
+
+    def __init__(self, name: str, region: str | None = None,
+                 queue_duration: float = 0.0, run_duration: float = 0.0,
+                 fails: bool = False, log_rate: float = 100.0):
+        self.name = name
+        self.region = region
+        self.queue_duration = queue_duration
+        self.run_duration = run_duration
+        self.fails = fails
+        self.created_at = time.time()
+        self.killed_at: float | None = None
+        self.log_rate = log_rate
+
+    def log(self) -> tuple[bytes, bool]:
+        """Output produced so far (`log_rate` lines per second of running)
+        and whether job is finished.
+        """
+        status = self.status()
+        now = self.killed_at or time.time()
+        running = now - self.created_at - self.queue_duration
+        lines = []
+        if running >= 0:
+            steps = min(running, self.run_duration) * self.log_rate
+            steps = int(steps) if math.isfinite(steps) else 0
+            lines.append(f'job {self.name} started\n')
+            lines.extend(f'step {i}\n' for i in range(steps))
+        complete = status in ('Completed', 'Failed', 'Stopped')
+        if complete:
+            lines.append(f'job {self.name} is {status.lower()}\n')
+        return ''.join(lines).encode('utf-8'), complete
+
+    def kill(self):
+        if self.killed_at is None and self.status() in ('Pending', 'Running'):
+            self.killed_at = time.time()
+
+    def status(self) -> str:
+        if self.killed_at is not None:
+            return 'Stopped'
+        elapsed = time.time() - self.created_at
+        if elapsed < self.queue_duration:
+            return 'Pending'
+        if elapsed < self.queue_duration + self.run_duration:
+            return 'Running'
+        return 'Failed' if self.fails else 'Completed'
+
+    def to_dict(self) -> dict[str, Any]:
+        return {'job_name': self.name, 'status': self.status(),
+                'region': self.region, 'created_at': self.created_at}
+
+
+class MockHTTPServer(ThreadingHTTPServer):
+
+    daemon_threads = True
+
+    def __init__(self, *args, sim: Simulation | None = None,
+                 seed: int | None = None, **kwargs):
+        super().__init__(*args, **kwargs)
+        self.lock = Lock()
+        self.sim = sim or Simulation()
+        self.rng = Random(seed)
+        self.num_requests = 0
+        self.num_faults = 0
+        self.faults: deque[tuple[int, float | None]] = deque()
+        self.jobs: dict[str, MockJob] = {}
+        self.log_offsets = True  # Whether to support `offset` of logs.
+        self.log_bytes = 0  # Total size of logs sent.
+
+    def spawn(self, name: str, region: str | None) -> MockJob:
+        """Create a job with random durations. Lock must be held."""
+        job = MockJob(name, region,
+                      queue_duration=self.sim.queue.sample(self.rng),
+                      run_duration=self.sim.run.sample(self.rng),
+                      fails=self.rng.random() < self.sim.fail_rate,
+                      log_rate=self.sim.log_rate)
+        self.jobs[name] = job
+        return job
+
+
 class MockServer:
-    """Simple mock server for `mlspace.api.GatewayV2`.
+    """Simulator of `mlspace.api.GatewayV2` (see :class:`Simulation`).
 
-    NOTE It is not completely thread-safe.
+    Every request is served in its own thread. Faults injected with
+    :meth:`inject` or :meth:`drop` are returned to the next requests instead
+    of responses. Otherwise, random faults are drawn.
     """
 
-    def __init__(self, host: str, port: int, quiet=False):
+    def __init__(self, host: str, port: int, quiet=False,
+                 sim: Simulation | None = None, seed: int | None = None):
         self.host = host
         self.port = port
         self.endpoint = f'http://{self.host}:{self.port}'
@@ -109,7 +465,49 @@ class MockServer:
 
         # TODO(@daskol): Are sockets managed inproperly in abnormal conditions?
         # TODO(@daskol): Reusable?
-        self.server = HTTPServer((self.host, self.port), fn)
+        self.server = MockHTTPServer((self.host, self.port), fn, sim=sim,
+                                     seed=seed)
+
+    @property
+    def num_requests(self) -> int:
+        return self.server.num_requests
+
+    @property
+    def jobs(self) -> dict[str, MockJob]:
+        return self.server.jobs
+
+    @property
+    def num_faults(self) -> int:
+        return self.server.num_faults
+
+    @property
+    def log_bytes(self) -> int:
+        return self.server.log_bytes
+
+    @property
+    def sim(self) -> Simulation:
+        return self.server.sim
+
+    def configure(self, **kwargs):
+        """Update simulation parameters (see :class:`Simulation`)."""
+        with self.server.lock:
+            self.server.sim = replace(self.server.sim, **kwargs)
+
+    def set_durations(self, queue: float = 0.0, run: float = 0.0):
+        """Set how long new jobs stay pending and running."""
+        self.configure(queue=Distribution.constant(queue),
+                       run=Distribution.constant(run))
+
+    def inject(self, status: int, count: int = 1,
+               retry_after: float | None = None):
+        """Respond with `status` to the next `count` requests."""
+        with self.server.lock:
+            self.server.faults.extend([(status, retry_after)] * count)
+
+    def drop(self, count: int = 1):
+        """Close connection of the next `count` requests without response.
+        """
+        self.inject(DROP, count)
 
     def run(self):
         with self.server as httpd:
@@ -119,12 +517,12 @@ class MockServer:
         self.server.shutdown()
 
 
-def spawn_mock_server(host='localhost',
-                      num_attempts=5) -> tuple[MockServer, Thread]:
+def spawn_mock_server(host='localhost', num_attempts=5,
+                      **kwargs) -> tuple[MockServer, Thread]:
     for _ in range(num_attempts):
         port = randint(4096, 65535)
         try:
-            server = MockServer(host, port, quiet=True)
+            server = MockServer(host, port, quiet=True, **kwargs)
         except OSError:
             continue
         thread = Thread(target=server.run)
@@ -137,7 +535,10 @@ def spawn_mock_server(host='localhost',
 
 def main() -> None:
     ns: Namespace = parser.parse_args()
-    MockServer(ns.host, ns.port).run()
+    sim = Simulation(ns.queue, ns.run, ns.latency, ns.fail_rate,
+                     ns.throttle_rate, ns.error_rate, ns.drop_rate,
+                     ns.retry_after)
+    MockServer(ns.host, ns.port, ns.quiet, sim, ns.seed).run()
 
 
 if __name__ == '__main__':
@@ -0,0 +1,117 @@
+# Copyright 2025 Daniel Bershatsky
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from random import Random
+from typing import Iterator
+
+import pytest
+
+from mlspace.api import GatewayV2, RetryPolicy
+from mlspace.testing import (Distribution, MockServer, Simulation,
+                             spawn_mock_server)
+
+KWARGS = {
+    'api_key': 'API_KEY',
+    'access_token': 'JWT',
+    'workspace_id': '00000000-0000-0000-0000-000000000000',
+}
+
+JOB = {
+    'script': '/home/user/.cache/mlspace/launch',
+    'base_image': 'cr.ai.cloud.ru/8ff21ec0-666d-4950/job-example',
+    'instance_type': 'v100.1gpu',
+}
+
+RETRY = RetryPolicy(max_attempts=10, backoff_base=0.001, backoff_max=0.01)
+
+
+@pytest.fixture
+def gwapi() -> Iterator[MockServer]:
+    server, thread = spawn_mock_server(seed=42)
+    try:
+        yield server
+    finally:
+        server.stop()
+        thread.join()
+
+
+class TestDistribution:
+
+    @pytest.mark.parametrize('spec', [
+        '0.5', 'uniform:0.1,0.5', 'exp:0.2', 'lognormal:-2.0,0.5',
+    ])
+    def test_parse(self, spec: str):
+        dist = Distribution.parse(spec)
+        assert str(dist) == spec
+        rng = Random(42)
+        assert all(x >= 0 for x in (dist.sample(rng) for _ in range(100)))
+
+    @pytest.mark.parametrize('spec', ['', 'x', 'uniform:1', 'gamma:1,2'])
+    def test_parse_invalid(self, spec: str):
+        with pytest.raises(ValueError):
+            Distribution.parse(spec)
+
+    def test_uniform(self):
+        dist = Distribution.parse('uniform:1,2')
+        rng = Random(42)
+        assert all(1 <= dist.sample(rng) <= 2 for _ in range(100))
+
+
+class TestSimulation:
+
+    def test_fault(self):
+        rng = Random(42)
+        sim = Simulation(throttle_rate=0.2, error_rate=0.1, drop_rate=0.1,
+                         retry_after=1)
+        faults = [sim.fault(rng) for _ in range(10_000)]
+        statuses = [fault[0] for fault in faults if fault is not None]
+        assert 1800 < statuses.count(429) < 2200
+        assert 800 < statuses.count(0) < 1200
+        assert 800 < sum(status >= 500 for status in statuses) < 1200
+        assert Simulation().fault(rng) is None
+
+
+class TestMockServer:
+
+    def test_drop(self, gwapi: MockServer):
+        cli = GatewayV2(**KWARGS, endpoint=gwapi.endpoint, retry=RETRY)
+        gwapi.drop()
+        assert cli.ping()  # Idempotent request is retried.
+        assert gwapi.num_requests == 2
+        assert gwapi.num_faults == 1
+
+    def test_lifecycle(self, gwapi: MockServer):
+        cli = GatewayV2(**KWARGS, endpoint=gwapi.endpoint)
+        gwapi.configure(run=Distribution.constant(60), fail_rate=1.0)
+        job_name = cli.job_run(**JOB)
+        assert cli.job_status(job_name).status == 'Running'
+        cli.job_kill(job_name)
+        assert cli.job_status(job_name).status == 'Stopped'
+
+        gwapi.configure(run=Distribution.constant(0))
+        job_name = cli.job_run(**JOB)
+        assert cli.job_status(job_name).status == 'Failed'
+        assert {job.status for job in cli.job_list()} == {'Stopped', 'Failed'}
+
+    def test_throughput(self, gwapi: MockServer):
+        # Submissions survive throttling and 503 under latency.
+        cli = GatewayV2(**KWARGS, endpoint=gwapi.endpoint, retry=RETRY,
+                        pool_size=8)
+        gwapi.configure(latency=Distribution.parse('uniform:0,0.005'),
+                        throttle_rate=0.2, retry_after=0)
+        gwapi.inject(503, count=4)
+        job_names = cli.job_run_many([JOB] * 64)
+        assert len(set(job_names)) == 64
+        assert len(gwapi.jobs) == 64
+        assert gwapi.num_requests == 64 + gwapi.num_faults